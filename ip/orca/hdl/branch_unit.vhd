@@ -33,7 +33,19 @@ entity branch_unit is
     to_pc_correction_data      : out unsigned(REGISTER_SIZE-1 downto 0);
     to_pc_correction_source_pc : out unsigned(REGISTER_SIZE-1 downto 0);
     to_pc_correction_valid     : out std_logic;
-    from_pc_correction_ready   : in  std_logic
+    from_pc_correction_ready   : in  std_logic;
+    --Which kind of branch/jump the correction is for (performance counters)
+    to_pc_correction_branch    : out std_logic;
+    to_pc_correction_return    : out std_logic;
+
+    --Valid for a cycle per branch/jump to train the branch predictor; the
+    --PC is to_pc_correction_source_pc and the rest hold until the next one.
+    to_predictor_update_valid  : out std_logic;
+    to_predictor_update_branch : out std_logic;
+    to_predictor_update_taken  : out std_logic;
+    to_predictor_update_target : out unsigned(REGISTER_SIZE-1 downto 0);
+    to_predictor_update_call   : out std_logic;
+    to_predictor_update_return : out std_logic
     );
 end entity branch_unit;
 
@@ -61,10 +73,17 @@ architecture rtl of branch_unit is
 
   alias opcode : std_logic_vector(6 downto 0) is instruction(INSTR_OPCODE'range);
   alias func3  : std_logic_vector(2 downto 0) is instruction(INSTR_FUNC3'range);
+  alias rd     : std_logic_vector(4 downto 0) is instruction(REGISTER_RD'range);
+  alias rs1    : std_logic_vector(4 downto 0) is instruction(REGISTER_RS1'range);
 
   signal jal_select    : std_logic;
   signal jalr_select   : std_logic;
   signal branch_select : std_logic;
+
+  signal rd_link   : std_logic;
+  signal rs1_link  : std_logic;
+  signal is_call   : std_logic;
+  signal is_return : std_logic;
 begin
   --Decode instruction to select submodule.  All paths must decode to exactly
   --one submodule.
@@ -150,6 +169,8 @@ begin
       jalr_target when jalr_select = '1' else
       branch_target;
     mispredict <= (take_if_branch and branch_select) or jal_select or jalr_select;
+    --Nothing to train; the update is only used for performance counters
+    to_predictor_update_target <= (others => '0');
     process(clk)
     begin
       if rising_edge(clk) then
@@ -161,6 +182,8 @@ begin
           if to_branch_valid = '1' then
             to_pc_correction_data      <= target_pc;
             to_pc_correction_source_pc <= current_pc;
+            to_pc_correction_branch    <= branch_select;
+            to_pc_correction_return    <= is_return;
 
             if mispredict = '1' then
               to_pc_correction_valid <= '1';
@@ -196,6 +219,8 @@ begin
           if to_branch_valid = '1' then
             previously_targeted_pc     <= target_pc;
             to_pc_correction_source_pc <= current_pc;
+            to_pc_correction_branch    <= branch_select;
+            to_pc_correction_return    <= is_return;
             previously_predicted_pc    <= predicted_pc;
 
             to_pc_correction_valid_if_mispredicted <= '1';
@@ -207,7 +232,8 @@ begin
         end if;
       end if;
     end process;
-    to_pc_correction_data  <= previously_targeted_pc;
+    to_pc_correction_data      <= previously_targeted_pc;
+    to_predictor_update_target <= previously_targeted_pc;
     --Note that computing mispredict during the execute cycle (as is done in
     --the no BTB generate) is more readable/consistent.  The latter part of the
     --mispredict calculation was moved to the next cycle only because there is
@@ -217,6 +243,36 @@ begin
     to_pc_correction_valid <= to_pc_correction_valid_if_mispredicted and was_mispredicted;
   end generate has_predictor_gen;
 
+  --Calls and returns by the standard calling convention, which links through
+  --x1 or x5.  A JALR that reads one link register and links through the
+  --other is both (a coroutine swap); reading and linking the same one is
+  --only a call.
+  rd_link   <= '1' when rd = "00001" or rd = "00101" else '0';
+  rs1_link  <= '1' when rs1 = "00001" or rs1 = "00101" else '0';
+  is_call   <= (jal_select or jalr_select) and rd_link;
+  is_return <= jalr_select and rs1_link and (not (rd_link and bool_to_sl(rd = rs1)));
+
+  process(clk)
+  begin
+    if rising_edge(clk) then
+      to_predictor_update_valid <= '0';
+
+      if to_branch_ready = '1' then
+        if to_branch_valid = '1' then
+          to_predictor_update_valid  <= '1';
+          to_predictor_update_branch <= branch_select;
+          to_predictor_update_taken  <= jal_select or jalr_select or (branch_select and take_if_branch);
+          to_predictor_update_call   <= is_call;
+          to_predictor_update_return <= is_return;
+        end if;
+      end if;
+
+      if reset = '1' then
+        to_predictor_update_valid <= '0';
+      end if;
+    end if;
+  end process;
+
   branch_target  <= b_imm + current_pc;
   nbranch_target <= to_unsigned(4, REGISTER_SIZE) + current_pc;
   jalr_target    <= jalr_imm + unsigned(rs1_data);
@@ -5,11 +5,14 @@ use IEEE.numeric_std.all;
 library work;
 use work.rv_components.all;
 use work.utils.all;
+use work.constants_pkg.all;
 
 entity cache is
   generic (
     NUM_LINES             : positive;
     LINE_SIZE             : positive;
+    WAYS                  : positive;
+    REPLACEMENT           : cache_replacement_type;
     ADDRESS_WIDTH         : positive;
     WIDTH                 : positive;
     DIRTY_BITS            : natural;
@@ -29,8 +32,11 @@ entity cache is
     read_miss            : buffer std_logic;
     read_requestinflight : buffer std_logic;
     read_lastaddress     : buffer std_logic_vector(ADDRESS_WIDTH-1 downto 0);
-    read_tag             : buffer std_logic_vector((ADDRESS_WIDTH-log2(NUM_LINES*LINE_SIZE))-1 downto 0);
+    read_tag             : buffer std_logic_vector((ADDRESS_WIDTH-log2((NUM_LINES/WAYS)*LINE_SIZE))-1 downto 0);
     read_dirty_valid     : out    std_logic_vector(DIRTY_BITS downto 0);
+    read_way             : in     natural range 0 to WAYS-1;
+    read_hit_way         : buffer natural range 0 to WAYS-1;
+    read_victim_way      : out    natural range 0 to WAYS-1;
 
     --Write-only data ORCA-internal memory-mapped slave
     write_address      : in std_logic_vector(ADDRESS_WIDTH-1 downto 0);
@@ -38,28 +44,71 @@ entity cache is
     write_requestvalid : in std_logic;
     write_writedata    : in std_logic_vector(WIDTH-1 downto 0);
     write_tag_update   : in std_logic;
-    write_dirty_valid  : in std_logic_vector(DIRTY_BITS downto 0)
+    write_dirty_valid  : in std_logic_vector(DIRTY_BITS downto 0);
+    write_way          : in natural range 0 to WAYS-1
     );
 end entity;
 
 architecture rtl of cache is
+  constant NUM_SETS        : positive := NUM_LINES/WAYS;
   constant WORDS_PER_LINE  : positive := LINE_SIZE/(WIDTH/8);
-  constant TAG_BITS        : positive := ADDRESS_WIDTH-log2(NUM_LINES*LINE_SIZE);
+  constant TAG_BITS        : positive := ADDRESS_WIDTH-log2(NUM_SETS*LINE_SIZE);
   constant TAG_LEFT        : natural  := ADDRESS_WIDTH-1;
-  constant TAG_RIGHT       : natural  := log2(NUM_LINES)+log2(LINE_SIZE);
-  constant CACHELINE_BITS  : positive := log2(NUM_LINES);
+  constant TAG_RIGHT       : natural  := log2(NUM_SETS)+log2(LINE_SIZE);
+  constant CACHELINE_BITS  : positive := log2(NUM_SETS);
   constant CACHELINE_RIGHT : natural  := log2(LINE_SIZE);
-  constant CACHEWORD_BITS  : positive := log2(NUM_LINES)+log2(WORDS_PER_LINE);
-  constant CACHEWORD_LEFT  : natural  := log2(NUM_LINES)+log2(LINE_SIZE)-1;
+  constant CACHEWORD_BITS  : positive := log2(NUM_SETS)+log2(WORDS_PER_LINE);
+  constant CACHEWORD_LEFT  : natural  := log2(NUM_SETS)+log2(LINE_SIZE)-1;
   constant CACHEWORD_RIGHT : natural  := log2(WIDTH/8);
 
+  type dirty_valid_tag_vector is array (natural range <>) of std_logic_vector(TAG_BITS+DIRTY_BITS downto 0);
+  type readdata_vector is array (natural range <>) of std_logic_vector(WIDTH-1 downto 0);
+
+  --Tree pseudo-LRU: one bit per node of a binary tree over the ways, set to
+  --point at the half that was used least recently (exact LRU for 2 ways).
+  function plru_victim (
+    constant lru : std_logic_vector
+    )
+    return natural is
+    variable node : positive := 1;
+  begin
+    for ilevel in log2(WAYS)-1 downto 0 loop
+      if lru(lru'right+node-1) = '1' then
+        node := (2*node)+1;
+      else
+        node := 2*node;
+      end if;
+    end loop;
+    return node-WAYS;
+  end function plru_victim;
+
+  function plru_touch (
+    constant lru : std_logic_vector;
+    constant way : natural
+    )
+    return std_logic_vector is
+    variable node    : positive := 1;
+    variable new_lru : std_logic_vector(lru'range);
+  begin
+    new_lru := lru;
+    for ilevel in log2(WAYS)-1 downto 0 loop
+      if ((way/(2**ilevel)) mod 2) = 1 then
+        new_lru(lru'right+node-1) := '0';
+        node                      := (2*node)+1;
+      else
+        new_lru(lru'right+node-1) := '1';
+        node                      := 2*node;
+      end if;
+    end loop;
+    return new_lru;
+  end function plru_touch;
+
   signal read_speculationinflight : std_logic;
   signal read_hit                 : std_logic;
 
   signal read_dirty_valid_tag : std_logic_vector(TAG_BITS+DIRTY_BITS downto 0);
   alias read_valid            : std_logic is
     read_dirty_valid_tag(TAG_BITS);
-  signal read_tag_equal : std_logic;
 
   signal write_dirty_valid_tag_in : std_logic_vector(TAG_BITS+DIRTY_BITS downto 0);
 
@@ -72,6 +121,8 @@ architecture rtl of cache is
     is write_address(TAG_LEFT downto TAG_RIGHT);
   alias read_request_tag : std_logic_vector(TAG_BITS-1 downto 0)
     is read_lastaddress(TAG_LEFT downto TAG_RIGHT);
+  alias read_request_cacheline : std_logic_vector(CACHELINE_BITS-1 downto 0)
+    is read_lastaddress(TAG_RIGHT-1 downto CACHELINE_RIGHT);
 begin
   read_miss <= read_requestinflight and (not read_hit);
 
@@ -95,8 +146,6 @@ begin
     end if;
   end process;
 
-  read_tag_equal <= '1' when read_tag = read_request_tag else '0';
-
   read_dirty_valid(0) <= read_valid;
   read_tag            <= read_dirty_valid_tag(TAG_BITS-1 downto 0);
   dirty_gen : if DIRTY_BITS > 0 generate
@@ -105,51 +154,205 @@ begin
   begin
     read_dirty_valid(DIRTY_BITS downto 1) <= read_dirty;
   end generate dirty_gen;
-  read_hit           <= read_valid and read_tag_equal;
   read_readdatavalid <= read_hit and (read_requestinflight or read_speculationinflight);
   read_readabort     <= (not read_hit) and read_speculationinflight;
 
   write_dirty_valid_tag_in <= write_dirty_valid & write_tag;
 
-  --This block contains the tag, with a valid bit.
   read_cacheline  <= unsigned(read_address(TAG_RIGHT-1 downto CACHELINE_RIGHT));
   write_cacheline <= unsigned(write_address(TAG_RIGHT-1 downto CACHELINE_RIGHT));
-  cache_tags : bram_sdp_write_first
-    generic map (
-      DEPTH                 => NUM_LINES,
-      WIDTH                 => TAG_BITS+1+DIRTY_BITS,
-      WRITE_FIRST_SUPPORTED => WRITE_FIRST_SUPPORTED
-      )
-    port map (
-      clk           => clk,
-      read_address  => read_cacheline,
-      read_data     => read_dirty_valid_tag,
-      write_address => write_cacheline,
-      write_enable  => write_tag_update,
-      write_data    => write_dirty_valid_tag_in
-      );
-
-  --For each byte generate a separate data cache RAM
   read_cacheword  <= unsigned(read_address(CACHEWORD_LEFT downto CACHEWORD_RIGHT));
   write_cacheword <= unsigned(write_address(CACHEWORD_LEFT downto CACHEWORD_RIGHT));
-  byte_gen : for gbyte in (WIDTH/8)-1 downto 0 generate
-    signal write_enable : std_logic;
+
+  ------------------------------------------------------------------------------
+  -- Direct-mapped: one tag RAM and one set of data RAMs, no way selection.
+  ------------------------------------------------------------------------------
+  direct_mapped_gen : if WAYS = 1 generate
+    signal read_tag_equal : std_logic;
   begin
-    write_enable <= write_requestvalid and write_byteenable(gbyte);
-    cache_data : component bram_sdp_write_first
+    read_tag_equal <= '1' when read_tag = read_request_tag else '0';
+    read_hit       <= read_valid and read_tag_equal;
+
+    read_hit_way    <= 0;
+    read_victim_way <= 0;
+
+    --This block contains the tag, with a valid bit.
+    cache_tags : bram_sdp_write_first
       generic map (
-        DEPTH                 => NUM_LINES*WORDS_PER_LINE,
-        WIDTH                 => 8,
+        DEPTH                 => NUM_LINES,
+        WIDTH                 => TAG_BITS+1+DIRTY_BITS,
         WRITE_FIRST_SUPPORTED => WRITE_FIRST_SUPPORTED
         )
       port map (
         clk           => clk,
-        read_address  => read_cacheword,
-        read_data     => read_readdata(((gbyte+1)*8)-1 downto gbyte*8),
-        write_address => write_cacheword,
-        write_enable  => write_enable,
-        write_data    => write_writedata(((gbyte+1)*8)-1 downto gbyte*8)
+        read_address  => read_cacheline,
+        read_data     => read_dirty_valid_tag,
+        write_address => write_cacheline,
+        write_enable  => write_tag_update,
+        write_data    => write_dirty_valid_tag_in
         );
-  end generate byte_gen;
+
+    --For each byte generate a separate data cache RAM
+    byte_gen : for gbyte in (WIDTH/8)-1 downto 0 generate
+      signal write_enable : std_logic;
+    begin
+      write_enable <= write_requestvalid and write_byteenable(gbyte);
+      cache_data : component bram_sdp_write_first
+        generic map (
+          DEPTH                 => NUM_LINES*WORDS_PER_LINE,
+          WIDTH                 => 8,
+          WRITE_FIRST_SUPPORTED => WRITE_FIRST_SUPPORTED
+          )
+        port map (
+          clk           => clk,
+          read_address  => read_cacheword,
+          read_data     => read_readdata(((gbyte+1)*8)-1 downto gbyte*8),
+          write_address => write_cacheword,
+          write_enable  => write_enable,
+          write_data    => write_writedata(((gbyte+1)*8)-1 downto gbyte*8)
+          );
+    end generate byte_gen;
+  end generate direct_mapped_gen;
+
+  ------------------------------------------------------------------------------
+  -- Set-associative: a tag RAM and data RAMs per way, all tags compared at
+  -- once.
+  ------------------------------------------------------------------------------
+  set_associative_gen : if WAYS > 1 generate
+    signal read_hit_inflight     : std_logic;
+    signal read_dirty_valid_tags : dirty_valid_tag_vector(WAYS-1 downto 0);
+    signal read_readdatas        : readdata_vector(WAYS-1 downto 0);
+    signal read_way_hits         : std_logic_vector(WAYS-1 downto 0);
+    signal read_valid_ways       : std_logic_vector(WAYS-1 downto 0);
+    signal read_select_way       : natural range 0 to WAYS-1;
+    signal replacement_way       : natural range 0 to WAYS-1;
+  begin
+    read_hit          <= or_slv(read_way_hits);
+    read_hit_inflight <= read_hit and (read_requestinflight or read_speculationinflight);
+    process (read_way_hits) is
+    begin
+      read_hit_way <= 0;
+      for iway in WAYS-1 downto 0 loop
+        if read_way_hits(iway) = '1' then
+          read_hit_way <= iway;
+        end if;
+      end loop;
+    end process;
+
+    --Return the way that hit; with no hit in flight read_way selects the tag
+    --and data to return (the line the controller is spilling).
+    read_select_way      <= read_hit_way when read_hit_inflight = '1' else read_way;
+    read_dirty_valid_tag <= read_dirty_valid_tags(read_select_way);
+    read_readdata        <= read_readdatas(read_select_way);
+
+    way_gen : for gway in WAYS-1 downto 0 generate
+      signal write_tag_enable : std_logic;
+    begin
+      read_valid_ways(gway) <= read_dirty_valid_tags(gway)(TAG_BITS);
+      read_way_hits(gway) <=
+        '1' when (read_dirty_valid_tags(gway)(TAG_BITS) = '1' and
+                  read_dirty_valid_tags(gway)(TAG_BITS-1 downto 0) = read_request_tag) else
+        '0';
+
+      --This block contains the tag, with a valid bit.
+      write_tag_enable <= write_tag_update and bool_to_sl(write_way = gway);
+      cache_tags : bram_sdp_write_first
+        generic map (
+          DEPTH                 => NUM_SETS,
+          WIDTH                 => TAG_BITS+1+DIRTY_BITS,
+          WRITE_FIRST_SUPPORTED => WRITE_FIRST_SUPPORTED
+          )
+        port map (
+          clk           => clk,
+          read_address  => read_cacheline,
+          read_data     => read_dirty_valid_tags(gway),
+          write_address => write_cacheline,
+          write_enable  => write_tag_enable,
+          write_data    => write_dirty_valid_tag_in
+          );
+
+      --For each byte generate a separate data cache RAM
+      byte_gen : for gbyte in (WIDTH/8)-1 downto 0 generate
+        signal write_enable : std_logic;
+      begin
+        write_enable <= write_requestvalid and write_byteenable(gbyte) and bool_to_sl(write_way = gway);
+        cache_data : component bram_sdp_write_first
+          generic map (
+            DEPTH                 => NUM_SETS*WORDS_PER_LINE,
+            WIDTH                 => 8,
+            WRITE_FIRST_SUPPORTED => WRITE_FIRST_SUPPORTED
+            )
+          port map (
+            clk           => clk,
+            read_address  => read_cacheword,
+            read_data     => read_readdatas(gway)(((gbyte+1)*8)-1 downto gbyte*8),
+            write_address => write_cacheword,
+            write_enable  => write_enable,
+            write_data    => write_writedata(((gbyte+1)*8)-1 downto gbyte*8)
+            );
+      end generate byte_gen;
+    end generate way_gen;
+
+    --Fill an invalid way if the set has one, otherwise the way picked by the
+    --replacement policy.
+    process (read_valid_ways, replacement_way) is
+    begin
+      read_victim_way <= replacement_way;
+      for iway in WAYS-1 downto 0 loop
+        if read_valid_ways(iway) = '0' then
+          read_victim_way <= iway;
+        end if;
+      end loop;
+    end process;
+
+    lru_gen : if REPLACEMENT = LRU generate
+      signal read_lru      : std_logic_vector(WAYS-2 downto 0);
+      signal write_lru     : std_logic_vector(WAYS-2 downto 0);
+      signal lru_cacheline : unsigned(CACHELINE_BITS-1 downto 0);
+    begin
+      --Read alongside the tags; every hit marks its way most recently used.
+      --Lines are not touched on fill, the hit that follows the fill does it.
+      replacement_way <= plru_victim(read_lru);
+      write_lru       <= plru_touch(read_lru, read_hit_way);
+      lru_cacheline   <= unsigned(read_request_cacheline);
+      lru_bits : bram_sdp_write_first
+        generic map (
+          DEPTH                 => NUM_SETS,
+          WIDTH                 => WAYS-1,
+          WRITE_FIRST_SUPPORTED => WRITE_FIRST_SUPPORTED
+          )
+        port map (
+          clk           => clk,
+          read_address  => read_cacheline,
+          read_data     => read_lru,
+          write_address => lru_cacheline,
+          write_enable  => read_hit_inflight,
+          write_data    => write_lru
+          );
+    end generate lru_gen;
+
+    pseudo_random_gen : if REPLACEMENT = PSEUDO_RANDOM generate
+      signal lfsr : std_logic_vector(15 downto 0);
+    begin
+      --Free running x^16+x^14+x^13+x^11+1 LFSR
+      process (clk) is
+      begin
+        if rising_edge(clk) then
+          lfsr <= lfsr(14 downto 0) & (lfsr(15) xor lfsr(13) xor lfsr(12) xor lfsr(10));
+
+          if reset = '1' then
+            lfsr <= x"ACE1";
+          end if;
+        end if;
+      end process;
+      replacement_way <= to_integer(unsigned(lfsr(log2(WAYS)-1 downto 0)));
+    end generate pseudo_random_gen;
+  end generate set_associative_gen;
+
+  assert 2**log2(WAYS) = WAYS and WAYS <= NUM_LINES/2
+    report "Error in cache: WAYS (" &
+    integer'image(WAYS) &
+    ") must be a power of 2 and leave at least 2 sets."
+    severity failure;
 
 end architecture;
@@ -9,15 +9,19 @@ use work.constants_pkg.all;
 
 entity cache_controller is
   generic (
-    CACHE_SIZE            : natural;
-    LINE_SIZE             : positive range 16 to 256;
-    ADDRESS_WIDTH         : positive;
-    INTERNAL_WIDTH        : positive;
-    EXTERNAL_WIDTH        : positive;
-    LOG2_BURSTLENGTH      : positive;
-    POLICY                : cache_policy;
-    REGION_OPTIMIZATIONS  : boolean;
-    WRITE_FIRST_SUPPORTED : boolean
+    CACHE_SIZE               : natural;
+    LINE_SIZE                : positive range 16 to 256;
+    WAYS                     : positive range 1 to 4;
+    REPLACEMENT              : cache_replacement_type;
+    PREFETCH                 : cache_prefetch_type;
+    ADDRESS_WIDTH            : positive;
+    INTERNAL_WIDTH           : positive;
+    EXTERNAL_WIDTH           : positive;
+    LOG2_BURSTLENGTH         : positive;
+    MAX_OUTSTANDING_REQUESTS : positive;
+    POLICY                   : cache_policy;
+    REGION_OPTIMIZATIONS     : boolean;
+    WRITE_FIRST_SUPPORTED    : boolean
     );
   port (
     clk   : in std_logic;
@@ -32,6 +36,7 @@ entity cache_controller is
 
     precache_idle : in  std_logic;
     cache_idle    : out std_logic;
+    cache_miss    : out std_logic;
 
     --Cache interface ORCA-internal memory-mapped slave
     cacheint_oimm_address       : in     std_logic_vector(ADDRESS_WIDTH-1 downto 0);
@@ -61,10 +66,12 @@ end entity cache_controller;
 architecture rtl of cache_controller is
   constant DIRTY_BITS                       : natural  := conditional(POLICY = WRITE_BACK, 1, 0);
   constant NUM_LINES                        : positive := CACHE_SIZE/LINE_SIZE;
-  constant TAG_BITS                         : positive := ADDRESS_WIDTH-log2(CACHE_SIZE);
+  constant WAY_SIZE                         : positive := CACHE_SIZE/WAYS;
+  constant NUM_SETS                         : positive := NUM_LINES/WAYS;
+  constant TAG_BITS                         : positive := ADDRESS_WIDTH-log2(WAY_SIZE);
   constant TAG_LEFT                         : natural  := ADDRESS_WIDTH-1;
-  constant TAG_RIGHT                        : natural  := log2(NUM_LINES)+log2(LINE_SIZE);
-  constant CACHELINE_BITS                   : positive := log2(NUM_LINES);
+  constant TAG_RIGHT                        : natural  := log2(NUM_SETS)+log2(LINE_SIZE);
+  constant CACHELINE_BITS                   : positive := log2(NUM_SETS);
   constant CACHELINE_RIGHT                  : natural  := log2(LINE_SIZE);
   constant INTERNAL_WORDS_PER_EXTERNAL_WORD : positive := EXTERNAL_WIDTH/INTERNAL_WIDTH;
 
@@ -102,7 +109,7 @@ architecture rtl of cache_controller is
   signal read_miss            : std_logic;
   signal read_requestinflight : std_logic;
   signal read_lastaddress     : std_logic_vector(ADDRESS_WIDTH-1 downto 0);
-  signal read_lastline        : unsigned(log2(NUM_LINES)-1 downto 0);
+  signal read_lastline        : unsigned(log2(NUM_SETS)-1 downto 0);
 
   type control_state_type is (WALK_CACHE, IDLE, CACHE_MISSED, WAIT_FOR_HIT);
   signal control_state      : control_state_type;
@@ -131,6 +138,8 @@ architecture rtl of cache_controller is
   signal cache_walker_line           : unsigned(log2(NUM_LINES)-1 downto 0);
   signal cache_walker_line_increment : std_logic;
   signal cache_walker_line_last      : std_logic;
+  signal cache_walker_set            : unsigned(log2(NUM_SETS)-1 downto 0);
+  signal cache_walker_way            : natural range 0 to WAYS-1;
 
   signal write_hit             : std_logic;
   signal write_hit_dirty_valid : std_logic_vector(DIRTY_BITS downto 0);
@@ -160,11 +169,34 @@ architecture rtl of cache_controller is
   signal read_readabort     : std_logic;
   signal read_tag           : std_logic_vector(TAG_BITS-1 downto 0);
   signal read_dirty_valid   : std_logic_vector(DIRTY_BITS downto 0);
+  signal read_way           : natural range 0 to WAYS-1;
+  signal read_hit_way       : natural range 0 to WAYS-1;
+  signal read_victim_way    : natural range 0 to WAYS-1;
+  signal write_way          : natural range 0 to WAYS-1;
+  signal fill_way           : natural range 0 to WAYS-1;
+
+  signal fill_readdatavalid    : std_logic;
+  signal fill_readdata         : std_logic_vector(EXTERNAL_WIDTH-1 downto 0);
+  signal fill_request_line     : std_logic_vector(ADDRESS_WIDTH-1 downto log2(LINE_SIZE));
+  signal fill_request_offset   : unsigned(log2(LINE_SIZE)-1 downto 0);
+  signal fill_hold             : std_logic;
+
+  signal ready_from_prefetcher    : std_logic;
+  signal prefetch_idle            : std_logic;
+  signal prefetch_hit             : std_logic;
+  signal prefetch_reading         : std_logic;
+  signal prefetch_requestvalid    : std_logic;
+  signal prefetch_invalidate      : std_logic;
+  signal prefetch_invalidate_line : std_logic_vector(ADDRESS_WIDTH-1 downto log2(LINE_SIZE));
+  signal other_c_oimm_start       : std_logic;
 begin
   --Idle when no reads in flight (either hit or miss), not waiting on a
   --writeback/writethrough, and not walking the cache.
   --Idle is state-only; do not check for incoming requests
-  cache_idle <= (not read_requestinflight) and write_idle and (not cache_walking);
+  cache_idle <= (not read_requestinflight) and write_idle and (not cache_walking) and prefetch_idle;
+
+  --One cycle per line fill started
+  cache_miss <= '1' when control_state = IDLE and read_miss = '1' and ready_from_filler = '1' else '0';
 
   cacheint_oimm_waitrequest <= read_miss or
                                (not write_ready) or
@@ -193,7 +225,7 @@ begin
   ------------------------------------------------------------------------------
   -- Cache Contol FSM
   ------------------------------------------------------------------------------
-  process(control_state, cache_walker_tag_update, cache_walker_dirty_valid, done_from_cache_walker, read_miss, ready_from_filler, precache_idle, cacheint_oimm_requestvalid, write_idle, to_cache_control_valid, ready_from_cache_walker, to_cache_control_command, done_from_filler)
+  process(control_state, cache_walker_tag_update, cache_walker_dirty_valid, done_from_cache_walker, read_miss, ready_from_filler, precache_idle, cacheint_oimm_requestvalid, write_idle, to_cache_control_valid, ready_from_cache_walker, to_cache_control_command, done_from_filler, prefetch_idle)
   begin
     next_control_state       <= control_state;
     cache_mgt_tag_update     <= '0';
@@ -221,7 +253,8 @@ begin
             cache_mgt_tag_valid  <= '0';
           end if;
         else
-          if precache_idle = '1' and cacheint_oimm_requestvalid = '0' and write_idle = '1' then
+          if (precache_idle = '1' and cacheint_oimm_requestvalid = '0' and write_idle = '1' and
+              prefetch_idle = '1') then
             if ready_from_cache_walker = '1' then
               from_cache_control_ready <= '1';
               if to_cache_control_valid = '1' then
@@ -261,6 +294,11 @@ begin
 
   ready_from_cache_walker <= '1';
   cache_walker_line_last  <= '1' when cache_walker_line = to_unsigned(NUM_LINES-1, log2(NUM_LINES)) else '0';
+
+  --The walker steps through every set of way 0, then every set of way 1, etc.
+  cache_walker_set <= resize(cache_walker_line, cache_walker_set'length);
+  cache_walker_way <= to_integer(cache_walker_line)/NUM_SETS;
+
   process(clk)
   begin
     if rising_edge(clk) then
@@ -279,6 +317,12 @@ begin
         cache_walker_line <= cache_walker_line + to_unsigned(1, cache_walker_line'length);
       end if;
 
+      --Fill the way chosen when the miss started; its tag is invalidated
+      --then so the choice can't change while the line is filled.
+      if start_to_filler = '1' and ready_from_filler = '1' then
+        fill_way <= read_victim_way;
+      end if;
+
       if reset = '1' then
         control_state        <= WALK_CACHE;
         cache_walker_command <= INITIALIZE;
@@ -303,8 +347,10 @@ begin
         filling <= '0';
       end if;
 
+      --A line already in the prefetch buffer is copied from there instead of
+      --being read from memory.
       if start_to_filler = '1' and ready_from_filler = '1' then
-        fill_reading <= '1';
+        fill_reading <= not prefetch_hit;
         filling      <= '1';
       end if;
 
@@ -315,7 +361,7 @@ begin
     end if;
   end process;
 
-  fill_internal_offset_increment <= c_oimm_readdatavalid;
+  fill_internal_offset_increment <= fill_readdatavalid;
   fill_external_offset_increment <= (not c_oimm_waitrequest) and fill_reading;
   one_beat_per_line_gen : if BEATS_PER_LINE = 1 generate
     fill_internal_offset_last <= '1';
@@ -360,14 +406,225 @@ begin
     end process;
   end generate multiple_bursts_per_line_gen;
 
-  --Write if filling a cacheline (c_oimm_readdatavalid) or a write has caused a
+  ------------------------------------------------------------------------------
+  -- Prefetcher
+  ------------------------------------------------------------------------------
+  --fill_readdata(valid) is the data of a line fill and fill_request_line/
+  --offset the address of a fill or prefetch read.  Without a prefetcher they
+  --are the bus and miss address signals, and the prefetch_* flags are
+  --constants that drop out of the logic that uses them.
+  no_prefetch_gen : if PREFETCH = NO_PREFETCH generate
+    fill_readdatavalid  <= c_oimm_readdatavalid;
+    fill_readdata       <= c_oimm_readdata;
+    fill_request_line   <= read_lastaddress(ADDRESS_WIDTH-1 downto log2(LINE_SIZE));
+    fill_request_offset <= fill_external_offset;
+
+    ready_from_prefetcher <= '1';
+    prefetch_idle         <= '1';
+    prefetch_hit          <= '0';
+    prefetch_reading      <= '0';
+    prefetch_requestvalid <= '0';
+  end generate no_prefetch_gen;
+  --After each line fill the next line (NEXT_LINE), or the line one stride
+  --past it once two consecutive misses are the same stride apart (STRIDE), is
+  --read into a one line buffer.  The prefetch waits until the bus is free,
+  --keeps MAX_OUTSTANDING_REQUESTS-1 bursts in flight at most so a demand miss
+  --can always issue, and does not cross a PREFETCH_REGION_SIZE boundary as
+  --the next region may not be memory.  A miss to the buffered line is filled
+  --from the buffer; a miss to any other line cancels the prefetch.
+  prefetch_gen : if PREFETCH /= NO_PREFETCH generate
+    constant PREFETCH_REGION_SIZE : positive := 4096;
+    constant LINE_ADDRESS_BITS    : positive := ADDRESS_WIDTH-log2(LINE_SIZE);
+    constant REGION_LINE_BITS     : natural  := log2(PREFETCH_REGION_SIZE)-log2(LINE_SIZE);
+    constant PREFETCH_MAX_BURSTS  : positive := imax(MAX_OUTSTANDING_REQUESTS-1, 1);
+
+    type beat_vector is array (natural range <>) of std_logic_vector(EXTERNAL_WIDTH-1 downto 0);
+    --Asynchronous read so it can be drained one beat per cycle; small enough
+    --for LUTs or distributed RAMs at the usual line sizes.
+    signal prefetch_buffer : beat_vector(BEATS_PER_LINE-1 downto 0);
+
+    signal miss_line       : unsigned(LINE_ADDRESS_BITS-1 downto 0);
+    signal miss_line_match : std_logic;
+    signal last_miss_line  : unsigned(LINE_ADDRESS_BITS-1 downto 0);
+    signal last_stride     : unsigned(LINE_ADDRESS_BITS-1 downto 0);
+    signal stride          : unsigned(LINE_ADDRESS_BITS-1 downto 0);
+    signal next_line       : unsigned(LINE_ADDRESS_BITS-1 downto 0);
+    signal next_line_ok    : std_logic;
+
+    signal prefetch_valid                  : std_logic;
+    signal prefetch_pending                : std_logic;
+    signal prefetch_pending_line           : unsigned(LINE_ADDRESS_BITS-1 downto 0);
+    signal prefetch_start                  : std_logic;
+    signal prefetch_cancel                 : std_logic;
+    signal prefetch_throttled              : std_logic;
+    signal prefetch_burst_accepted         : std_logic;
+    signal prefetch_external_offset_last   : std_logic;
+    signal prefetch_beat_returned          : std_logic;
+    signal prefetch_beats_outstanding      : unsigned(log2(BEATS_PER_LINE+1)-1 downto 0);
+    signal prefetch_internal_beat          : natural range 0 to BEATS_PER_LINE-1;
+    signal prefetch_receiving              : std_logic;
+    signal prefetch_line                   : std_logic_vector(ADDRESS_WIDTH-1 downto log2(LINE_SIZE));
+    signal prefetch_external_offset        : unsigned(log2(LINE_SIZE)-1 downto 0);
+    signal prefetch_readdata               : std_logic_vector(EXTERNAL_WIDTH-1 downto 0);
+    signal filling_from_prefetch           : std_logic;
+  begin
+    --Readdata is the prefetcher's until all of its beats have returned.
+    fill_readdatavalid <= (c_oimm_readdatavalid and (not prefetch_receiving)) or
+                          (filling_from_prefetch and (not fill_hold));
+    fill_readdata <= prefetch_readdata when filling_from_prefetch = '1' else c_oimm_readdata;
+    fill_request_line <= prefetch_line when prefetch_reading = '1' else
+                         read_lastaddress(ADDRESS_WIDTH-1 downto log2(LINE_SIZE));
+    fill_request_offset <= prefetch_external_offset when prefetch_reading = '1' else
+                           fill_external_offset;
+
+    miss_line       <= unsigned(read_lastaddress(ADDRESS_WIDTH-1 downto log2(LINE_SIZE)));
+    miss_line_match <= '1' when std_logic_vector(miss_line) = prefetch_line else '0';
+
+    --Stride is in lines, modulo the address space
+    stride <= miss_line - last_miss_line;
+    next_line_gen : if PREFETCH = NEXT_LINE generate
+      next_line    <= miss_line + to_unsigned(1, LINE_ADDRESS_BITS);
+      next_line_ok <= '1';
+    end generate next_line_gen;
+    stride_gen : if PREFETCH = STRIDE generate
+      next_line    <= miss_line + stride;
+      next_line_ok <= '1' when stride = last_stride and stride /= to_unsigned(0, LINE_ADDRESS_BITS) else '0';
+    end generate stride_gen;
+
+    prefetch_receiving     <= '1' when prefetch_beats_outstanding /= to_unsigned(0, prefetch_beats_outstanding'length) else '0';
+    prefetch_idle          <= (not prefetch_reading) and (not prefetch_receiving);
+    prefetch_beat_returned <= c_oimm_readdatavalid and prefetch_receiving;
+
+    --Wait on a miss to the line being prefetched, and don't start a fill
+    --while the prefetcher is using the bus.
+    ready_from_prefetcher <= (not prefetch_reading) and (not (prefetch_valid and prefetch_receiving and miss_line_match));
+    prefetch_hit          <= prefetch_valid and prefetch_idle and miss_line_match;
+    prefetch_cancel       <= '1' when control_state = IDLE and read_miss = '1' and miss_line_match = '0' else '0';
+
+    --Lowest priority on the bus; only start when nothing else is using it
+    --and the beats of any cancelled prefetch have all returned.
+    prefetch_start <= prefetch_pending and
+                      prefetch_idle and
+                      (not read_miss) and
+                      (not filling) and
+                      (not cache_walking) and
+                      (not start_to_cache_walker) and
+                      write_idle and
+                      (not other_c_oimm_start);
+
+    prefetch_throttled <=
+      '1' when to_integer(prefetch_beats_outstanding) > (PREFETCH_MAX_BURSTS-1)*BEATS_PER_BURST else
+      '0';
+    prefetch_requestvalid         <= prefetch_reading and (not prefetch_throttled);
+    prefetch_burst_accepted       <= prefetch_requestvalid and (not c_oimm_waitrequest);
+    prefetch_external_offset_last <=
+      '1' when prefetch_external_offset = to_unsigned(LINE_SIZE-BYTES_PER_BURST, prefetch_external_offset'length) else
+      '0';
+
+    process(clk)
+    begin
+      if rising_edge(clk) then
+        if prefetch_burst_accepted = '1' then
+          if prefetch_external_offset_last = '1' then
+            prefetch_reading <= '0';
+          else
+            prefetch_external_offset <=
+              prefetch_external_offset + to_unsigned(BYTES_PER_BURST, prefetch_external_offset'length);
+          end if;
+        end if;
+
+        if prefetch_burst_accepted = '1' and prefetch_beat_returned = '0' then
+          prefetch_beats_outstanding <=
+            prefetch_beats_outstanding + to_unsigned(BEATS_PER_BURST, prefetch_beats_outstanding'length);
+        elsif prefetch_burst_accepted = '1' and prefetch_beat_returned = '1' then
+          prefetch_beats_outstanding <=
+            prefetch_beats_outstanding + to_unsigned(BEATS_PER_BURST-1, prefetch_beats_outstanding'length);
+        elsif prefetch_beat_returned = '1' then
+          prefetch_beats_outstanding <=
+            prefetch_beats_outstanding - to_unsigned(1, prefetch_beats_outstanding'length);
+        end if;
+
+        if prefetch_beat_returned = '1' then
+          prefetch_buffer(prefetch_internal_beat) <= c_oimm_readdata;
+          prefetch_internal_beat                  <= (prefetch_internal_beat + 1) mod BEATS_PER_LINE;
+        end if;
+
+        if prefetch_cancel = '1' then
+          prefetch_valid <= '0';
+        end if;
+        if prefetch_invalidate = '1' and prefetch_invalidate_line = prefetch_line then
+          prefetch_valid <= '0';
+        end if;
+        --Stop requesting a cancelled prefetch once any request in progress
+        --has been accepted; its beats are still counted and dropped.
+        if ((prefetch_valid = '0' or prefetch_cancel = '1') and
+            (prefetch_requestvalid = '0' or c_oimm_waitrequest = '0')) then
+          prefetch_reading <= '0';
+        end if;
+
+        if done_from_filler = '1' then
+          filling_from_prefetch <= '0';
+        end if;
+
+        --Train on every line fill; the buffered line is used up by its fill.
+        if start_to_filler = '1' and ready_from_filler = '1' then
+          filling_from_prefetch <= prefetch_hit;
+          if prefetch_hit = '1' then
+            prefetch_valid <= '0';
+          end if;
+          last_miss_line        <= miss_line;
+          last_stride           <= stride;
+          prefetch_pending_line <= next_line;
+          prefetch_pending      <= '0';
+          if (next_line_ok = '1' and
+              next_line(LINE_ADDRESS_BITS-1 downto REGION_LINE_BITS) =
+              miss_line(LINE_ADDRESS_BITS-1 downto REGION_LINE_BITS)) then
+            prefetch_pending <= '1';
+          end if;
+        end if;
+
+        if prefetch_start = '1' then
+          prefetch_pending         <= '0';
+          prefetch_valid           <= '1';
+          prefetch_reading         <= '1';
+          prefetch_line            <= std_logic_vector(prefetch_pending_line);
+          prefetch_external_offset <= to_unsigned(0, prefetch_external_offset'length);
+          prefetch_internal_beat   <= 0;
+        end if;
+
+        --Cache control commands may be for memory changed behind the cache
+        if start_to_cache_walker = '1' then
+          prefetch_valid   <= '0';
+          prefetch_pending <= '0';
+        end if;
+
+        if reset = '1' then
+          prefetch_valid             <= '0';
+          prefetch_pending           <= '0';
+          prefetch_reading           <= '0';
+          filling_from_prefetch      <= '0';
+          prefetch_beats_outstanding <= to_unsigned(0, prefetch_beats_outstanding'length);
+          last_miss_line             <= to_unsigned(0, last_miss_line'length);
+          last_stride                <= to_unsigned(0, last_stride'length);
+        end if;
+      end if;
+    end process;
+
+    prefetch_readdata <= prefetch_buffer(to_integer(fill_internal_offset)/BYTES_PER_BEAT);
+  end generate prefetch_gen;
+
+  --Write if filling a cacheline (fill_readdatavalid) or a write has caused a
   --tag check (write_on_hit) and that write has hit an existing cacheline
   --(read_readdatavalid)
   write_hit                <= write_on_hit and read_readdatavalid;
   write_hit_dirty_valid(0) <= '1';
-  write_requestvalid       <= c_oimm_readdatavalid or write_hit;
+  write_requestvalid       <= fill_readdatavalid or write_hit;
   write_tag_update         <= cache_mgt_tag_update or write_hit;
   write_dirty_valid        <= write_hit_dirty_valid when write_hit = '1' else cache_mgt_dirty_valid;
+  write_way                <= cache_walker_way when cache_walking = '1' else
+                              read_hit_way    when write_hit = '1' else
+                              read_victim_way when control_state = IDLE else
+                              fill_way;
 
 
   ------------------------------------------------------------------------------
@@ -377,6 +634,8 @@ begin
     generic map (
       NUM_LINES             => NUM_LINES,
       LINE_SIZE             => LINE_SIZE,
+      WAYS                  => WAYS,
+      REPLACEMENT           => REPLACEMENT,
       ADDRESS_WIDTH         => ADDRESS_WIDTH,
       WIDTH                 => EXTERNAL_WIDTH,
       DIRTY_BITS            => DIRTY_BITS,
@@ -397,17 +656,21 @@ begin
       read_lastaddress     => read_lastaddress,
       read_tag             => read_tag,
       read_dirty_valid     => read_dirty_valid,
+      read_way             => read_way,
+      read_hit_way         => read_hit_way,
+      read_victim_way      => read_victim_way,
 
       write_address      => write_address,
       write_byteenable   => write_byteenable,
       write_requestvalid => write_requestvalid,
       write_writedata    => write_writedata,
       write_tag_update   => write_tag_update,
-      write_dirty_valid  => write_dirty_valid
+      write_dirty_valid  => write_dirty_valid,
+      write_way          => write_way
       );
-  read_lastline <= unsigned(read_lastaddress(log2(CACHE_SIZE)-1 downto log2(LINE_SIZE)));
+  read_lastline <= unsigned(read_lastaddress(log2(WAY_SIZE)-1 downto log2(LINE_SIZE)));
 
-  cache_walker_read_tag_line <= read_tag & std_logic_vector(cache_walker_line);
+  cache_walker_read_tag_line <= read_tag & std_logic_vector(cache_walker_set);
   to_cache_control_base_partial <=
     '1' when to_cache_control_base(log2(LINE_SIZE)-1 downto 0) /= replicate_slv("0", log2(LINE_SIZE)) else '0';
   read_region_base_hit <= '1' when cache_walker_read_tag_line = to_cache_control_base_tag_line else '0';
@@ -438,7 +701,7 @@ begin
     write_idle         <= '1';
     write_ready        <= '1';
     write_on_hit       <= '0';
-    write_writedata    <= c_oimm_readdata;
+    write_writedata    <= fill_readdata;
     write_byteenable   <= (others => '1');
     c_oimm_byteenable  <= (others => '1');
     c_oimm_writedata   <= (others => '-');
@@ -446,24 +709,29 @@ begin
     c_oimm_burstlength_minus1 <=
       std_logic_vector(to_unsigned(BEATS_PER_BURST-1, c_oimm_burstlength_minus1'length));
     c_oimm_writelast    <= '1';
-    ready_from_filler   <= (not filling) or done_from_filler;
-    c_oimm_requestvalid <= fill_reading;
+    ready_from_filler   <= ((not filling) or done_from_filler) and ready_from_prefetcher;
+    c_oimm_requestvalid <= fill_reading or prefetch_requestvalid;
     c_oimm_readnotwrite <= '1';
-    c_oimm_address(ADDRESS_WIDTH-1 downto log2(LINE_SIZE)) <=
-      read_lastaddress(ADDRESS_WIDTH-1 downto log2(LINE_SIZE));
+    c_oimm_address(ADDRESS_WIDTH-1 downto log2(LINE_SIZE)) <= fill_request_line;
     multiple_beats_per_line_gen : if BEATS_PER_LINE > 1 generate
       c_oimm_address(log2(LINE_SIZE)-1 downto log2(BYTES_PER_BEAT)) <=
-        std_logic_vector(fill_external_offset(log2(LINE_SIZE)-1 downto log2(BYTES_PER_BEAT)));
+        std_logic_vector(fill_request_offset(log2(LINE_SIZE)-1 downto log2(BYTES_PER_BEAT)));
     end generate multiple_beats_per_line_gen;
     read_address <= cacheint_oimm_address when read_miss = '0' else
                     read_lastaddress;
     read_speculative <= '0';
+    read_way         <= 0;
+
+    fill_hold                <= '0';
+    other_c_oimm_start       <= '0';
+    prefetch_invalidate      <= '0';
+    prefetch_invalidate_line <= (others => '0');
 
     --On a cacheline fill use the last address (which caused the miss).
-    write_address(ADDRESS_WIDTH-1 downto log2(CACHE_SIZE)) <=
-      read_lastaddress(ADDRESS_WIDTH-1 downto log2(CACHE_SIZE));
-    write_address(log2(CACHE_SIZE)-1 downto log2(LINE_SIZE)) <=
-      std_logic_vector(cache_walker_line) when cache_walking = '1' else
+    write_address(ADDRESS_WIDTH-1 downto log2(WAY_SIZE)) <=
+      read_lastaddress(ADDRESS_WIDTH-1 downto log2(WAY_SIZE));
+    write_address(log2(WAY_SIZE)-1 downto log2(LINE_SIZE)) <=
+      std_logic_vector(cache_walker_set) when cache_walking = '1' else
       std_logic_vector(read_lastline);
     write_address(log2(LINE_SIZE)-1 downto 0) <=
       std_logic_vector(fill_internal_offset) when read_miss = '1' else
@@ -529,7 +797,7 @@ begin
         end if;
       end process;
     end generate multiple_internal_words_gen;
-    write_writedata <= c_oimm_readdata when read_miss = '1' else
+    write_writedata <= fill_readdata when read_miss = '1' else
                        replicate_slv(last_writedata, INTERNAL_WORDS_PER_EXTERNAL_WORD);
     write_byteenable <= (others => '1') when read_miss = '1' else write_hit_byteenable;
 
@@ -550,7 +818,7 @@ begin
       done_from_cache_walker      <= cache_walker_line_last and cache_walking;
 
       write_idle  <= not writing_through;
-      write_ready <= ready_from_write_through;
+      write_ready <= ready_from_write_through and (not prefetch_reading);
 
       --In write-through mode all writes are single cycle, all reads are BEATS_PER_BURST
       c_oimm_burstlength <=
@@ -563,28 +831,34 @@ begin
       c_oimm_byteenable <= write_hit_byteenable when writing_through = '1' else (others => '1');
       c_oimm_writelast  <= '1';
 
-      ready_from_filler <= ((not filling) or done_from_filler) and ready_from_write_through;
+      ready_from_filler <= ((not filling) or done_from_filler) and ready_from_write_through and ready_from_prefetcher;
 
-      c_oimm_requestvalid <= fill_reading or writing_through;
+      c_oimm_requestvalid <= fill_reading or writing_through or prefetch_requestvalid;
       c_oimm_readnotwrite <= not writing_through;
-      c_oimm_address(ADDRESS_WIDTH-1 downto log2(LINE_SIZE)) <=
-        read_lastaddress(ADDRESS_WIDTH-1 downto log2(LINE_SIZE));
+      c_oimm_address(ADDRESS_WIDTH-1 downto log2(LINE_SIZE)) <= fill_request_line;
       multiple_beats_per_line_gen : if BEATS_PER_LINE > 1 generate
         c_oimm_address(log2(LINE_SIZE)-1 downto log2(BYTES_PER_BEAT)) <=
           read_lastaddress(log2(LINE_SIZE)-1 downto log2(BYTES_PER_BEAT)) when writing_through = '1' else
-          std_logic_vector(fill_external_offset(log2(LINE_SIZE)-1 downto log2(BYTES_PER_BEAT)));
+          std_logic_vector(fill_request_offset(log2(LINE_SIZE)-1 downto log2(BYTES_PER_BEAT)));
       end generate multiple_beats_per_line_gen;
       read_address <= cacheint_oimm_address when read_miss = '0' else
                       read_lastaddress;
       read_speculative     <= not cacheint_oimm_readnotwrite;
+      read_way             <= 0;
       done_to_write_on_hit <= read_readdatavalid or read_readabort;
 
+      --A write through makes a prefetch of its line stale
+      fill_hold                <= '0';
+      other_c_oimm_start       <= start_to_write_through;
+      prefetch_invalidate      <= start_to_write_through;
+      prefetch_invalidate_line <= cacheint_oimm_address(ADDRESS_WIDTH-1 downto log2(LINE_SIZE));
+
       --On a cacheline fill use the last address (which caused the miss).  On a
       --write hit, use the last address (which caused the hit).
-      write_address(ADDRESS_WIDTH-1 downto log2(CACHE_SIZE)) <=
-        read_lastaddress(ADDRESS_WIDTH-1 downto log2(CACHE_SIZE));
-      write_address(log2(CACHE_SIZE)-1 downto log2(LINE_SIZE)) <=
-        std_logic_vector(cache_walker_line) when cache_walking = '1' else
+      write_address(ADDRESS_WIDTH-1 downto log2(WAY_SIZE)) <=
+        read_lastaddress(ADDRESS_WIDTH-1 downto log2(WAY_SIZE));
+      write_address(log2(WAY_SIZE)-1 downto log2(LINE_SIZE)) <=
+        std_logic_vector(cache_walker_set) when cache_walking = '1' else
         std_logic_vector(read_lastline);
       write_address(log2(LINE_SIZE)-1 downto 0) <=
         std_logic_vector(fill_internal_offset) when read_miss = '1' else
@@ -639,7 +913,8 @@ begin
       signal spill_tag                 : std_logic_vector(TAG_BITS-1 downto 0);
       signal spill_dirty_valid         : std_logic_vector(DIRTY_BITS downto 0);
       signal spill_region_hit          : std_logic;
-      signal spill_line                : unsigned(log2(NUM_LINES)-1 downto 0);
+      signal spill_line                : unsigned(log2(NUM_SETS)-1 downto 0);
+      signal spill_way                 : natural range 0 to WAYS-1;
 
       type cache_walker_state_type is (IDLE, START_SPILLER, WAIT_ON_SPILLER);
       signal cache_walker_state            : cache_walker_state_type;
@@ -729,32 +1004,32 @@ begin
       c_oimm_writedata    <= spill_buffer_read_data;
       c_oimm_byteenable   <= (others => '1');
       c_oimm_writelast    <= spill_burst_last;
-      ready_from_filler   <= ((not filling) or done_from_filler) and ready_from_spiller;
-      c_oimm_requestvalid <= fill_reading or spill_writing_to_memory;
-      c_oimm_readnotwrite <= fill_reading;
-      c_oimm_address(ADDRESS_WIDTH-1 downto log2(CACHE_SIZE)) <=
-        read_lastaddress(ADDRESS_WIDTH-1 downto log2(CACHE_SIZE)) when fill_reading = '1' else
+      ready_from_filler   <= ((not filling) or done_from_filler) and ready_from_spiller and ready_from_prefetcher;
+      c_oimm_requestvalid <= fill_reading or spill_writing_to_memory or prefetch_requestvalid;
+      c_oimm_readnotwrite <= fill_reading or prefetch_reading;
+      c_oimm_address(ADDRESS_WIDTH-1 downto log2(WAY_SIZE)) <=
+        fill_request_line(ADDRESS_WIDTH-1 downto log2(WAY_SIZE)) when (fill_reading or prefetch_reading) = '1' else
         spill_tag;
-      c_oimm_address(log2(CACHE_SIZE)-1 downto log2(LINE_SIZE)) <=
-        std_logic_vector(read_lastline) when fill_reading = '1' else
+      c_oimm_address(log2(WAY_SIZE)-1 downto log2(LINE_SIZE)) <=
+        fill_request_line(log2(WAY_SIZE)-1 downto log2(LINE_SIZE)) when (fill_reading or prefetch_reading) = '1' else
         std_logic_vector(spill_line);
       multiple_bursts_per_line_address_gen : if BURSTS_PER_LINE > 1 generate
         c_oimm_address(log2(LINE_SIZE)-1 downto log2(BYTES_PER_BURST)) <=
-          std_logic_vector(fill_external_offset(log2(LINE_SIZE)-1 downto log2(BYTES_PER_BURST))) when
-          fill_reading = '1' else
+          std_logic_vector(fill_request_offset(log2(LINE_SIZE)-1 downto log2(BYTES_PER_BURST))) when
+          (fill_reading or prefetch_reading) = '1' else
           std_logic_vector(spill_offset(log2(LINE_SIZE)-1 downto log2(BYTES_PER_BURST)));
       end generate multiple_bursts_per_line_address_gen;
       multiple_beats_per_burst_line_address_gen : if BEATS_PER_BURST > 1 generate
         c_oimm_address(log2(BYTES_PER_BURST)-1 downto log2(BYTES_PER_BEAT)) <= (others => '0');
       end generate multiple_beats_per_burst_line_address_gen;
-      read_address(ADDRESS_WIDTH-1 downto log2(CACHE_SIZE)) <=
+      read_address(ADDRESS_WIDTH-1 downto log2(WAY_SIZE)) <=
         spill_tag                                                      when spill_reading_into_buffer = '1' else
-        cacheint_oimm_address(ADDRESS_WIDTH-1 downto log2(CACHE_SIZE)) when read_miss = '0' else
-        read_lastaddress(ADDRESS_WIDTH-1 downto log2(CACHE_SIZE));
-      read_address(log2(CACHE_SIZE)-1 downto log2(LINE_SIZE)) <=
+        cacheint_oimm_address(ADDRESS_WIDTH-1 downto log2(WAY_SIZE)) when read_miss = '0' else
+        read_lastaddress(ADDRESS_WIDTH-1 downto log2(WAY_SIZE));
+      read_address(log2(WAY_SIZE)-1 downto log2(LINE_SIZE)) <=
         std_logic_vector(spill_line)                                     when spill_reading_into_buffer = '1' else
-        std_logic_vector(cache_walker_line)                              when cache_walking = '1' else
-        cacheint_oimm_address(log2(CACHE_SIZE)-1 downto log2(LINE_SIZE)) when read_miss = '0' else
+        std_logic_vector(cache_walker_set)                               when cache_walking = '1' else
+        cacheint_oimm_address(log2(WAY_SIZE)-1 downto log2(LINE_SIZE)) when read_miss = '0' else
         std_logic_vector(read_lastline);
       read_address(log2(LINE_SIZE)-1 downto 0) <=
         std_logic_vector(spill_offset)                    when spill_reading_into_buffer = '1' else
@@ -765,15 +1040,30 @@ begin
       done_to_write_on_hit                              <= read_readdatavalid;
       write_hit_dirty_valid(write_hit_dirty_valid'left) <= '1';
 
+      --A line filled from the prefetch buffer waits until the victim has been
+      --read into the spill buffer.  Spilling a line makes a prefetch of it
+      --stale.
+      fill_hold                <= spill_reading_into_buffer;
+      other_c_oimm_start       <= '0';
+      prefetch_invalidate      <= start_to_spiller and ready_from_spiller;
+      prefetch_invalidate_line <= read_tag & read_address(log2(WAY_SIZE)-1 downto log2(LINE_SIZE));
+
+      --Without a hit the cache returns read_way's tag and data: the line
+      --being read into the spill buffer, the line being walked, or the
+      --victim of a miss (captured when the spiller starts).
+      read_way <= spill_way when (spill_reading_into_buffer or spill_buffer_write_enable) = '1' else
+                  cache_walker_way when cache_walking = '1' else
+                  read_victim_way;
+
       --On a cacheline fill use the last address (which caused the miss).  On a
       --write hit, use the last address (which caused the hit).  When spilling
       --a line use the same tag so that the WRITEBACK command correctly sets
       --the line to clean after writing it out to memory.
-      write_address(ADDRESS_WIDTH-1 downto log2(CACHE_SIZE)) <=
+      write_address(ADDRESS_WIDTH-1 downto log2(WAY_SIZE)) <=
         spill_tag when cache_walking = '1' else
-        read_lastaddress(ADDRESS_WIDTH-1 downto log2(CACHE_SIZE));
-      write_address(log2(CACHE_SIZE)-1 downto log2(LINE_SIZE)) <=
-        std_logic_vector(cache_walker_line) when cache_walking = '1' else
+        read_lastaddress(ADDRESS_WIDTH-1 downto log2(WAY_SIZE));
+      write_address(log2(WAY_SIZE)-1 downto log2(LINE_SIZE)) <=
+        std_logic_vector(cache_walker_set) when cache_walking = '1' else
         std_logic_vector(read_lastline);
       write_address(log2(LINE_SIZE)-1 downto 0) <=
         std_logic_vector(fill_internal_offset) when read_miss = '1' else
@@ -819,7 +1109,8 @@ begin
           if start_to_spiller = '1' and ready_from_spiller = '1' then
             spilling          <= '1';
             spill_tag         <= read_tag;
-            spill_line        <= unsigned(read_address(log2(CACHE_SIZE)-1 downto log2(LINE_SIZE)));
+            spill_line        <= unsigned(read_address(log2(WAY_SIZE)-1 downto log2(LINE_SIZE)));
+            spill_way         <= read_way;
             spill_dirty_valid <= read_dirty_valid;
             spill_region_hit  <= read_region_hit;
 
@@ -956,6 +1247,12 @@ begin
     ") must be a power of 2."
     severity failure;
 
+  assert 2**log2(WAYS) = WAYS
+    report "Error in cache: WAYS (" &
+    integer'image(WAYS) &
+    ") must be 1, 2, or 4."
+    severity failure;
+
   assert EXTERNAL_WIDTH >= INTERNAL_WIDTH
     report "Error in cache: EXTERNAL_WIDTH (" &
     integer'image(EXTERNAL_WIDTH) &
@@ -15,6 +15,8 @@ package rv_components is
       INTERRUPT_VECTOR       : std_logic_vector(31 downto 0) := X"00000200";
       MAX_IFETCHES_IN_FLIGHT : positive                      := 1;
       BTB_ENTRIES            : natural                       := 0;
+      BRANCH_PREDICTOR       : natural range 0 to 2          := 0;
+      RAS_ENTRIES            : natural                       := 0;
       MULTIPLY_ENABLE        : natural range 0 to 1          := 0;
       DIVIDE_ENABLE          : natural range 0 to 1          := 0;
       SHIFTER_MAX_CYCLES     : positive range 1 to 32        := 1;
@@ -26,6 +28,8 @@ package rv_components is
       POWER_OPTIMIZED        : natural range 0 to 1          := 0;
       FAMILY                 : string                        := "GENERIC";
 
+      PERFORMANCE_COUNTERS : natural range 0 to 10 := 0;
+
       -------------------------------------------------------------------------------
       -- Memory interfaces
       -------------------------------------------------------------------------------
@@ -50,6 +54,9 @@ package rv_components is
       --Instruction cache (ICACHE_SIZE 0 to disable)
       ICACHE_SIZE           : natural                  := 0;
       ICACHE_LINE_SIZE      : positive range 16 to 256 := 32;
+      ICACHE_WAYS           : positive range 1 to 4   := 1;
+      ICACHE_REPLACEMENT    : natural range 0 to 1    := 0;
+      ICACHE_PREFETCH       : natural range 0 to 2    := 0;
       ICACHE_EXTERNAL_WIDTH : positive                 := 32;
 
       --Instruction interface registers for timing/fmax
@@ -66,6 +73,9 @@ package rv_components is
       --Data cache (DCACHE_SIZE 0 to disable)
       DCACHE_SIZE           : natural                  := 0;
       DCACHE_LINE_SIZE      : positive range 16 to 256 := 32;
+      DCACHE_WAYS           : positive range 1 to 4   := 1;
+      DCACHE_REPLACEMENT    : natural range 0 to 1    := 0;
+      DCACHE_PREFETCH       : natural range 0 to 2    := 0;
       DCACHE_EXTERNAL_WIDTH : positive                 := 32;
       DCACHE_WRITEBACK      : natural range 0 to 1     := 1;
 
@@ -391,6 +401,9 @@ package rv_components is
 
       ICACHE_SIZE           : natural;
       ICACHE_LINE_SIZE      : positive range 16 to 256;
+      ICACHE_WAYS           : positive range 1 to 4;
+      ICACHE_REPLACEMENT    : cache_replacement_type;
+      ICACHE_PREFETCH       : cache_prefetch_type;
       ICACHE_EXTERNAL_WIDTH : positive;
 
       INSTRUCTION_REQUEST_REGISTER : request_register_type;
@@ -404,6 +417,9 @@ package rv_components is
 
       DCACHE_SIZE           : natural;
       DCACHE_LINE_SIZE      : positive range 16 to 256;
+      DCACHE_WAYS           : positive range 1 to 4;
+      DCACHE_REPLACEMENT    : cache_replacement_type;
+      DCACHE_PREFETCH       : cache_prefetch_type;
       DCACHE_EXTERNAL_WIDTH : positive;
       DCACHE_WRITEBACK      : boolean;
 
@@ -441,6 +457,8 @@ package rv_components is
       to_cache_control_last : in std_logic_vector(REGISTER_SIZE-1 downto 0);
 
       memory_interface_idle : out std_logic;
+      icache_miss           : out std_logic;
+      dcache_miss           : out std_logic;
 
       --Instruction ORCA-internal memory-mapped master
       ifetch_oimm_address       : in  std_logic_vector(REGISTER_SIZE-1 downto 0);
@@ -719,6 +737,8 @@ package rv_components is
       INTERRUPT_VECTOR       : std_logic_vector(31 downto 0);
       MAX_IFETCHES_IN_FLIGHT : positive;
       BTB_ENTRIES            : natural;
+      BRANCH_PREDICTOR       : branch_predictor_type;
+      RAS_ENTRIES            : natural;
       MULTIPLY_ENABLE        : boolean;
       DIVIDE_ENABLE          : boolean;
       SHIFTER_MAX_CYCLES     : positive range 1 to 32;
@@ -742,7 +762,9 @@ package rv_components is
       UMR0_READ_ONLY    : boolean;
 
       HAS_ICACHE : boolean;
-      HAS_DCACHE : boolean
+      HAS_DCACHE : boolean;
+
+      PERFORMANCE_COUNTERS : natural range 0 to 10
       );
     port (
       clk   : in std_logic;
@@ -766,6 +788,9 @@ package rv_components is
 
       memory_interface_idle : in std_logic;
 
+      icache_miss : in std_logic;
+      dcache_miss : in std_logic;
+
       --Instruction ORCA-internal memory-mapped master
       ifetch_oimm_address       : buffer std_logic_vector(REGISTER_SIZE-1 downto 0);
       ifetch_oimm_requestvalid  : buffer std_logic;
@@ -879,7 +904,9 @@ package rv_components is
       UMR0_READ_ONLY    : boolean;
 
       HAS_ICACHE : boolean;
-      HAS_DCACHE : boolean
+      HAS_DCACHE : boolean;
+
+      PERFORMANCE_COUNTERS : natural range 0 to 10
       );
     port (
       clk   : in std_logic;
@@ -912,6 +939,14 @@ package rv_components is
       to_pc_correction_predictable : out    std_logic;
       from_pc_correction_ready     : in     std_logic;
 
+      --To branch predictor
+      to_predictor_update_valid  : out std_logic;
+      to_predictor_update_branch : out std_logic;
+      to_predictor_update_taken  : out std_logic;
+      to_predictor_update_target : out unsigned(REGISTER_SIZE-1 downto 0);
+      to_predictor_update_call   : out std_logic;
+      to_predictor_update_return : out std_logic;
+
       --To register file
       to_rf_select : buffer std_logic_vector(REGISTER_NAME_SIZE-1 downto 0);
       to_rf_data   : buffer std_logic_vector(REGISTER_SIZE-1 downto 0);
@@ -967,7 +1002,9 @@ package rv_components is
       vcp_alu_data2        : in  std_logic_vector(REGISTER_SIZE-1 downto 0);
       vcp_alu_source_valid : in  std_logic;
       vcp_alu_result       : out std_logic_vector(REGISTER_SIZE-1 downto 0);
-      vcp_alu_result_valid : out std_logic
+      vcp_alu_result_valid : out std_logic;
+
+      core_hpm_events : in std_logic_vector(HPM_EVENTS-1 downto 0)
       );
   end component execute;
 
@@ -976,7 +1013,9 @@ package rv_components is
       REGISTER_SIZE          : positive range 32 to 32;
       RESET_VECTOR           : std_logic_vector(31 downto 0);
       MAX_IFETCHES_IN_FLIGHT : positive;
-      BTB_ENTRIES            : natural
+      BTB_ENTRIES            : natural;
+      BRANCH_PREDICTOR       : branch_predictor_type;
+      RAS_ENTRIES            : natural
       );
     port (
       clk   : in std_logic;
@@ -990,6 +1029,13 @@ package rv_components is
       to_pc_correction_predictable : in     std_logic;
       from_pc_correction_ready     : buffer std_logic;
 
+      to_predictor_update_valid  : in std_logic;
+      to_predictor_update_branch : in std_logic;
+      to_predictor_update_taken  : in std_logic;
+      to_predictor_update_target : in unsigned(REGISTER_SIZE-1 downto 0);
+      to_predictor_update_call   : in std_logic;
+      to_predictor_update_return : in std_logic;
+
       --quash_ifetch is handled by to_pc_correction_valid
       ifetch_idle : out std_logic;
 
@@ -1073,7 +1119,19 @@ package rv_components is
       to_pc_correction_data      : out unsigned(REGISTER_SIZE-1 downto 0);
       to_pc_correction_source_pc : out unsigned(REGISTER_SIZE-1 downto 0);
       to_pc_correction_valid     : out std_logic;
-      from_pc_correction_ready   : in  std_logic
+      from_pc_correction_ready   : in  std_logic;
+      --Which kind of branch/jump the correction is for (performance counters)
+      to_pc_correction_branch    : out std_logic;
+      to_pc_correction_return    : out std_logic;
+
+      --Valid for a cycle per branch/jump to train the branch predictor; the
+      --PC is to_pc_correction_source_pc and the rest hold until the next one.
+      to_predictor_update_valid  : out std_logic;
+      to_predictor_update_branch : out std_logic;
+      to_predictor_update_taken  : out std_logic;
+      to_predictor_update_target : out unsigned(REGISTER_SIZE-1 downto 0);
+      to_predictor_update_call   : out std_logic;
+      to_predictor_update_return : out std_logic
       );
   end component branch_unit;
 
@@ -1163,7 +1221,9 @@ package rv_components is
       UMR0_READ_ONLY    : boolean;
 
       HAS_ICACHE : boolean;
-      HAS_DCACHE : boolean
+      HAS_DCACHE : boolean;
+
+      PERFORMANCE_COUNTERS : natural range 0 to 10
       );
     port (
       clk   : in std_logic;
@@ -1216,7 +1276,9 @@ package rv_components is
       timer_interrupt : in std_logic;
 
       vcp_writeback_en   : in std_logic;
-      vcp_writeback_data : in std_logic_vector(REGISTER_SIZE-1 downto 0)
+      vcp_writeback_data : in std_logic_vector(REGISTER_SIZE-1 downto 0);
+
+      hpm_events : in std_logic_vector(HPM_EVENTS-1 downto 0)
       );
   end component sys_call;
 
@@ -1415,15 +1477,19 @@ package rv_components is
 
   component cache_controller is
     generic (
-      CACHE_SIZE            : natural;
-      LINE_SIZE             : positive range 16 to 256;
-      ADDRESS_WIDTH         : positive;
-      INTERNAL_WIDTH        : positive;
-      EXTERNAL_WIDTH        : positive;
-      LOG2_BURSTLENGTH      : positive;
-      POLICY                : cache_policy;
-      REGION_OPTIMIZATIONS  : boolean;
-      WRITE_FIRST_SUPPORTED : boolean
+      CACHE_SIZE               : natural;
+      LINE_SIZE                : positive range 16 to 256;
+      WAYS                     : positive range 1 to 4;
+      REPLACEMENT              : cache_replacement_type;
+      PREFETCH                 : cache_prefetch_type;
+      ADDRESS_WIDTH            : positive;
+      INTERNAL_WIDTH           : positive;
+      EXTERNAL_WIDTH           : positive;
+      LOG2_BURSTLENGTH         : positive;
+      MAX_OUTSTANDING_REQUESTS : positive;
+      POLICY                   : cache_policy;
+      REGION_OPTIMIZATIONS     : boolean;
+      WRITE_FIRST_SUPPORTED    : boolean
       );
     port (
       clk   : in std_logic;
@@ -1438,6 +1504,7 @@ package rv_components is
 
       precache_idle : in  std_logic;
       cache_idle    : out std_logic;
+      cache_miss    : out std_logic;
 
       --Cache interface ORCA-internal memory-mapped slave
       cacheint_oimm_address       : in     std_logic_vector(ADDRESS_WIDTH-1 downto 0);
@@ -1468,6 +1535,8 @@ package rv_components is
     generic (
       NUM_LINES             : positive;
       LINE_SIZE             : positive;
+      WAYS                  : positive;
+      REPLACEMENT           : cache_replacement_type;
       ADDRESS_WIDTH         : positive;
       WIDTH                 : positive;
       DIRTY_BITS            : natural;
@@ -1487,8 +1556,11 @@ package rv_components is
       read_miss            : buffer std_logic;
       read_requestinflight : buffer std_logic;
       read_lastaddress     : buffer std_logic_vector(ADDRESS_WIDTH-1 downto 0);
-      read_tag             : buffer std_logic_vector((ADDRESS_WIDTH-log2(NUM_LINES*LINE_SIZE))-1 downto 0);
+      read_tag             : buffer std_logic_vector((ADDRESS_WIDTH-log2((NUM_LINES/WAYS)*LINE_SIZE))-1 downto 0);
       read_dirty_valid     : out    std_logic_vector(DIRTY_BITS downto 0);
+      read_way             : in     natural range 0 to WAYS-1;
+      read_hit_way         : buffer natural range 0 to WAYS-1;
+      read_victim_way      : out    natural range 0 to WAYS-1;
 
       --Write-only data ORCA-internal memory-mapped slave
       write_address      : in std_logic_vector(ADDRESS_WIDTH-1 downto 0);
@@ -1496,7 +1568,8 @@ package rv_components is
       write_requestvalid : in std_logic;
       write_writedata    : in std_logic_vector(WIDTH-1 downto 0);
       write_tag_update   : in std_logic;
-      write_dirty_valid  : in std_logic_vector(DIRTY_BITS downto 0)
+      write_dirty_valid  : in std_logic_vector(DIRTY_BITS downto 0);
+      write_way          : in natural range 0 to WAYS-1
       );
   end component cache;
 
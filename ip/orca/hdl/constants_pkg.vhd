@@ -109,10 +109,25 @@ package constants_pkg is
   constant CSR_UTIME    : std_logic_vector(11 downto 0)  := x"C01";
   constant CSR_UTIMEH   : std_logic_vector(11 downto 0)  := x"C81";
 
+--Performance counters; counter n is at CSR_MCYCLE+n/CSR_MCYCLEH+n (read-only
+--copies at CSR_CYCLE+n/CSR_CYCLEH+n) and its event selector at
+--CSR_MHPMEVENT0+n.  Counter 1 is time, which is read from the timer instead.
+  constant CSR_MCYCLE        : std_logic_vector(11 downto 0) := x"B00";
+  constant CSR_MINSTRET      : std_logic_vector(11 downto 0) := x"B02";
+  constant CSR_MCYCLEH       : std_logic_vector(11 downto 0) := x"B80";
+  constant CSR_MINSTRETH     : std_logic_vector(11 downto 0) := x"B82";
+  constant CSR_CYCLE         : std_logic_vector(11 downto 0) := x"C00";
+  constant CSR_INSTRET       : std_logic_vector(11 downto 0) := x"C02";
+  constant CSR_CYCLEH        : std_logic_vector(11 downto 0) := x"C80";
+  constant CSR_INSTRETH      : std_logic_vector(11 downto 0) := x"C82";
+  constant CSR_MCOUNTINHIBIT : std_logic_vector(11 downto 0) := x"320";
+  constant CSR_MHPMEVENT0    : std_logic_vector(11 downto 0) := x"320";
+
 --NON-STANDARD
   constant CSR_MEIMASK    : std_logic_vector(11 downto 0) := x"7C0";
   constant CSR_MEIPEND    : std_logic_vector(11 downto 0) := x"FC0";
   constant CSR_MCACHE     : std_logic_vector(11 downto 0) := x"BC0";
+  constant CSR_MSLEEP     : std_logic_vector(11 downto 0) := x"800";
   constant CSR_MAMR0_BASE : std_logic_vector(11 downto 0) := x"BD0";
   constant CSR_MAMR1_BASE : std_logic_vector(11 downto 0) := x"BD1";
   constant CSR_MAMR2_BASE : std_logic_vector(11 downto 0) := x"BD2";
@@ -140,10 +155,16 @@ package constants_pkg is
   constant CSR_MCACHE_AMRS    : std_logic_vector(19 downto 16) := (others => '-');
   constant CSR_MCACHE_UMRS    : std_logic_vector(23 downto 20) := (others => '-');
 
+--CSR_MHPMEVENTn BITS (NON-STANDARD)
+  constant CSR_MHPMEVENT_SELECT : std_logic_vector(4 downto 0) := (others => '-');
+  constant CSR_MHPMEVENT_OF     : natural                      := 30;  --Overflowed, write 0 to clear
+  constant CSR_MHPMEVENT_OFIE   : natural                      := 31;  --Interrupt while CSR_MHPMEVENT_OF
+
   constant CSR_MCAUSE_CODE : std_logic_vector(3 downto 0) := (others => '-');
 
   constant CSR_MCAUSE_MTIMER         : std_logic_vector(CSR_MCAUSE_CODE'range) := x"7";
   constant CSR_MCAUSE_MEXT           : std_logic_vector(CSR_MCAUSE_CODE'range) := x"B";
+  constant CSR_MCAUSE_MHPM           : std_logic_vector(CSR_MCAUSE_CODE'range) := x"D";
   constant CSR_MCAUSE_ILLEGAL        : std_logic_vector(CSR_MCAUSE_CODE'range) := x"2";
   constant CSR_MCAUSE_EBREAK         : std_logic_vector(CSR_MCAUSE_CODE'range) := x"3";
   constant CSR_MCAUSE_MECALL         : std_logic_vector(CSR_MCAUSE_CODE'range) := x"B";
@@ -215,11 +236,40 @@ package constants_pkg is
   constant MUL_FUNC7         : std_logic_vector(6 downto 0) := "0000001";
 
 
+------------------------------------------------------------------------------
+-- Performance counter events, the CSR_MHPMEVENT_SELECT values.  Each is a
+-- bit of the hpm_events vector that is high for the cycles it counts.
+------------------------------------------------------------------------------
+  constant HPM_EVENTS : positive := 32;
+
+  constant HPM_EVENT_NONE          : natural := 0;
+  constant HPM_EVENT_CYCLES        : natural := 1;
+  constant HPM_EVENT_INSTRET       : natural := 2;
+  constant HPM_EVENT_EXECUTE_EMPTY : natural := 3;   --Nothing to execute
+  constant HPM_EVENT_IFETCH_WAIT   : natural := 4;   --Instruction fetch waitrequest
+  constant HPM_EVENT_EXECUTE_STALL : natural := 5;   --Instruction held in execute
+  constant HPM_EVENT_BRANCH        : natural := 6;   --Branches and jumps
+  constant HPM_EVENT_MISPREDICT    : natural := 7;   --Branch PC corrections
+  constant HPM_EVENT_LOAD_STORE    : natural := 8;
+  constant HPM_EVENT_LSU_STALL     : natural := 9;   --Waiting on the data bus or a load
+  constant HPM_EVENT_ICACHE_MISS   : natural := 10;  --ICache line fills
+  constant HPM_EVENT_DCACHE_MISS   : natural := 11;  --DCache line fills
+  constant HPM_EVENT_VCP_ISSUE     : natural := 12;  --Instructions sent to the VCP
+  constant HPM_EVENT_VCP_STALL     : natural := 13;  --VCP not ready
+  constant HPM_EVENT_SLEEP         : natural := 14;  --Held in a CSR_MSLEEP write
+
+  constant HPM_EVENT_BRANCH_MISPREDICT : natural := 15;  --Conditional branch PC corrections
+  constant HPM_EVENT_RETURN            : natural := 16;  --Function returns (JALR from x1/x5)
+  constant HPM_EVENT_RETURN_MISPREDICT : natural := 17;  --Return PC corrections
+
 ------------------------------------------------------------------------------
 -- Types
 ------------------------------------------------------------------------------
   type cache_policy is (READ_ONLY, WRITE_THROUGH, WRITE_BACK);
   type cache_control_command is (INITIALIZE, INVALIDATE, FLUSH, WRITEBACK);
+  type cache_replacement_type is (LRU, PSEUDO_RANDOM);
+  type cache_prefetch_type is (NO_PREFETCH, NEXT_LINE, STRIDE);
+  type branch_predictor_type is (ONE_BIT, TWO_BIT, GSHARE);
   type request_register_type is (OFF, LIGHT, FULL);
   type vcp_type is (DISABLED, THIRTY_TWO_BIT, SIXTY_FOUR_BIT);
 
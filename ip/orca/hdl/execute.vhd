@@ -38,7 +38,9 @@ entity execute is
     UMR0_READ_ONLY    : boolean;
 
     HAS_ICACHE : boolean;
-    HAS_DCACHE : boolean
+    HAS_DCACHE : boolean;
+
+    PERFORMANCE_COUNTERS : natural range 0 to 10
     );
   port (
     clk   : in std_logic;
@@ -71,6 +73,14 @@ entity execute is
     to_pc_correction_predictable : out    std_logic;
     from_pc_correction_ready     : in     std_logic;
 
+    --To branch predictor
+    to_predictor_update_valid  : out std_logic;
+    to_predictor_update_branch : out std_logic;
+    to_predictor_update_taken  : out std_logic;
+    to_predictor_update_target : out unsigned(REGISTER_SIZE-1 downto 0);
+    to_predictor_update_call   : out std_logic;
+    to_predictor_update_return : out std_logic;
+
     --To register file
     to_rf_select : buffer std_logic_vector(REGISTER_NAME_SIZE-1 downto 0);
     to_rf_data   : buffer std_logic_vector(REGISTER_SIZE-1 downto 0);
@@ -126,7 +136,10 @@ entity execute is
     vcp_alu_data2        : in  std_logic_vector(REGISTER_SIZE-1 downto 0);
     vcp_alu_source_valid : in  std_logic;
     vcp_alu_result       : out std_logic_vector(REGISTER_SIZE-1 downto 0);
-    vcp_alu_result_valid : out std_logic
+    vcp_alu_result_valid : out std_logic;
+
+    --Performance counter events from outside execute (fetch and caches)
+    core_hpm_events : in std_logic_vector(HPM_EVENTS-1 downto 0)
     );
 end entity execute;
 
@@ -197,8 +210,12 @@ architecture behavioural of execute is
   signal to_alu_rs1_data : std_logic_vector(REGISTER_SIZE-1 downto 0);
   signal to_alu_rs2_data : std_logic_vector(REGISTER_SIZE-1 downto 0);
 
-  signal branch_to_pc_correction_valid : std_logic;
-  signal branch_to_pc_correction_data  : unsigned(REGISTER_SIZE-1 downto 0);
+  signal branch_to_pc_correction_valid  : std_logic;
+  signal branch_to_pc_correction_data   : unsigned(REGISTER_SIZE-1 downto 0);
+  signal branch_to_pc_correction_branch : std_logic;
+  signal branch_to_pc_correction_return : std_logic;
+  signal branch_update_valid            : std_logic;
+  signal branch_update_return           : std_logic;
 
   signal writeback_stall_from_lsu : std_logic;
   signal load_in_progress         : std_logic;
@@ -214,6 +231,8 @@ architecture behavioural of execute is
   signal vcp_writeback_select : std_logic;
 
   signal from_branch_misaligned : std_logic;
+
+  signal hpm_events : std_logic_vector(HPM_EVENTS-1 downto 0);
 begin
   --Decode instruction; could get pushed back to decode stage
   process (opcode) is
@@ -410,8 +429,19 @@ begin
       to_pc_correction_data      => branch_to_pc_correction_data,
       to_pc_correction_source_pc => to_pc_correction_source_pc,
       to_pc_correction_valid     => branch_to_pc_correction_valid,
-      from_pc_correction_ready   => from_pc_correction_ready
+      from_pc_correction_ready   => from_pc_correction_ready,
+      to_pc_correction_branch    => branch_to_pc_correction_branch,
+      to_pc_correction_return    => branch_to_pc_correction_return,
+
+      to_predictor_update_valid  => branch_update_valid,
+      to_predictor_update_branch => to_predictor_update_branch,
+      to_predictor_update_taken  => to_predictor_update_taken,
+      to_predictor_update_target => to_predictor_update_target,
+      to_predictor_update_call   => to_predictor_update_call,
+      to_predictor_update_return => branch_update_return
       );
+  to_predictor_update_valid  <= branch_update_valid;
+  to_predictor_update_return <= branch_update_return;
 
   ls_unit : load_store_unit
     generic map (
@@ -476,7 +506,9 @@ begin
       UMR0_READ_ONLY    => UMR0_READ_ONLY,
 
       HAS_ICACHE => HAS_ICACHE,
-      HAS_DCACHE => HAS_DCACHE
+      HAS_DCACHE => HAS_DCACHE,
+
+      PERFORMANCE_COUNTERS => PERFORMANCE_COUNTERS
       )
     port map (
       clk   => clk,
@@ -528,7 +560,9 @@ begin
       timer_interrupt => timer_interrupt,
 
       vcp_writeback_data => vcp_writeback_data,
-      vcp_writeback_en   => vcp_writeback_en
+      vcp_writeback_en   => vcp_writeback_en,
+
+      hpm_events => hpm_events
       );
 
   vcp_port : vcp_handler
@@ -559,6 +593,32 @@ begin
   vcp_alu_result_valid <= from_alu_valid;
   vcp_alu_result       <= from_alu_data;
 
+  ------------------------------------------------------------------------------
+  -- Performance counter events
+  ------------------------------------------------------------------------------
+  hpm_events(HPM_EVENT_NONE)          <= '0';
+  hpm_events(HPM_EVENT_CYCLES)        <= '1';
+  hpm_events(HPM_EVENT_INSTRET)       <= to_execute_valid and from_execute_ready;
+  hpm_events(HPM_EVENT_EXECUTE_EMPTY) <= not to_execute_valid;
+  hpm_events(HPM_EVENT_IFETCH_WAIT)   <= core_hpm_events(HPM_EVENT_IFETCH_WAIT);
+  hpm_events(HPM_EVENT_EXECUTE_STALL) <= to_execute_valid and (not from_execute_ready);
+  hpm_events(HPM_EVENT_BRANCH)        <= to_branch_valid;
+  hpm_events(HPM_EVENT_MISPREDICT)    <= branch_to_pc_correction_valid and from_pc_correction_ready;
+  hpm_events(HPM_EVENT_LOAD_STORE)    <= to_lsu_valid and from_lsu_ready;
+  hpm_events(HPM_EVENT_LSU_STALL)     <= (lsu_select and to_execute_valid and (not from_lsu_ready)) or
+                                         writeback_stall_from_lsu;
+  hpm_events(HPM_EVENT_ICACHE_MISS)   <= core_hpm_events(HPM_EVENT_ICACHE_MISS);
+  hpm_events(HPM_EVENT_DCACHE_MISS)   <= core_hpm_events(HPM_EVENT_DCACHE_MISS);
+  hpm_events(HPM_EVENT_VCP_ISSUE)     <= to_vcp_valid and vcp_ready;
+  hpm_events(HPM_EVENT_VCP_STALL)     <= vcp_select and to_execute_valid and (not vcp_ready);
+  hpm_events(HPM_EVENT_SLEEP)         <= to_syscall_valid and (not from_syscall_ready);
+  hpm_events(HPM_EVENT_BRANCH_MISPREDICT) <= branch_to_pc_correction_valid and from_pc_correction_ready and
+                                             branch_to_pc_correction_branch;
+  hpm_events(HPM_EVENT_RETURN)            <= branch_update_valid and branch_update_return;
+  hpm_events(HPM_EVENT_RETURN_MISPREDICT) <= branch_to_pc_correction_valid and from_pc_correction_ready and
+                                             branch_to_pc_correction_return;
+  hpm_events(HPM_EVENTS-1 downto HPM_EVENT_RETURN_MISPREDICT+1) <= (others => '0');
+
   ------------------------------------------------------------------------------
   -- PC correction (branch mispredict, interrupt, etc.)
   ------------------------------------------------------------------------------
@@ -12,7 +12,9 @@ entity instruction_fetch is
     REGISTER_SIZE          : positive range 32 to 32;
     RESET_VECTOR           : std_logic_vector(31 downto 0);
     MAX_IFETCHES_IN_FLIGHT : positive;
-    BTB_ENTRIES            : natural
+    BTB_ENTRIES            : natural;
+    BRANCH_PREDICTOR       : branch_predictor_type;
+    RAS_ENTRIES            : natural
     );
   port (
     clk   : in std_logic;
@@ -26,6 +28,13 @@ entity instruction_fetch is
     to_pc_correction_predictable : in     std_logic;
     from_pc_correction_ready     : buffer std_logic;
 
+    to_predictor_update_valid  : in std_logic;
+    to_predictor_update_branch : in std_logic;
+    to_predictor_update_taken  : in std_logic;
+    to_predictor_update_target : in unsigned(REGISTER_SIZE-1 downto 0);
+    to_predictor_update_call   : in std_logic;
+    to_predictor_update_return : in std_logic;
+
     --quash_ifetch is handled by to_pc_correction_valid
     ifetch_idle : out std_logic;
 
@@ -94,8 +103,20 @@ begin
   no_btb_gen : if BTB_ENTRIES = 0 generate
     predicted_program_counter <= program_counter + to_unsigned(4, predicted_program_counter'length);
   end generate no_btb_gen;
-  --Branch predictor.  On a branch/jump update BTB ways; don't predict PC
-  --updates from other sources as they have side-effects.
+  --Branch predictor.  The BTB holds the target of branches/jumps; don't
+  --predict PC updates from other sources as they have side-effects.
+  --BRANCH_PREDICTOR selects when a BTB hit is followed:
+  --  ONE_BIT: entries are written on a mispredict with the PC that should
+  --    have been fetched, so a branch is predicted to go where it last went.
+  --  TWO_BIT: entries are allocated on a taken branch/jump and have a 2-bit
+  --    saturating counter trained on every resolved branch; taken while the
+  --    counter is 2 or 3.
+  --  GSHARE: conditional branches index a table of 2-bit counters with their
+  --    PC xor the global history of branch outcomes; jumps are always taken.
+  --With RAS_ENTRIES > 0 entries marked as returns take the top of the return
+  --address stack instead of the BTB target.  ONE_BIT without a return stack
+  --builds the original BTB (one_bit_btb_gen); everything else needs the
+  --extra per-entry state in predictor_gen.
   btb_gen : if BTB_ENTRIES > 0 generate
     subtype btb_tag_type is std_logic_vector(((REGISTER_SIZE-log2(BTB_ENTRIES))-2)-1 downto 0);
     type btb_tag_vector is array (natural range <>) of btb_tag_type;
@@ -114,43 +135,136 @@ begin
   begin
     btb_update <= to_pc_correction_valid and to_pc_correction_predictable;
 
-    one_entry_gen : if BTB_ENTRIES = 1 generate
-      process (clk) is
-      begin
-        if rising_edge(clk) then
-          if btb_update = '1' then
-            btb_valid(0)      <= '1';
-            btb_prediction(0) <= std_logic_vector(to_pc_correction_data(REGISTER_SIZE-1 downto 2));
-            btb_tag(0)        <= std_logic_vector(to_pc_correction_source_pc(REGISTER_SIZE-1 downto 2));
+    one_bit_btb_gen : if BRANCH_PREDICTOR = ONE_BIT and RAS_ENTRIES = 0 generate
+      one_entry_gen : if BTB_ENTRIES = 1 generate
+        process (clk) is
+        begin
+          if rising_edge(clk) then
+            if btb_update = '1' then
+              btb_valid(0)      <= '1';
+              btb_prediction(0) <= std_logic_vector(to_pc_correction_data(REGISTER_SIZE-1 downto 2));
+              btb_tag(0)        <= std_logic_vector(to_pc_correction_source_pc(REGISTER_SIZE-1 downto 2));
+            end if;
+
+            if reset = '1' then
+              btb_valid <= (others => '0');
+            end if;
           end if;
+        end process;
+        btb_prediction_valid <= btb_valid(0);
+        btb_prediction_pc    <= unsigned(std_logic_vector'(btb_prediction(0) & "00"));
+        btb_prediction_tag   <= btb_tag(0);
+      end generate one_entry_gen;
+      multiple_entries_gen : if BTB_ENTRIES > 1 generate
+        signal btb_read_entry_select  : unsigned(log2(BTB_ENTRIES)-1 downto 0);
+        signal btb_write_entry_select : unsigned(log2(BTB_ENTRIES)-1 downto 0);
+        signal btb_read_valid         : std_logic;
+        signal btb_read_prediction    : btb_prediction_type;
+        signal btb_read_tag           : btb_tag_type;
+      begin
+        btb_read_entry_select  <= unsigned(program_counter(log2(BTB_ENTRIES)+1 downto 2));
+        btb_write_entry_select <= to_pc_correction_source_pc(log2(BTB_ENTRIES)+1 downto 2);
+        process (clk) is
+        begin
+          if rising_edge(clk) then
+            if btb_update = '1' then
+              btb_valid(to_integer(btb_write_entry_select)) <= '1';
+              btb_prediction(to_integer(btb_write_entry_select)) <=
+                std_logic_vector(to_pc_correction_data(REGISTER_SIZE-1 downto 2));
+              btb_tag(to_integer(btb_write_entry_select)) <=
+                std_logic_vector(to_pc_correction_source_pc(REGISTER_SIZE-1 downto log2(BTB_ENTRIES)+2));
+            end if;
 
-          if reset = '1' then
-            btb_valid <= (others => '0');
+            if reset = '1' then
+              --For large rams we may want to change this; for now since the BTB
+              --is asynchronous read we can assume it will be small (implemented
+              --in LUTs or distributed RAMs) and so having a reset vector is OK.
+              btb_valid <= (others => '0');
+            end if;
           end if;
-        end if;
-      end process;
-      btb_prediction_valid <= btb_valid(0);
-      btb_prediction_pc    <= unsigned(std_logic_vector'(btb_prediction(0) & "00"));
-      btb_prediction_tag   <= btb_tag(0);
-    end generate one_entry_gen;
-    multiple_entries_gen : if BTB_ENTRIES > 1 generate
-      signal btb_read_entry_select  : unsigned(log2(BTB_ENTRIES)-1 downto 0);
-      signal btb_write_entry_select : unsigned(log2(BTB_ENTRIES)-1 downto 0);
-      signal btb_read_valid         : std_logic;
-      signal btb_read_prediction    : btb_prediction_type;
-      signal btb_read_tag           : btb_tag_type;
+        end process;
+        btb_prediction_valid <= btb_valid(to_integer(btb_read_entry_select));
+        btb_prediction_pc    <= unsigned(std_logic_vector'(btb_prediction(to_integer(btb_read_entry_select)) & "00"));
+        btb_prediction_tag   <= btb_tag(to_integer(btb_read_entry_select));
+      end generate multiple_entries_gen;
+      btb_prediction_tag_match <=
+        '1' when btb_prediction_tag = std_logic_vector(program_counter(REGISTER_SIZE-1 downto log2(BTB_ENTRIES)+2)) else
+        '0';
+
+      predicted_program_counter <=
+        btb_prediction_pc when btb_prediction_valid = '1' and btb_prediction_tag_match = '1' else
+        program_counter + to_unsigned(4, predicted_program_counter'length);
+    end generate one_bit_btb_gen;
+    predictor_gen : if BRANCH_PREDICTOR /= ONE_BIT or RAS_ENTRIES > 0 generate
+      type counter_vector is array (natural range <>) of unsigned(1 downto 0);
+
+      signal btb_counter : counter_vector(BTB_ENTRIES-1 downto 0);
+      signal btb_branch  : std_logic_vector(BTB_ENTRIES-1 downto 0);
+      signal btb_call    : std_logic_vector(BTB_ENTRIES-1 downto 0);
+      signal btb_return  : std_logic_vector(BTB_ENTRIES-1 downto 0);
+
+      signal btb_read_entry  : natural range 0 to BTB_ENTRIES-1;
+      signal btb_write_entry : natural range 0 to BTB_ENTRIES-1;
+      signal btb_write_tag   : btb_tag_type;
+      signal btb_write_hit   : std_logic;
+
+      signal btb_prediction_taken : std_logic;
+      signal btb_predict_taken    : std_logic;
+      signal ras_prediction_pc    : unsigned(REGISTER_SIZE-1 downto 0);
+
+      signal fetch_issued : std_logic;
     begin
-      btb_read_entry_select  <= unsigned(program_counter(log2(BTB_ENTRIES)+1 downto 2));
-      btb_write_entry_select <= to_pc_correction_source_pc(log2(BTB_ENTRIES)+1 downto 2);
+      one_entry_index_gen : if BTB_ENTRIES = 1 generate
+        btb_read_entry  <= 0;
+        btb_write_entry <= 0;
+      end generate one_entry_index_gen;
+      multiple_entries_index_gen : if BTB_ENTRIES > 1 generate
+        btb_read_entry  <= to_integer(program_counter(log2(BTB_ENTRIES)+1 downto 2));
+        btb_write_entry <= to_integer(to_pc_correction_source_pc(log2(BTB_ENTRIES)+1 downto 2));
+      end generate multiple_entries_index_gen;
+      btb_write_tag <= std_logic_vector(to_pc_correction_source_pc(REGISTER_SIZE-1 downto log2(BTB_ENTRIES)+2));
+      btb_write_hit <= btb_valid(btb_write_entry) when btb_tag(btb_write_entry) = btb_write_tag else '0';
+
       process (clk) is
       begin
         if rising_edge(clk) then
-          if btb_update = '1' then
-            btb_valid(to_integer(btb_write_entry_select)) <= '1';
-            btb_prediction(to_integer(btb_write_entry_select)) <=
-              std_logic_vector(to_pc_correction_data(REGISTER_SIZE-1 downto 2));
-            btb_tag(to_integer(btb_write_entry_select)) <=
-              std_logic_vector(to_pc_correction_source_pc(REGISTER_SIZE-1 downto log2(BTB_ENTRIES)+2));
+          if BRANCH_PREDICTOR = ONE_BIT then
+            if btb_update = '1' then
+              btb_valid(btb_write_entry)      <= '1';
+              btb_prediction(btb_write_entry) <= std_logic_vector(to_pc_correction_data(REGISTER_SIZE-1 downto 2));
+              btb_tag(btb_write_entry)        <= btb_write_tag;
+              btb_branch(btb_write_entry)     <= to_predictor_update_branch;
+              btb_call(btb_write_entry)       <= to_predictor_update_call;
+              btb_return(btb_write_entry)     <= to_predictor_update_return;
+            end if;
+          else
+            if to_predictor_update_valid = '1' then
+              if btb_write_hit = '1' then
+                if to_predictor_update_taken = '1' then
+                  if btb_counter(btb_write_entry) /= "11" then
+                    btb_counter(btb_write_entry) <= btb_counter(btb_write_entry) + to_unsigned(1, 2);
+                  end if;
+                else
+                  if btb_counter(btb_write_entry) /= "00" then
+                    btb_counter(btb_write_entry) <= btb_counter(btb_write_entry) - to_unsigned(1, 2);
+                  end if;
+                end if;
+              end if;
+
+              --Only taken branches/jumps need a target; start a new entry
+              --weakly taken.
+              if to_predictor_update_taken = '1' then
+                btb_valid(btb_write_entry)      <= '1';
+                btb_prediction(btb_write_entry) <= std_logic_vector(to_predictor_update_target(REGISTER_SIZE-1 downto 2));
+                btb_tag(btb_write_entry)        <= btb_write_tag;
+                btb_branch(btb_write_entry)     <= to_predictor_update_branch;
+                btb_call(btb_write_entry)       <= to_predictor_update_call;
+                btb_return(btb_write_entry)     <= to_predictor_update_return;
+                if btb_write_hit = '0' then
+                  btb_counter(btb_write_entry) <= "10";
+                end if;
+              end if;
+            end if;
           end if;
 
           if reset = '1' then
@@ -161,17 +275,133 @@ begin
           end if;
         end if;
       end process;
-      btb_prediction_valid <= btb_valid(to_integer(btb_read_entry_select));
-      btb_prediction_pc    <= unsigned(std_logic_vector'(btb_prediction(to_integer(btb_read_entry_select)) & "00"));
-      btb_prediction_tag   <= btb_tag(to_integer(btb_read_entry_select));
-    end generate multiple_entries_gen;
-    btb_prediction_tag_match <=
-      '1' when btb_prediction_tag = std_logic_vector(program_counter(REGISTER_SIZE-1 downto log2(BTB_ENTRIES)+2)) else
-      '0';
-
-    predicted_program_counter <=
-      btb_prediction_pc when btb_prediction_valid = '1' and btb_prediction_tag_match = '1' else
-      program_counter + to_unsigned(4, predicted_program_counter'length);
+      btb_prediction_pc <= unsigned(std_logic_vector'(btb_prediction(btb_read_entry) & "00"));
+      btb_prediction_tag_match <=
+        '1' when btb_tag(btb_read_entry) = std_logic_vector(program_counter(REGISTER_SIZE-1 downto log2(BTB_ENTRIES)+2)) else
+        '0';
+
+      one_bit_gen : if BRANCH_PREDICTOR = ONE_BIT generate
+        btb_prediction_taken <= '1';
+      end generate one_bit_gen;
+      two_bit_gen : if BRANCH_PREDICTOR = TWO_BIT generate
+        btb_prediction_taken <= btb_counter(btb_read_entry)(1);
+      end generate two_bit_gen;
+      gshare_gen : if BRANCH_PREDICTOR = GSHARE generate
+        --Four counters per BTB entry so different paths to a branch can be
+        --told apart.  The history is updated when branches resolve rather than
+        --when they are fetched, so a branch fetched while others are still in
+        --flight sees a slightly older history than it trains with.
+        constant PHT_INDEX_BITS : positive := log2(BTB_ENTRIES)+2;
+
+        signal pht             : counter_vector((2**PHT_INDEX_BITS)-1 downto 0);
+        signal global_history  : std_logic_vector(PHT_INDEX_BITS-1 downto 0);
+        signal pht_read_entry  : natural range 0 to (2**PHT_INDEX_BITS)-1;
+        signal pht_write_entry : natural range 0 to (2**PHT_INDEX_BITS)-1;
+      begin
+        pht_read_entry <=
+          to_integer(unsigned(std_logic_vector(program_counter(PHT_INDEX_BITS+1 downto 2)) xor global_history));
+        pht_write_entry <=
+          to_integer(unsigned(std_logic_vector(to_pc_correction_source_pc(PHT_INDEX_BITS+1 downto 2)) xor global_history));
+
+        process (clk) is
+        begin
+          if rising_edge(clk) then
+            if to_predictor_update_valid = '1' and to_predictor_update_branch = '1' then
+              if to_predictor_update_taken = '1' then
+                if pht(pht_write_entry) /= "11" then
+                  pht(pht_write_entry) <= pht(pht_write_entry) + to_unsigned(1, 2);
+                end if;
+              else
+                if pht(pht_write_entry) /= "00" then
+                  pht(pht_write_entry) <= pht(pht_write_entry) - to_unsigned(1, 2);
+                end if;
+              end if;
+              global_history <= global_history(global_history'left-1 downto 0) & to_predictor_update_taken;
+            end if;
+
+            if reset = '1' then
+              pht            <= (others => "10");
+              global_history <= (others => '0');
+            end if;
+          end if;
+        end process;
+
+        btb_prediction_taken <= pht(pht_read_entry)(1) when btb_branch(btb_read_entry) = '1' else '1';
+      end generate gshare_gen;
+
+      btb_predict_taken <= btb_valid(btb_read_entry) and btb_prediction_tag_match and btb_prediction_taken;
+
+      predicted_program_counter <=
+        ras_prediction_pc when btb_predict_taken = '1' and btb_return(btb_read_entry) = '1' else
+        btb_prediction_pc when btb_predict_taken = '1' else
+        program_counter + to_unsigned(4, predicted_program_counter'length);
+
+      fetch_issued <= oimm_requestvalid and (not oimm_waitrequest);
+
+      no_ras_gen : if RAS_ENTRIES = 0 generate
+        ras_prediction_pc <= btb_prediction_pc;
+      end generate no_ras_gen;
+      --Return address stack.  The speculative stack is pushed and popped as
+      --calls and returns are fetched and predicts the returns; the committed
+      --stack follows resolved branches and replaces the speculative one on any
+      --PC correction, as wrong-path fetches may have pushed or popped it.
+      ras_gen : if RAS_ENTRIES > 0 generate
+        signal ras_speculative     : btb_prediction_vector(RAS_ENTRIES-1 downto 0);
+        signal ras_speculative_top : natural range 0 to RAS_ENTRIES-1;
+        signal ras_committed       : btb_prediction_vector(RAS_ENTRIES-1 downto 0);
+        signal ras_committed_top   : natural range 0 to RAS_ENTRIES-1;
+      begin
+        process (clk) is
+          variable committed     : btb_prediction_vector(RAS_ENTRIES-1 downto 0);
+          variable committed_top : natural range 0 to RAS_ENTRIES-1;
+          variable return_pc     : unsigned(REGISTER_SIZE-1 downto 0);
+        begin
+          if rising_edge(clk) then
+            committed     := ras_committed;
+            committed_top := ras_committed_top;
+            if to_predictor_update_valid = '1' then
+              if to_predictor_update_return = '1' then
+                committed_top := (committed_top + RAS_ENTRIES - 1) mod RAS_ENTRIES;
+              end if;
+              if to_predictor_update_call = '1' then
+                return_pc                := to_pc_correction_source_pc + to_unsigned(4, REGISTER_SIZE);
+                committed_top            := (committed_top + 1) mod RAS_ENTRIES;
+                committed(committed_top) := std_logic_vector(return_pc(REGISTER_SIZE-1 downto 2));
+              end if;
+            end if;
+            ras_committed     <= committed;
+            ras_committed_top <= committed_top;
+
+            if to_pc_correction_valid = '1' and from_pc_correction_ready = '1' then
+              ras_speculative     <= committed;
+              ras_speculative_top <= committed_top;
+            elsif fetch_issued = '1' and btb_predict_taken = '1' then
+              if btb_call(btb_read_entry) = '1' then
+                --A call that is also a return replaces the top
+                return_pc := program_counter + to_unsigned(4, REGISTER_SIZE);
+                if btb_return(btb_read_entry) = '1' then
+                  ras_speculative(ras_speculative_top) <= std_logic_vector(return_pc(REGISTER_SIZE-1 downto 2));
+                else
+                  ras_speculative((ras_speculative_top + 1) mod RAS_ENTRIES) <=
+                    std_logic_vector(return_pc(REGISTER_SIZE-1 downto 2));
+                  ras_speculative_top <= (ras_speculative_top + 1) mod RAS_ENTRIES;
+                end if;
+              elsif btb_return(btb_read_entry) = '1' then
+                ras_speculative_top <= (ras_speculative_top + RAS_ENTRIES - 1) mod RAS_ENTRIES;
+              end if;
+            end if;
+
+            if reset = '1' then
+              ras_committed       <= (others => (others => '0'));
+              ras_committed_top   <= 0;
+              ras_speculative     <= (others => (others => '0'));
+              ras_speculative_top <= 0;
+            end if;
+          end if;
+        end process;
+        ras_prediction_pc <= unsigned(std_logic_vector'(ras_speculative(ras_speculative_top) & "00"));
+      end generate ras_gen;
+    end generate predictor_gen;
   end generate btb_gen;
 
 
@@ -526,6 +756,16 @@ begin
     ") must be a power of 2."
     severity failure;
 
+  assert (RAS_ENTRIES = 0) or (2**log2(RAS_ENTRIES) = RAS_ENTRIES) report
+    "RAS_ENTRIES (" &
+    natural'image(RAS_ENTRIES) &
+    ") must be a power of 2."
+    severity failure;
+
+  assert (RAS_ENTRIES = 0) or (BTB_ENTRIES > 0) report
+    "RAS_ENTRIES is ignored without a BTB (BTB_ENTRIES = 0)."
+    severity warning;
+
   assert (MAX_IFETCHES_IN_FLIGHT < 4) or (2**log2(MAX_IFETCHES_IN_FLIGHT) = MAX_IFETCHES_IN_FLIGHT) report
     "MAX_IFETCHES_IN_FLIGHT (" &
     natural'image(MAX_IFETCHES_IN_FLIGHT) &
@@ -33,6 +33,9 @@ entity memory_interface is
 
     ICACHE_SIZE           : natural;
     ICACHE_LINE_SIZE      : positive range 16 to 256;
+    ICACHE_WAYS           : positive range 1 to 4;
+    ICACHE_REPLACEMENT    : cache_replacement_type;
+    ICACHE_PREFETCH       : cache_prefetch_type;
     ICACHE_EXTERNAL_WIDTH : positive;
 
     INSTRUCTION_REQUEST_REGISTER : request_register_type;
@@ -46,6 +49,9 @@ entity memory_interface is
 
     DCACHE_SIZE           : natural;
     DCACHE_LINE_SIZE      : positive range 16 to 256;
+    DCACHE_WAYS           : positive range 1 to 4;
+    DCACHE_REPLACEMENT    : cache_replacement_type;
+    DCACHE_PREFETCH       : cache_prefetch_type;
     DCACHE_EXTERNAL_WIDTH : positive;
     DCACHE_WRITEBACK      : boolean;
 
@@ -83,6 +89,8 @@ entity memory_interface is
     to_cache_control_last : in std_logic_vector(REGISTER_SIZE-1 downto 0);
 
     memory_interface_idle : out std_logic;
+    icache_miss           : out std_logic;
+    dcache_miss           : out std_logic;
 
     --Instruction ORCA-internal memory-mapped master
     ifetch_oimm_address       : in  std_logic_vector(REGISTER_SIZE-1 downto 0);
@@ -532,15 +540,19 @@ begin
   begin
     instruction_cache : cache_controller
       generic map (
-        CACHE_SIZE            => ICACHE_SIZE,
-        LINE_SIZE             => ICACHE_LINE_SIZE,
-        ADDRESS_WIDTH         => REGISTER_SIZE,
-        INTERNAL_WIDTH        => REGISTER_SIZE,
-        EXTERNAL_WIDTH        => ICACHE_EXTERNAL_WIDTH,
-        LOG2_BURSTLENGTH      => LOG2_BURSTLENGTH,
-        POLICY                => READ_ONLY,
-        REGION_OPTIMIZATIONS  => true,
-        WRITE_FIRST_SUPPORTED => WRITE_FIRST_SUPPORTED
+        CACHE_SIZE               => ICACHE_SIZE,
+        LINE_SIZE                => ICACHE_LINE_SIZE,
+        WAYS                     => ICACHE_WAYS,
+        REPLACEMENT              => ICACHE_REPLACEMENT,
+        PREFETCH                 => ICACHE_PREFETCH,
+        ADDRESS_WIDTH            => REGISTER_SIZE,
+        INTERNAL_WIDTH           => REGISTER_SIZE,
+        EXTERNAL_WIDTH           => ICACHE_EXTERNAL_WIDTH,
+        LOG2_BURSTLENGTH         => LOG2_BURSTLENGTH,
+        MAX_OUTSTANDING_REQUESTS => MAX_OUTSTANDING_REQUESTS,
+        POLICY                   => READ_ONLY,
+        REGION_OPTIMIZATIONS     => true,
+        WRITE_FIRST_SUPPORTED    => WRITE_FIRST_SUPPORTED
         )
       port map (
         clk   => clk,
@@ -554,6 +566,7 @@ begin
 
         precache_idle => iinternal_register_idle,
         cache_idle    => icache_idle,
+        cache_miss    => icache_miss,
 
         cacheint_oimm_address       => icacheint_oimm_address,
         cacheint_oimm_byteenable    => icacheint_oimm_byteenable,
@@ -650,6 +663,7 @@ begin
   no_instruction_cache_gen : if ICACHE_SIZE = 0 generate
     from_icache_control_ready <= '1';
     icache_idle               <= '1';
+    icache_miss               <= '0';
     ic_master_idle            <= '1';
 
     IC_AWID    <= (others => '0');
@@ -786,15 +800,19 @@ begin
   begin
     data_cache : cache_controller
       generic map (
-        CACHE_SIZE            => DCACHE_SIZE,
-        LINE_SIZE             => DCACHE_LINE_SIZE,
-        ADDRESS_WIDTH         => REGISTER_SIZE,
-        INTERNAL_WIDTH        => REGISTER_SIZE,
-        EXTERNAL_WIDTH        => DCACHE_EXTERNAL_WIDTH,
-        LOG2_BURSTLENGTH      => LOG2_BURSTLENGTH,
-        POLICY                => boolean_to_cache_policy(DCACHE_WRITEBACK),
-        REGION_OPTIMIZATIONS  => true,
-        WRITE_FIRST_SUPPORTED => WRITE_FIRST_SUPPORTED
+        CACHE_SIZE               => DCACHE_SIZE,
+        LINE_SIZE                => DCACHE_LINE_SIZE,
+        WAYS                     => DCACHE_WAYS,
+        REPLACEMENT              => DCACHE_REPLACEMENT,
+        PREFETCH                 => DCACHE_PREFETCH,
+        ADDRESS_WIDTH            => REGISTER_SIZE,
+        INTERNAL_WIDTH           => REGISTER_SIZE,
+        EXTERNAL_WIDTH           => DCACHE_EXTERNAL_WIDTH,
+        LOG2_BURSTLENGTH         => LOG2_BURSTLENGTH,
+        MAX_OUTSTANDING_REQUESTS => MAX_OUTSTANDING_REQUESTS,
+        POLICY                   => boolean_to_cache_policy(DCACHE_WRITEBACK),
+        REGION_OPTIMIZATIONS     => true,
+        WRITE_FIRST_SUPPORTED    => WRITE_FIRST_SUPPORTED
         )
       port map (
         clk   => clk,
@@ -808,6 +826,7 @@ begin
 
         precache_idle => dinternal_register_idle,
         cache_idle    => dcache_idle,
+        cache_miss    => dcache_miss,
 
         cacheint_oimm_address       => dcacheint_oimm_address,
         cacheint_oimm_byteenable    => dcacheint_oimm_byteenable,
@@ -904,6 +923,7 @@ begin
   no_data_cache_gen : if DCACHE_SIZE = 0 generate
     from_dcache_control_ready <= '1';
     dcache_idle               <= '1';
+    dcache_miss               <= '0';
     dc_master_idle            <= '1';
 
     DC_AWID    <= (others => '0');
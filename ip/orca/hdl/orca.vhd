@@ -15,6 +15,8 @@ entity orca is
     INTERRUPT_VECTOR       : std_logic_vector(31 downto 0) := X"00000200";
     MAX_IFETCHES_IN_FLIGHT : positive                      := 1;
     BTB_ENTRIES            : natural                       := 0;
+    BRANCH_PREDICTOR       : natural range 0 to 2          := 0;
+    RAS_ENTRIES            : natural                       := 0;
     MULTIPLY_ENABLE        : natural range 0 to 1          := 0;
     DIVIDE_ENABLE          : natural range 0 to 1          := 0;
     SHIFTER_MAX_CYCLES     : positive range 1 to 32        := 1;
@@ -26,6 +28,10 @@ entity orca is
     POWER_OPTIMIZED        : natural range 0 to 1          := 0;
     FAMILY                 : string                        := "GENERIC";
 
+    --64-bit performance counters: 1 for mcycle, 2 adds minstret, 3 to 10 add
+    --mhpmcounter3 onwards (0 to disable)
+    PERFORMANCE_COUNTERS : natural range 0 to 10 := 0;
+
     -------------------------------------------------------------------------------
     -- Memory interfaces
     -------------------------------------------------------------------------------
@@ -52,6 +58,9 @@ entity orca is
     --Instruction cache (ICACHE_SIZE 0 to disable)
     ICACHE_SIZE           : natural                  := 0;
     ICACHE_LINE_SIZE      : positive range 16 to 256 := 32;
+    ICACHE_WAYS           : positive range 1 to 4   := 1;
+    ICACHE_REPLACEMENT    : natural range 0 to 1    := 0;
+    ICACHE_PREFETCH       : natural range 0 to 2    := 0;
     ICACHE_EXTERNAL_WIDTH : positive                 := 32;
 
     --Instruction interface registers for timing/fmax
@@ -68,6 +77,9 @@ entity orca is
     --Data cache (DCACHE_SIZE 0 to disable)
     DCACHE_SIZE           : natural                  := 0;
     DCACHE_LINE_SIZE      : positive range 16 to 256 := 32;
+    DCACHE_WAYS           : positive range 1 to 4   := 1;
+    DCACHE_REPLACEMENT    : natural range 0 to 1    := 0;
+    DCACHE_PREFETCH       : natural range 0 to 2    := 0;
     DCACHE_EXTERNAL_WIDTH : positive                 := 32;
     DCACHE_WRITEBACK      : natural range 0 to 1     := 1;
 
@@ -407,6 +419,51 @@ architecture rtl of orca is
     return vcp;
   end function natural_to_vcp;
 
+  function natural_to_cache_replacement (
+    constant NATURAL_REPLACEMENT : natural range 0 to 1
+    )
+    return cache_replacement_type is
+  begin
+    if NATURAL_REPLACEMENT = 1 then
+      return PSEUDO_RANDOM;
+    end if;
+    return LRU;
+  end function natural_to_cache_replacement;
+
+  function natural_to_cache_prefetch (
+    constant NATURAL_PREFETCH : natural range 0 to 2
+    )
+    return cache_prefetch_type is
+    variable prefetch : cache_prefetch_type := NO_PREFETCH;
+  begin
+    case NATURAL_PREFETCH is
+      when 2 =>
+        prefetch := STRIDE;
+      when 1 =>
+        prefetch := NEXT_LINE;
+      when others =>
+        prefetch := NO_PREFETCH;
+    end case;
+    return prefetch;
+  end function natural_to_cache_prefetch;
+
+  function natural_to_branch_predictor (
+    constant NATURAL_BRANCH_PREDICTOR : natural range 0 to 2
+    )
+    return branch_predictor_type is
+    variable branch_predictor : branch_predictor_type := ONE_BIT;
+  begin
+    case NATURAL_BRANCH_PREDICTOR is
+      when 2 =>
+        branch_predictor := GSHARE;
+      when 1 =>
+        branch_predictor := TWO_BIT;
+      when others =>
+        branch_predictor := ONE_BIT;
+    end case;
+    return branch_predictor;
+  end function natural_to_branch_predictor;
+
   signal amr_base_addrs : std_logic_vector((imax(AUX_MEMORY_REGIONS, 1)*REGISTER_SIZE)-1 downto 0);
   signal amr_last_addrs : std_logic_vector((imax(AUX_MEMORY_REGIONS, 1)*REGISTER_SIZE)-1 downto 0);
   signal umr_base_addrs : std_logic_vector((imax(UC_MEMORY_REGIONS, 1)*REGISTER_SIZE)-1 downto 0);
@@ -422,6 +479,8 @@ architecture rtl of orca is
   signal to_cache_control_last     : std_logic_vector(REGISTER_SIZE-1 downto 0);
 
   signal memory_interface_idle : std_logic;
+  signal icache_miss           : std_logic;
+  signal dcache_miss           : std_logic;
 
   signal lsu_oimm_address       : std_logic_vector(REGISTER_SIZE-1 downto 0);
   signal lsu_oimm_byteenable    : std_logic_vector((REGISTER_SIZE/8)-1 downto 0);
@@ -446,6 +505,8 @@ begin
       INTERRUPT_VECTOR       => INTERRUPT_VECTOR,
       MAX_IFETCHES_IN_FLIGHT => MAX_IFETCHES_IN_FLIGHT,
       BTB_ENTRIES            => BTB_ENTRIES,
+      BRANCH_PREDICTOR       => natural_to_branch_predictor(BRANCH_PREDICTOR),
+      RAS_ENTRIES            => RAS_ENTRIES,
       MULTIPLY_ENABLE        => MULTIPLY_ENABLE /= 0,
       DIVIDE_ENABLE          => DIVIDE_ENABLE /= 0,
       SHIFTER_MAX_CYCLES     => SHIFTER_MAX_CYCLES,
@@ -469,7 +530,9 @@ begin
       UMR0_READ_ONLY    => UMR0_READ_ONLY /= 0,
 
       HAS_ICACHE => ICACHE_SIZE /= 0,
-      HAS_DCACHE => DCACHE_SIZE /= 0
+      HAS_DCACHE => DCACHE_SIZE /= 0,
+
+      PERFORMANCE_COUNTERS => PERFORMANCE_COUNTERS
       )
     port map (
       clk   => clk,
@@ -478,6 +541,8 @@ begin
       global_interrupts => global_interrupts,
 
       memory_interface_idle => memory_interface_idle,
+      icache_miss           => icache_miss,
+      dcache_miss           => dcache_miss,
 
       --ICache control (Invalidate/flush/writeback)
       from_icache_control_ready => from_icache_control_ready,
@@ -565,6 +630,9 @@ begin
 
       ICACHE_SIZE           => ICACHE_SIZE,
       ICACHE_LINE_SIZE      => ICACHE_LINE_SIZE,
+      ICACHE_WAYS           => ICACHE_WAYS,
+      ICACHE_REPLACEMENT    => natural_to_cache_replacement(ICACHE_REPLACEMENT),
+      ICACHE_PREFETCH       => natural_to_cache_prefetch(ICACHE_PREFETCH),
       ICACHE_EXTERNAL_WIDTH => ICACHE_EXTERNAL_WIDTH,
 
       INSTRUCTION_REQUEST_REGISTER => natural_to_request_register(INSTRUCTION_REQUEST_REGISTER),
@@ -578,6 +646,9 @@ begin
 
       DCACHE_SIZE           => DCACHE_SIZE,
       DCACHE_LINE_SIZE      => DCACHE_LINE_SIZE,
+      DCACHE_WAYS           => DCACHE_WAYS,
+      DCACHE_REPLACEMENT    => natural_to_cache_replacement(DCACHE_REPLACEMENT),
+      DCACHE_PREFETCH       => natural_to_cache_prefetch(DCACHE_PREFETCH),
       DCACHE_EXTERNAL_WIDTH => DCACHE_EXTERNAL_WIDTH,
       DCACHE_WRITEBACK      => DCACHE_WRITEBACK /= 0,
 
@@ -595,6 +666,8 @@ begin
       reset => reset,
 
       memory_interface_idle => memory_interface_idle,
+      icache_miss           => icache_miss,
+      dcache_miss           => dcache_miss,
 
       --Auxiliary/Uncached memory regions
       amr_base_addrs => amr_base_addrs,
@@ -13,6 +13,8 @@ entity orca_core is
     INTERRUPT_VECTOR       : std_logic_vector(31 downto 0);
     MAX_IFETCHES_IN_FLIGHT : positive;
     BTB_ENTRIES            : natural;
+    BRANCH_PREDICTOR       : branch_predictor_type;
+    RAS_ENTRIES            : natural;
     MULTIPLY_ENABLE        : boolean;
     DIVIDE_ENABLE          : boolean;
     SHIFTER_MAX_CYCLES     : positive range 1 to 32;
@@ -36,7 +38,9 @@ entity orca_core is
     UMR0_READ_ONLY    : boolean;
 
     HAS_ICACHE : boolean;
-    HAS_DCACHE : boolean
+    HAS_DCACHE : boolean;
+
+    PERFORMANCE_COUNTERS : natural range 0 to 10
     );
   port (
     clk   : in std_logic;
@@ -46,6 +50,10 @@ entity orca_core is
 
     memory_interface_idle : in std_logic;
 
+    --Cache line fills, for the performance counters
+    icache_miss : in std_logic;
+    dcache_miss : in std_logic;
+
     --ICache control (Invalidate/flush/writeback)
     from_icache_control_ready : in     std_logic;
     to_icache_control_valid   : buffer std_logic;
@@ -121,6 +129,13 @@ architecture rtl of orca_core is
   signal to_pc_correction_predictable : std_logic;
   signal from_pc_correction_ready     : std_logic;
 
+  signal to_predictor_update_valid  : std_logic;
+  signal to_predictor_update_branch : std_logic;
+  signal to_predictor_update_taken  : std_logic;
+  signal to_predictor_update_target : unsigned(REGISTER_SIZE-1 downto 0);
+  signal to_predictor_update_call   : std_logic;
+  signal to_predictor_update_return : std_logic;
+
   signal ifetch_to_decode_instruction       : std_logic_vector(31 downto 0);
   signal ifetch_to_decode_program_counter   : unsigned(REGISTER_SIZE-1 downto 0);
   signal ifetch_to_decode_predicted_pc      : unsigned(REGISTER_SIZE-1 downto 0);
@@ -149,6 +164,8 @@ architecture rtl of orca_core is
   signal from_execute_pause_ifetch : std_logic;
   signal to_ifetch_pause_ifetch    : std_logic;
 
+  signal core_hpm_events : std_logic_vector(HPM_EVENTS-1 downto 0);
+
 begin
 
   to_ifetch_pause_ifetch <= (not (from_decode_incomplete_instruction and ifetch_idle)) and from_execute_pause_ifetch;
@@ -157,7 +174,9 @@ begin
       REGISTER_SIZE          => REGISTER_SIZE,
       RESET_VECTOR           => RESET_VECTOR,
       MAX_IFETCHES_IN_FLIGHT => MAX_IFETCHES_IN_FLIGHT,
-      BTB_ENTRIES            => BTB_ENTRIES
+      BTB_ENTRIES            => BTB_ENTRIES,
+      BRANCH_PREDICTOR       => BRANCH_PREDICTOR,
+      RAS_ENTRIES            => RAS_ENTRIES
       )
     port map (
       clk   => clk,
@@ -169,6 +188,13 @@ begin
       to_pc_correction_predictable => to_pc_correction_predictable,
       from_pc_correction_ready     => from_pc_correction_ready,
 
+      to_predictor_update_valid  => to_predictor_update_valid,
+      to_predictor_update_branch => to_predictor_update_branch,
+      to_predictor_update_taken  => to_predictor_update_taken,
+      to_predictor_update_target => to_predictor_update_target,
+      to_predictor_update_call   => to_predictor_update_call,
+      to_predictor_update_return => to_predictor_update_return,
+
       pause_ifetch => to_ifetch_pause_ifetch,
 
       ifetch_idle => ifetch_idle,
@@ -257,7 +283,9 @@ begin
       UMR0_READ_ONLY    => UMR0_READ_ONLY,
 
       HAS_ICACHE => HAS_ICACHE,
-      HAS_DCACHE => HAS_DCACHE
+      HAS_DCACHE => HAS_DCACHE,
+
+      PERFORMANCE_COUNTERS => PERFORMANCE_COUNTERS
       )
     port map (
       clk   => clk,
@@ -289,6 +317,13 @@ begin
       to_pc_correction_predictable => to_pc_correction_predictable,
       from_pc_correction_ready     => from_pc_correction_ready,
 
+      to_predictor_update_valid  => to_predictor_update_valid,
+      to_predictor_update_branch => to_predictor_update_branch,
+      to_predictor_update_taken  => to_predictor_update_taken,
+      to_predictor_update_target => to_predictor_update_target,
+      to_predictor_update_call   => to_predictor_update_call,
+      to_predictor_update_return => to_predictor_update_return,
+
       to_rf_select => execute_to_rf_select,
       to_rf_data   => execute_to_rf_data,
       to_rf_valid  => execute_to_rf_valid,
@@ -336,9 +371,20 @@ begin
       vcp_alu_data2        => vcp_alu_data2,
       vcp_alu_source_valid => vcp_alu_source_valid,
       vcp_alu_result       => vcp_alu_result,
-      vcp_alu_result_valid => vcp_alu_result_valid
+      vcp_alu_result_valid => vcp_alu_result_valid,
+
+      core_hpm_events => core_hpm_events
       );
 
+  --Execute fills in the rest of the events
+  process (ifetch_oimm_requestvalid, ifetch_oimm_waitrequest, icache_miss, dcache_miss) is
+  begin
+    core_hpm_events                        <= (others => '0');
+    core_hpm_events(HPM_EVENT_IFETCH_WAIT) <= ifetch_oimm_requestvalid and ifetch_oimm_waitrequest;
+    core_hpm_events(HPM_EVENT_ICACHE_MISS) <= icache_miss;
+    core_hpm_events(HPM_EVENT_DCACHE_MISS) <= dcache_miss;
+  end process;
+
   core_idle <= ifetch_idle and decode_idle and execute_idle;
 
 end architecture rtl;
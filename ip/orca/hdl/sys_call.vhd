@@ -30,7 +30,9 @@ entity sys_call is
     UMR0_READ_ONLY    : boolean;
 
     HAS_ICACHE : boolean;
-    HAS_DCACHE : boolean
+    HAS_DCACHE : boolean;
+
+    PERFORMANCE_COUNTERS : natural range 0 to 10
     );
   port (
     clk   : in std_logic;
@@ -85,7 +87,9 @@ entity sys_call is
     timer_interrupt : in std_logic;
 
     vcp_writeback_en   : in std_logic;
-    vcp_writeback_data : in std_logic_vector(REGISTER_SIZE-1 downto 0)
+    vcp_writeback_data : in std_logic_vector(REGISTER_SIZE-1 downto 0);
+
+    hpm_events : in std_logic_vector(HPM_EVENTS-1 downto 0)
     );
 end entity sys_call;
 
@@ -136,6 +140,7 @@ architecture rtl of sys_call is
 
   signal fence_pending                 : std_logic;
   signal interrupt_pending             : std_logic;
+  signal sleep_stall                   : std_logic;
   signal interrupt_pc_correction_valid : std_logic;
 
 
@@ -153,6 +158,31 @@ architecture rtl of sys_call is
   signal amr_last_write  : std_logic_vector(3 downto 0);
   signal umr_base_write  : std_logic_vector(3 downto 0);
   signal umr_last_write  : std_logic_vector(3 downto 0);
+
+  --Performance counters, indexed by CSR number (counter 1 is time).  Counters
+  --not in the configuration read as 0 and ignore writes.
+  type counter_vector is array (natural range <>) of unsigned(63 downto 0);
+  signal mcounter         : counter_vector(31 downto 0);
+  signal mhpmevent        : csr_vector(31 downto 0);
+  signal mcountinhibit    : std_logic_vector(REGISTER_SIZE-1 downto 0);
+  signal counter_readdata : std_logic_vector(REGISTER_SIZE-1 downto 0);
+  signal counter_write    : std_logic;
+  signal counter_lo       : std_logic;
+  signal counter_hi       : std_logic;
+  signal hpm_pending      : std_logic_vector(31 downto 0);
+  signal hpm_interrupt    : std_logic;
+
+  alias counter_index : std_logic_vector(4 downto 0) is csr_number(4 downto 0);
+
+  --PERFORMANCE_COUNTERS is 1 for mcycle, 2 adds minstret and 3 to 10 add
+  --mhpmcounter3 onwards.
+  function counter_present (
+    counter : natural
+    )
+    return boolean is
+  begin
+    return (counter = 0 and PERFORMANCE_COUNTERS > 0) or (counter >= 2 and counter <= PERFORMANCE_COUNTERS);
+  end function counter_present;
 begin
   --Decode instruction to select submodule.  All paths must decode to exactly
   --one submodule.
@@ -269,7 +299,7 @@ begin
     mumr_last(1)    when CSR_MUMR1_LAST,
     mumr_last(2)    when CSR_MUMR2_LAST,
     mumr_last(3)    when CSR_MUMR3_LAST,
-    (others => '0') when others;
+    counter_readdata when others;
 
   with func3 select
     csr_writedata <=
@@ -280,8 +310,15 @@ begin
     csr_readdata or rs1_data                                                             when CSRRS_FUNC3,
     rs1_data                                                                             when others;  --CSRRW_FUNC3,
 
-  --Currently all syscall instructions execute without backpressure
-  from_syscall_ready <= '1';
+  --A write to CSR_MSLEEP holds the instruction in execute until mtime reaches
+  --the value written (sleepuntil() in software) or an interrupt is pending.
+  --Nothing is fetched or issued meanwhile, so the LVE and its scratchpad sit
+  --idle.  All other syscall instructions execute without backpressure.
+  sleep_stall <= '1' when (to_syscall_valid = '1' and csr_select = '1' and csr_number = CSR_MSLEEP and
+                           interrupt_pending = '0' and
+                           signed(unsigned(mtime) - unsigned(csr_writedata)) < 0) else
+                 '0';
+  from_syscall_ready <= not sleep_stall;
 
   exceptions_gen : if ENABLE_EXCEPTIONS generate
     process(clk)
@@ -376,6 +413,9 @@ begin
           mstatus(CSR_MSTATUS_MPIE) <= '1';
           mcause(mcause'left)       <= '1';
           mcause_exc_code           <= CSR_MCAUSE_MEXT;
+          if hpm_interrupt = '1' then
+            mcause_exc_code <= CSR_MCAUSE_MHPM;
+          end if;
           if timer_interrupt = '1' then
             mcause_exc_code <= CSR_MCAUSE_MTIMER;
           end if;
@@ -578,7 +618,7 @@ begin
         to_dcache_control_valid <= '0';
       end if;
 
-      if illegal_instruction = '0' and to_syscall_valid = '1' then
+      if illegal_instruction = '0' and to_syscall_valid = '1' and sleep_stall = '0' then
         if csr_select = '1' then
           --CSR Read/Write
           from_syscall_valid <= '1';
@@ -713,10 +753,121 @@ begin
     meipend <= (others => '0');
     meimask <= (others => '0');
   end generate no_interrupts_gen;
-  interrupt_pending <= mstatus(CSR_MSTATUS_MIE) when unsigned(meimask and meipend) /= 0 or timer_interrupt = '1' else '0';
+  interrupt_pending <= mstatus(CSR_MSTATUS_MIE) when (unsigned(meimask and meipend) /= 0 or timer_interrupt = '1' or
+                                                      hpm_interrupt = '1') else
+                       '0';
 
   pause_ifetch <= fence_pending or interrupt_pending;
 
+--------------------------------------------------------------------------------
+-- Performance counters
+--
+-- 64-bit mcycle, minstret and mhpmcounterN, each counting the cycles its event
+-- is high unless its mcountinhibit bit is set.  A write to either half stops
+-- the whole counter for that cycle, so no carry from the count reaches the
+-- half that was not written.  mhpmeventN selects one of the
+-- hpm_events and, when a counter wraps to 0, sets CSR_MHPMEVENT_OF, which
+-- raises a CSR_MCAUSE_MHPM interrupt if CSR_MHPMEVENT_OFIE is set; presetting
+-- a counter to -N gives an interrupt every N events for sampling.
+--------------------------------------------------------------------------------
+  counter_lo <= '1' when (csr_number(11 downto 5) = CSR_MCYCLE(11 downto 5) or
+                          csr_number(11 downto 5) = CSR_CYCLE(11 downto 5)) else
+                '0';
+  counter_hi <= '1' when (csr_number(11 downto 5) = CSR_MCYCLEH(11 downto 5) or
+                          csr_number(11 downto 5) = CSR_CYCLEH(11 downto 5)) else
+                '0';
+  counter_readdata <=
+    std_logic_vector(mcounter(to_integer(unsigned(counter_index)))(REGISTER_SIZE-1 downto 0)) when counter_lo = '1' else
+    std_logic_vector(mcounter(to_integer(unsigned(counter_index)))(63 downto REGISTER_SIZE))  when counter_hi = '1' else
+    mcountinhibit when csr_number = CSR_MCOUNTINHIBIT else
+    mhpmevent(to_integer(unsigned(counter_index))) when csr_number(11 downto 5) = CSR_MHPMEVENT0(11 downto 5) else
+    (others => '0');
+
+  --Same condition as the CSR write in the main process.  CSRs from 0xC00 up
+  --are read-only, so the CSR_CYCLE copies are not written.
+  counter_write <= '1' when (to_syscall_valid = '1' and csr_select = '1' and illegal_instruction = '0' and
+                             sleep_stall = '0' and csr_number(11 downto 10) /= "11") else
+                   '0';
+
+  counters_gen : for gcounter in 31 downto 0 generate
+    counter_gen : if counter_present(gcounter) generate
+      signal counter_event   : std_logic;
+      signal counter_written : std_logic;
+    begin
+      cycle_gen : if gcounter = 0 generate
+        counter_event <= hpm_events(HPM_EVENT_CYCLES);
+      end generate cycle_gen;
+      instret_gen : if gcounter = 2 generate
+        counter_event <= hpm_events(HPM_EVENT_INSTRET);
+      end generate instret_gen;
+      hpm_gen : if gcounter > 2 generate
+        counter_event <= hpm_events(to_integer(unsigned(mhpmevent(gcounter)(CSR_MHPMEVENT_SELECT'range))));
+      end generate hpm_gen;
+
+      counter_written <= '1' when (counter_write = '1' and (counter_lo = '1' or counter_hi = '1') and
+                                   unsigned(counter_index) = to_unsigned(gcounter, counter_index'length)) else
+                         '0';
+
+      process(clk)
+      begin
+        if rising_edge(clk) then
+          if counter_event = '1' and mcountinhibit(gcounter) = '0' and counter_written = '0' then
+            mcounter(gcounter) <= mcounter(gcounter) + to_unsigned(1, 64);
+            if mcounter(gcounter) = unsigned'(63 downto 0 => '1') and gcounter > 2 then
+              mhpmevent(gcounter)(CSR_MHPMEVENT_OF) <= '1';
+            end if;
+          end if;
+
+          if counter_write = '1' and unsigned(counter_index) = to_unsigned(gcounter, counter_index'length) then
+            if counter_lo = '1' then
+              mcounter(gcounter)(REGISTER_SIZE-1 downto 0) <= unsigned(csr_writedata);
+            end if;
+            if counter_hi = '1' then
+              mcounter(gcounter)(63 downto REGISTER_SIZE) <= unsigned(csr_writedata);
+            end if;
+            if csr_number(11 downto 5) = CSR_MHPMEVENT0(11 downto 5) and gcounter > 2 then
+              mhpmevent(gcounter)(CSR_MHPMEVENT_SELECT'range) <= csr_writedata(CSR_MHPMEVENT_SELECT'range);
+              mhpmevent(gcounter)(CSR_MHPMEVENT_OF)           <= csr_writedata(CSR_MHPMEVENT_OF);
+              mhpmevent(gcounter)(CSR_MHPMEVENT_OFIE)         <= csr_writedata(CSR_MHPMEVENT_OFIE);
+            end if;
+          end if;
+
+          if reset = '1' then
+            mcounter(gcounter)                              <= (others => '0');
+            mhpmevent(gcounter)(CSR_MHPMEVENT_SELECT'range) <= (others => '0');
+            mhpmevent(gcounter)(CSR_MHPMEVENT_OF)           <= '0';
+            mhpmevent(gcounter)(CSR_MHPMEVENT_OFIE)         <= '0';
+          end if;
+        end if;
+      end process;
+      mhpmevent(gcounter)(CSR_MHPMEVENT_OF-1 downto CSR_MHPMEVENT_SELECT'left+1) <= (others => '0');
+      hpm_pending(gcounter) <= mhpmevent(gcounter)(CSR_MHPMEVENT_OF) and mhpmevent(gcounter)(CSR_MHPMEVENT_OFIE);
+    end generate counter_gen;
+    no_counter_gen : if not counter_present(gcounter) generate
+      mcounter(gcounter)    <= (others => '0');
+      mhpmevent(gcounter)   <= (others => '0');
+      hpm_pending(gcounter) <= '0';
+    end generate no_counter_gen;
+  end generate counters_gen;
+
+  process(clk)
+  begin
+    if rising_edge(clk) then
+      if counter_write = '1' and csr_number = CSR_MCOUNTINHIBIT then
+        for icounter in 31 downto 0 loop
+          if counter_present(icounter) then
+            mcountinhibit(icounter) <= csr_writedata(icounter);
+          end if;
+        end loop;
+      end if;
+      if reset = '1' then
+        mcountinhibit <= (others => '0');
+      end if;
+    end if;
+  end process;
+
+  hpm_interrupt <= or_slv(hpm_pending) when ENABLE_EXCEPTIONS else '0';
+
   -- There are several reasons that sys_calls might send a pc correction
   -- global interrupt
   -- illegal instruction
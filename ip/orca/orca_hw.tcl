@@ -206,6 +206,33 @@ set_parameter_property BTB_ENTRIES DESCRIPTION \
          "Set to disabled to disable branch predcition." ]
 add_display_item "Performance/Area Optimizations" BTB_ENTRIES PARAMETER
 
+add_parameter BRANCH_PREDICTOR natural 0
+set_parameter_property BRANCH_PREDICTOR DEFAULT_VALUE 0
+set_parameter_property BRANCH_PREDICTOR DISPLAY_NAME "Branch predictor"
+set_parameter_property BRANCH_PREDICTOR TYPE NATURAL
+set_parameter_property BRANCH_PREDICTOR UNITS None
+set_parameter_property BRANCH_PREDICTOR HDL_PARAMETER true
+set_parameter_property BRANCH_PREDICTOR ALLOWED_RANGES {0:1-bit 1:2-bit 2:gshare}
+set_parameter_property BRANCH_PREDICTOR DESCRIPTION \
+    [concat \
+         "How BTB hits are predicted: the last outcome (1-bit), " \
+         "a 2-bit saturating counter per BTB entry, " \
+         "or 2-bit counters indexed by PC xor global branch history (gshare)." ]
+add_display_item "Performance/Area Optimizations" BRANCH_PREDICTOR PARAMETER
+
+add_parameter RAS_ENTRIES natural 0
+set_parameter_property RAS_ENTRIES DEFAULT_VALUE 0
+set_parameter_property RAS_ENTRIES DISPLAY_NAME "Return address stack entries"
+set_parameter_property RAS_ENTRIES TYPE NATURAL
+set_parameter_property RAS_ENTRIES UNITS None
+set_parameter_property RAS_ENTRIES HDL_PARAMETER true
+set_parameter_property RAS_ENTRIES ALLOWED_RANGES {0:Disabled 1 2 4 8 16}
+set_parameter_property RAS_ENTRIES DESCRIPTION \
+    [concat \
+         "Number of return address stack entries used to predict function returns.  " \
+         "Requires a BTB." ]
+add_display_item "Performance/Area Optimizations" RAS_ENTRIES PARAMETER
+
 add_parameter MULTIPLY_ENABLE natural 1
 set_parameter_property MULTIPLY_ENABLE DEFAULT_VALUE 1
 set_parameter_property MULTIPLY_ENABLE DISPLAY_NAME "Hardware Multiply"
@@ -298,6 +325,17 @@ set_parameter_property POWER_OPTIMIZED DESCRIPTION \
          "Enable optimizations for power at the cost of higher area and potentially lower fmax." ]
 add_display_item "Performance/Area Optimizations" POWER_OPTIMIZED PARAMETER
 
+add_parameter PERFORMANCE_COUNTERS natural
+set_parameter_property PERFORMANCE_COUNTERS DEFAULT_VALUE 0
+set_parameter_property PERFORMANCE_COUNTERS DISPLAY_NAME "Performance Counters"
+set_parameter_property PERFORMANCE_COUNTERS HDL_PARAMETER true
+set_parameter_property PERFORMANCE_COUNTERS ALLOWED_RANGES 0:10
+set_parameter_property PERFORMANCE_COUNTERS DESCRIPTION \
+    [concat \
+         "Number of 64-bit performance counters.  1 gives mcycle, 2 adds minstret and " \
+         "3 to 10 add mhpmcounter3 onwards, each counting an event chosen by its mhpmevent CSR." ]
+add_display_item "Performance/Area Optimizations" PERFORMANCE_COUNTERS PARAMETER
+
 add_parameter FAMILY string INTEL
 set_parameter_property FAMILY HDL_PARAMETER true
 set_parameter_property FAMILY visible false
@@ -410,6 +448,40 @@ set_parameter_property ICACHE_LINE_SIZE DESCRIPTION \
          "Instruction line cache size in bytes.  " ]
 add_display_item "Instruction Cache and IC AXI4 Master" ICACHE_LINE_SIZE PARAMETER
 
+add_parameter ICACHE_WAYS NATURAL 1
+set_parameter_property ICACHE_WAYS ALLOWED_RANGES {1:Direct-mapped 2:2-way 4:4-way}
+set_parameter_property ICACHE_WAYS HDL_PARAMETER true
+set_parameter_property ICACHE_WAYS DISPLAY_NAME "Instruction Cache Associativity"
+set_parameter_property ICACHE_WAYS visible true
+set_parameter_property ICACHE_WAYS DESCRIPTION \
+    [concat \
+         "Number of ways in the instruction cache; each way holds a " \
+         "cache size/ways piece of the cache." ]
+add_display_item "Instruction Cache and IC AXI4 Master" ICACHE_WAYS PARAMETER
+
+add_parameter ICACHE_REPLACEMENT NATURAL 0
+set_parameter_property ICACHE_REPLACEMENT ALLOWED_RANGES {0:LRU 1:Pseudo-random}
+set_parameter_property ICACHE_REPLACEMENT HDL_PARAMETER true
+set_parameter_property ICACHE_REPLACEMENT DISPLAY_NAME "Instruction Cache Replacement"
+set_parameter_property ICACHE_REPLACEMENT visible true
+set_parameter_property ICACHE_REPLACEMENT DESCRIPTION \
+    [concat \
+         "Line replaced on a miss when every way of the set is valid.  " \
+         "LRU is pseudo-LRU for 4 ways." ]
+add_display_item "Instruction Cache and IC AXI4 Master" ICACHE_REPLACEMENT PARAMETER
+
+add_parameter ICACHE_PREFETCH NATURAL 0
+set_parameter_property ICACHE_PREFETCH ALLOWED_RANGES {0:None 1:Next-line 2:Stride}
+set_parameter_property ICACHE_PREFETCH HDL_PARAMETER true
+set_parameter_property ICACHE_PREFETCH DISPLAY_NAME "Instruction Cache Prefetch"
+set_parameter_property ICACHE_PREFETCH visible true
+set_parameter_property ICACHE_PREFETCH DESCRIPTION \
+    [concat \
+         "Next-line reads the line after each miss into a one line buffer while the bus is idle.  " \
+         "Stride does so once two misses in a row are the same distance apart; next-line suits straight-line code.  " \
+         "Prefetches do not cross a 4KB boundary." ]
+add_display_item "Instruction Cache and IC AXI4 Master" ICACHE_PREFETCH PARAMETER
+
 add_parameter ICACHE_EXTERNAL_WIDTH integer 32
 set_parameter_property ICACHE_EXTERNAL_WIDTH HDL_PARAMETER true
 set_parameter_property ICACHE_EXTERNAL_WIDTH DISPLAY_NAME "Instruction Cache External Interface Width"
@@ -480,6 +552,40 @@ set_parameter_property DCACHE_LINE_SIZE DESCRIPTION \
          "Data line cache size in bytes.  " ]
 add_display_item "Data Cache and DC AXI4 Master" DCACHE_LINE_SIZE PARAMETER
 
+add_parameter DCACHE_WAYS NATURAL 1
+set_parameter_property DCACHE_WAYS ALLOWED_RANGES {1:Direct-mapped 2:2-way 4:4-way}
+set_parameter_property DCACHE_WAYS HDL_PARAMETER true
+set_parameter_property DCACHE_WAYS DISPLAY_NAME "Data Cache Associativity"
+set_parameter_property DCACHE_WAYS visible true
+set_parameter_property DCACHE_WAYS DESCRIPTION \
+    [concat \
+         "Number of ways in the data cache; each way holds a " \
+         "cache size/ways piece of the cache." ]
+add_display_item "Data Cache and DC AXI4 Master" DCACHE_WAYS PARAMETER
+
+add_parameter DCACHE_REPLACEMENT NATURAL 0
+set_parameter_property DCACHE_REPLACEMENT ALLOWED_RANGES {0:LRU 1:Pseudo-random}
+set_parameter_property DCACHE_REPLACEMENT HDL_PARAMETER true
+set_parameter_property DCACHE_REPLACEMENT DISPLAY_NAME "Data Cache Replacement"
+set_parameter_property DCACHE_REPLACEMENT visible true
+set_parameter_property DCACHE_REPLACEMENT DESCRIPTION \
+    [concat \
+         "Line replaced on a miss when every way of the set is valid.  " \
+         "LRU is pseudo-LRU for 4 ways." ]
+add_display_item "Data Cache and DC AXI4 Master" DCACHE_REPLACEMENT PARAMETER
+
+add_parameter DCACHE_PREFETCH NATURAL 0
+set_parameter_property DCACHE_PREFETCH ALLOWED_RANGES {0:None 1:Next-line 2:Stride}
+set_parameter_property DCACHE_PREFETCH HDL_PARAMETER true
+set_parameter_property DCACHE_PREFETCH DISPLAY_NAME "Data Cache Prefetch"
+set_parameter_property DCACHE_PREFETCH visible true
+set_parameter_property DCACHE_PREFETCH DESCRIPTION \
+    [concat \
+         "Next-line reads the line after each miss into a one line buffer while the bus is idle.  " \
+         "Stride does so once two misses in a row are the same distance apart, for arrays walked with any stride.  " \
+         "Prefetches do not cross a 4KB boundary." ]
+add_display_item "Data Cache and DC AXI4 Master" DCACHE_PREFETCH PARAMETER
+
 add_parameter DCACHE_EXTERNAL_WIDTH integer 32
 set_parameter_property DCACHE_EXTERNAL_WIDTH HDL_PARAMETER true
 set_parameter_property DCACHE_EXTERNAL_WIDTH visible false
@@ -1246,13 +1352,27 @@ proc elaboration_callback {} {
         set_display_item_property DUC_RETURN_REGISTER enabled false
     }
 
+    if { [get_parameter_value BTB_ENTRIES] } {
+        set_display_item_property BRANCH_PREDICTOR enabled true
+        set_display_item_property RAS_ENTRIES enabled true
+    } else {
+        set_display_item_property BRANCH_PREDICTOR enabled false
+        set_display_item_property RAS_ENTRIES enabled false
+    }
+
     if { [get_parameter_value ICACHE_SIZE] } {
         set_display_item_property ICACHE_LINE_SIZE enabled true
+        set_display_item_property ICACHE_WAYS enabled true
+        set_display_item_property ICACHE_REPLACEMENT enabled true
+        set_display_item_property ICACHE_PREFETCH enabled true
         set_display_item_property ICACHE_EXTERNAL_WIDTH enabled true
         set_display_item_property IC_REQUEST_REGISTER enabled true
         set_display_item_property IC_RETURN_REGISTER enabled true
     } else {
         set_display_item_property ICACHE_LINE_SIZE enabled false
+        set_display_item_property ICACHE_WAYS enabled false
+        set_display_item_property ICACHE_REPLACEMENT enabled false
+        set_display_item_property ICACHE_PREFETCH enabled false
         set_display_item_property ICACHE_EXTERNAL_WIDTH enabled false
         set_display_item_property IC_REQUEST_REGISTER enabled false
         set_display_item_property IC_RETURN_REGISTER enabled false
@@ -1261,12 +1381,18 @@ proc elaboration_callback {} {
     if { [get_parameter_value DCACHE_SIZE] } {
         set_display_item_property DCACHE_WRITEBACK enabled true
         set_display_item_property DCACHE_LINE_SIZE enabled true
+        set_display_item_property DCACHE_WAYS enabled true
+        set_display_item_property DCACHE_REPLACEMENT enabled true
+        set_display_item_property DCACHE_PREFETCH enabled true
         set_display_item_property DCACHE_EXTERNAL_WIDTH enabled true
         set_display_item_property DC_REQUEST_REGISTER enabled true
         set_display_item_property DC_RETURN_REGISTER enabled true
     } else {
         set_display_item_property DCACHE_WRITEBACK enabled false
         set_display_item_property DCACHE_LINE_SIZE enabled false
+        set_display_item_property DCACHE_WAYS enabled false
+        set_display_item_property DCACHE_REPLACEMENT enabled false
+        set_display_item_property DCACHE_PREFETCH enabled false
         set_display_item_property DCACHE_EXTERNAL_WIDTH enabled false
         set_display_item_property DC_REQUEST_REGISTER enabled false
         set_display_item_property DC_RETURN_REGISTER enabled false
@@ -0,0 +1,165 @@
+#include "beamform.h"
+
+#define SPEED_OF_SOUND_M 343 // m/s
+
+// sin of degrees in [-180, 180] as Q15, Bhaskara's approximation (error < 0.2%)
+static int sin_q15(const int degrees)
+{
+	int x = degrees < 0 ? -degrees : degrees;
+	int p = x*(180 - x);
+	int sine = 4*32768*p/(40500 - p);
+	return degrees < 0 ? -sine : sine;
+}
+
+void beamform_linear_delays(int *delays, const int mics, const int angles, const int spacing_mm, const int sample_hz)
+{
+	int a, n;
+	// delay between neighbouring microphones for a source end on, in 1/1000ths of a fraction
+	int end_on = spacing_mm*sample_hz*BF_FRAC_ONE/SPEED_OF_SOUND_M;
+	for (a = 0; a < angles; a++) {
+		int degrees = angles > 1 ? -90 + 180*a/(angles - 1) : 0;
+		// neighbour delay in 1/1024ths of a fraction
+		int step = end_on*(sin_q15(degrees) >> 5)/1000;
+		for (n = 0; n < mics; n++) {
+			int delay = n*step;
+			delays[a*mics + n] = (delay + (delay < 0 ? -512 : 512))/1024;
+		}
+	}
+}
+
+static int ceil_log2(int x)
+{
+	int bits = 0;
+	while ((1 << bits) < x) {
+		bits++;
+	}
+	return bits;
+}
+
+int beamform_init(beamform_t *bf, const int mics, const int angles, const int window,
+                  const int *delays, vbx_word_t *v_work)
+{
+	int a, n, m, p, lag, max_lag = 0;
+	int pairs = mics*(mics - 1)/2;
+	if (mics < 2 || mics > BF_MAX_MICS || angles < 1 || angles > BF_MAX_ANGLES || window < 1) {
+		return 0;
+	}
+
+	for (a = 0; a < angles; a++) {
+		for (n = 0; n < mics; n++) {
+			for (m = n+1; m < mics; m++) {
+				lag = delays[a*mics + m] - delays[a*mics + n];
+				lag = lag < 0 ? -lag : lag;
+				max_lag = max(max_lag, (lag + BF_FRAC_ONE - 1) >> BF_FRAC_BITS);
+			}
+		}
+	}
+
+	bf->mics = mics;
+	bf->angles = angles;
+	bf->window = window;
+	bf->max_lag = max_lag;
+	// |sum of mics| squared over a window of 16 bit samples has to stay below 2^31
+	bf->prescale = max(1, ceil_log2(mics*mics*window)/2);
+
+	vbx_word_t *v = v_work;
+	int hist = window + 2*max_lag;
+	for (n = 0; n < mics; n++) {
+		bf->v_hist[n] = v;
+		v += hist;
+	}
+	bf->v_energy = v;
+	v += mics;
+	bf->v_xcorr = v;
+	v += pairs*(2*max_lag + 1);
+	bf->v_sums = v;
+	v += 2*max_lag + 2;
+	bf->v_lags = v;
+	v += angles*pairs;
+
+	vbx_set_vl(mics*hist);
+	vbx(SVW, VAND, bf->v_hist[0], 0, bf->v_hist[0]);
+	bf->v_sums[0] = 0;
+	for (a = 0; a < angles; a++) {
+		for (n = 0, p = 0; n < mics; n++) {
+			for (m = n+1; m < mics; m++, p++) {
+				bf->v_lags[a*pairs + p] = delays[a*mics + m] - delays[a*mics + n];
+			}
+		}
+		bf->histogram[a] = 0;
+	}
+	return (v - v_work)*sizeof(vbx_word_t);
+}
+
+int beamform_window(beamform_t *bf, vbx_word_t **v_in)
+{
+	int a, n, m, p, best = 0;
+	int L = bf->max_lag, W = bf->window, rows = 2*L + 1;
+	int pairs = bf->mics*(bf->mics - 1)/2;
+
+	// slide the last 2*max_lag samples to the front and append the new window,
+	// so sample max_lag + t of the history is sample t of this window
+	for (n = 0; n < bf->mics; n++) {
+		if (L) {
+			vbx_set_vl(2*L);
+			vbx(VVW, VMOV, bf->v_hist[n], bf->v_hist[n] + W, 0);
+		}
+		vbx_set_vl(W);
+		vbx(SVW, VMULH, bf->v_hist[n] + 2*L, 1 << (32 - bf->prescale), v_in[n]);
+	}
+
+	vbx_set_vl(W);
+	for (n = 0; n < bf->mics; n++) {
+		vbx_acc(VVW, VMUL, bf->v_energy + n, bf->v_hist[n] + L, bf->v_hist[n] + L);
+	}
+
+	// row j multiplies microphone n's window with microphone m's shifted by
+	// j - max_lag, the accumulator carries across rows so v_sums holds running sums
+	for (n = 0, p = 0; n < bf->mics; n++) {
+		for (m = n+1; m < bf->mics; m++, p++) {
+			vbx_set_vl(W, rows);
+			vbx_set_2D(sizeof(vbx_word_t), 0, sizeof(vbx_word_t));
+			vbx_acc(VVW, VMUL, bf->v_sums + 1, bf->v_hist[n] + L, bf->v_hist[m]);
+			vbx_set_vl(rows);
+			vbx(VVW, VSUB, bf->v_xcorr + p*rows, bf->v_sums + 1, bf->v_sums);
+		}
+	}
+
+	int32_t energy = 0;
+	for (n = 0; n < bf->mics; n++) {
+		energy += bf->v_energy[n];
+	}
+	for (a = 0; a < bf->angles; a++) {
+		int32_t power = energy;
+		for (p = 0; p < pairs; p++) {
+			int lag = bf->v_lags[a*pairs + p];
+			int frac = lag & (BF_FRAC_ONE - 1);
+			vbx_word_t *r = bf->v_xcorr + p*rows + L + (lag >> BF_FRAC_BITS);
+			int32_t xcorr = r[0];
+			if (frac) {
+				xcorr += (((long long)r[1] - r[0])*frac) >> BF_FRAC_BITS;
+			}
+			power += 2*xcorr;
+		}
+		bf->powers[a] = power;
+		if (power > bf->powers[best]) {
+			best = a;
+		}
+	}
+	bf->histogram[best]++;
+	return best;
+}
+
+int beamform_histogram_peak(beamform_t *bf, const int decay)
+{
+	int a, best = 0;
+	for (a = 0; a < bf->angles; a++) {
+		if (bf->histogram[a] > bf->histogram[best]) {
+			best = a;
+		}
+	}
+	for (a = 0; a < bf->angles; a++) {
+		bf->histogram[a] >>= decay;
+	}
+	return best;
+}
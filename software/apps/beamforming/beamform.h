@@ -0,0 +1,59 @@
+#ifndef BEAMFORM_H
+#define BEAMFORM_H
+
+#include "vbx.h"
+
+// Steered response power (delay-and-sum) beamforming for N microphones and
+// M steering angles.
+//
+// Every window, the filtered block of each microphone is prescaled and
+// appended to a history of 2*max_lag earlier samples. The cross-correlation of
+// every microphone pair over all lags in [-max_lag, max_lag] then takes one 2D
+// accumulate per pair. A steering angle's power is the sum of the microphone
+// energies plus twice each pair's correlation at that angle's lag, linearly
+// interpolated between whole-sample lags. Apart from the samples the steering
+// shifts across the window edges, that is the power of the delay-and-sum
+// beam. The window evaluated lags the newest samples by max_lag so every lag
+// has samples on both sides.
+//
+// Delays are in 1/BF_FRAC_ONE samples. delays[angle*mics + mic] is how much
+// later a source at that angle reaches that microphone.
+
+#define BF_MAX_MICS   8
+#define BF_MAX_ANGLES 16
+#define BF_FRAC_BITS  4
+#define BF_FRAC_ONE   (1 << BF_FRAC_BITS)
+
+typedef struct {
+	int mics, angles, window, max_lag;
+	int prescale; // samples are shifted right by this before correlating
+	vbx_word_t *v_hist[BF_MAX_MICS];
+	vbx_word_t *v_energy;
+	vbx_word_t *v_xcorr;  // [pair][2*max_lag+1]
+	vbx_word_t *v_sums;   // running sums of one pair, v_sums[0] stays 0
+	vbx_word_t *v_lags;   // [angle][pair]
+	int32_t powers[BF_MAX_ANGLES];
+	int histogram[BF_MAX_ANGLES];
+} beamform_t;
+
+// Delays for a uniform linear array, microphone 0 at one end, with angles
+// spread evenly from -90 to 90 degrees (0 is broadside).
+void beamform_linear_delays(int *delays, const int mics, const int angles, const int spacing_mm, const int sample_hz);
+
+// window samples per call, v_work must have room for
+// (mics*(window + 2*max_lag + 1) + pairs*(2*max_lag + 1) + 2*max_lag + 2 + angles*pairs) words,
+// where max_lag is the largest pair delay difference rounded up to whole samples.
+// Returns the bytes of v_work used, or 0 if the sizes are out of range.
+int beamform_init(beamform_t *bf, const int mics, const int angles, const int window,
+                  const int *delays, vbx_word_t *v_work);
+
+// v_in[mic] is that microphone's next window of filtered samples in the
+// scratchpad. Fills bf->powers, adds to the histogram and returns the
+// angle with the most power.
+int beamform_window(beamform_t *bf, vbx_word_t **v_in);
+
+// Returns the most frequent angle since the last call and shifts every
+// histogram count down by decay, so older windows count for less.
+int beamform_histogram_peak(beamform_t *bf, const int decay);
+
+#endif //BEAMFORM_H
@@ -5,6 +5,7 @@
 #include "fir.h"
 #include "printf.h"
 #include "i2s.h"
+#include "bf_kernels.h"
 
 #include <stddef.h>
 
@@ -44,12 +45,10 @@ static inline unsigned get_time() {
 #define SAMPLE_DIFFERENCE ((int) (DISTANCE*SAMPLE_RATE/SPEED_OF_SOUND))
 
 #define WINDOW_LENGTH 64
-#define NUM_WINDOWS 2
-#define BUFFER_LENGTH WINDOW_LENGTH*NUM_WINDOWS
 
 #define PRESCALE 4
-#define PRESCALE_MUL 1 << (32 - PRESCALE)
 
+#undef SCRATCHPAD_BASE
 #define SCRATCHPAD_BASE ((int32_t *) (0x80000000))
 
 extern int samples_l[NUM_SAMPLES];
@@ -83,6 +82,7 @@ vbx_void_t *vbx_lattice_sp_malloc(size_t num_bytes) {
 #define USE_PRINT 1
 #define USE_MICS  1
 #define TRACK_TIME 1
+#define BLOCK_FIR  1 // filter each window at once rather than per sample
 
 int main() {
 
@@ -95,56 +95,29 @@ int main() {
 #if USE_MICS
   i2s_set_frequency(SYS_CLK, 8000);
 #endif
+#if !USE_MICS
   int sample_count = 0;
-
-  vbx_word_t *v_filtered_l;
-  vbx_word_t *v_filtered_r;
-  vbx_word_t *sound_vector_l;
-  vbx_word_t *sound_vector_r;
-  vbx_word_t *sum_vector;
-  vbx_word_t *v_fir_taps;
-  vbx_word_t *mic_buffer_l;
-  vbx_word_t *mic_buffer_r;
-
-  vbx_word_t *power_center;
-  vbx_word_t *power_left;
-  vbx_word_t *power_right;
-  vbx_word_t *fir_acc_l;
-  vbx_word_t *fir_acc_r;
+#endif
 
   int32_t i;
-  int32_t buffer_count = 0;
-  int32_t transfer_offset;
+  bf_window_t bf;
 
   sp_malloc_init((char *)SCRATCHPAD_BASE);
 
-  v_filtered_l = (vbx_word_t *) vbx_lattice_sp_malloc(BUFFER_LENGTH * sizeof(vbx_word_t));
-  v_filtered_r = (vbx_word_t *) vbx_lattice_sp_malloc(BUFFER_LENGTH * sizeof(vbx_word_t)); 
-  sound_vector_l = (vbx_word_t *) vbx_lattice_sp_malloc((WINDOW_LENGTH + SAMPLE_DIFFERENCE) * sizeof(vbx_word_t));
-  sound_vector_r = (vbx_word_t *) vbx_lattice_sp_malloc((WINDOW_LENGTH + SAMPLE_DIFFERENCE) * sizeof(vbx_word_t));
-  sum_vector = (vbx_word_t *) vbx_lattice_sp_malloc((WINDOW_LENGTH) * sizeof(vbx_word_t));
-  v_fir_taps = (vbx_word_t *) vbx_lattice_sp_malloc((NUM_TAPS) * sizeof(vbx_word_t));  
-  mic_buffer_l = (vbx_word_t *) vbx_lattice_sp_malloc(BUFFER_LENGTH * sizeof(vbx_word_t));
-  mic_buffer_r = (vbx_word_t *) vbx_lattice_sp_malloc(BUFFER_LENGTH * sizeof(vbx_word_t));
-  power_center = (vbx_word_t *) vbx_lattice_sp_malloc(sizeof(vbx_word_t));
-  power_left = (vbx_word_t *) vbx_lattice_sp_malloc(sizeof(vbx_word_t));
-  power_right = (vbx_word_t *) vbx_lattice_sp_malloc(sizeof(vbx_word_t)); 
-  fir_acc_l = (vbx_word_t *) vbx_lattice_sp_malloc(sizeof(vbx_word_t));
-  fir_acc_r = (vbx_word_t *) vbx_lattice_sp_malloc(sizeof(vbx_word_t));
-
-  vbx_set_vl(BUFFER_LENGTH);
-  vbx(SEWS, VAND, v_filtered_l, 0, vbx_ENUM);
-  vbx(SEWS, VAND, v_filtered_r, 0, vbx_ENUM);
-  vbx(SEWS, VAND, mic_buffer_l, 0, vbx_ENUM);
-  vbx(SEWS, VAND, mic_buffer_r, 0, vbx_ENUM);
-  vbx_set_vl(WINDOW_LENGTH + SAMPLE_DIFFERENCE);
-  vbx(SEWS, VAND, sound_vector_l, 0, vbx_ENUM);
-  vbx(SEWS, VAND, sound_vector_r, 0, vbx_ENUM);
-
-  // Initialize FIR vector.
-  for (i = 0; i < NUM_TAPS; i++) {
-    v_fir_taps[i] = fir_taps[i];
-  }
+  // mic_buffer holds the last NUM_TAPS - 1 samples of the previous window
+  // then the new ones, sound_vector the filtered samples.
+  bf.v_taps = (vbx_word_t *) vbx_lattice_sp_malloc((NUM_TAPS) * sizeof(vbx_word_t));
+  bf.v_mic_l = (vbx_word_t *) vbx_lattice_sp_malloc((NUM_TAPS - 1 + WINDOW_LENGTH) * sizeof(vbx_word_t));
+  bf.v_mic_r = (vbx_word_t *) vbx_lattice_sp_malloc((NUM_TAPS - 1 + WINDOW_LENGTH) * sizeof(vbx_word_t));
+  bf.v_sound_l = (vbx_word_t *) vbx_lattice_sp_malloc((WINDOW_LENGTH + SAMPLE_DIFFERENCE) * sizeof(vbx_word_t));
+  bf.v_sound_r = (vbx_word_t *) vbx_lattice_sp_malloc((WINDOW_LENGTH + SAMPLE_DIFFERENCE) * sizeof(vbx_word_t));
+  bf.v_tmp = (vbx_word_t *) vbx_lattice_sp_malloc((WINDOW_LENGTH + 1) * sizeof(vbx_word_t));
+  bf.ntaps = NUM_TAPS;
+  bf.window = WINDOW_LENGTH;
+  bf.diff = SAMPLE_DIFFERENCE;
+  bf.fir_shift = FIR_PRECISION;
+  bf.prescale = PRESCALE;
+  bf_window_init(&bf, fir_taps);
 
 #if USE_PRINT
   printf("entering loop\r\n");
@@ -0,0 +1,235 @@
+#include "bf_kernels.h"
+#include "time.h"
+
+// Until bf_calibrate() runs: the LVE takes a handful of cycles to issue an
+// instruction and then one per element, the scalar loops several per element.
+int bf_min_vl[BF_STAGES] = { 4, 16, 8 };
+
+const char *bf_stage_names[BF_STAGES] = { "fir", "copy", "power" };
+
+// x >> shift rounding down, as VMULH by 1 << (32 - shift) gives it; the LVE
+// versions skip the VMULH for a shift of 0
+static inline int32_t shift_down(const int32_t x, const int shift)
+{
+	return x >> shift;
+}
+
+void bf_fir_scalar(vbx_word_t *v_out, vbx_word_t *v_hist, vbx_word_t *v_taps, const int ntaps,
+                   const int n, const int shift)
+{
+	int r, k;
+	for (r = 0; r < n; r++) {
+		uint32_t acc = 0;
+		for (k = 0; k < ntaps; k++) {
+			acc += (uint32_t)(v_taps[k]*v_hist[r + k]);
+		}
+		v_out[r] = shift_down((int32_t)acc, shift);
+	}
+}
+
+void bf_fir_lve(vbx_word_t *v_out, vbx_word_t *v_hist, vbx_word_t *v_taps, const int ntaps,
+                const int n, const int shift, vbx_word_t *v_sums)
+{
+	// One 2D accumulate, a row per output with srca stepping a sample per row.
+	// The accumulator carries across rows, so the outputs are the differences
+	// of the running sums after a leading zero.
+	v_sums[0] = 0;
+	vbx_set_vl(ntaps, n);
+	vbx_set_2D(sizeof(vbx_word_t), sizeof(vbx_word_t), 0);
+	vbx_acc(VVW, VMUL, v_sums + 1, v_hist, v_taps);
+	vbx_set_vl(n);
+	vbx(VVW, VSUB, v_out, v_sums + 1, v_sums);
+	if (shift) {
+		vbx(SVW, VMULH, v_out, 1 << (32 - shift), v_out);
+	}
+}
+
+void bf_fir(vbx_word_t *v_out, vbx_word_t *v_hist, vbx_word_t *v_taps, const int ntaps,
+            const int n, const int shift, vbx_word_t *v_sums)
+{
+	if (n >= bf_min_vl[BF_STAGE_FIR]) {
+		bf_fir_lve(v_out, v_hist, v_taps, ntaps, n, shift, v_sums);
+	} else {
+		bf_fir_scalar(v_out, v_hist, v_taps, ntaps, n, shift);
+	}
+}
+
+void bf_copy_scalar(vbx_word_t *v_dst, vbx_word_t *v_src, const int n)
+{
+	int i;
+	for (i = 0; i < n; i++) {
+		v_dst[i] = v_src[i];
+	}
+}
+
+void bf_copy_lve(vbx_word_t *v_dst, vbx_word_t *v_src, const int n)
+{
+	vbx_set_vl(n);
+	vbx(VVW, VMOV, v_dst, v_src, 0);
+}
+
+void bf_copy(vbx_word_t *v_dst, vbx_word_t *v_src, const int n)
+{
+	if (n >= bf_min_vl[BF_STAGE_COPY]) {
+		bf_copy_lve(v_dst, v_src, n);
+	} else {
+		bf_copy_scalar(v_dst, v_src, n);
+	}
+}
+
+int32_t bf_power_scalar(vbx_word_t *v_a, vbx_word_t *v_b, const int n, const int shift)
+{
+	int i;
+	uint32_t power = 0;
+	for (i = 0; i < n; i++) {
+		int32_t s = shift_down(v_a[i] + v_b[i], shift);
+		power += (uint32_t)(s*s);
+	}
+	return (int32_t)power;
+}
+
+int32_t bf_power_lve(vbx_word_t *v_a, vbx_word_t *v_b, const int n, const int shift, vbx_word_t *v_tmp)
+{
+	vbx_set_vl(n);
+	vbx(VVW, VADD, v_tmp, v_a, v_b);
+	if (shift) {
+		vbx(SVW, VMULH, v_tmp, 1 << (32 - shift), v_tmp);
+	}
+	vbx_acc(VVW, VMUL, v_tmp + n, v_tmp, v_tmp);
+	return v_tmp[n];
+}
+
+int32_t bf_power(vbx_word_t *v_a, vbx_word_t *v_b, const int n, const int shift, vbx_word_t *v_tmp)
+{
+	if (n >= bf_min_vl[BF_STAGE_POWER]) {
+		return bf_power_lve(v_a, v_b, n, shift, v_tmp);
+	}
+	return bf_power_scalar(v_a, v_b, n, shift);
+}
+
+void bf_window_init(bf_window_t *w, const int *taps)
+{
+	int i;
+	for (i = 0; i < w->ntaps; i++) {
+		w->v_taps[i] = taps[i];
+	}
+	for (i = 0; i < w->ntaps - 1 + w->window; i++) {
+		w->v_mic_l[i] = w->v_mic_r[i] = 0;
+	}
+	for (i = 0; i < w->diff + w->window; i++) {
+		w->v_sound_l[i] = w->v_sound_r[i] = 0;
+	}
+}
+
+void bf_window_start(bf_window_t *w)
+{
+	// keep the last diff filtered samples in front of the new ones
+	bf_copy(w->v_sound_l, w->v_sound_l + w->window, w->diff);
+	bf_copy(w->v_sound_r, w->v_sound_r + w->window, w->diff);
+}
+
+int bf_window_finish(bf_window_t *w)
+{
+	const int n = w->window, diff = w->diff, keep = w->ntaps - 1;
+
+	// slide the history the next window's first outputs need to the front
+	bf_copy(w->v_mic_l, w->v_mic_l + n, keep);
+	bf_copy(w->v_mic_r, w->v_mic_r + n, keep);
+
+	w->power[BF_CENTRE] = bf_power(w->v_sound_l + diff, w->v_sound_r + diff, n, w->prescale, w->v_tmp);
+	w->power[BF_LEFT] = bf_power(w->v_sound_l, w->v_sound_r + diff, n, w->prescale, w->v_tmp);
+	w->power[BF_RIGHT] = bf_power(w->v_sound_l + diff, w->v_sound_r, n, w->prescale, w->v_tmp);
+
+	if (w->power[BF_CENTRE] > w->power[BF_LEFT]) {
+		return w->power[BF_CENTRE] > w->power[BF_RIGHT] ? BF_CENTRE : BF_RIGHT;
+	}
+	return w->power[BF_LEFT] > w->power[BF_RIGHT] ? BF_LEFT : BF_RIGHT;
+}
+
+int bf_window(bf_window_t *w)
+{
+	bf_window_start(w);
+	bf_fir(w->v_sound_l + w->diff, w->v_mic_l, w->v_taps, w->ntaps, w->window, w->fir_shift, w->v_tmp);
+	bf_fir(w->v_sound_r + w->diff, w->v_mic_r, w->v_taps, w->ntaps, w->window, w->fir_shift, w->v_tmp);
+	return bf_window_finish(w);
+}
+
+#define CAL_RUNS  4 // the fastest of these many runs counts
+#define CAL_SHIFT 8
+
+// cycles for one run of stage at vector length vl, scalar or on the LVE
+static unsigned time_stage(const int stage, const int lve, const int vl, const int ntaps,
+                           vbx_word_t *v_hist, vbx_word_t *v_taps, vbx_word_t *v_out, vbx_word_t *v_tmp)
+{
+	int run;
+	unsigned best = ~0u;
+	for (run = 0; run < CAL_RUNS; run++) {
+		unsigned start = get_time();
+		switch (stage) {
+		case BF_STAGE_FIR:
+			if (lve) {
+				bf_fir_lve(v_out, v_hist, v_taps, ntaps, vl, CAL_SHIFT, v_tmp);
+			} else {
+				bf_fir_scalar(v_out, v_hist, v_taps, ntaps, vl, CAL_SHIFT);
+			}
+			break;
+		case BF_STAGE_COPY:
+			if (lve) {
+				bf_copy_lve(v_out, v_hist, vl);
+			} else {
+				bf_copy_scalar(v_out, v_hist, vl);
+			}
+			break;
+		default:
+			if (lve) {
+				v_out[0] = bf_power_lve(v_hist, v_hist + ntaps - 1, vl, CAL_SHIFT, v_tmp);
+			} else {
+				v_out[0] = bf_power_scalar(v_hist, v_hist + ntaps - 1, vl, CAL_SHIFT);
+			}
+			break;
+		}
+		vbx_sync();
+		unsigned cycles = get_time() - start;
+		best = min(best, cycles);
+	}
+	return best;
+}
+
+int bf_calibrate(const int ntaps, const int max_vl, vbx_word_t *v_work, bf_calibration_t *cal)
+{
+	int i, p, stage, points = 0;
+	bf_calibration_t own;
+	if (!cal) {
+		cal = &own;
+	}
+
+	vbx_word_t *v_taps = v_work;
+	vbx_word_t *v_hist = v_taps + ntaps;
+	vbx_word_t *v_out = v_hist + ntaps - 1 + max_vl;
+	vbx_word_t *v_tmp = v_out + max_vl;
+
+	// any values will do, these stay well clear of overflow
+	for (i = 0; i < ntaps; i++) {
+		v_taps[i] = i + 1;
+	}
+	for (i = 0; i < ntaps - 1 + max_vl; i++) {
+		v_hist[i] = (i*97 & 0xFFF) - 0x800;
+	}
+
+	for (p = BF_CAL_MIN_VL; p <= max_vl && points < BF_CAL_POINTS; p *= 2) {
+		cal->vl[points++] = p;
+	}
+	for (stage = 0; stage < BF_STAGES; stage++) {
+		bf_min_vl[stage] = BF_VL_NEVER;
+		for (p = 0; p < points; p++) {
+			int vl = cal->vl[p];
+			cal->scalar_cycles[stage][p] = time_stage(stage, 0, vl, ntaps, v_hist, v_taps, v_out, v_tmp);
+			cal->lve_cycles[stage][p] = time_stage(stage, 1, vl, ntaps, v_hist, v_taps, v_out, v_tmp);
+		}
+		// the shortest length from which the LVE wins at every longer one
+		for (p = points - 1; p >= 0 && cal->lve_cycles[stage][p] < cal->scalar_cycles[stage][p]; p--) {
+			bf_min_vl[stage] = cal->vl[p];
+		}
+	}
+	return points;
+}
@@ -0,0 +1,113 @@
+#ifndef BF_KERNELS_H
+#define BF_KERNELS_H
+
+#include "vbx.h"
+
+// The stages beamforming.c and beamforming_scalar.c both run, each with a
+// plain C and an LVE version, and a dispatcher that picks between them by
+// vector length. bf_window() strings them into one window of the two
+// microphone beamformer, which both apps call. Every LVE instruction costs a few cycles to issue whatever
+// its length, so below some length the scalar loop wins; bf_min_vl holds that
+// length for each stage. The defaults are a guess, bf_calibrate() measures
+// them on the running system.
+//
+// Both versions give the same bits: sums wrap at 32 bits and right shifts
+// round down, the way VMULH by 1 << (32 - shift) does. The scalar versions
+// read and write the same scratchpad buffers, so a stage can switch sides
+// between calls.
+
+enum {
+	BF_STAGE_FIR,   // vector length is the outputs per call
+	BF_STAGE_COPY,
+	BF_STAGE_POWER,
+	BF_STAGES
+};
+
+#define BF_VL_NEVER 0x7FFFFFFF // a bf_min_vl that keeps a stage scalar
+
+// Shortest vector length each stage runs on the LVE.
+extern int bf_min_vl[BF_STAGES];
+
+extern const char *bf_stage_names[BF_STAGES];
+
+// out[r] = (taps[0]*hist[r] + ... + taps[ntaps-1]*hist[r+ntaps-1]) >> shift
+// for r in [0, n). hist holds ntaps-1 + n samples, shift is 2 to 31 and
+// v_sums is n+1 words of scratch for the LVE version.
+void bf_fir(vbx_word_t *v_out, vbx_word_t *v_hist, vbx_word_t *v_taps, const int ntaps,
+            const int n, const int shift, vbx_word_t *v_sums);
+void bf_fir_scalar(vbx_word_t *v_out, vbx_word_t *v_hist, vbx_word_t *v_taps, const int ntaps,
+                   const int n, const int shift);
+void bf_fir_lve(vbx_word_t *v_out, vbx_word_t *v_hist, vbx_word_t *v_taps, const int ntaps,
+                const int n, const int shift, vbx_word_t *v_sums);
+
+// n words from src to dst, which may overlap if dst comes first.
+void bf_copy(vbx_word_t *v_dst, vbx_word_t *v_src, const int n);
+void bf_copy_scalar(vbx_word_t *v_dst, vbx_word_t *v_src, const int n);
+void bf_copy_lve(vbx_word_t *v_dst, vbx_word_t *v_src, const int n);
+
+// Sum over i of ((a[i] + b[i]) >> shift)^2, shift 2 to 31. v_tmp is n+1
+// words of scratch for the LVE version.
+int32_t bf_power(vbx_word_t *v_a, vbx_word_t *v_b, const int n, const int shift, vbx_word_t *v_tmp);
+int32_t bf_power_scalar(vbx_word_t *v_a, vbx_word_t *v_b, const int n, const int shift);
+int32_t bf_power_lve(vbx_word_t *v_a, vbx_word_t *v_b, const int n, const int shift, vbx_word_t *v_tmp);
+
+enum {
+	BF_CENTRE,
+	BF_RIGHT,
+	BF_LEFT,
+	BF_DIRECTIONS
+};
+
+// One window of the two microphone beamformer. Every buffer can be in the
+// scratchpad, or all of them in main memory with the stages kept scalar.
+typedef struct {
+	vbx_word_t *v_taps;         // ntaps
+	vbx_word_t *v_mic_l;        // ntaps-1 samples of history, then the window
+	vbx_word_t *v_mic_r;
+	vbx_word_t *v_sound_l;      // diff filtered samples of the last window, then this one's
+	vbx_word_t *v_sound_r;
+	vbx_word_t *v_tmp;          // window+1 words of scratch
+	int ntaps;
+	int window;
+	int diff;                   // samples the sound reaches one microphone before the other
+	int fir_shift;
+	int prescale;               // shift before squaring for the powers
+	int32_t power[BF_DIRECTIONS];
+} bf_window_t;
+
+// Clears the histories and copies in the taps. The buffers, lengths and
+// shifts must be set.
+void bf_window_init(bf_window_t *w, const int *taps);
+
+// Filters the window of new samples at v_mic_l/r + ntaps-1, sets the power of
+// each direction and returns the loudest. The right microphone's samples lag
+// for sound from the left, so left pairs the older left samples with the
+// newer right ones.
+int bf_window(bf_window_t *w);
+
+// bf_window() in parts, for a caller that filters each sample as it arrives:
+// bf_window_start() keeps the last diff filtered samples in front of the
+// window, the caller filters sample i into v_sound_l/r + diff + i with
+// bf_fir(), then bf_window_finish() slides the microphone history along, sets
+// the powers and returns the loudest direction.
+void bf_window_start(bf_window_t *w);
+int bf_window_finish(bf_window_t *w);
+
+// Vector lengths bf_calibrate() times, doubling from the first.
+#define BF_CAL_MIN_VL 2
+#define BF_CAL_POINTS 8
+
+typedef struct {
+	int vl[BF_CAL_POINTS];
+	unsigned scalar_cycles[BF_STAGES][BF_CAL_POINTS];
+	unsigned lve_cycles[BF_STAGES][BF_CAL_POINTS];
+} bf_calibration_t;
+
+// Times both versions of every stage with get_time() at each calibration
+// length up to max_vl, FIR with ntaps taps, and sets bf_min_vl to the
+// shortest length from which the LVE stays faster. v_work holds
+// 3*max_vl + 2*ntaps words and is overwritten. cal, if not NULL, gets the
+// measurements. Returns the number of lengths timed.
+int bf_calibrate(const int ntaps, const int max_vl, vbx_word_t *v_work, bf_calibration_t *cal);
+
+#endif //BF_KERNELS_H
@@ -0,0 +1,68 @@
+#include "replay.h"
+#include "flash_dma.h"
+
+void replay_init(replay_t *rp, const int window, const int windows,
+                 const int16_t *left, const int16_t *right, const uint8_t *expected)
+{
+	rp->window = window;
+	rp->windows = windows;
+	rp->next = 0;
+	rp->config = 0;
+	rp->rate = 0;
+	rp->left = left;
+	rp->right = right;
+	rp->expected = expected;
+	rp->flash_address = -1;
+	rp->staging = 0;
+}
+
+static void flash_read(const int flash_address, void *dest, const int bytes)
+{
+	flash_dma_trans(flash_address, dest, bytes);
+	while (!flash_dma_done());
+}
+
+int replay_init_flash(replay_t *rp, const int flash_address, void *staging, const int max_window)
+{
+	int32_t *header = staging;
+	flash_read(flash_address, header, REPLAY_HEADER_WORDS*sizeof(int32_t));
+	if (header[0] != REPLAY_MAGIC || header[1] < 1 || header[1] > max_window || header[2] < 0) {
+		return 0;
+	}
+	replay_init(rp, header[1], header[2], 0, 0, 0);
+	rp->config = header[3];
+	rp->rate = header[4];
+	rp->flash_address = flash_address + REPLAY_HEADER_WORDS*sizeof(int32_t);
+	rp->staging = staging;
+	return 1;
+}
+
+int replay_next(replay_t *rp, vbx_word_t *v_left, vbx_word_t *v_right)
+{
+	int i, expected;
+	int window = rp->window;
+	if (rp->next >= rp->windows) {
+		return -1;
+	}
+
+	if (rp->flash_address < 0) {
+		const int16_t *left = rp->left + rp->next*window;
+		const int16_t *right = rp->right + rp->next*window;
+		for (i = 0; i < window; i++) {
+			v_left[i] = left[i];
+			v_right[i] = right[i];
+		}
+		expected = rp->expected[rp->next];
+	} else {
+		int record = (window + 1)*sizeof(int32_t);
+		flash_read(rp->flash_address + rp->next*record, rp->staging, record);
+		expected = *(int32_t*)rp->staging;
+		int16_t *samples = rp->staging + 2;
+		for (i = 0; i < window; i++) {
+			v_left[i] = samples[2*i];
+			v_right[i] = samples[2*i + 1];
+		}
+	}
+	rp->next++;
+	return expected;
+}
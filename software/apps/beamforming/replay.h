@@ -0,0 +1,49 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "vbx.h"
+
+// Feeds recorded two microphone audio to the beamformer a window at a time,
+// from arrays linked into the program or from a flash image, both written by
+// wav_to_samples.py together with the direction each window should come out
+// as. The same recording always replays the same way, there is no wrap
+// around and nothing depends on timing.
+//
+// A flash image is a header of REPLAY_HEADER_WORDS words (magic, window,
+// windows, config, rate) and then per window the expected direction as a
+// word followed by the window's samples as interleaved left/right halfwords.
+
+#define REPLAY_MAGIC        0x594C5052 // "RPLY"
+#define REPLAY_HEADER_WORDS 5
+
+typedef struct {
+	int window, windows;
+	int next;    // the window replay_next() returns next
+	int config;  // the image's REPLAY_CONFIG, fir shift, prescale and sample difference
+	int rate;
+	const int16_t *left, *right;
+	const uint8_t *expected;
+	int flash_address;  // of the first window record, or -1 with linked arrays
+	int16_t *staging;   // one window record read from flash
+} replay_t;
+
+// Replay windows windows of window samples from linked arrays.
+void replay_init(replay_t *rp, const int window, const int windows,
+                 const int16_t *left, const int16_t *right, const uint8_t *expected);
+
+// Replay the image at flash_address. staging must hold 4*(window + 1) bytes,
+// at most max_window samples. Returns 0 if there is no image or its windows
+// are too long.
+int replay_init_flash(replay_t *rp, const int flash_address, void *staging, const int max_window);
+
+// Copies the next window to v_left and v_right as words and returns the
+// direction it is expected to come out as, or -1 when the recording is over.
+int replay_next(replay_t *rp, vbx_word_t *v_left, vbx_word_t *v_right);
+
+// Start again from the first window.
+static inline void replay_rewind(replay_t *rp)
+{
+	rp->next = 0;
+}
+
+#endif //REPLAY_H
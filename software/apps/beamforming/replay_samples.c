@@ -0,0 +1,60 @@
+#include "replay_samples.h"
+
+const int16_t replay_l[REPLAY_SAMPLES] = {
+	5251, 3604, 1696, 2816, 5913, 6839, 7688, 8078, 2619, -595, -4912, -2918, -100, -536, 183, -3516,
+	-9840, -11423, -8307, -3402, -1508, -572, -999, -4167, -4253, -1568, 2808, 6270, 8296, 7213, 4926, 1731,
+	412, 4630, 6156, 7101, 3500, 1477, -3362, -7812, -6488, -2953, -1214, -1052, -5281, -7067, -8592, -7660,
+	-2558, 2529, 4457, 2770, 1032, -1673, 380, 5612, 8174, 9019, 8578, 5329, 1675, -653, 582, 2779,
+	4254, 1444, -3141, -7101, -10514, -9427, -4437, -912, -1568, -3937, -6975, -6667, -2996, 811, 4561, 7755,
+	5183, 3659, 3205, 2595, 4925, 7365, 9247, 8442, 1338, -531, -2457, -1596, -43, 1204, -1095, -4536,
+	-8653, -11331, -7321, -4510, -2052, 291, -810, -3184, -3880, -1266, 3191, 7408, 8977, 6641, 4236, 1393,
+	2101, 4701, 6881, 7565, 5391, -734, -3417, -6155, -7236, -5067, -3304, -1595, -5799, -9229, -8729, -7537,
+	-9229, -8729, -7537, -4112, 360, 3500, 1759, 84, 357, 1015, 4186, 8353, 8570, 8091, 4483, 215,
+	-1451, 1964, 2784, 2545, 1698, -1870, -8508, -10549, -9118, -4391, -3381, -1233, -3083, -5852, -7512, -3015,
+	893, 4492, 5844, 6432, 3302, 2075, 1825, 5440, 6733, 8499, 8474, 3947, -1962, -2343, -3323, 552,
+	1009, -1403, -5463, -9906, -8863, -9818, -3762, 234, 488, -1750, -1651, -1997, -769, 2847, 6704, 8644,
+	7174, 5570, 2160, 930, 2431, 6484, 6062, 4441, -523, -3327, -5475, -7432, -4515, -2364, -900, -4199,
+	-8540, -9964, -6547, -1808, 2678, 2950, 3901, 1326, -324, 2608, 3924, 9108, 8754, 7441, 5953, 290,
+	499, 1065, 3777, 3023, 902, -3447, -5968, -8791, -6694, -3885, -3456, -1694, -4805, -7369, -7955, -3343,
+	864, 5427, 6197, 6332, 4463, 1481, 2574, 4218, 6802, 8403, 8243, 3014, -106, -3545, -3423, 95,
+	-9656, -11154, -7276, -6100, -1932, 1741, -1002, -3907, -4416, -2157, 3553, 5879, 10335, 7692, 6458, 3589,
+	1229, 2878, 5917, 5475, 4898, -1381, -5910, -5226, -6600, -3328, -1998, -2922, -6358, -6817, -7694, -5661,
+	-3987, 527, 3772, 4194, 894, 287, 1637, 3997, 8556, 9421, 7671, 3464, 494, 1172, 609, 3210,
+	3849, 2704, -3149, -7650, -9621, -8607, -4006, -1181, -2439, -4115, -5854, -6437, -4154, -764, 3003, 5905,
+	4703, 3771, 560, 1087, 5453, 7429, 9980, 7050, 3909, -2419, -3414, -1869, -2034, 1625, -2132, -3891,
+	-6977, -9035, -8972, -5899, -1108, 1535, -1384, -1573, -4493, -150, 1416, 6519, 10312, 8969, 6269, 3384,
+	2586, 4186, 5021, 6472, 3415, 644, -3938, -7416, -7293, -2227, -923, -2214, -4923, -7003, -9243, -7383,
+	-3305, 655, 1991, 3193, 515, -65, -161, 4285, 7346, 8875, 7709, 5707, 845, -574, 1102, 1955,
+};
+
+const int16_t replay_r[REPLAY_SAMPLES] = {
+	5251, 3604, 1696, 2816, 5913, 6839, 7688, 8078, 2619, -595, -4912, -2918, -100, -536, 183, -3516,
+	-9840, -11423, -8307, -3402, -1508, -572, -999, -4167, -4253, -1568, 2808, 6270, 8296, 7213, 4926, 1731,
+	412, 4630, 6156, 7101, 3500, 1477, -3362, -7812, -6488, -2953, -1214, -1052, -5281, -7067, -8592, -7660,
+	-2558, 2529, 4457, 2770, 1032, -1673, 380, 5612, 8174, 9019, 8578, 5329, 1675, -653, 582, 2779,
+	4254, 1444, -3141, -7101, -10514, -9427, -4437, -912, -1568, -3937, -6975, -6667, -2996, 811, 4561, 7755,
+	5183, 3659, 3205, 2595, 4925, 7365, 9247, 8442, 1338, -531, -2457, -1596, -43, 1204, -1095, -4536,
+	-8653, -11331, -7321, -4510, -2052, 291, -810, -3184, -3880, -1266, 3191, 7408, 8977, 6641, 4236, 1393,
+	2101, 4701, 6881, 7565, 5391, -734, -3417, -6155, -7236, -5067, -3304, -1595, -5799, -9229, -8729, -7537,
+	-4112, 360, 3500, 1759, 84, 357, 1015, 4186, 8353, 8570, 8091, 4483, 215, -1451, 1964, 2784,
+	2545, 1698, -1870, -8508, -10549, -9118, -4391, -3381, -1233, -3083, -5852, -7512, -3015, 893, 4492, 5844,
+	6432, 3302, 2075, 1825, 5440, 6733, 8499, 8474, 3947, -1962, -2343, -3323, 552, 1009, -1403, -5463,
+	-9906, -8863, -9818, -3762, 234, 488, -1750, -1651, -1997, -769, 2847, 6704, 8644, 7174, 5570, 2160,
+	930, 2431, 6484, 6062, 4441, -523, -3327, -5475, -7432, -4515, -2364, -900, -4199, -8540, -9964, -6547,
+	-1808, 2678, 2950, 3901, 1326, -324, 2608, 3924, 9108, 8754, 7441, 5953, 290, 499, 1065, 3777,
+	3023, 902, -3447, -5968, -8791, -6694, -3885, -3456, -1694, -4805, -7369, -7955, -3343, 864, 5427, 6197,
+	6332, 4463, 1481, 2574, 4218, 6802, 8403, 8243, 3014, -106, -3545, -3423, 95, 1260, -2614, -4209,
+	1260, -2614, -4209, -9656, -11154, -7276, -6100, -1932, 1741, -1002, -3907, -4416, -2157, 3553, 5879, 10335,
+	7692, 6458, 3589, 1229, 2878, 5917, 5475, 4898, -1381, -5910, -5226, -6600, -3328, -1998, -2922, -6358,
+	-6817, -7694, -5661, -3987, 527, 3772, 4194, 894, 287, 1637, 3997, 8556, 9421, 7671, 3464, 494,
+	1172, 609, 3210, 3849, 2704, -3149, -7650, -9621, -8607, -4006, -1181, -2439, -4115, -5854, -6437, -4154,
+	-764, 3003, 5905, 4703, 3771, 560, 1087, 5453, 7429, 9980, 7050, 3909, -2419, -3414, -1869, -2034,
+	1625, -2132, -3891, -6977, -9035, -8972, -5899, -1108, 1535, -1384, -1573, -4493, -150, 1416, 6519, 10312,
+	8969, 6269, 3384, 2586, 4186, 5021, 6472, 3415, 644, -3938, -7416, -7293, -2227, -923, -2214, -4923,
+	-7003, -9243, -7383, -3305, 655, 1991, 3193, 515, -65, -161, 4285, 7346, 8875, 7709, 5707, 845,
+};
+
+const uint8_t replay_expected[REPLAY_WINDOWS] = {
+	0, 0, 1, 1, 2, 2,
+};
+
@@ -0,0 +1,22 @@
+#ifndef REPLAY_SAMPLES_H
+#define REPLAY_SAMPLES_H
+
+#include <stdint.h>
+
+// written by wav_to_samples.py from synth.wav
+#define REPLAY_RATE              8000
+#define REPLAY_WINDOW            64
+#define REPLAY_WINDOWS           6
+#define REPLAY_SAMPLES           (REPLAY_WINDOWS*REPLAY_WINDOW)
+#define REPLAY_SAMPLE_DIFFERENCE 3
+#define REPLAY_FIR_SHIFT         16
+#define REPLAY_PRESCALE          4
+#define REPLAY_NUM_TAPS          16
+#define REPLAY_CONFIG            0x041003 // as in a flash image header
+#define REPLAY_IN_FLASH          0
+
+extern const int16_t replay_l[REPLAY_SAMPLES];
+extern const int16_t replay_r[REPLAY_SAMPLES];
+extern const uint8_t replay_expected[REPLAY_WINDOWS];
+
+#endif
@@ -0,0 +1,86 @@
+import argparse
+import math
+
+# Designs the prototype low-pass for vbx_resample and writes it out as
+# resample_taps.c / resample_taps.h, next to the samples sample_generator.py
+# writes. The filter runs at UP times the input rate and keeps everything
+# below the lower of the two Nyquist rates, with a gain of UP to make up for
+# the zeros interpolation stuffs in.
+#
+#   python resample_generator.py --up 1 --down 2 --taps 16
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--up', type=int, default=1)
+parser.add_argument('--down', type=int, default=2)
+parser.add_argument('--taps', type=int, default=16, help='taps per phase')
+parser.add_argument('--shift', type=int, default=16, help='fraction bits of the taps')
+parser.add_argument('--beta', type=float, default=6.0, help='kaiser window shape')
+parser.add_argument('--cutoff', type=float, default=0.9, help='fraction of the output Nyquist rate to pass')
+args = parser.parse_args()
+
+def gcd(a, b):
+  while b:
+    a, b = b, a % b
+  return a
+
+if gcd(args.up, args.down) != 1:
+  raise SystemExit('up and down must not have a common factor')
+
+UP = args.up
+DOWN = args.down
+TAPS = args.taps
+LENGTH = UP*TAPS
+# cycles per sample at the filter rate
+CUTOFF = args.cutoff*0.5/max(UP, DOWN)
+
+def bessel_i0(x):
+  total = 1.0
+  term = 1.0
+  k = 1
+  while term > 1e-12*total:
+    term *= (x/(2*k))**2
+    total += term
+    k += 1
+  return total
+
+def kaiser(i):
+  r = 2.0*i/(LENGTH - 1) - 1.0 if LENGTH > 1 else 0.0
+  return bessel_i0(args.beta*math.sqrt(max(0.0, 1.0 - r*r)))/bessel_i0(args.beta)
+
+def sinc(x):
+  return 1.0 if x == 0 else math.sin(math.pi*x)/(math.pi*x)
+
+center = (LENGTH - 1)/2.0
+taps = [2*CUTOFF*sinc(2*CUTOFF*(i - center))*kaiser(i) for i in range(LENGTH)]
+
+# the taps sum to UP, so on average every phase passes DC at the input level
+scale = UP/sum(taps)
+fir = [int(round(t*scale*(1 << args.shift))) for t in taps]
+
+def response(f):
+  re = sum(fir[i]*math.cos(2*math.pi*f*i) for i in range(LENGTH))
+  im = sum(fir[i]*math.sin(2*math.pi*f*i) for i in range(LENGTH))
+  return math.sqrt(re*re + im*im)/(UP << args.shift)
+
+for f in [0.0, CUTOFF/2, CUTOFF, 0.5/max(UP, DOWN), 0.75/max(UP, DOWN)]:
+  gain = response(f)
+  print('{:.3f} of the filter rate: {:.1f} dB'.format(f, 20*math.log10(max(gain, 1e-9))))
+
+# Format taps for C files.
+f = open('resample_taps.h', 'w')
+f.write('#ifndef RESAMPLE_TAPS_H\n#define RESAMPLE_TAPS_H\n\n')
+f.write('#include <stdint.h>\n\n')
+f.write('#define RESAMPLE_UP    {:d}\n'.format(UP))
+f.write('#define RESAMPLE_DOWN  {:d}\n'.format(DOWN))
+f.write('#define RESAMPLE_TAPS  {:d} // per phase\n'.format(TAPS))
+f.write('#define RESAMPLE_SHIFT {:d}\n\n'.format(args.shift))
+f.write('extern const int32_t resample_taps[RESAMPLE_UP*RESAMPLE_TAPS];\n\n')
+f.write('#endif\n')
+f.close()
+
+f = open('resample_taps.c', 'w')
+f.write('#include "resample_taps.h"\n\n')
+f.write('const int32_t resample_taps[RESAMPLE_UP*RESAMPLE_TAPS] = {\n\t')
+f.write(',\n\t'.join('{:d}'.format(t) for t in fir))
+f.write('\n};\n')
+f.close()
@@ -0,0 +1,20 @@
+#include "resample_taps.h"
+
+const int32_t resample_taps[RESAMPLE_UP*RESAMPLE_TAPS] = {
+	-38,
+	54,
+	680,
+	123,
+	-3090,
+	-2336,
+	10615,
+	26761,
+	26761,
+	10615,
+	-2336,
+	-3090,
+	123,
+	680,
+	54,
+	-38
+};
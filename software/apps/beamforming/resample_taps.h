@@ -0,0 +1,13 @@
+#ifndef RESAMPLE_TAPS_H
+#define RESAMPLE_TAPS_H
+
+#include <stdint.h>
+
+#define RESAMPLE_UP    1
+#define RESAMPLE_DOWN  2
+#define RESAMPLE_TAPS  16 // per phase
+#define RESAMPLE_SHIFT 16
+
+extern const int32_t resample_taps[RESAMPLE_UP*RESAMPLE_TAPS];
+
+#endif
@@ -0,0 +1,198 @@
+import argparse
+import math
+import os
+import random
+import re
+import struct
+import wave
+
+# Turns a stereo WAV recording into replay data for the beamformer bench
+# (systems/ice40ultraplus/software/beamform_replay.c), either linkable arrays
+# in replay_samples.c / replay_samples.h or a flash image for replay.c to read.
+# Alongside the samples it writes the direction the window beamformer should
+# pick for every window, from a model of bf_kernels that wraps and rounds the
+# same way, so the bench can check its decisions bit for bit.
+#
+#   python wav_to_samples.py recording.wav
+#   python wav_to_samples.py recording.wav --flash replay.bin
+#   python wav_to_samples.py --synth synth.wav   # write a test recording first
+#
+# DMEM only has room for a few windows of linked samples, longer recordings
+# have to go to flash. The left channel is the left microphone. Decisions are
+# numbered as in beamforming.c: 0 centre, 1 right, 2 left.
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+parser = argparse.ArgumentParser()
+parser.add_argument('wav', nargs='?', help='16 bit PCM, mono is used for both microphones')
+parser.add_argument('--synth', metavar='WAV', help='write a source moving centre, left, right to WAV and convert it')
+parser.add_argument('--synth-windows', type=int, default=2, help='windows the --synth source stays at each direction')
+parser.add_argument('--out', default='replay_samples', help='base name of the .c/.h to write')
+parser.add_argument('--flash', metavar='BIN', help='write a flash image instead of C arrays')
+parser.add_argument('--window', type=int, default=64)
+parser.add_argument('--diff', type=int, default=3, help='samples between the microphones end on')
+parser.add_argument('--fir', default=os.path.join(HERE, '../../../systems/ice40ultraplus/software/fir.c'),
+                    help='C file holding the FIR taps')
+parser.add_argument('--fir-shift', type=int, default=16, help='FIR_PRECISION')
+parser.add_argument('--prescale', type=int, default=4)
+parser.add_argument('--max-windows', type=int, default=0, help='stop after this many windows (0 for all)')
+args = parser.parse_args()
+
+if not args.wav and not args.synth:
+  parser.error('give a WAV file or --synth')
+
+REPLAY_MAGIC = 0x594C5052 # "RPLY" read as a little endian word
+WINDOW = args.window
+DIFF = args.diff
+
+def read_taps(path):
+  text = open(path).read()
+  body = text[text.index('{') + 1:text.index('}')]
+  return [int(t) for t in re.findall(r'-?\d+', body)]
+
+TAPS = read_taps(args.fir)
+
+# A noisy 300 Hz + 1100 Hz source held at each direction for a few windows,
+# the far microphone hearing it DIFF samples late.
+def synth(path, windows_each, rate=8000):
+  rnd = random.Random(1)
+  total = 3*windows_each*WINDOW + DIFF
+  source = [math.sin(2*math.pi*300*i/rate)*6000 + math.sin(2*math.pi*1100*i/rate)*4000 +
+            rnd.uniform(-1500, 1500) for i in range(total)]
+  frames = []
+  truth = []
+  for w in range(3*windows_each):
+    direction = w//windows_each
+    truth.append(direction)
+    late_l = DIFF if direction == 1 else 0
+    late_r = DIFF if direction == 2 else 0
+    for i in range(WINDOW):
+      t = DIFF + w*WINDOW + i
+      frames.append(struct.pack('<hh', int(source[t - late_l]), int(source[t - late_r])))
+  f = wave.open(path, 'wb')
+  f.setnchannels(2)
+  f.setsampwidth(2)
+  f.setframerate(rate)
+  f.writeframes(b''.join(frames))
+  f.close()
+  return truth
+
+def read_wav(path):
+  f = wave.open(path, 'rb')
+  if f.getsampwidth() != 2:
+    raise SystemExit('{}: only 16 bit PCM is supported'.format(path))
+  channels = f.getnchannels()
+  rate = f.getframerate()
+  data = f.readframes(f.getnframes())
+  f.close()
+  count = len(data)//(2*channels)
+  samples = struct.unpack('<{}h'.format(count*channels), data[:count*2*channels])
+  left = list(samples[0::channels])
+  right = list(samples[1::channels]) if channels > 1 else left
+  return rate, left, right
+
+def wrap(x):
+  x &= 0xFFFFFFFF
+  return x - (1 << 32) if x & 0x80000000 else x
+
+# bf_fir over the taps-1 sample history plus the new window
+def fir(hist):
+  return [wrap(sum(t*h for t, h in zip(TAPS, hist[r:r + len(TAPS)]))) >> args.fir_shift
+          for r in range(WINDOW)]
+
+def power(a, b):
+  total = 0
+  for x, y in zip(a, b):
+    s = wrap(x + y) >> args.prescale
+    total = wrap(total + wrap(s*s))
+  return total
+
+def decide(centre, left, right):
+  if centre > left:
+    return 0 if centre > right else 1
+  return 2 if left > right else 1
+
+truth = synth(args.synth, args.synth_windows) if args.synth else None
+rate, left, right = read_wav(args.synth or args.wav)
+windows = len(left)//WINDOW
+if args.max_windows:
+  windows = min(windows, args.max_windows)
+if windows == 0:
+  raise SystemExit('not even one window of samples')
+
+# the two microphone window of beamforming.c, as bf_window() in bf_kernels.c
+hist_l = [0]*(len(TAPS) - 1)
+hist_r = [0]*(len(TAPS) - 1)
+snd_l = [0]*(WINDOW + DIFF)
+snd_r = [0]*(WINDOW + DIFF)
+expected = []
+for w in range(windows):
+  new_l = left[w*WINDOW:(w + 1)*WINDOW]
+  new_r = right[w*WINDOW:(w + 1)*WINDOW]
+  snd_l = snd_l[WINDOW:] + fir(hist_l + new_l)
+  snd_r = snd_r[WINDOW:] + fir(hist_r + new_r)
+  hist_l = (hist_l + new_l)[WINDOW:]
+  hist_r = (hist_r + new_r)[WINDOW:]
+  expected.append(decide(power(snd_l[DIFF:], snd_r[DIFF:]),
+                         power(snd_l[:WINDOW], snd_r[DIFF:]),
+                         power(snd_l[DIFF:], snd_r[:WINDOW])))
+
+print('{} Hz, {} windows of {}: {} centre, {} right, {} left'.format(
+  rate, windows, WINDOW, expected.count(0), expected.count(1), expected.count(2)))
+if truth:
+  right_calls = sum(1 for e, t in zip(expected, truth) if e == t)
+  print('reference picks the true direction in {} of {} windows'.format(right_calls, windows))
+
+samples = windows*WINDOW
+config = DIFF | (args.fir_shift << 8) | (args.prescale << 16)
+
+if args.flash:
+  # header, then per window the expected decision as a word and the
+  # samples as interleaved left/right halfwords
+  f = open(args.flash, 'wb')
+  f.write(struct.pack('<5i', REPLAY_MAGIC, WINDOW, windows, config, rate))
+  for w in range(windows):
+    f.write(struct.pack('<i', expected[w]))
+    for i in range(w*WINDOW, (w + 1)*WINDOW):
+      f.write(struct.pack('<hh', left[i], right[i]))
+  f.close()
+
+def write_array(f, ctype, name, size, values):
+  f.write('const {} {}[{}] = {{\n'.format(ctype, name, size))
+  for i in range(0, len(values), 16):
+    f.write('\t' + ', '.join('{:d}'.format(v) for v in values[i:i + 16]) + ',\n')
+  f.write('};\n\n')
+
+# The header is written for flash images too, the bench needs its settings.
+f = open(args.out + '.h', 'w')
+f.write('#ifndef REPLAY_SAMPLES_H\n#define REPLAY_SAMPLES_H\n\n')
+f.write('#include <stdint.h>\n\n')
+f.write('// written by wav_to_samples.py from {}\n'.format(os.path.basename(args.synth or args.wav)))
+f.write('#define REPLAY_RATE              {:d}\n'.format(rate))
+f.write('#define REPLAY_WINDOW            {:d}\n'.format(WINDOW))
+f.write('#define REPLAY_WINDOWS           {:d}\n'.format(windows))
+f.write('#define REPLAY_SAMPLES           (REPLAY_WINDOWS*REPLAY_WINDOW)\n')
+f.write('#define REPLAY_SAMPLE_DIFFERENCE {:d}\n'.format(DIFF))
+f.write('#define REPLAY_FIR_SHIFT         {:d}\n'.format(args.fir_shift))
+f.write('#define REPLAY_PRESCALE          {:d}\n'.format(args.prescale))
+f.write('#define REPLAY_NUM_TAPS          {:d}\n'.format(len(TAPS)))
+f.write('#define REPLAY_CONFIG            0x{:06x} // as in a flash image header\n'.format(config))
+f.write('#define REPLAY_IN_FLASH          {:d}\n\n'.format(1 if args.flash else 0))
+if not args.flash:
+  f.write('extern const int16_t replay_l[REPLAY_SAMPLES];\n')
+  f.write('extern const int16_t replay_r[REPLAY_SAMPLES];\n')
+  f.write('extern const uint8_t replay_expected[REPLAY_WINDOWS];\n\n')
+f.write('#endif\n')
+f.close()
+
+f = open(args.out + '.c', 'w')
+f.write('#include "{}.h"\n\n'.format(os.path.basename(args.out)))
+if args.flash:
+  f.write('// the samples are in {}\n'.format(os.path.basename(args.flash)))
+else:
+  if 4*samples + windows > 2048:
+    print('warning: {} bytes of samples will not fit in DMEM next to the bench, try --flash'.format(4*samples + windows))
+  write_array(f, 'int16_t', 'replay_l', 'REPLAY_SAMPLES', left[:samples])
+  write_array(f, 'int16_t', 'replay_r', 'REPLAY_SAMPLES', right[:samples])
+  write_array(f, 'uint8_t', 'replay_expected', 'REPLAY_WINDOWS', expected)
+f.close()
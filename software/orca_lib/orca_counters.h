@@ -0,0 +1,145 @@
+#ifndef __ORCA_COUNTERS_H
+#define __ORCA_COUNTERS_H
+
+#include <stdint.h>
+#include "orca_csrs.h"
+
+//Performance counters, present when ORCA is built with
+//PERFORMANCE_COUNTERS > 0.  Counter 0 is mcycle, 2 is minstret and 3 up to
+//PERFORMANCE_COUNTERS are the mhpmcounters, which count the event selected
+//with orca_counter_event().  Counters that are not there read as 0.
+
+//Events for orca_counter_event(); each counts the cycles it is true.
+#define HPM_EVENT_NONE          0
+#define HPM_EVENT_CYCLES        1
+#define HPM_EVENT_INSTRET       2
+#define HPM_EVENT_EXECUTE_EMPTY 3  //Nothing to execute
+#define HPM_EVENT_IFETCH_WAIT   4  //Instruction fetch waitrequest
+#define HPM_EVENT_EXECUTE_STALL 5  //Instruction held in execute
+#define HPM_EVENT_BRANCH        6  //Branches and jumps
+#define HPM_EVENT_MISPREDICT    7  //Branch PC corrections
+#define HPM_EVENT_LOAD_STORE    8
+#define HPM_EVENT_LSU_STALL     9  //Waiting on the data bus or a load
+#define HPM_EVENT_ICACHE_MISS   10 //ICache line fills
+#define HPM_EVENT_DCACHE_MISS   11 //DCache line fills
+#define HPM_EVENT_VCP_ISSUE     12 //Instructions sent to the LVE
+#define HPM_EVENT_VCP_STALL     13 //LVE busy
+#define HPM_EVENT_SLEEP         14 //Held in sleepuntil()
+#define HPM_EVENT_BRANCH_MISPREDICT 15 //Conditional branch PC corrections
+#define HPM_EVENT_RETURN            16 //Function returns
+#define HPM_EVENT_RETURN_MISPREDICT 17 //Return PC corrections
+
+#define ORCA_COUNTERS 11
+
+//The upper half is read before and after the lower so a carry between the
+//reads is not missed.
+#define ORCA_COUNTER_READ(lo_csr, hi_csr, result) do {                  \
+    uint32_t _hi, _lo, _hi2;                                            \
+    do {                                                                \
+      asm volatile("csrr %0, " CSR_STRING(hi_csr) : "=r"(_hi));         \
+      asm volatile("csrr %0, " CSR_STRING(lo_csr) : "=r"(_lo));         \
+      asm volatile("csrr %0, " CSR_STRING(hi_csr) : "=r"(_hi2));        \
+    } while(_hi != _hi2);                                               \
+    result = ((uint64_t)_hi << 32) | _lo;                               \
+  } while(0)
+
+//The lower half is zeroed first so it cannot carry into the new upper half.
+#define ORCA_COUNTER_WRITE(lo_csr, hi_csr, value) do {                  \
+    asm volatile("csrw " CSR_STRING(lo_csr) ", zero");                  \
+    asm volatile("csrw " CSR_STRING(hi_csr) ", %0" : : "r"((uint32_t)((value) >> 32))); \
+    asm volatile("csrw " CSR_STRING(lo_csr) ", %0" : : "r"((uint32_t)(value))); \
+  } while(0)
+
+//Read counter n; inlines to a single case when n is a constant.
+static inline uint64_t orca_counter_read(int n){
+  uint64_t value = 0;
+  switch(n){
+  case 0:  ORCA_COUNTER_READ(0xB00, 0xB80, value); break;
+  case 2:  ORCA_COUNTER_READ(0xB02, 0xB82, value); break;
+  case 3:  ORCA_COUNTER_READ(0xB03, 0xB83, value); break;
+  case 4:  ORCA_COUNTER_READ(0xB04, 0xB84, value); break;
+  case 5:  ORCA_COUNTER_READ(0xB05, 0xB85, value); break;
+  case 6:  ORCA_COUNTER_READ(0xB06, 0xB86, value); break;
+  case 7:  ORCA_COUNTER_READ(0xB07, 0xB87, value); break;
+  case 8:  ORCA_COUNTER_READ(0xB08, 0xB88, value); break;
+  case 9:  ORCA_COUNTER_READ(0xB09, 0xB89, value); break;
+  case 10: ORCA_COUNTER_READ(0xB0A, 0xB8A, value); break;
+  }
+  return value;
+}
+
+//Set counter n.
+static inline void orca_counter_write(int n, uint64_t value){
+  switch(n){
+  case 0:  ORCA_COUNTER_WRITE(0xB00, 0xB80, value); break;
+  case 2:  ORCA_COUNTER_WRITE(0xB02, 0xB82, value); break;
+  case 3:  ORCA_COUNTER_WRITE(0xB03, 0xB83, value); break;
+  case 4:  ORCA_COUNTER_WRITE(0xB04, 0xB84, value); break;
+  case 5:  ORCA_COUNTER_WRITE(0xB05, 0xB85, value); break;
+  case 6:  ORCA_COUNTER_WRITE(0xB06, 0xB86, value); break;
+  case 7:  ORCA_COUNTER_WRITE(0xB07, 0xB87, value); break;
+  case 8:  ORCA_COUNTER_WRITE(0xB08, 0xB88, value); break;
+  case 9:  ORCA_COUNTER_WRITE(0xB09, 0xB89, value); break;
+  case 10: ORCA_COUNTER_WRITE(0xB0A, 0xB8A, value); break;
+  }
+}
+
+//Get the MHPMEVENT of counter n (3 and up), 0 for the others.
+static inline uint32_t orca_counter_get_event(int n){
+  uint32_t mhpmevent = 0;
+  switch(n){
+  case 3:  asm volatile("csrr %0, 0x323" : "=r"(mhpmevent)); break;
+  case 4:  asm volatile("csrr %0, 0x324" : "=r"(mhpmevent)); break;
+  case 5:  asm volatile("csrr %0, 0x325" : "=r"(mhpmevent)); break;
+  case 6:  asm volatile("csrr %0, 0x326" : "=r"(mhpmevent)); break;
+  case 7:  asm volatile("csrr %0, 0x327" : "=r"(mhpmevent)); break;
+  case 8:  asm volatile("csrr %0, 0x328" : "=r"(mhpmevent)); break;
+  case 9:  asm volatile("csrr %0, 0x329" : "=r"(mhpmevent)); break;
+  case 10: asm volatile("csrr %0, 0x32A" : "=r"(mhpmevent)); break;
+  }
+  return mhpmevent;
+}
+
+//Set the MHPMEVENT of counter n (3 and up): an HPM_EVENT_ value, or'd with
+//MHPMEVENT_OFIE to interrupt when the counter wraps to 0.  Clears
+//MHPMEVENT_OF.
+static inline void orca_counter_event(int n, uint32_t mhpmevent){
+  switch(n){
+  case 3:  asm volatile("csrw 0x323, %0" : : "r"(mhpmevent)); break;
+  case 4:  asm volatile("csrw 0x324, %0" : : "r"(mhpmevent)); break;
+  case 5:  asm volatile("csrw 0x325, %0" : : "r"(mhpmevent)); break;
+  case 6:  asm volatile("csrw 0x326, %0" : : "r"(mhpmevent)); break;
+  case 7:  asm volatile("csrw 0x327, %0" : : "r"(mhpmevent)); break;
+  case 8:  asm volatile("csrw 0x328, %0" : : "r"(mhpmevent)); break;
+  case 9:  asm volatile("csrw 0x329, %0" : : "r"(mhpmevent)); break;
+  case 10: asm volatile("csrw 0x32A, %0" : : "r"(mhpmevent)); break;
+  }
+}
+
+//Stop (bit set) or run (bit clear) the counters in counter_mask, bit n for
+//counter n.
+static inline void orca_counters_inhibit(uint32_t counter_mask){
+  asm volatile("csrw " CSR_STRING(CSR_MCOUNTINHIBIT) ", %0" : : "r"(counter_mask));
+}
+
+//Bit n set for each counter with MHPMEVENT_OF set.
+static inline uint32_t orca_counters_overflowed(){
+  uint32_t overflowed = 0;
+  int n;
+  for(n = 3; n < ORCA_COUNTERS; n++){
+    if(orca_counter_get_event(n) & MHPMEVENT_OF){
+      overflowed |= 1 << n;
+    }
+  }
+  return overflowed;
+}
+
+//Count event on counter n and interrupt every period events, for sampling
+//with orca_register_counter_overflow_handler().  Call again from the
+//handler to clear the overflow and start the next period.
+static inline void orca_counter_sample(int n, uint32_t event, uint32_t period){
+  orca_counter_write(n, -(uint64_t)period);
+  orca_counter_event(n, event | MHPMEVENT_OFIE);
+}
+
+#endif //#ifndef __ORCA_COUNTERS_H
@@ -28,11 +28,26 @@
 #define CSR_MUMR2_LAST 0xBEA
 #define CSR_MUMR3_LAST 0xBEB
 
+//Performance counters.  Counter n (0 is mcycle, 2 minstret and 3 up the
+//mhpmcounters) is at CSR_MCOUNTER_BASE+n, its upper half at
+//CSR_MCOUNTERH_BASE+n and its event selector at CSR_MHPMEVENT_BASE+n.
+#define CSR_MCOUNTER_BASE  0xB00
+#define CSR_MCOUNTERH_BASE 0xB80
+#define CSR_MHPMEVENT_BASE 0x320
+#ifndef CSR_MCOUNTINHIBIT
+#define CSR_MCOUNTINHIBIT  0x320
+#endif
+
 
 //MCACHE bits implemented in ORCA
 #define MCACHE_IEXISTS 0x00000001
 #define MCACHE_DEXISTS 0x00000002
 
+//MHPMEVENT bits implemented in ORCA
+#define MHPMEVENT_SELECT 0x0000001F
+#define MHPMEVENT_OF     0x40000000
+#define MHPMEVENT_OFIE   0x80000000
+
 #ifndef stringify
 #define _stringify(a) #a
 #define stringify(a) _stringify(a)
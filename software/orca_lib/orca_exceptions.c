@@ -3,6 +3,7 @@
 #include "bsp.h"
 #include "orca_exceptions.h"
 #include "orca_interrupts.h"
+#include "orca_counters.h"
 #include "orca_printf.h"
 
 #if ORCA_ENABLE_EXCEPTIONS
@@ -12,6 +13,8 @@ static orca_exception_handler timer_handler = NULL;
 static void* timer_context=NULL;
 static orca_exception_handler ecall_handler = NULL;
 static void* ecall_context=NULL;
+static orca_counter_overflow_handler counter_overflow_handler = NULL;
+static void* counter_overflow_context=NULL;
 
 #if ORCA_INTERRUPT_HANDLERS
 
@@ -43,6 +46,17 @@ orca_exception_handler orca_register_ecall_handler(orca_exception_handler the_ha
 	return old;
 }
 
+orca_counter_overflow_handler orca_register_counter_overflow_handler(orca_counter_overflow_handler the_handler,void** the_context){
+	orca_counter_overflow_handler old=counter_overflow_handler;
+	void* old_context=counter_overflow_context;
+	counter_overflow_handler = the_handler;
+	if(the_context){
+		counter_overflow_context = *the_context;
+		*the_context = old_context;
+	}
+	return old;
+}
+
 //Register an illegal instruction
 int register_orca_illegal_instruction_handler(orca_illegal_instruction_handler the_handler, void *the_context){
 	int return_code = 0;
@@ -150,6 +164,11 @@ int handle_exception(size_t cause, size_t epc, size_t regs[32]){
 			timer_handler(timer_context);
 			break;
 		}else{ while(1); }
+	case 0x8000000D://performance counter overflow
+		if(counter_overflow_handler){
+			counter_overflow_handler(orca_counters_overflowed(),epc,counter_overflow_context);
+			break;
+		}else{ while(1); }
 	case CAUSE_MISALIGNED_STORE:
 		handle_misaligned_store(*((size_t*)epc), regs);
 		epc+=4;
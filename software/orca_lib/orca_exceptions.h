@@ -22,6 +22,7 @@
 typedef void (*orca_exception_handler)(void *);
 typedef void (*orca_interrupt_handler)(int, void *);
 typedef int (*orca_illegal_instruction_handler)(size_t, size_t, size_t[], void *);
+typedef void (*orca_counter_overflow_handler)(uint32_t, size_t, void *);
 /**
  * @brief Register a timer interrupt handler.
  * @param handler The function to be called when timer interrupt goes off
@@ -42,6 +43,16 @@ orca_exception_handler orca_register_timer_handler(orca_exception_handler handle
  */
 orca_exception_handler orca_register_ecall_handler(orca_exception_handler the_handler,void** the_context);
 
+/**
+ * @brief Register a performance counter overflow handler, for sampling profilers.
+ * @param handler Called with the orca_counters_overflowed() mask, the interrupted pc
+ *        and context when a counter with MHPMEVENT_OFIE set wraps to 0.  It must clear
+ *        MHPMEVENT_OF on those counters, e.g. with orca_counter_sample().
+ * @param context as for orca_register_timer_handler()
+ * @return The old handler
+ */
+orca_counter_overflow_handler orca_register_counter_overflow_handler(orca_counter_overflow_handler the_handler,void** the_context);
+
 //Register an illegal instruction handler.
 int orca_register_illegal_instruction_handler(orca_illegal_instruction_handler the_handler, void *the_context);
 
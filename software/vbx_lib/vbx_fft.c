@@ -0,0 +1,208 @@
+#include "vbx_fft.h"
+
+#define Q30_ONE     (1 << 30)
+#define Q30_HALF_PI 1686629713 // pi/2 in Q30
+
+// sin(pi/2 * t/quarter) in Q31 for t in [0, quarter], Taylor series to x^13
+static int32_t quarter_sin_q31(const int t, const int quarter)
+{
+	int k;
+	int64_t x = (int64_t)Q30_HALF_PI*t/quarter;
+	int64_t x2 = (x*x) >> 30;
+	int64_t sum = Q30_ONE;
+	for (k = 12; k >= 2; k -= 2) {
+		sum = Q30_ONE - ((x2*sum) >> 30)/(k*(k+1));
+	}
+	int64_t sine = ((x*sum) >> 30) << 1;
+	return sine > 0x7FFFFFFF ? 0x7FFFFFFF : (int32_t)sine;
+}
+
+int vbx_fft_init(vbx_fft_t *fft, const int n, vbx_word_t *v_work)
+{
+	int h, j;
+	if (n < VBX_FFT_MIN_N || n > VBX_FFT_MAX_N || (n & (n-1))) {
+		return 0;
+	}
+	fft->n = n;
+	for (fft->log2n = 0; (1 << fft->log2n) < n; fft->log2n++);
+	fft->v_cos = v_work;
+	fft->v_sin = v_work + n;
+	fft->v_tmp = v_work + 2*n;
+
+	// the widest stage has W^j for j < n/2, the narrower ones every
+	// (n/2h)th of those
+	vbx_word_t *c = fft->v_cos + n/2 - 1, *s = fft->v_sin + n/2 - 1;
+	int quarter = n/4;
+	for (j = 0; j < n/2; j++) {
+		if (j <= quarter) {
+			c[j] = quarter_sin_q31(quarter - j, quarter);
+			s[j] = quarter_sin_q31(j, quarter);
+		} else {
+			c[j] = -quarter_sin_q31(j - quarter, quarter);
+			s[j] = quarter_sin_q31(n/2 - j, quarter);
+		}
+	}
+	for (h = n/4; h >= 1; h /= 2) {
+		for (j = 0; j < h; j++) {
+			fft->v_cos[h - 1 + j] = c[j*(n/2/h)];
+			fft->v_sin[h - 1 + j] = s[j*(n/2/h)];
+		}
+	}
+	return 3*n*sizeof(vbx_word_t);
+}
+
+void vbx_fft(vbx_fft_t *fft, vbx_word_t *v_re, vbx_word_t *v_im)
+{
+	int h, n = fft->n;
+
+	for (h = n/2; h > 1; h /= 2) {
+		// row r is the group of butterflies between elements r*2h + j and
+		// r*2h + h + j, the two temps sit in the same places in v_tmp
+		vbx_word_t *v_c = fft->v_cos + h - 1, *v_s = fft->v_sin + h - 1;
+		vbx_word_t *v_t0 = fft->v_tmp, *v_t1 = fft->v_tmp + h;
+		int pitch = 2*h*sizeof(vbx_word_t);
+
+		vbx_set_vl(h, n/(2*h));
+		vbx_set_2D(pitch, pitch, pitch);
+		vbx(VVW, VSUB, v_t0, v_re, v_re + h);
+		vbx(VVW, VSUB, v_t1, v_im, v_im + h);
+		vbx(VVW, VADD, v_re, v_re, v_re + h);
+		vbx(VVW, VADD, v_im, v_im, v_im + h);
+		// VMULH by a Q31 twiddle halves, so double the difference first
+		vbx(VVW, VADD, v_t0, v_t0, v_t0);
+		vbx(VVW, VADD, v_t1, v_t1, v_t1);
+
+		// (t0 + i*t1)*(c - i*s)
+		vbx_set_2D(pitch, pitch, 0);
+		vbx(VVW, VMULH, v_re + h, v_t0, v_c);
+		vbx(VVW, VMULH, v_im + h, v_t1, v_c);
+		vbx(VVW, VMULH, v_t1, v_t1, v_s);
+		vbx(VVW, VMULH, v_t0, v_t0, v_s);
+		vbx_set_2D(pitch, pitch, pitch);
+		vbx(VVW, VADD, v_re + h, v_re + h, v_t1);
+		vbx(VVW, VSUB, v_im + h, v_im + h, v_t0);
+	}
+
+	// the last stage only has the twiddle 1
+	vbx_set_vl(1, n/2);
+	vbx_set_2D(2*sizeof(vbx_word_t), 2*sizeof(vbx_word_t), 2*sizeof(vbx_word_t));
+	vbx(VVW, VSUB, fft->v_tmp, v_re, v_re + 1);
+	vbx(VVW, VSUB, fft->v_tmp + 1, v_im, v_im + 1);
+	vbx(VVW, VADD, v_re, v_re, v_re + 1);
+	vbx(VVW, VADD, v_im, v_im, v_im + 1);
+	vbx(VVW, VMOV, v_re + 1, fft->v_tmp, 0);
+	vbx(VVW, VMOV, v_im + 1, fft->v_tmp + 1, 0);
+}
+
+void vbx_fft_bitreverse(vbx_fft_t *fft, vbx_word_t *v_data)
+{
+	int b, g, j, n = fft->n;
+	vbx_word_t *v_src = v_data, *v_dst = fft->v_tmp;
+
+	// moving the even elements of every block of b to its first half and the
+	// odd ones to its second half, for b from n down to 4, reverses the bits
+	for (b = n; b >= 4; b /= 2) {
+		if (n/b <= b/2) {
+			// a row per pair of elements, a pair of moves per block
+			vbx_set_vl(1, b/2);
+			vbx_set_2D(sizeof(vbx_word_t), 2*sizeof(vbx_word_t), 0);
+			for (g = 0; g < n; g += b) {
+				vbx(VVW, VMOV, v_dst + g, v_src + g, 0);
+				vbx(VVW, VMOV, v_dst + g + b/2, v_src + g + 1, 0);
+			}
+		} else {
+			// a row per block, a pair of moves per element of the half block
+			vbx_set_vl(1, n/b);
+			vbx_set_2D(b*sizeof(vbx_word_t), b*sizeof(vbx_word_t), 0);
+			for (j = 0; j < b/2; j++) {
+				vbx(VVW, VMOV, v_dst + j, v_src + 2*j, 0);
+				vbx(VVW, VMOV, v_dst + b/2 + j, v_src + 2*j + 1, 0);
+			}
+		}
+		vbx_word_t *v_swap = v_src;
+		v_src = v_dst;
+		v_dst = v_swap;
+	}
+	if (v_src != v_data) {
+		vbx_set_vl(n);
+		vbx(VVW, VMOV, v_data, v_src, 0);
+	}
+}
+
+void vbx_fft_power(vbx_word_t *v_out, vbx_word_t *v_re, vbx_word_t *v_im, const int n)
+{
+	vbx_set_vl(n);
+	vbx(VVW, VMULH, v_out, v_re, v_re);
+	vbx(VVW, VMULH, v_im, v_im, v_im);
+	vbx(VVW, VADD, v_out, v_out, v_im);
+}
+
+// log2(x) in Q16 for x > 0
+static int log2_q16(uint32_t x)
+{
+	int i, msb = 31;
+	while (!(x >> msb)) {
+		msb--;
+	}
+	// y in [1, 2) as Q30, every squaring gives one more fraction bit
+	uint64_t y = msb > 30 ? x >> (msb - 30) : (uint64_t)x << (30 - msb);
+	int log = msb << 16;
+	for (i = 15; i >= 0; i--) {
+		y = (y*y) >> 30;
+		if (y >= 2*(uint64_t)Q30_ONE) {
+			y >>= 1;
+			log |= 1 << i;
+		}
+	}
+	return log;
+}
+
+int vbx_mel_init(vbx_mel_t *mel, const int bands, const int n, const int sample_hz, vbx_word_t *v_work)
+{
+	int b, k, bins = n/2 + 1;
+	if (bands < 1 || bands > VBX_MEL_MAX_BANDS) {
+		return 0;
+	}
+	mel->bands = bands;
+	mel->v_weights = v_work;
+
+	// mel(f) is proportional to log2(1 + f/700), only the spacing matters here
+	int base = log2_q16(700*n);
+	int top = log2_q16(700*n + n/2*sample_hz) - base;
+	vbx_word_t *w = v_work;
+	for (b = 0; b < bands; b++) {
+		int lo = top*b/(bands + 1), mid = top*(b + 1)/(bands + 1), hi = top*(b + 2)/(bands + 1);
+		mel->lo[b] = bins;
+		mel->width[b] = 0;
+		for (k = 0; k < bins; k++) {
+			int m = log2_q16(700*n + k*sample_hz) - base;
+			if (m <= lo || m >= hi) {
+				continue;
+			}
+			int64_t weight = m <= mid ? ((int64_t)(m - lo) << 31)/(mid - lo)
+			                          : ((int64_t)(hi - m) << 31)/(hi - mid);
+			if (!mel->width[b]) {
+				mel->lo[b] = k;
+			}
+			*w++ = weight > 0x7FFFFFFF ? 0x7FFFFFFF : (int32_t)weight;
+			mel->width[b]++;
+		}
+	}
+	return (w - v_work)*sizeof(vbx_word_t);
+}
+
+void vbx_mel(vbx_mel_t *mel, vbx_word_t *v_out, vbx_word_t *v_power)
+{
+	int b;
+	vbx_word_t *v_w = mel->v_weights;
+	for (b = 0; b < mel->bands; b++) {
+		if (!mel->width[b]) {
+			// too narrow to hold a bin at this FFT size
+			v_out[b] = 0;
+			continue;
+		}
+		vbx_set_vl(mel->width[b]);
+		vbx_acc(VVW, VMULH, v_out + b, v_w, v_power + mel->lo[b]);
+		v_w += mel->width[b];
+	}
+}
@@ -0,0 +1,53 @@
+#ifndef VBX_FFT_H
+#define VBX_FFT_H
+
+#include "vbx.h"
+
+// Fixed point FFT and spectral helpers.
+//
+// Complex data is split into a real and an imaginary vector of words. The FFT
+// is radix-2 decimation in frequency, done in place, one stage at a time: each
+// stage is a 2D pass where a row is one group of butterflies and the
+// twiddles repeat on every row. Twiddles are Q31 and multiplied with VMULH.
+// The butterflies don't scale, so the output is the plain DFT sum and the
+// input magnitude must stay below 2^(31 - log2 n).
+//
+// The FFT leaves its output in bit reversed order. vbx_fft_power() doesn't care
+// about order, so reversing the power spectrum alone is the cheap way to a
+// natural order spectrum.
+
+#define VBX_FFT_MIN_N      64
+#define VBX_FFT_MAX_N      1024
+#define VBX_MEL_MAX_BANDS  32
+
+typedef struct {
+	int n, log2n;
+	vbx_word_t *v_cos;  // twiddles for the stage with span h at [h-1, 2h-2]
+	vbx_word_t *v_sin;
+	vbx_word_t *v_tmp;  // n words
+} vbx_fft_t;
+
+typedef struct {
+	int bands;
+	uint16_t lo[VBX_MEL_MAX_BANDS];     // first power bin of each band
+	uint16_t width[VBX_MEL_MAX_BANDS];  // bins in each band
+	vbx_word_t *v_weights;              // Q31 triangle weights of every band, back to back
+} vbx_mel_t;
+
+// n a power of 2 in [VBX_FFT_MIN_N, VBX_FFT_MAX_N], v_work holds 3*n words.
+// Returns the bytes of v_work used, or 0 if n is out of range.
+int vbx_fft_init(vbx_fft_t *fft, const int n, vbx_word_t *v_work);
+void vbx_fft(vbx_fft_t *fft, vbx_word_t *v_re, vbx_word_t *v_im);
+// put n words from bit reversed into natural order, or back
+void vbx_fft_bitreverse(vbx_fft_t *fft, vbx_word_t *v_data);
+// (re^2 + im^2) >> 32 of n bins. v_out may be v_re, v_im is overwritten.
+void vbx_fft_power(vbx_word_t *v_out, vbx_word_t *v_re, vbx_word_t *v_im, const int n);
+
+// bands triangular filters evenly spaced on the mel scale from 0 to
+// sample_hz/2, over the n/2+1 natural order power bins of an n point FFT.
+// v_work holds n+2 words. Returns the bytes of v_work used, or 0 if bands is out of range.
+int vbx_mel_init(vbx_mel_t *mel, const int bands, const int n, const int sample_hz, vbx_word_t *v_work);
+// v_out[b] = sum of weight*power >> 32 over band b
+void vbx_mel(vbx_mel_t *mel, vbx_word_t *v_out, vbx_word_t *v_power);
+
+#endif //VBX_FFT_H
@@ -0,0 +1,146 @@
+#include "vbx_nn.h"
+
+void vbx_nn_unpack_int8(vbx_word_t *v_out, vbx_word_t *v_in, const int n)
+{
+	int j;
+	// move byte j to the top of word 4*i+j, then shift it back down signed.
+	// there is no scalar shift amount, so shifts are multiplies
+	vbx_set_vl(1, n/4);
+	vbx_set_2D(4*sizeof(vbx_word_t), 0, sizeof(vbx_word_t));
+	for (j = 0; j < 4; j++) {
+		vbx(SVW, VMUL, v_out+j, 1 << (24-8*j), v_in);
+	}
+	vbx_set_vl(n);
+	vbx(SVW, VMULH, v_out, 1 << 8, v_out);
+}
+
+void vbx_nn_pack_int8(vbx_word_t *v_out, vbx_word_t *v_in, vbx_word_t *v_tmp, const int n)
+{
+	int j;
+	vbx_set_vl(1, n/4);
+	for (j = 0; j < 4; j++) {
+		vbx_set_2D(sizeof(vbx_word_t), 0, 4*sizeof(vbx_word_t));
+		vbx(SVW, VAND, j ? v_tmp : v_out, 0xFF, v_in+j);
+		if (j) {
+			vbx_set_2D(sizeof(vbx_word_t), sizeof(vbx_word_t), sizeof(vbx_word_t));
+			vbx(SVW, VMUL, v_tmp, 1 << (8*j), v_tmp);
+			vbx(VVW, VOR, v_out, v_out, v_tmp);
+		}
+	}
+}
+
+void vbx_nn_saturate(vbx_word_t *v_data, vbx_word_t *v_flag, const int n, const int lo, const int hi)
+{
+	vbx_set_vl(n);
+	vbx(SVW, VSLT, v_flag, hi, v_data);
+	vbx(SVW, VCMV_NZ, v_data, hi, v_flag);
+	vbx(SVW, VSGT, v_flag, lo, v_data);
+	vbx(SVW, VCMV_NZ, v_data, lo, v_flag);
+}
+
+void vbx_nn_requantize(vbx_word_t *v_data, const int n, const int32_t mult, const int shift, const int zero_point)
+{
+	vbx_set_vl(n);
+	if (shift) {
+		vbx(SVW, VMUL, v_data, 1 << shift, v_data);
+	}
+	vbx(SVW, VMULH, v_data, mult, v_data);
+	if (zero_point) {
+		vbx(SVW, VADD, v_data, zero_point, v_data);
+	}
+}
+
+void vbx_nn_requantize_channels(vbx_word_t *v_data, const int size, const int channels,
+                                const int32_t *mults, const int8_t *shifts, const int zero_point)
+{
+	int c;
+	for (c = 0; c < channels; c++) {
+		vbx_nn_requantize(v_data + c*size, size, mults[c], shifts[c], zero_point);
+	}
+}
+
+void vbx_nn_conv1x1(vbx_word_t *v_out, vbx_word_t *v_in, vbx_word_t *v_tmp, const int size,
+                    const int channels, const int kernels, const int8_t *weights, const int32_t *biases)
+{
+	int k, c;
+	vbx_set_vl(size);
+	for (k = 0; k < kernels; k++) {
+		vbx_word_t *v_dst = v_out + k*size;
+		vbx(SVW, VMOV, v_dst, biases ? biases[k] : 0, 0);
+		for (c = 0; c < channels; c++) {
+			int w = weights[k*channels + c];
+			if (w) {
+				vbx(SVW, VMUL, v_tmp, w, v_in + c*size);
+				vbx(VVW, VADD, v_dst, v_dst, v_tmp);
+			}
+		}
+	}
+}
+
+void vbx_nn_conv3x3(vbx_word_t *v_out, vbx_word_t *v_in, vbx_word_t *v_tmp, const int m, const int n,
+                    const int channels, const int kernels, const int stride, const int depthwise,
+                    const int8_t *weights, const int32_t *biases)
+{
+	int k, c, t, y;
+	int m0 = m/stride, n0 = n/stride;
+	int in_size = (m+2)*(n+2);
+	// every output row is computed at full input width, one output row per
+	// stride input rows, so all operands share the input row pitch
+	int pitch = stride*(n+2);
+	vbx_word_t *v_acc = v_tmp + m0*pitch;
+
+	for (k = 0; k < kernels; k++) {
+		vbx_set_vl(n, m0);
+		vbx_set_2D(pitch*sizeof(vbx_word_t), pitch*sizeof(vbx_word_t), pitch*sizeof(vbx_word_t));
+		vbx(SVW, VMOV, v_acc, biases ? biases[k] : 0, 0);
+		for (c = depthwise ? k : 0; c < (depthwise ? k+1 : channels); c++) {
+			const int8_t *w = weights + (depthwise ? c : k*channels + c)*9;
+			for (t = 0; t < 9; t++) {
+				if (w[t]) {
+					vbx(SVW, VMUL, v_tmp, w[t], v_in + c*in_size + (t/3)*(n+2) + t%3);
+					vbx(VVW, VADD, v_acc, v_acc, v_tmp);
+				}
+			}
+		}
+
+		// drop the pitch padding and, when striding, every other column
+		if (stride == 1) {
+			vbx_set_2D(n0*sizeof(vbx_word_t), pitch*sizeof(vbx_word_t), 0);
+			vbx(VVW, VMOV, v_out + k*m0*n0, v_acc, 0);
+		} else {
+			vbx_set_vl(1, n0);
+			vbx_set_2D(sizeof(vbx_word_t), stride*sizeof(vbx_word_t), 0);
+			for (y = 0; y < m0; y++) {
+				vbx(VVW, VMOV, v_out + (k*m0 + y)*n0, v_acc + y*pitch, 0);
+			}
+		}
+	}
+}
+
+void vbx_nn_dense(vbx_word_t *v_out, vbx_word_t *v_in, vbx_word_t *v_packed, vbx_word_t *v_biases,
+                  vbx_word_t *v_tmp, const int tmp_words, const int inputs, const int outputs)
+{
+	int o, rows = (tmp_words-1)/(inputs+1);
+
+	for (o = 0; o < outputs; o += rows) {
+		rows = min(rows, outputs-o);
+		vbx_word_t *v_weights = v_tmp;
+		vbx_word_t *v_sums = v_tmp + rows*inputs;
+
+		vbx_nn_unpack_int8(v_weights, v_packed + o*inputs/4, rows*inputs);
+
+		// accumulate mode keeps summing across rows, so row r leaves the sum
+		// of rows 0..r, and neighbouring differences give the dot products
+		v_sums[0] = 0;
+		vbx_set_vl(inputs, rows);
+		vbx_set_2D(sizeof(vbx_word_t), inputs*sizeof(vbx_word_t), 0);
+		vbx_acc(VVW, VMUL, v_sums+1, v_weights, v_in);
+		vbx_set_vl(rows);
+		vbx(VVW, VSUB, v_out + o, v_sums+1, v_sums);
+	}
+
+	if (v_biases) {
+		vbx_set_vl(outputs);
+		vbx(VVW, VADD, v_out, v_out, v_biases);
+	}
+}
@@ -0,0 +1,45 @@
+#ifndef VBX_NN_H
+#define VBX_NN_H
+
+#include "vbx.h"
+
+// Quantized neural network kernels for int8 weights.
+//
+// The LVE only moves words, so activations live one per word in the scratchpad
+// and are narrowed back to packed bytes with vbx_nn_pack_int8() when they need
+// to be stored compactly. Feature maps are channel major: each channel is a
+// rows x cols block of words, and 3x3 inputs carry a one element zero border
+// on every side ((rows+2) x (cols+2) words per channel).
+//
+// Requantization follows the usual int8 scheme: the int32 accumulator is
+// shifted left by shift, multiplied by a Q31 multiplier keeping the high word
+// (VMULH, so results round toward -inf), offset by the zero point and then
+// saturated to the activation range.
+
+// sign extend n packed int8 values (n a multiple of 4) to words
+void vbx_nn_unpack_int8(vbx_word_t *v_out, vbx_word_t *v_in, const int n);
+// pack the low bytes of n words (n a multiple of 4), v_tmp holds n/4 words
+void vbx_nn_pack_int8(vbx_word_t *v_out, vbx_word_t *v_in, vbx_word_t *v_tmp, const int n);
+// clamp n words to [lo, hi], v_flag holds n words
+void vbx_nn_saturate(vbx_word_t *v_data, vbx_word_t *v_flag, const int n, const int lo, const int hi);
+void vbx_nn_requantize(vbx_word_t *v_data, const int n, const int32_t mult, const int shift, const int zero_point);
+// per channel multipliers and shifts over channels blocks of size words
+void vbx_nn_requantize_channels(vbx_word_t *v_data, const int size, const int channels,
+                                const int32_t *mults, const int8_t *shifts, const int zero_point);
+
+// v_tmp holds size words
+void vbx_nn_conv1x1(vbx_word_t *v_out, vbx_word_t *v_in, vbx_word_t *v_tmp, const int size,
+                    const int channels, const int kernels, const int8_t *weights, const int32_t *biases);
+// m x n padded input, (m/stride) x (n/stride) outputs, weights are [kernels][channels][9]
+// or [channels][9] when depthwise (kernels must equal channels).
+// v_tmp holds 2*(m/stride)*stride*(n+2) words
+void vbx_nn_conv3x3(vbx_word_t *v_out, vbx_word_t *v_in, vbx_word_t *v_tmp, const int m, const int n,
+                    const int channels, const int kernels, const int stride, const int depthwise,
+                    const int8_t *weights, const int32_t *biases);
+// weights are packed int8 [outputs][inputs] in the scratchpad, inputs a multiple of 4,
+// v_biases may be 0. Rows are done as many at a time as fit in tmp_words of v_tmp,
+// which needs at least inputs+2 words.
+void vbx_nn_dense(vbx_word_t *v_out, vbx_word_t *v_in, vbx_word_t *v_packed, vbx_word_t *v_biases,
+                  vbx_word_t *v_tmp, const int tmp_words, const int inputs, const int outputs);
+
+#endif //VBX_NN_H
@@ -0,0 +1,77 @@
+#include "vbx_resample.h"
+
+int vbx_resample_init(vbx_resample_t *rs, const int up, const int down, const int taps, const int block,
+                      const int32_t *coefs, const int shift, vbx_word_t *v_work)
+{
+	int a, b, p, i;
+	if (up < 1 || down < 1 || taps < 1 || block < down || block % down || shift < 2 || shift > 31) {
+		return 0;
+	}
+	for (a = up, b = down; b; ) {
+		int r = a % b;
+		a = b;
+		b = r;
+	}
+	if (a != 1) {
+		return 0;
+	}
+
+	rs->up = up;
+	rs->down = down;
+	rs->taps = taps;
+	rs->block = block;
+	rs->shift = shift;
+	rs->v_taps = v_work;
+	rs->v_hist = rs->v_taps + up*taps;
+	rs->v_sums = rs->v_hist + taps - 1 + block;
+
+	// tap i of phase p is coefs[p + i*up], and it multiplies the input i
+	// samples back, so the phase is stored reversed to line up with the input
+	for (p = 0; p < up; p++) {
+		for (i = 0; i < taps; i++) {
+			rs->v_taps[p*taps + taps - 1 - i] = coefs[p + i*up];
+		}
+		rs->v_sums[p*(block/down + 1)] = 0;
+	}
+	vbx_set_vl(taps - 1 + block);
+	vbx(SVW, VMOV, rs->v_hist, 0, 0);
+
+	return (rs->v_sums + up*(block/down + 1) - v_work)*sizeof(vbx_word_t);
+}
+
+int vbx_resample(vbx_resample_t *rs, vbx_word_t *v_out, vbx_word_t *v_in)
+{
+	int r;
+	int up = rs->up, down = rs->down, taps = rs->taps, block = rs->block;
+	int rows = block/down, outputs = rows*up;
+	vbx_word_t *v_input = vbx_resample_input(rs);
+
+	if (v_in != v_input) {
+		vbx_set_vl(block);
+		vbx(VVW, VMOV, v_input, v_in, 0);
+	}
+
+	// output r + t*up of this block has phase r*down mod up, and its input
+	// window ends r*down/up + t*down samples into the block
+	vbx_set_vl(taps, rows);
+	vbx_set_2D(sizeof(vbx_word_t), down*sizeof(vbx_word_t), 0);
+	for (r = 0; r < up; r++) {
+		int phase = r*down % up, end = r*down/up;
+		vbx_acc(VVW, VMUL, rs->v_sums + r*(rows + 1) + 1, v_input + end - (taps - 1), rs->v_taps + phase*taps);
+	}
+	vbx_set_vl(1, rows);
+	vbx_set_2D(up*sizeof(vbx_word_t), sizeof(vbx_word_t), sizeof(vbx_word_t));
+	for (r = 0; r < up; r++) {
+		vbx_word_t *v_sums = rs->v_sums + r*(rows + 1);
+		vbx(VVW, VSUB, v_out + r, v_sums + 1, v_sums);
+	}
+	vbx_set_vl(outputs);
+	vbx(SVW, VMULH, v_out, 1 << (32 - rs->shift), v_out);
+
+	// keep the last taps-1 inputs for the next block
+	if (taps > 1) {
+		vbx_set_vl(taps - 1);
+		vbx(VVW, VMOV, rs->v_hist, rs->v_hist + block, 0);
+	}
+	return outputs;
+}
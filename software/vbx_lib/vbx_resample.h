@@ -0,0 +1,44 @@
+#ifndef VBX_RESAMPLE_H
+#define VBX_RESAMPLE_H
+
+#include "vbx.h"
+
+// Polyphase resampling by up/down: the input is conceptually zero stuffed to
+// up times its rate, low-pass filtered and kept every down'th sample, but only
+// the kept outputs are ever computed.
+//
+// Output j is the dot product of phase (j*down mod up) of the filter with the
+// taps input samples ending at j*down/up. Every up'th output uses the same
+// phase and input down samples further on, so each phase is one 2D
+// accumulate with a row per output; the accumulator runs on across rows and
+// differencing neighbouring rows, which also interleaves the phases, gives the
+// outputs. The differences are exact even when the running sum wraps.
+//
+// Prototype filters come from apps/beamforming/resample_generator.py.
+
+typedef struct {
+	int up, down, taps, block;
+	int shift;
+	vbx_word_t *v_taps;  // [phase][taps], each phase reversed
+	vbx_word_t *v_hist;  // the last taps-1 inputs, then the current block
+	vbx_word_t *v_sums;  // [phase][block/down + 1] running sums, each led by a 0
+} vbx_resample_t;
+
+// up and down without a common factor, coefs the up*taps tap prototype with
+// shift fraction bits (2 to 31), block input samples per call, a multiple of
+// down. v_work holds up*taps + taps-1 + block + up*(block/down + 1) words.
+// Returns the bytes of v_work used, or 0 if the sizes don't fit together.
+int vbx_resample_init(vbx_resample_t *rs, const int up, const int down, const int taps, const int block,
+                      const int32_t *coefs, const int shift, vbx_word_t *v_work);
+
+// Where the next block of input can be written to save vbx_resample() a copy.
+static inline vbx_word_t *vbx_resample_input(vbx_resample_t *rs)
+{
+	return rs->v_hist + rs->taps - 1;
+}
+
+// Filter block inputs from v_in into block*up/down outputs in v_out and
+// return the number of outputs.
+int vbx_resample(vbx_resample_t *rs, vbx_word_t *v_out, vbx_word_t *v_in);
+
+#endif //VBX_RESAMPLE_H
@@ -10,9 +10,15 @@ use work.top_util_pkg.all;
 -- 0x00 Version
 -- 0x04 clock_divider (Max 0xFFFF)
 -- 0x08 DATA
+-- 0x0C STATUS
 
 -- The DATA register at 0x08 reads a fifo. the fifo always has the latest data
 -- in it. If the data is not read often enough, the oldest data will be dropped
+--
+-- STATUS bits 15:0 are the number of samples in the fifo, so it can be drained
+-- without stalling on an empty fifo. The top bit is set when a sample was dropped
+-- and is cleared by reading STATUS. rx_int_o is high while the fifo is at
+-- least half full.
 -------------------------------------------------------------------------------
 
 
@@ -79,11 +85,15 @@ architecture rtl of i2s_wb is
   signal do_read : boolean;
   signal do_write : boolean;
 
+  signal fifo_level : unsigned(write_ptr'range);
+  signal overflow   : std_logic;
+
 
   constant REGISTER_NAME_SIZE     : integer                                 := 4;
   constant VERSION_REGISTER       : unsigned(REGISTER_NAME_SIZE-1 downto 0) := x"0";
   constant CLOCK_DIVIDER_REGISTER : unsigned(REGISTER_NAME_SIZE-1 downto 0) := x"4";
   constant DATA_REGISTER          : unsigned(REGISTER_NAME_SIZE-1 downto 0) := x"8";
+  constant STATUS_REGISTER        : unsigned(REGISTER_NAME_SIZE-1 downto 0) := x"C";
   signal addr                     : unsigned(REGISTER_NAME_SIZE-1 downto 0);
   signal clk_div_32 : std_logic_vector(31 downto 0);
 begin  -- architecture rtl
@@ -105,6 +115,8 @@ begin  -- architecture rtl
   --read pointer increment after read
   fifo_empty <= write_ptr = read_ptr;
   fifo_full  <= write_ptr + 1 = read_ptr;
+  fifo_level <= write_ptr - read_ptr;
+  rx_int_o   <= '1' when fifo_level >= FIFO_DEPTH/2 else '0';
 
   --write pointer control
   process(clk)
@@ -146,7 +158,7 @@ begin  -- architecture rtl
       if do_read then
         case addr is
           when VERSION_REGISTER =>
-            wb_dat_o <= x"00010000";
+            wb_dat_o <= x"00010001";
             wb_ack_o <= '1';
           when CLOCK_DIVIDER_REGISTER =>
             wb_dat_o <= std_logic_vector(resize(clock_divider, 32));
@@ -157,6 +169,12 @@ begin  -- architecture rtl
               wb_ack_o <= '1';
               read_ptr <= read_ptr +1;
             end if;
+          when STATUS_REGISTER =>
+            wb_dat_o                   <= (others => '0');
+            wb_dat_o(wb_dat_o'left)    <= overflow;
+            wb_dat_o(fifo_level'range) <= std_logic_vector(fifo_level);
+            wb_ack_o                   <= '1';
+            overflow                   <= '0';
           when others => null;
         end case;
       end if;
@@ -168,9 +186,11 @@ begin  -- architecture rtl
       end if;
       if i2s_data_valid = '1' and fifo_full then
         read_ptr <= read_ptr +1;
+        overflow <= '1';
       end if;
       if wb_rst_i = '1' then
         read_ptr      <= to_unsigned(0, read_ptr'length);
+        overflow      <= '0';
         clock_divider <= (others => '1');
       end if;
     end if;
@@ -762,6 +762,7 @@ package top_component_pkg is
       cam_start  : in  std_logic;
       cam_done   : out std_logic;
       cam_dat_en : out std_logic;
+      cam_buffer : in  std_logic_vector(1 downto 0) := (others => '0');
       --camera signals
       ovm_pclk   : in  std_logic;
       ovm_vsync  : in  std_logic;
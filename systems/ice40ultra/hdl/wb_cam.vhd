@@ -26,6 +26,8 @@ entity wb_cam is
     cam_start  : in  std_logic;
     cam_done   : out std_logic;
     cam_dat_en : out std_logic;
+    -- which 8K of the scratchpad the next frame goes to, sampled while idle
+    cam_buffer : in  std_logic_vector(1 downto 0) := (others => '0');
     --camera signals
     ovm_pclk   : in  std_logic;
     ovm_vsync  : in  std_logic;
@@ -110,6 +112,7 @@ architecture rtl of wb_cam is
   signal cam_start_ff   : std_logic;
   signal cam_start_sync : std_logic;
   signal cam_done_ff    : std_logic;
+  signal frame_buffer   : std_logic_vector(1 downto 0);
 
   -- clock-domain crossing wishbone fsm
 
@@ -418,9 +421,18 @@ begin  -- architecture rtl
         master_ADR_O(12 downto 0) <= v_rgb_out_row & v_rgb_out_col & "00";
       end if;
 
+      -- hold the buffer steady for the whole frame so software can select
+      -- the next one as soon as this one starts
+      if cam_done_ff = '1' then
+        frame_buffer <= cam_buffer;
+      end if;
+      if rst_i = '1' then
+        frame_buffer <= (others => '0');
+      end if;
     end if;
   end process;
-  master_ADR_O(master_ADR_O'left downto 13) <= (others => '0');
+  master_ADR_O(14 downto 13)                <= frame_buffer;
+  master_ADR_O(master_ADR_O'left downto 15) <= (others => '0');
   master_SEL_O                              <= (others => '1');
 
 end architecture rtl;
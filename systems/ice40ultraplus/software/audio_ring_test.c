@@ -0,0 +1,70 @@
+#include "printf.h"
+#include "vbx.h"
+#include "time.h"
+#include "i2s.h"
+
+// Plays a square wave through the output ring while vector work runs between
+// blocks, and checks the codec never ran dry. Then stops feeding it and checks
+// the underruns are counted.
+#define OUT_HZ     8000
+#define TONE_HZ    500
+#define BLOCK      32
+#define RING       256
+#define SECONDS    2
+#define WORK_WORDS 1024
+
+#define SP_RING ((i2s_data_t*)(SCRATCHPAD_BASE + 0*1024))
+#define SP_WORK ((vbx_word_t*)(SCRATCHPAD_BASE + 4*1024))
+
+static i2s_data_t block[BLOCK];
+
+// stands in for the vector kernels the main loop runs between blocks
+static void work()
+{
+	vbx_set_vl(WORK_WORDS);
+	vbx(SVW, VADD, SP_WORK, 1, SP_WORK);
+	vbx(VVW, VMUL, SP_WORK, SP_WORK, SP_WORK);
+}
+
+int main()
+{
+	int b, t = 0, errors = 0;
+
+	printf("audio ring test\r\n");
+	init_lve();
+	i2s_set_frequency(ORCA_CLK, OUT_HZ);
+	i2s_tx_start(SP_RING, RING);
+
+	for (b = 0; b < SECONDS*OUT_HZ/BLOCK; b++) {
+		int i;
+		for (i = 0; i < BLOCK; i++, t++) {
+			short level = (t*TONE_HZ*2/OUT_HZ) & 1 ? 0x2000 : -0x2000;
+			block[i].left = level;
+			block[i].right = level;
+		}
+		i2s_put_block(block, BLOCK);
+		work();
+#if !I2S_TX_USE_INTERRUPT
+		i2s_tx_service();
+#endif
+	}
+	printf("playing: %d refills, %d underruns, %d queued %s\r\n",
+	       (int)i2s_tx_stats.refills, (int)i2s_tx_stats.underruns, i2s_tx_level(),
+	       i2s_tx_stats.underruns ? "Failed" : "Passed");
+	errors += i2s_tx_stats.underruns != 0;
+
+	// let the ring drain and play silence for a while
+	unsigned start = get_time();
+	while (get_time() - start < ms2cycle(100)) {
+#if !I2S_TX_USE_INTERRUPT
+		i2s_tx_service();
+#endif
+	}
+	printf("starved: %d underruns, %d queued %s\r\n",
+	       (int)i2s_tx_stats.underruns, i2s_tx_level(),
+	       i2s_tx_stats.underruns && !i2s_tx_level() ? "Passed" : "Failed");
+	errors += !i2s_tx_stats.underruns || i2s_tx_level();
+
+	printf("DONE -- errors = %d %s\r\n\r\n", errors, errors ? "FAILED :(" : "PASSED :)");
+	return errors;
+}
@@ -1,37 +1,36 @@
-#include "orca_printf.h"
+#include "uart.h"
+#include "base64.h"
 
-union base64_t{
-  struct {
-	 char byte_c;
-	 char byte_b;
-	 char byte_a;
-
-  };
-  struct {
-	 unsigned int index_d : 6;
-	 unsigned int index_c : 6;
-	 unsigned int index_b : 6;
-	 unsigned int index_a : 6;
-  };
-};
 const char base_64_table[]="ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-void print_base64(char* in_str, int in_len)
+int base64_encode(char* out, const uint8_t* in, int in_len)
 {
   int i;
-  union base64_t b64;
+  char* start = out;
   for(i = 0;i<in_len;i+=3){
+	 uint32_t group = in[i]<<16;
+	 if(i+1<in_len) group |= in[i+1]<<8;
+	 if(i+2<in_len) group |= in[i+2];
 
-	 b64.byte_a=in_str[i];
-	 b64.byte_b=i+1<in_len?in_str[i+1]:0;
-	 b64.byte_c=i+2<in_len?in_str[i+2]:0;
-
-	 printf("%c%c%c%c",
-			  base_64_table[b64.index_a],
-			  base_64_table[b64.index_b],
-			  i+1<in_len?base_64_table[b64.index_c]:'=',
-			  i+2<in_len?base_64_table[b64.index_d]:'=');
+	 *out++ = base_64_table[(group>>18) & 0x3F];
+	 *out++ = base_64_table[(group>>12) & 0x3F];
+	 *out++ = i+1<in_len?base_64_table[(group>>6) & 0x3F]:'=';
+	 *out++ = i+2<in_len?base_64_table[group & 0x3F]:'=';
   }
+  return out-start;
+}
 
-
+// encodes a few groups at a time and hands the characters straight to the
+// UART rather than formatting each group with printf
+void print_base64(char* in_str, int in_len)
+{
+  char line[4*BASE64_PRINT_GROUPS];
+  int i, j, len;
+  for(i = 0;i<in_len;i+=3*BASE64_PRINT_GROUPS){
+	 len = in_len-i<3*BASE64_PRINT_GROUPS ? in_len-i : 3*BASE64_PRINT_GROUPS;
+	 len = base64_encode(line,(uint8_t*)in_str+i,len);
+	 for(j = 0;j<len;j++){
+		mputc(DEFAULT_PUTP,line[j]);
+	 }
+  }
 }
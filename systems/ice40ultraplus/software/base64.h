@@ -1,6 +1,17 @@
 #ifndef BASE64_H
 #define BASE64_H
 
+#include <stdint.h>
+
+// input groups print_base64() encodes between writes to the UART
+#define BASE64_PRINT_GROUPS 16
+
+// the encoded length of in_len bytes
+#define BASE64_LEN(in_len) (4*(((in_len)+2)/3))
+
+// writes BASE64_LEN(in_len) characters to out, no terminator, returns how many
+int base64_encode(char* out, const uint8_t* in, int in_len);
+
 void print_base64(char* in_str, int in_len);
 
 #endif //BASE64_H
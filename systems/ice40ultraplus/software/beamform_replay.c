@@ -0,0 +1,110 @@
+#include "printf.h"
+#include "vbx.h"
+#include "time.h"
+#include "fir.h"
+#include "bf_kernels.h"
+#include "replay.h"
+#include "replay_samples.h"
+#if REPLAY_IN_FLASH
+#include "flash_dma.h"
+#endif
+
+// Replays a recording made with wav_to_samples.py through the two microphone
+// beamformer of beamforming.c, checks every window's direction against the
+// reference model in the script and reports the cycles per window against
+// the real time budget. Regenerate replay_samples.c/.h to replay something
+// else; with --flash, write the image to REPLAY_FLASH_OFFSET first.
+#define REPLAY_FLASH_OFFSET 0x1C0000
+// Time the kernels first rather than use the default dispatch. The host
+// model only counts LVE cycles, so there everything would stay scalar.
+#define CALIBRATE           0
+
+#define TAPS     REPLAY_NUM_TAPS
+#define WINDOW   REPLAY_WINDOW
+#define DIFF     REPLAY_SAMPLE_DIFFERENCE
+
+#define SP_TAPS  ((vbx_word_t*)(SCRATCHPAD_BASE + 0*1024))
+#define SP_TMP   ((vbx_word_t*)(SCRATCHPAD_BASE + 1*1024))
+#define SP_MIC_L ((vbx_word_t*)(SCRATCHPAD_BASE + 2*1024))
+#define SP_MIC_R ((vbx_word_t*)(SCRATCHPAD_BASE + 3*1024))
+#define SP_SND_L ((vbx_word_t*)(SCRATCHPAD_BASE + 4*1024))
+#define SP_SND_R ((vbx_word_t*)(SCRATCHPAD_BASE + 5*1024))
+#define SP_STAGE ((vbx_word_t*)(SCRATCHPAD_BASE + 6*1024))
+#define SP_WORK  ((vbx_word_t*)(SCRATCHPAD_BASE + 8*1024))
+
+static const char *direction_names[BF_DIRECTIONS] = { "centre", "right", "left" };
+
+int main()
+{
+	int i, expected, errors = 0;
+	int windows = 0, matches = 0;
+	int counts[BF_DIRECTIONS] = { 0, 0, 0 };
+	unsigned total = 0, worst = 0;
+	replay_t rp;
+	bf_window_t bf = {
+		SP_TAPS, SP_MIC_L, SP_MIC_R, SP_SND_L, SP_SND_R, SP_TMP,
+		TAPS, WINDOW, DIFF, REPLAY_FIR_SHIFT, REPLAY_PRESCALE
+	};
+
+	printf("beamform replay\r\n");
+	init_lve();
+
+#if REPLAY_IN_FLASH
+	flash_dma_init();
+	if (!replay_init_flash(&rp, REPLAY_FLASH_OFFSET, SP_STAGE, WINDOW)) {
+		printf("no replay image at %x\r\n", REPLAY_FLASH_OFFSET);
+		return 1;
+	}
+	if (rp.window != WINDOW || rp.config != REPLAY_CONFIG) {
+		printf("the replay image does not match replay_samples.h\r\n");
+		return 1;
+	}
+#else
+	replay_init(&rp, WINDOW, REPLAY_WINDOWS, replay_l, replay_r, replay_expected);
+#endif
+
+	if (TAPS != NUM_TAPS) {
+		printf("replay_samples.h has %d taps, fir.h %d\r\n", TAPS, NUM_TAPS);
+		return 1;
+	}
+#if CALIBRATE
+	bf_calibrate(TAPS, 2*WINDOW, SP_WORK, 0);
+#endif
+	for (i = 0; i < BF_STAGES; i++) {
+		if (bf_min_vl[i] == BF_VL_NEVER) {
+			printf("%s stays scalar\r\n", bf_stage_names[i]);
+		} else {
+			printf("%s on the LVE from %d\r\n", bf_stage_names[i], bf_min_vl[i]);
+		}
+	}
+
+	bf_window_init(&bf, fir_taps);
+
+	while ((expected = replay_next(&rp, SP_MIC_L + TAPS - 1, SP_MIC_R + TAPS - 1)) >= 0) {
+		unsigned start = get_time();
+		int direction = bf_window(&bf);
+		unsigned cycles = get_time() - start;
+
+		total += cycles;
+		worst = max(worst, cycles);
+		counts[direction]++;
+		if (direction == expected) {
+			matches++;
+		} else if (errors++ < 4) {
+			printf("window %d: %s, the reference says %s\r\n", windows,
+			       direction_names[direction], direction_names[expected]);
+		}
+		windows++;
+	}
+
+	// one window of samples arrives every WINDOW/REPLAY_RATE seconds
+	unsigned budget = (unsigned)((long long)ORCA_CLK*WINDOW/REPLAY_RATE);
+	printf("%d windows: %d centre, %d right, %d left\r\n", windows, counts[0], counts[1], counts[2]);
+	printf("decisions matching the reference: %d of %d %s\r\n", matches, windows,
+	       matches == windows ? "Passed" : "Failed");
+	printf("cycles/window: %d average, %d worst, budget %d\r\n",
+	       windows ? (int)(total/windows) : 0, (int)worst, (int)budget);
+
+	printf("DONE -- errors = %d %s\r\n\r\n", errors, errors ? "FAILED :(" : "PASSED :)");
+	return errors;
+}
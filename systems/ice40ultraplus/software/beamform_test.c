@@ -0,0 +1,131 @@
+#include "printf.h"
+#include "vbx.h"
+#include "time.h"
+#include "beamform.h"
+
+// Checks the beamform library against plain C on a noise source swept
+// across the steering angles, and times it against the real time budget.
+#define MIC_HZ     8000
+#define WINDOW     64
+#define MICS       4
+#define ANGLES     7
+#define SPACING_MM 140
+#define WINDOWS    6 // per angle
+#define SAMPLES    (WINDOWS*WINDOW)
+
+#define SP_SOURCE ((vbx_word_t*)(SCRATCHPAD_BASE + 0*1024))
+#define SP_MICS   ((vbx_word_t*)(SCRATCHPAD_BASE + 4*1024))
+#define SP_WORK   ((vbx_word_t*)(SCRATCHPAD_BASE + 16*1024))
+
+static int delays[ANGLES*MICS];
+
+static unsigned seed = 0x13579bd;
+static int next_rand()
+{
+	seed = seed*1103515245 + 12345;
+	return (int)(seed >> 8);
+}
+
+// microphone n hears the source delays[angle*MICS + n] later, linearly interpolated
+static void make_signals(const int angle)
+{
+	int n, t;
+	for (t = 0; t < SAMPLES + 32; t++) {
+		SP_SOURCE[t] = (next_rand() & 0x3FFF) - 0x2000;
+	}
+	for (n = 0; n < MICS; n++) {
+		int delay = delays[angle*MICS + n];
+		int whole = delay >> BF_FRAC_BITS, frac = delay & (BF_FRAC_ONE - 1);
+		for (t = 0; t < SAMPLES; t++) {
+			vbx_word_t *s = SP_SOURCE + 16 + t - whole;
+			SP_MICS[n*SAMPLES + t] = ((BF_FRAC_ONE - frac)*s[0] + frac*s[-1]) >> BF_FRAC_BITS;
+		}
+	}
+}
+
+// the prescaled sample t of microphone n in the window evaluated after
+// window w came in, which lags it by max_lag, zero before the first window
+static int sample(beamform_t *bf, const int n, const int w, const int t)
+{
+	int i = w*WINDOW - bf->max_lag + t;
+	return i < 0 ? 0 : SP_MICS[n*SAMPLES + i] >> bf->prescale;
+}
+
+static int check_powers(beamform_t *bf, const int w)
+{
+	int a, n, m, t, errors = 0;
+	int32_t energy = 0;
+
+	for (n = 0; n < MICS; n++) {
+		for (t = 0; t < WINDOW; t++) {
+			energy += sample(bf, n, w, t)*sample(bf, n, w, t);
+		}
+	}
+	for (a = 0; a < ANGLES; a++) {
+		int32_t power = energy;
+		for (n = 0; n < MICS; n++) {
+			for (m = n+1; m < MICS; m++) {
+				int lag = delays[a*MICS + m] - delays[a*MICS + n];
+				int whole = lag >> BF_FRAC_BITS, frac = lag & (BF_FRAC_ONE - 1);
+				int32_t xcorr = 0, next = 0;
+				for (t = 0; t < WINDOW; t++) {
+					xcorr += sample(bf, n, w, t)*sample(bf, m, w, t + whole);
+					if (frac) {
+						next += sample(bf, n, w, t)*sample(bf, m, w, t + whole + 1);
+					}
+				}
+				power += 2*(xcorr + ((((long long)next - xcorr)*frac) >> BF_FRAC_BITS));
+			}
+		}
+		if (power != bf->powers[a]) {
+			if (errors < 4) {
+				printf("ERROR window %d angle %d: %d != %d\r\n", w, a, (int)power, (int)bf->powers[a]);
+			}
+			errors++;
+		}
+	}
+	return errors;
+}
+
+int main()
+{
+	int a, n, w, errors = 0;
+	unsigned start, cycles = 0;
+	beamform_t bf;
+	vbx_word_t *v_in[MICS];
+
+	printf("beamform test\r\n");
+	init_lve();
+	beamform_linear_delays(delays, MICS, ANGLES, SPACING_MM, MIC_HZ);
+	if (!beamform_init(&bf, MICS, ANGLES, WINDOW, delays, SP_WORK)) {
+		printf("beamform_init failed\r\n");
+		return 1;
+	}
+	printf("max lag %d, prescale %d\r\n", bf.max_lag, bf.prescale);
+
+	for (a = 0; a < ANGLES; a++) {
+		make_signals(a);
+		beamform_init(&bf, MICS, ANGLES, WINDOW, delays, SP_WORK);
+		for (w = 0; w < WINDOWS; w++) {
+			for (n = 0; n < MICS; n++) {
+				v_in[n] = SP_MICS + n*SAMPLES + w*WINDOW;
+			}
+			start = get_time();
+			beamform_window(&bf, v_in);
+			cycles += get_time() - start;
+			errors += check_powers(&bf, w);
+		}
+		int peak = beamform_histogram_peak(&bf, 2);
+		printf("angle %d found %d %s\r\n", a, peak, peak == a ? "Passed" : "Failed");
+		errors += peak != a;
+	}
+
+	// one window of samples arrives every WINDOW/MIC_HZ seconds
+	int budget = ORCA_CLK/MIC_HZ*WINDOW;
+	cycles /= ANGLES*WINDOWS;
+	printf("%d mics %d angles: %d cycles/window, budget %d (%d%%)\r\n",
+	       MICS, ANGLES, (int)cycles, budget, (int)(cycles*100/budget));
+
+	printf("DONE -- errors = %d %s\r\n\r\n", errors, errors ? "FAILED :(" : "PASSED :)");
+	return errors;
+}
@@ -0,0 +1,188 @@
+#include "printf.h"
+#include "vbx.h"
+#include "time.h"
+#include "bf_kernels.h"
+
+// Checks the scalar and LVE versions of every beamforming stage give the same
+// bits, calibrates the dispatch lengths and runs the two microphone window of
+// beamforming.c and beamforming_scalar.c all scalar, all LVE and dispatched,
+// and filtered a sample at a time as with BLOCK_FIR 0.
+#define TAPS     16
+#define WINDOW   64
+#define DIFF     4 // samples between the microphones end on
+#define SHIFT    12
+#define PRESCALE 4
+#define WINDOWS  4
+#define MAX_VL   128
+
+#define SP_HIST  ((vbx_word_t*)(SCRATCHPAD_BASE + 0*1024))
+#define SP_TAPS  ((vbx_word_t*)(SCRATCHPAD_BASE + 4*1024))
+#define SP_OUT   ((vbx_word_t*)(SCRATCHPAD_BASE + 5*1024))
+#define SP_REF   ((vbx_word_t*)(SCRATCHPAD_BASE + 6*1024))
+#define SP_TMP   ((vbx_word_t*)(SCRATCHPAD_BASE + 7*1024))
+#define SP_MIC_L ((vbx_word_t*)(SCRATCHPAD_BASE + 8*1024))
+#define SP_MIC_R ((vbx_word_t*)(SCRATCHPAD_BASE + 9*1024))
+#define SP_SND_L ((vbx_word_t*)(SCRATCHPAD_BASE + 10*1024))
+#define SP_SND_R ((vbx_word_t*)(SCRATCHPAD_BASE + 11*1024))
+#define SP_WORK  ((vbx_word_t*)(SCRATCHPAD_BASE + 12*1024))
+
+static unsigned seed = 0x2468ace;
+static int next_rand()
+{
+	seed = seed*1103515245 + 12345;
+	return (int)(seed >> 8);
+}
+
+static int taps[TAPS];
+
+static int check(const char *what, const int n, vbx_word_t *ref, vbx_word_t *out)
+{
+	int i, errors = 0;
+	for (i = 0; i < n; i++) {
+		if (ref[i] != out[i]) {
+			if (errors < 4) {
+				printf("ERROR %s %d of %d: %d != %d\r\n", what, i, n, (int)ref[i], (int)out[i]);
+			}
+			errors++;
+		}
+	}
+	return errors;
+}
+
+// scalar against LVE on full range words, so the sums wrap
+static int test_length(const int n)
+{
+	int i, errors = 0;
+	for (i = 0; i < TAPS - 1 + n; i++) {
+		SP_HIST[i] = next_rand() << 8;
+	}
+	for (i = 0; i < TAPS; i++) {
+		SP_TAPS[i] = next_rand() << 8;
+	}
+
+	bf_fir_scalar(SP_REF, SP_HIST, SP_TAPS, TAPS, n, SHIFT);
+	bf_fir_lve(SP_OUT, SP_HIST, SP_TAPS, TAPS, n, SHIFT, SP_TMP);
+	errors += check("fir", n, SP_REF, SP_OUT);
+
+	bf_copy_scalar(SP_REF, SP_HIST + 3, n);
+	bf_copy_lve(SP_OUT, SP_HIST + 3, n);
+	errors += check("copy", n, SP_REF, SP_OUT);
+
+	SP_REF[0] = bf_power_scalar(SP_HIST, SP_HIST + TAPS - 1, n, PRESCALE);
+	SP_OUT[0] = bf_power_lve(SP_HIST, SP_HIST + TAPS - 1, n, PRESCALE, SP_TMP);
+	errors += check("power", 1, SP_REF, SP_OUT);
+
+	// beamforming_scalar.c squares without a prescale
+	SP_REF[0] = bf_power_scalar(SP_HIST, SP_HIST + TAPS - 1, n, 0);
+	SP_OUT[0] = bf_power_lve(SP_HIST, SP_HIST + TAPS - 1, n, 0, SP_TMP);
+	errors += check("unscaled power", 1, SP_REF, SP_OUT);
+
+	printf("%3d long: %s\r\n", n, errors ? "Failed" : "Passed");
+	return errors;
+}
+
+// the beamformer over WINDOWS windows of the same input, cycles per window in *cycles
+static void run_beamformer(const char *what, const int per_sample, int32_t *powers, unsigned *cycles)
+{
+	int i, w;
+	bf_window_t bf = {
+		SP_TAPS, SP_MIC_L, SP_MIC_R, SP_SND_L, SP_SND_R, SP_TMP,
+		TAPS, WINDOW, DIFF, SHIFT, PRESCALE
+	};
+	seed = 0x1357;
+	bf_window_init(&bf, taps);
+	*cycles = 0;
+	for (w = 0; w < WINDOWS; w++) {
+		for (i = 0; i < WINDOW; i++) {
+			SP_MIC_L[TAPS - 1 + i] = (next_rand() & 0xFFFF) - 0x8000;
+			SP_MIC_R[TAPS - 1 + i] = (next_rand() & 0xFFFF) - 0x8000;
+		}
+		unsigned start = get_time();
+		if (per_sample) {
+			bf_window_start(&bf);
+			for (i = 0; i < WINDOW; i++) {
+				bf_fir(SP_SND_L + DIFF + i, SP_MIC_L + i, SP_TAPS, TAPS, 1, SHIFT, SP_TMP);
+				bf_fir(SP_SND_R + DIFF + i, SP_MIC_R + i, SP_TAPS, TAPS, 1, SHIFT, SP_TMP);
+			}
+			bf_window_finish(&bf);
+		} else {
+			bf_window(&bf);
+		}
+		*cycles += get_time() - start;
+		for (i = 0; i < BF_DIRECTIONS; i++) {
+			powers[BF_DIRECTIONS*w + i] = bf.power[i];
+		}
+	}
+	*cycles /= WINDOWS;
+	printf("%-10s %d cycles/window\r\n", what, (int)*cycles);
+}
+
+int main()
+{
+	int i, p, stage, points, errors = 0;
+	int lengths[] = { 1, 2, 5, 16, 64, 100 };
+	int32_t ref[BF_DIRECTIONS*WINDOWS], powers[BF_DIRECTIONS*WINDOWS];
+	int saved[BF_STAGES];
+	unsigned cycles;
+	bf_calibration_t cal;
+
+	printf("bf_kernels test\r\n");
+	init_lve();
+
+	for (i = 0; i < sizeof(lengths)/sizeof(lengths[0]); i++) {
+		errors += test_length(lengths[i]);
+	}
+
+	points = bf_calibrate(TAPS, MAX_VL, SP_WORK, &cal);
+	printf("calibration, scalar/LVE cycles\r\n   vl");
+	for (stage = 0; stage < BF_STAGES; stage++) {
+		printf(" %13s", bf_stage_names[stage]);
+	}
+	printf("\r\n");
+	for (p = 0; p < points; p++) {
+		printf("%5d", cal.vl[p]);
+		for (stage = 0; stage < BF_STAGES; stage++) {
+			printf("  %5d/%-5d", (int)cal.scalar_cycles[stage][p], (int)cal.lve_cycles[stage][p]);
+		}
+		printf("\r\n");
+	}
+	for (stage = 0; stage < BF_STAGES; stage++) {
+		saved[stage] = bf_min_vl[stage];
+		if (bf_min_vl[stage] == BF_VL_NEVER) {
+			printf("%s stays scalar\r\n", bf_stage_names[stage]);
+		} else {
+			printf("%s on the LVE from %d\r\n", bf_stage_names[stage], bf_min_vl[stage]);
+		}
+	}
+
+	for (i = 0; i < TAPS; i++) {
+		taps[i] = (next_rand() & 0xFFF) - 0x800;
+	}
+	for (stage = 0; stage < BF_STAGES; stage++) {
+		bf_min_vl[stage] = BF_VL_NEVER;
+	}
+	run_beamformer("scalar", 0, ref, &cycles);
+	for (stage = 0; stage < BF_STAGES; stage++) {
+		bf_min_vl[stage] = 1;
+	}
+	run_beamformer("LVE", 0, powers, &cycles);
+	errors += check("LVE powers", BF_DIRECTIONS*WINDOWS, ref, powers);
+	run_beamformer("LVE sample", 1, powers, &cycles);
+	errors += check("LVE per sample powers", BF_DIRECTIONS*WINDOWS, ref, powers);
+	// the copies stay scalar and the rest goes to the LVE
+	for (stage = 0; stage < BF_STAGES; stage++) {
+		bf_min_vl[stage] = TAPS;
+	}
+	run_beamformer("mixed", 0, powers, &cycles);
+	errors += check("mixed powers", BF_DIRECTIONS*WINDOWS, ref, powers);
+	for (stage = 0; stage < BF_STAGES; stage++) {
+		bf_min_vl[stage] = saved[stage];
+	}
+	run_beamformer("dispatched", 0, powers, &cycles);
+	errors += check("dispatched powers", BF_DIRECTIONS*WINDOWS, ref, powers);
+	run_beamformer("per sample", 1, powers, &cycles);
+	errors += check("per sample powers", BF_DIRECTIONS*WINDOWS, ref, powers);
+
+	printf("DONE -- errors = %d %s\r\n\r\n", errors, errors ? "FAILED :(" : "PASSED :)");
+	return errors;
+}
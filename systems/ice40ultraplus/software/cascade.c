@@ -0,0 +1,50 @@
+#include "neural.h"
+#include "time.h"
+
+// confidence of a stage is the margin between its two highest scores
+static int score_margin(vbx_word_t *v_out)
+{
+	int c, top = v_out[0], second = v_out[1];
+	if (second > top) {
+		top = v_out[1];
+		second = v_out[0];
+	}
+	for (c = 2; c < CATEGORIES; c++) {
+		if (v_out[c] > top) {
+			second = top;
+			top = v_out[c];
+		} else if (v_out[c] > second) {
+			second = v_out[c];
+		}
+	}
+	return top - second;
+}
+
+// expects the padded input at v_in, where run_network() reads it, and keeps a
+// copy at v_in_copy for the later stages; returns the outputs of the stage
+// that exited
+vbx_word_t* run_cascade(cascade_stage_t *stages, const int num_stages,
+                        vbx_word_t *v_in, vbx_word_t *v_in_copy, const int verbose)
+{
+	int s;
+	vbx_word_t *v_out = 0;
+
+	vbx_set_vl(CASCADE_INPUT_WORDS);
+	vbx(VVW, VMOV, v_in_copy, v_in, 0);
+	for (s = 0; s < num_stages; s++) {
+		unsigned time = get_time();
+		if (s) {
+			// the previous stage used the input buffer as scratch
+			vbx_set_vl(CASCADE_INPUT_WORDS);
+			vbx(VVW, VMOV, v_in, v_in_copy, 0);
+		}
+		v_out = run_network(stages[s].network, verbose);
+		stages[s].cycles += get_time() - time;
+		stages[s].runs++;
+		if (s == num_stages-1 || score_margin(v_out) >= stages[s].threshold) {
+			stages[s].exits++;
+			break;
+		}
+	}
+	return v_out;
+}
@@ -1,14 +1,35 @@
 #include "neural.h"
 #include "time.h"
 #include "ovm7692.h"
-#include "base64.h"
+#include "img_upload.h"
 #include "sccb.h"
 #include "image_diff.h"
-#include "rgb2grayscale.h"
 
 #define USE_CAM_IMG 1
-#define PRINT_B64_IMG 0
+// The camera words' layout and the scaling the network wants, set these to
+// match ovm7692_reg.c and the training data.
+static const cam_format_t cam_format = CAM_FORMAT_DEFAULT;
+// Send every frame to get_image.py, the grayscale thumbnail with LOW_POW and
+// the network's RGB input otherwise. Packets go out during the LOW_POW idle
+// time, and whatever is left before the next capture.
+#define UPLOAD_IMG 0
 #define LOW_POW 0
+// With LOW_POW, a frame starts every frame period: capture, motion check, the
+// network when something moved, report, then the core sleeps until the next
+// one is due. Motion drops the period to FRAME_MS_MIN, each still frame adds a
+// quarter up to FRAME_MS_MAX. Active cycles per second are printed every
+// DUTY_REPORT_MS.
+#define FRAME_MS_MIN 250
+#define FRAME_MS_MAX 2000
+#define DUTY_REPORT_MS 10000
+// With LOW_POW, run the network when any 8x8 tile of the thumbnail moves
+// rather than on the whole image's difference.
+#define MOTION_TILES_GATE 1
+
+// Run a cascade of networks, each stage exits early with its result when the
+// margin between its top two scores reaches the stage's threshold.
+#define USE_CASCADE 0
+#define CASCADE_REPORT_FRAMES 16 // print per-stage statistics this often
 
 #define SP_CAM_IMG (SCRATCHPAD_BASE+0*1024)
 #define SP_NN_OUTPUT (SCRATCHPAD_BASE+4*1024) // outputs
@@ -22,64 +43,108 @@
 # endif
 #endif
 
+#if USE_CASCADE
+#define SP_CASCADE_INPUT (SP_NN_INPUTS-4*1024) // copy of the padded input, later stages start from it
+#endif
+
+#define SP_CAM_TMP (SP_NN_INPUTS+4*1024) // cam_preprocess_format() plane and row, above the padded inputs
+#define SP_CAM_GS (SP_NN_INPUTS+12*1024) // grayscale thumbnail for the motion check
+#define SP_DIFF_TMP (SP_NN_INPUTS+16*1024) // abs_image_diff() temporaries
+#if LOW_POW && (THUMBNAIL_X_OFFSET || THUMBNAIL_Y_OFFSET || THUMBNAIL_WIDTH != 32 || THUMBNAIL_HEIGHT != 32)
+# error cam_preprocess_format() makes the thumbnail from the 32x32 network input
+#endif
+
+// camera rows below the network's buffers, free from cam_preprocess_format() until
+// the next capture
+#define SP_UPLOAD SP_CAM_IMG
+#if UPLOAD_IMG && IMG_STAGE_BYTES(32,32,3) > 4*1024
+# error the upload does not fit below SP_NN_OUTPUT
+#endif
+
 #define SP_PREV_IMG_BUF1 (SCRATCHPAD_BASE+126*1024) // previous grayscale image
 #define SP_PREV_IMG_BUF2 (SCRATCHPAD_BASE+127*1024)
 
 #define MAX_FRAMES_BETWEEN_NN 2
 
-void transfer_network(layer_t *cifar, const int dst, const int src, const int verbose)
-{
-	int k, l = 0, offset = 0, koffset, dma_size, dma_pad;
-	while(1) {
-		if (cifar[l].layer_type == CONV) {
-			dma_size = (2*4 + 2*cifar[l].conv.channels);
-			dma_pad = dma_size % 4;
-
-			koffset = 0;
-			for (k=0; k < cifar[l].conv.kernels; k++) {
-				vbx_flash_dma((vbx_void_t*)(dst+offset+koffset), cifar[l].conv.weights + dma_size*k, dma_size+dma_pad);
-				koffset += dma_size+dma_pad;
-			}
-			if (verbose) {
-				printf("conv layer\r\n");
-			}
-			cifar[l].conv.weights = dst+offset;
-			offset += koffset;
+// Number of frames run through each layer while that layer's weights are in
+// the scratchpad. With more than 1 frame the activations of every frame in the
+// batch share the scratchpad with the weights; layers whose weights do not fit
+// alongside them are streamed from flash once per batch, the rest are loaded
+// once and kept.
+#define NN_BATCH_FRAMES 1
 
-			if (cifar[l].conv.last) break;
-		} else {
-			dma_size = cifar[l].dense.inputs/32*4*cifar[l].dense.outputs;
-			if(verbose){
-				printf("dense layer weights\r\n");
-			}
-			vbx_flash_dma((vbx_void_t*)(dst+offset), cifar[l].dense.weights, dma_size);
-			cifar[l].dense.weights = dst+offset;
-			offset += dma_size;
+#if NN_BATCH_FRAMES > 1
+# if LOW_POW
+#  error Can not enable Low Power and batched inference
+# endif
+#define SP_NN_BATCH_BASE (SCRATCHPAD_BASE+8*1024)   // layer weights then activations, above the camera image
+#define SP_NN_BATCH_END  (SCRATCHPAD_BASE+114*1024) // convolution_ci_lve() temporaries start here
+#define NN_BATCH_MAX_LAYERS 16
+#endif
 
-			dma_size = cifar[l].dense.outputs*4;
-			if(verbose){
-				printf("dense layer biases\r\n");
-			}
-			vbx_flash_dma((vbx_void_t*)(dst+offset), cifar[l].dense.biases, dma_size);
-			cifar[l].dense.biases = dst+offset;
-			offset += dma_size;
+// copies the weights of one layer from flash to dst and points the layer at
+// them, returns the number of bytes used at dst
+int transfer_layer(layer_t *layer, const int dst, const int verbose)
+{
+	int k, offset = 0, dma_size, dma_pad;
+	if (layer->layer_type == CONV) {
+		dma_size = (2*4 + 2*layer->conv.channels);
+		dma_pad = dma_size % 4;
+
+		for (k=0; k < layer->conv.kernels; k++) {
+			vbx_flash_dma((vbx_void_t*)(dst+offset), layer->conv.weights + dma_size*k, dma_size+dma_pad);
+			offset += dma_size+dma_pad;
+		}
+		if (verbose) {
+			printf("conv layer\r\n");
+		}
+		layer->conv.weights = dst;
+	} else {
+		dma_size = layer->dense.inputs/32*4*layer->dense.outputs;
+		if(verbose){
+			printf("dense layer weights\r\n");
+		}
+		vbx_flash_dma((vbx_void_t*)(dst+offset), layer->dense.weights, dma_size);
+		layer->dense.weights = dst+offset;
+		offset += dma_size;
 
-			dma_size = cifar[l].dense.outputs*4;
-			if (verbose) {
-				printf("dense layer scales\r\n");
-			}
-			vbx_flash_dma(((vbx_word_t*)dst)+offset/4, cifar[l].dense.scales, dma_size);
-			cifar[l].dense.scales = dst+offset;
-			offset += dma_size;
+		dma_size = layer->dense.outputs*4;
+		if(verbose){
+			printf("dense layer biases\r\n");
+		}
+		vbx_flash_dma((vbx_void_t*)(dst+offset), layer->dense.biases, dma_size);
+		layer->dense.biases = dst+offset;
+		offset += dma_size;
 
-			if (cifar[l].dense.last) break;
+		dma_size = layer->dense.outputs*4;
+		if (verbose) {
+			printf("dense layer scales\r\n");
 		}
+		vbx_flash_dma(((vbx_word_t*)dst)+offset/4, layer->dense.scales, dma_size);
+		layer->dense.scales = dst+offset;
+		offset += dma_size;
+	}
+	return offset;
+}
+
+static int layer_is_last(layer_t *layer)
+{
+	return layer->layer_type == CONV ? layer->conv.last : layer->dense.last;
+}
+
+int transfer_network(layer_t *cifar, const int dst, const int src, const int verbose)
+{
+	int l = 0, offset = 0;
+	while(1) {
+		offset += transfer_layer(&cifar[l], dst+offset, verbose);
+		if (layer_is_last(&cifar[l])) break;
 		l++;
 	}
+	return offset;
 }
 
-//expects 3 padded 32x32 byte images at SCRATCHPAD_BASE+80*1024, output @ SCRATCHPAD_BASE
-void run_network(layer_t *cifar, const int verbose)
+//expects 3 padded 32x32 byte images at SCRATCHPAD_BASE+80*1024, returns where the outputs were written
+vbx_word_t* run_network(layer_t *cifar, const int verbose)
 {
 	int l = 0, buf = 0;
 	vbx_ubyte_t* v_outb;
@@ -103,7 +168,7 @@ void run_network(layer_t *cifar, const int verbose)
 				v_outb = (vbx_ubyte_t*)SP_NN_INPUTS;
 			}
 			convolution_ci_lve(v_outb, v_padb, &(cifar[l].conv), 0);
-			if (cifar[l].conv.last) break;
+			if (cifar[l].conv.last) return (vbx_word_t*)v_outb;
 		} else {
 			if(verbose){
 				printf("dense layer\r\n");
@@ -116,7 +181,7 @@ void run_network(layer_t *cifar, const int verbose)
 				v_out = (vbx_word_t*)SP_NN_INPUTS;
 			}
 			dense_lve(v_out, v_in, &(cifar[l].dense));
-			if (cifar[l].dense.last) break;
+			if (cifar[l].dense.last) return v_out;
 		}
 		buf = !buf;
 		l++;
@@ -128,33 +193,6 @@ void run_network(layer_t *cifar, const int verbose)
 }
 
 
-#if USE_CAM_IMG
-void cam_extract_and_pad(vbx_ubyte_t* channel,vbx_word_t* rgba_in,int byte_sel,int rows,int cols,int pitch)
-{
-	int c,r;
-	//channel reverse
-	if(byte_sel==2){
-		byte_sel=0;
-	}else if(byte_sel ==0){
-		byte_sel =2;
-	}
-	for(r=0;r<rows+2;r++){
-		for(c=0;c<cols+4;c++){
-
-			int pixel;
-			if (c==0 || r==0 ||
-			    c>=cols+1 || r>=rows+1){
-				pixel=0;
-			}else {
-				pixel=rgba_in[(r-1)*pitch+(c-1)];
-			}
-			pixel=(pixel>>(byte_sel*8))&0xFF;
-			channel[r*(cols+4) + c]=pixel;
-		}
-	}
-}
-#endif
-
 void zeropad_input(vbx_ubyte_t *v_out, vbx_ubyte_t *v_in, const int m, const int n)
 {
 	// zero map
@@ -172,6 +210,260 @@ void zeropad_input(vbx_ubyte_t *v_out, vbx_ubyte_t *v_in, const int m, const int
 	}
 }
 
+#if NN_BATCH_FRAMES > 1
+static int layer_weight_bytes(layer_t *layer)
+{
+	if (layer->layer_type == CONV) {
+		int dma_size = 2*4 + 2*layer->conv.channels;
+		return layer->conv.kernels*(dma_size + dma_size%4);
+	}
+	return layer->dense.inputs/32*4*layer->dense.outputs + 2*layer->dense.outputs*4;
+}
+
+static int layer_activation_bytes(layer_t *layer)
+{
+	int in, out;
+	if (layer->layer_type == CONV) {
+		convolution_layer_t *conv = &layer->conv;
+		int m0 = conv->maxpool ? conv->m/2 : conv->m;
+		int n0 = conv->maxpool ? conv->n/2 : conv->n;
+		in = conv->channels*(conv->m+2)*(conv->n+4);
+		if (conv->zeropad_output) {
+			out = conv->kernels*(m0+2)*(n0+4);
+		} else {
+			out = conv->kernels*m0*n0*sizeof(vbx_word_t);
+		}
+	} else {
+		// dense_lve_batch() unpacks weights after the first 3*outputs words of the output
+		in = layer->dense.inputs*sizeof(vbx_word_t);
+		out = (3*layer->dense.outputs + layer->dense.inputs)*sizeof(vbx_word_t);
+	}
+	return (max(in, out)+3) & ~3;
+}
+
+typedef struct {
+	int frames;
+	int stream_buf; // where streamed layers' weights are loaded
+	int streamed_layers;
+	char streamed[NN_BATCH_MAX_LAYERS];
+	vbx_ubyte_t *v_act[2][NN_BATCH_FRAMES];
+} batch_plan_t;
+
+// Lays out, from SP_NN_BATCH_BASE up to SP_NN_BATCH_END, the weights kept
+// resident, one buffer for streamed weights and two banks of per-frame
+// activation slots. All weights stay resident if they fit next to the slots;
+// otherwise the largest layers are streamed until the rest fit, as every
+// streamed layer is read from flash again for each batch. More frames are
+// preferred over fewer streamed layers. Loads the resident weights and points
+// their layers at them. Returns the number of frames (at most NN_BATCH_FRAMES)
+// that fit.
+static int plan_batch(layer_t *network, batch_plan_t *plan)
+{
+	int weight_bytes[NN_BATCH_MAX_LAYERS];
+	int l, layers = 0, f, frames, slot_bytes = 0;
+	int avail = (int)SP_NN_BATCH_END - (int)SP_NN_BATCH_BASE;
+	int resident_bytes, stream_bytes, dst;
+	while(1) {
+		if (layers == NN_BATCH_MAX_LAYERS) {
+			return 0;
+		}
+		weight_bytes[layers] = (layer_weight_bytes(&network[layers])+3) & ~3;
+		slot_bytes = max(slot_bytes, layer_activation_bytes(&network[layers]));
+		if (layer_is_last(&network[layers++])) break;
+	}
+
+	for (frames = NN_BATCH_FRAMES; frames > 0; frames--) {
+		resident_bytes = stream_bytes = 0;
+		for (l = 0; l < layers; l++) {
+			plan->streamed[l] = 0;
+			resident_bytes += weight_bytes[l];
+		}
+		plan->streamed_layers = 0;
+		while (resident_bytes + stream_bytes + 2*frames*slot_bytes > avail) {
+			int largest = -1;
+			for (l = 0; l < layers; l++) {
+				if (!plan->streamed[l] && (largest < 0 || weight_bytes[l] > weight_bytes[largest])) {
+					largest = l;
+				}
+			}
+			if (largest < 0) break;
+			plan->streamed[largest] = 1;
+			plan->streamed_layers++;
+			resident_bytes -= weight_bytes[largest];
+			stream_bytes = max(stream_bytes, weight_bytes[largest]);
+		}
+		if (resident_bytes + stream_bytes + 2*frames*slot_bytes <= avail) break;
+	}
+	plan->frames = frames;
+	if (frames < 1) {
+		return 0;
+	}
+
+	dst = (int)SP_NN_BATCH_BASE;
+	for (l = 0; l < layers; l++) {
+		if (!plan->streamed[l]) {
+			transfer_layer(&network[l], dst, 0);
+			dst += weight_bytes[l];
+		}
+	}
+	plan->stream_buf = dst;
+	dst += stream_bytes;
+	for (f = 0; f < frames; f++) {
+		plan->v_act[0][f] = (vbx_ubyte_t*)dst + f*slot_bytes;
+		plan->v_act[1][f] = plan->v_act[0][f] + frames*slot_bytes;
+	}
+	return frames;
+}
+
+// Runs a batch of frames through the network a layer at a time, padded inputs
+// are expected in plan->v_act[0][f]. Streamed layers are read from flash once
+// per batch rather than once per frame. Returns the bank holding the outputs.
+int run_network_batch(layer_t *network, batch_plan_t *plan, const int verbose)
+{
+	int l = 0, buf = 0, last;
+	layer_t layer;
+	unsigned time;
+	while(1) {
+		if(verbose){
+			time=get_time();
+		}
+		layer = network[l];
+		if (plan->streamed[l]) {
+			// work on a copy so the network keeps its flash offsets for the next batch
+			transfer_layer(&layer, plan->stream_buf, 0);
+		}
+		if (layer.layer_type == CONV) {
+			convolution_ci_lve_batch(plan->v_act[!buf], plan->v_act[buf], plan->frames, &layer.conv);
+		} else {
+			dense_lve_batch((vbx_word_t**)plan->v_act[!buf], (vbx_word_t**)plan->v_act[buf], plan->frames, &layer.dense);
+		}
+		buf = !buf;
+		last = layer_is_last(&layer);
+		if(verbose){
+			time=get_time()-time;
+			printf("layer took %u cycles %u ms \r\n",time,cycle2ms(time));
+		}
+		if (last) break;
+		l++;
+	}
+	return buf;
+}
+
+static void cifar_batch_loop(layer_t *network, char **categories, const int verbose)
+{
+	batch_plan_t plan;
+	int f, c, out, m = 32, n = 32, frame_num = 0;
+	int frames = plan_batch(network, &plan);
+	if (frames < 1) {
+		printf("batch does not fit in scratchpad\r\n");
+		return;
+	}
+	printf("batch of %d frames, %d layers streamed from flash\r\n", frames, plan.streamed_layers);
+
+	do {
+		unsigned start_time = get_time();
+		for (f = 0; f < frames; f++) {
+#if USE_CAM_IMG
+			ovm_get_frame();
+			cam_preprocess_format(plan.v_act[0][f], 0, (vbx_word_t*)SP_CAM_IMG, m, n, CAM_IMG_WIDTH, (vbx_word_t*)SP_NN_BATCH_END, &cam_format);
+#else
+			vbx_flash_dma((vbx_word_t*)SP_CAM_IMG, GOLDEN_FLASH_DATA_OFFSET, (3*m*n)*sizeof(vbx_ubyte_t));
+			for (c = 0; c < 3; c++) {
+				zeropad_input(plan.v_act[0][f] + c*(m+2)*(n+4), (vbx_ubyte_t*)SP_CAM_IMG + c*m*n, m, n);
+			}
+#endif
+		}
+
+		out = run_network_batch(network, &plan, verbose);
+
+		unsigned net_ms = cycle2ms(get_time()-start_time);
+		for (f = 0; f < frames; f++) {
+			vbx_word_t *v_out = (vbx_word_t*)plan.v_act[out][f];
+			for (c = 0; c < CATEGORIES; c++) {
+				printf("%s\t%d\r\n", categories[c], (int)v_out[c]);
+			}
+			printf("Frame %d: %4d ms, Face Score = %d\r\n", frame_num++, net_ms/frames, (int)v_out[0]);
+		}
+	} while(USE_CAM_IMG);
+}
+#endif //#if NN_BATCH_FRAMES > 1
+
+#if USE_CASCADE
+// Stages run in order until one of them is confident, the last stage always
+// gives the result so its threshold is ignored. A small first-stage network
+// is added by describing its layers in net.c and listing it ahead of the
+// full network; all stages' weights must fit below SP_CASCADE_INPUT.
+cascade_stage_t cascade[] = {
+	{"full", 0, 0}, // the network CES_GOLDEN selects, set by cifar_lve()
+};
+#define CASCADE_STAGES ((int)(sizeof(cascade)/sizeof(cascade[0])))
+static unsigned motion_skips; // frames answered by the image_diff gate without running a stage
+
+static void cascade_report(cascade_stage_t *stages, const int num_stages, const int frames)
+{
+	int s;
+	if (LOW_POW) {
+		printf("motion gate: skipped %u\r\n", motion_skips);
+	}
+	for (s = 0; s < num_stages; s++) {
+		unsigned avg = stages[s].runs ? stages[s].cycles/stages[s].runs : 0;
+		printf("stage %s: ran %u/%d exited %u avg %u ms\r\n", stages[s].name,
+		       stages[s].runs, frames, stages[s].exits, cycle2ms(avg));
+	}
+}
+#endif //#if USE_CASCADE
+
+#if LOW_POW
+static struct {
+	unsigned start;  // of the report window
+	unsigned mark;   // when the core last woke up
+	unsigned active; // cycles awake in the window
+	unsigned frames,nn_runs;
+} duty;
+
+// Sleeps the core until wake, after sending what fits of an upload. The
+// scratchpad SPRAMs drop to standby on their own while the LVE is idle
+// (POWER_OPTIMIZED), so there is nothing else to switch off. The camera
+// polls in ovm_get_frame() sleep too but count as active here.
+static void duty_sleep(const unsigned wake)
+{
+#if UPLOAD_IMG
+	img_upload_until(wake);
+#endif
+	duty.active += get_time() - duty.mark;
+	sleepuntil(wake);
+	// cores without the sleep CSR return at once
+	while((int)(wake - get_time()) > 0){
+	}
+	duty.mark = get_time();
+}
+
+static void duty_report(const int frame_ms)
+{
+	unsigned now = get_time();
+	unsigned window_ms = cycle2ms(now - duty.start);
+	if(window_ms < DUTY_REPORT_MS){
+		return;
+	}
+	duty.active += now - duty.mark;
+	printf("Duty: %u active cycles/s, %u%% awake, network on %u of %u frames, %u active cycles per run, period %d ms\r\n",
+	       duty.active/window_ms*1000, duty.active/((now - duty.start)/100), duty.nn_runs, duty.frames,
+	       duty.nn_runs ? duty.active/duty.nn_runs : 0, frame_ms);
+	duty.start = duty.mark = now;
+	duty.active = duty.frames = duty.nn_runs = 0;
+}
+
+// Ends a frame that started at start, returns when the next one starts.
+static unsigned duty_frame_end(const unsigned start, const int frame_ms, const int ran_nn)
+{
+	duty.frames++;
+	duty.nn_runs += ran_nn;
+	duty_report(frame_ms);
+	duty_sleep(start + ms2cycle(frame_ms));
+	return get_time();
+}
+#endif //#if LOW_POW
+
 void cifar_lve() {
 
 	printf("CES demo\r\nLattice\r\ncategories:\r\n");
@@ -185,11 +477,10 @@ void cifar_lve() {
 	ovm_initialize();
 #endif
 	int face_score = 0;
+#if LOW_POW
 	int frames_since_last_run = MAX_FRAMES_BETWEEN_NN;
+#endif
 	int frame_num=0;
-#if USE_CAM_IMG
-	int is_face=0;
-#endif //#if USE_CAM_IMG
 	int c, m = 32, n = 32, verbose = 0;
 	vbx_ubyte_t* v_padb = (vbx_ubyte_t*)SP_NN_INPUTS; // IMPORTANT: padded input placed here
 	vbx_word_t* v_out = (vbx_word_t*)  SP_NN_OUTPUT; // IMPORTANT: 10 outputs produced here
@@ -197,6 +488,7 @@ void cifar_lve() {
 #if LOW_POW
 	vbx_ubyte_t* v_prev_img = (vbx_ubyte_t*)SP_PREV_IMG_BUF1;
 	vbx_ubyte_t* v_prev_buf = (vbx_ubyte_t*)SP_PREV_IMG_BUF2;
+	int frame_ms = FRAME_MS_MIN;
 #endif
 
 #if CATEGORIES == 10
@@ -222,57 +514,82 @@ void cifar_lve() {
 	}
 
 	layer_t* network=CES_GOLDEN? cifar_golden:cifar_reduced;
+#if NN_BATCH_FRAMES > 1
+	cifar_batch_loop(network, categories, verbose);
+	return;
+#endif
+#if USE_CASCADE
+	int s, weight_bytes = 0;
+	cascade[CASCADE_STAGES-1].network = network;
+	for (s = 0; s < CASCADE_STAGES; s++) {
+		weight_bytes += transfer_network(cascade[s].network, (int)SP_NN_WEIGHTS + weight_bytes, 0, verbose);
+	}
+	if ((int)SP_NN_WEIGHTS + weight_bytes > (int)SP_CASCADE_INPUT) {
+		printf("cascade weights do not fit in scratchpad\r\n");
+		return;
+	}
+#else
 	transfer_network(network, (int)SP_NN_WEIGHTS, REDUCED_FLASH_DATA_OFFSET, verbose);
+#endif
 
 #if USE_CAM_IMG
 	/* ovm_get_frame_async(); */
 #endif
 	unsigned start_time=get_time();
+#if LOW_POW
+	duty.start = duty.mark = start_time;
+#endif
 	do{
 
 
 
 #if USE_CAM_IMG
 
+#if UPLOAD_IMG
+		// the capture overwrites the staged frame
+		unsigned upload_time=get_time();
+		img_upload_flush();
+		//adjust start_time to elimate time spent sending the last frame
+		start_time+=get_time()-upload_time;
+#endif
+
 		//get camera frame
 		/* ovm_wait_frame(); */
 		ovm_get_frame();
 
-#if PRINT_B64_IMG
-
-		//print base64 encoding of rgb image
-		char* rgb_plane = (char*)v_padb;
-		int b64_time=get_time();
-		int row,col;
-		for(row=0;row<30;row++){
-			for(col=0;col<32;col++){
-				rgb_plane[3*(row*32+col)+0]= v_inb[4*(row*64+col) +0];
-				rgb_plane[3*(row*32+col)+1]= v_inb[4*(row*64+col) +1];
-				rgb_plane[3*(row*32+col)+2]= v_inb[4*(row*64+col) +2];
-
-			}
-		}
-
-		printf("base64:");
-		print_base64((char*)rgb_plane,3*32*32);
-		printf("\r\n");
-		b64_time=get_time()-b64_time;
-		//adjust start_time to elimate time spent printing base64 image
-		start_time+=b64_time;
+		vbx_word_t* v_in_gs = 0;
+#if LOW_POW && !GS_CAM
+		v_in_gs = (vbx_word_t*)SP_CAM_GS;
 #endif
+		cam_preprocess_format(v_padb, v_in_gs, (vbx_word_t*)v_inb, m, n, CAM_IMG_WIDTH, (vbx_word_t*)SP_CAM_TMP, &cam_format);
 #if LOW_POW
-		int img_diff_score = 0;
+		uint32_t img_diff_score = 0;
+		int moved;
 #if GS_CAM
-		img_diff_score = abs_image_diff(v_inb + THUMBNAIL_X_OFFSET*CAM_IMG_WIDTH+THUMBNAIL_Y_OFFSET,v_prev_img,v_prev_buf);
+		vbx_ubyte_t* v_cur = v_inb + THUMBNAIL_X_OFFSET*CAM_IMG_WIDTH+THUMBNAIL_Y_OFFSET;
 #else
-		vbx_word_t* v_in_gs = (vbx_word_t*)SP_NN_INPUTS;
-		convert_rgb2grayscale((vbx_word_t*)(v_inb)+THUMBNAIL_X_OFFSET*CAM_IMG_WIDTH+THUMBNAIL_Y_OFFSET,v_in_gs);
-		img_diff_score = abs_image_diff(v_in_gs,v_prev_img,v_prev_buf);
+		vbx_word_t* v_cur = v_in_gs;
 #endif
-#endif
-		for (c = 0; c < 3; c++) {
-			cam_extract_and_pad(v_padb + c*(m+2)*(n+4), (vbx_word_t*)v_inb,c, m, n, 64);
+#if MOTION_TILES_GATE
+		motion_map_t motion;
+		moved = motion_map(v_cur,v_prev_img,v_prev_buf,MOTION_TILE_THRESH,&motion,(vbx_word_t*)SP_DIFF_TMP);
+		img_diff_score = motion.total;
+		if(moved){
+			printf("Motion tiles %04x, box %d,%d to %d,%d\r\n",(int)motion.bitmap,motion.x0,motion.y0,motion.x1,motion.y1);
 		}
+#else
+		moved = abs_image_diff(v_cur,v_prev_img,v_prev_buf,DIFF_THRESH,&img_diff_score,(vbx_word_t*)SP_DIFF_TMP);
+#endif
+#endif
+#if UPLOAD_IMG
+#if LOW_POW
+		// the thumbnail the motion check just packed
+		img_t frame = {v_prev_buf, THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT, 1, 1, THUMBNAIL_WIDTH, 1};
+#else
+		img_t frame = {v_padb + (n+4) + 1, n, m, 3, 1, n+4, (m+2)*(n+4)};
+#endif
+		img_upload_start((uint8_t*)SP_UPLOAD, &frame, IMG_DELTA4);
+#endif
 		/* ovm_get_frame_async(); */
 
 #else
@@ -288,24 +605,39 @@ void cifar_lve() {
 #endif
 
 #if LOW_POW
-		printf("Image Diff Score = 0x%08x\r\n",img_diff_score);
+		// abs_image_diff() stops counting once the score passes the threshold
+		printf("Image Diff Score = 0x%08x%s\r\n",(int)img_diff_score,moved ? "+" : "");
 		// check if we want to run the NN
-		if(img_diff_score > DIFF_THRESH || frames_since_last_run >= MAX_FRAMES_BETWEEN_NN){
+		if(moved){
+			frame_ms = FRAME_MS_MIN;
+		}else{
+			frame_ms = min(frame_ms + frame_ms/4, FRAME_MS_MAX);
+		}
+		if(moved || frames_since_last_run >= MAX_FRAMES_BETWEEN_NN){
 			vbx_ubyte_t* tmp = v_prev_img;
 			v_prev_img = v_prev_buf;
 			v_prev_buf = tmp;
 
 			// run the network
+#if USE_CASCADE
+			v_out = run_cascade(cascade, CASCADE_STAGES, (vbx_word_t*)SP_NN_INPUTS, (vbx_word_t*)SP_CASCADE_INPUT, verbose);
+#else
 			run_network(network,verbose);
+#endif
 			// reset the counter
 			frames_since_last_run = 0;
 			face_score = (int)v_out[0];
 		}else{
-			delayms(300);
+#if USE_CASCADE
+			motion_skips++;
+#endif
 			frames_since_last_run++;
+			start_time = duty_frame_end(start_time, frame_ms, 0);
 			continue;
 		}
 
+#elif USE_CASCADE
+		v_out = run_cascade(cascade, CASCADE_STAGES, (vbx_word_t*)SP_NN_INPUTS, (vbx_word_t*)SP_CASCADE_INPUT, verbose);
 #else
 		run_network(network, verbose);
 #endif
@@ -326,16 +658,19 @@ void cifar_lve() {
 		unsigned net_cycles=get_time()-start_time;
 		unsigned net_ms=cycle2ms(net_cycles);
 
-		if(LOW_POW && net_ms <999){
-			delayms(999-net_ms);
-		}
-
-		net_cycles=get_time()-start_time;
-		net_ms=cycle2ms(net_cycles);
-
 		printf("Frame %d: %4d ms, Face Score = %d\r\n",frame_num,net_ms,face_score);
+#if USE_CASCADE
+		if ((frame_num+1) % CASCADE_REPORT_FRAMES == 0) {
+			cascade_report(cascade, CASCADE_STAGES, frame_num+1);
+		}
+#endif
 
+#if LOW_POW
+		// after the frame time is taken, so it leaves out the sleep
+		start_time = duty_frame_end(start_time, frame_ms, 1);
+#else
 		start_time = get_time();
+#endif
 		frame_num++;
 
 	} while(USE_CAM_IMG);
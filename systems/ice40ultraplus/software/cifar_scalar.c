@@ -117,7 +117,7 @@ void scalar_convolve_ci(vbx_half_t *v_out, vbx_ubyte_t *v_in, vbx_half_t *v_conv
   int i, j, ki, kj, value;
   short sum0, sum1;
   for (j = 0; j < m; j++) {
-    for (i = 0; i < m; i+=2) {
+    for (i = 0; i < n; i+=2) {
       sum0 = 0;
       sum1 = 0;
       for (kj = 0; kj < 3; kj++) {
@@ -132,8 +132,8 @@ void scalar_convolve_ci(vbx_half_t *v_out, vbx_ubyte_t *v_in, vbx_half_t *v_conv
 	  }
 	}
       }
-      v_out[j*m+i]   += sum0;
-      v_out[j*m+i+1] += sum1;
+      v_out[j*n+i]   += sum0;
+      v_out[j*n+i+1] += sum1;
     }
   }
 }
@@ -162,7 +162,85 @@ void scalar_zeropad_ci(vbx_ubyte_t *v_out, vbx_word_t *v_in, const int m, const
     }
 }
 
-// called once every 16 channels (touches data 3x)
+// red, green and blue of pixel x of a row of camera words, as the vector
+// build works them out, before the scaling
+static void cam_pixel(const cam_format_t *fmt, const vbx_word_t *row, const int x, int *rgb)
+{
+    uint32_t w;
+    int c, f;
+    static const int yuv_u[3] = {0, -88, 454};
+    static const int yuv_v[3] = {359, -183, 0};
+
+    switch (fmt->format) {
+    case CAM_XRGB:
+	w = row[x];
+	rgb[0] = (w >> 16) & 0xFF;
+	rgb[1] = (w >> 8) & 0xFF;
+	rgb[2] = w & 0xFF;
+	break;
+    case CAM_RGBA:
+	w = row[x];
+	rgb[0] = w & 0xFF;
+	rgb[1] = (w >> 8) & 0xFF;
+	rgb[2] = (w >> 16) & 0xFF;
+	break;
+    case CAM_RGB565:
+	w = (uint32_t)row[x/2] >> (16*(x&1));
+	f = (w >> 11) & 0x1F;
+	rgb[0] = (f*33) >> 2;
+	f = (w >> 5) & 0x3F;
+	rgb[1] = (f*65) >> 4;
+	f = w & 0x1F;
+	rgb[2] = (f*33) >> 2;
+	break;
+    default: {
+	w = row[x/2];
+	int y = (w >> (16*(x&1))) & 0xFF, u = (int)((w >> 8) & 0xFF) - 128, v = (int)(w >> 24) - 128;
+	for (c = 0; c < 3; c++) {
+	    rgb[c] = ((y << 16) + (1 << 15) + 256*yuv_u[c]*u + 256*yuv_v[c]*v) >> 16;
+	}
+	break;
+    }
+    }
+}
+
+void cam_preprocess(vbx_ubyte_t *v_padb, vbx_word_t *v_gs, vbx_word_t *v_rgba,
+                    const int rows, const int cols, const int pitch, vbx_word_t *v_tmp)
+{
+    static const cam_format_t fmt = CAM_FORMAT_DEFAULT;
+    cam_preprocess_format(v_padb, v_gs, v_rgba, rows, cols, pitch, v_tmp, &fmt);
+}
+
+void cam_preprocess_format(vbx_ubyte_t *v_padb, vbx_word_t *v_gs, vbx_word_t *v_cam,
+                           const int rows, const int cols, const int pitch, vbx_word_t *v_tmp,
+                           const cam_format_t *fmt)
+{
+    int c, j, i, rgb[3];
+    for (c = 0; c < 3; c++) {
+      vbx_ubyte_t *v_out = v_padb + c*(rows+2)*(cols+4);
+      for (j = 0; j < rows+2; j++) {
+	for (i = 0; i < cols+4; i++) {
+	  v_out[j*(cols+4)+i] = 0;
+	}
+      }
+    }
+
+    for (j = 0; j < rows; j++) {
+      for (i = 0; i < cols; i++) {
+	cam_pixel(fmt, v_cam + j*pitch, fmt->flip ? cols-1-i : i, rgb);
+	if (v_gs) {
+	  v_gs[j*cols+i] = (66*rgb[0] + 129*rgb[1] + 25*rgb[2] + 128) >> 8;
+	}
+	for (c = 0; c < 3; c++) {
+	  int v = (((rgb[c] - fmt->mean[c])*fmt->scale[c]) >> 8) + fmt->offset[c];
+	  v_padb[c*(rows+2)*(cols+4) + (j+1)*(cols+4) + i+1] = v > 255 ? 255 : v < 0 ? 0 : v;
+	}
+      }
+    }
+}
+
+// called once every 13 channels (touches data 3x), as in the vector build,
+// so the halfword sums wrap identically
 void scalar_accumulate_columns(vbx_word_t *v_map, vbx_half_t *v_maph, const int m, const int n) 
 {
   int i;
@@ -214,24 +292,25 @@ void convolution_ci_lve(vbx_ubyte_t *v_outb, vbx_ubyte_t *v_inb, convolution_lay
 
 	for (c = 0; c < layer->channels; c++) {
 	    scalar_convolve_ci(v_maph, v_inb + c*(m+2)*(n+4), (vbx_half_t*)v_tmp, m, n, v_weights[c]);
-	    if ((c+1)%16 == 0) {
+	    if ((c+1)%13 == 0) {
 	      scalar_accumulate_columns(v_map, v_maph, m, n);
 	    }
 	}
-	if (layer->channels % 16) {
+	if (layer->channels % 13) {
 	    scalar_accumulate_columns(v_map, v_maph, m , n);
 	}
 
 	if (layer->maxpool) {
-	    scalar_pool(v_map, m, n);
+	    scalar_pool(v_map, n, m);
 	}
 
 	vbx_set_vl(m0*n0);
 	if (layer->scale) {
+	    // prescaled by 1 << 32 when feeding another conv, a plain multiplier otherwise
 	    long long mul;
 	    for (i = 0; i < m0*n0; i++) {
 	      mul = (long long)v_map[i] * (long long)v_dma[buf][1];
-	      v_map[i] = (int)(mul >> 32);
+	      v_map[i] = layer->zeropad_output ? (int)(mul >> 32) : (int)mul;
 	    }
 	}
 
@@ -253,3 +332,20 @@ void convolution_ci_lve(vbx_ubyte_t *v_outb, vbx_ubyte_t *v_inb, convolution_lay
 	buf = !buf;
     }
 }
+
+// no weight reuse to exploit in the scalar build, run each frame in turn
+void convolution_ci_lve_batch(vbx_ubyte_t **v_outb, vbx_ubyte_t **v_inb, const int frames, convolution_layer_t *layer)
+{
+    int f;
+    for (f = 0; f < frames; f++) {
+	convolution_ci_lve(v_outb[f], v_inb[f], layer, 0);
+    }
+}
+
+void dense_lve_batch(vbx_word_t **v_out, vbx_word_t **v_in, const int frames, dense_layer_t *layer)
+{
+    int f;
+    for (f = 0; f < frames; f++) {
+	dense_lve(v_out[f], v_in[f], layer);
+    }
+}
@@ -22,6 +22,9 @@ __attribute__((unused)) static  int channel_sumw(vbx_word_t* chan,int size) {
 	return sum;
 }
 
+// assumes 128K scratch, convolution_ci_lve() temporaries up to 32x32 maps
+#define CONV_TEMP ((vbx_word_t*)(SCRATCHPAD_BASE + 114*1024))
+
 void vbx_flash_dma(vbx_word_t *v_dst, int flash_byte_offset, const int bytes)
 {
 	flash_dma_trans(flash_byte_offset, (void*)v_dst, bytes);
@@ -115,6 +118,200 @@ void vbx_zeropad_ci(vbx_ubyte_t *v_out, vbx_word_t *v_pad, vbx_word_t *v_in, con
 	}
 }
 
+// grayscale weights of convert_rgb2grayscale(), red, green, blue
+static const int gs_weights[3] = {66, 129, 25};
+
+// byte of each channel in the one pixel formats
+static const int xrgb_shift[3] = {16, 8, 0};
+static const int rgba_shift[3] = {0, 8, 16};
+// RGB565 fields, lowest bit and width
+static const int rgb565_lo[3] = {11, 5, 0};
+static const int rgb565_bits[3] = {5, 6, 5};
+// U and V weights of each channel in 1/256, R = Y + 1.402V', G = Y - 0.344U' - 0.714V', B = Y + 1.772U'
+static const int yuv_u[3] = {0, -88, 454};
+static const int yuv_v[3] = {359, -183, 0};
+
+// Adds weight/256 of the U (bits 15:8) or V (bits 31:24) of each camera word
+// of a row to both of its pixels in the plane, scaled by 1<<16.
+static void yuv_add_chroma(vbx_word_t *v_left, vbx_word_t *v_row, vbx_word_t *v_cam,
+                           const int step, const int is_v, const int weight)
+{
+	const int w = weight < 0 ? -weight : weight;
+	vbx_set_2D(sizeof(vbx_word_t), 0, sizeof(vbx_word_t));
+	if (is_v) {
+		vbx(SVW, VMULH, v_row, 1 << 8, v_cam);
+		vbx(SVW, VAND, v_row, 0xFF, v_row);
+		vbx(SVW, VMUL, v_row, w << 8, v_row);
+	} else {
+		vbx(SVW, VAND, v_row, 0xFF00, v_cam);
+		vbx(SVW, VMUL, v_row, w, v_row);
+	}
+	vbx_set_2D(2*step*sizeof(vbx_word_t), 2*step*sizeof(vbx_word_t), sizeof(vbx_word_t));
+	if (weight < 0) {
+		vbx(VVW, VSUB, v_left, v_left, v_row);
+		vbx(VVW, VSUB, v_left + step, v_left + step, v_row);
+	} else {
+		vbx(VVW, VADD, v_left, v_left, v_row);
+		vbx(VVW, VADD, v_left + step, v_left + step, v_row);
+	}
+}
+
+// Leaves channel c of every pixel in the inside of the padded word plane.
+// Whole frames go in one 2D op when the words map straight onto the plane,
+// mirrored frames and the two pixel formats take a few ops a row, with the
+// 2D rows one element long so the plane can be walked backwards or every
+// other word.
+static void cam_extract(vbx_word_t *v_plane, vbx_word_t *v_row, vbx_word_t *v_cam, const int rows,
+                        const int cols, const int pitch, const cam_format_t *fmt, const int c)
+{
+	int y;
+	const int padded = (cols+4)*sizeof(vbx_word_t);
+	const int step = fmt->flip ? -1 : 1;
+	const int first = fmt->flip ? cols-1 : 0;
+
+	if (fmt->format == CAM_XRGB || fmt->format == CAM_RGBA) {
+		const int shift = (fmt->format == CAM_RGBA ? rgba_shift : xrgb_shift)[c];
+		if (fmt->flip) {
+			vbx_set_vl(1, cols);
+			vbx_set_2D(-(int)sizeof(vbx_word_t), 0, sizeof(vbx_word_t));
+			for (y = 0; y < rows; y++) {
+				vbx(SVW, VAND, v_plane + y*(cols+4) + first, 0xFF << shift, v_cam + y*pitch);
+			}
+		} else {
+			vbx_set_vl(cols, rows);
+			vbx_set_2D(padded, 0, pitch*sizeof(vbx_word_t));
+			vbx(SVW, VAND, v_plane, 0xFF << shift, v_cam);
+		}
+		vbx_set_vl(cols, rows);
+		vbx_set_2D(padded, 0, padded);
+		if (shift) {
+			vbx(SVW, VMULH, v_plane, 1 << (32-shift), v_plane);
+		}
+		return;
+	}
+
+	// the left pixel of each word goes to even columns, the right one to odd
+	// columns: the low half of the word masked to the channel, and the high
+	// half sign extended, which the mask after it takes care of
+	const int mask = fmt->format == CAM_RGB565 ? ((1 << rgb565_bits[c]) - 1) << rgb565_lo[c] : 0xFF;
+	vbx_set_vl(1, cols/2);
+	vbx_set_2D(2*step*sizeof(vbx_word_t), 0, sizeof(vbx_word_t));
+	for (y = 0; y < rows; y++) {
+		vbx_word_t *v_left = v_plane + y*(cols+4) + first;
+		vbx(SVW, VAND, v_left, mask, v_cam + y*pitch);
+		vbx(SVW, VMULH, v_left + step, 1 << 16, v_cam + y*pitch);
+	}
+
+	vbx_set_vl(cols, rows);
+	vbx_set_2D(padded, 0, padded);
+	vbx(SVW, VAND, v_plane, mask, v_plane);
+	if (fmt->format == CAM_RGB565) {
+		// 5 bits to 8 is f*33 >> 2, 6 bits f*65 >> 4
+		const int five = rgb565_bits[c] == 5;
+		vbx(SVW, VMUL, v_plane, five ? 33 : 65, v_plane);
+		vbx(SVW, VMULH, v_plane, 1 << (32 - rgb565_lo[c] - (five ? 2 : 4)), v_plane);
+		return;
+	}
+
+	// Y scaled by 1<<16, plus the rounding and the -128 of U and V
+	vbx(SVW, VMUL, v_plane, 1 << 16, v_plane);
+	vbx(SVW, VADD, v_plane, (1 << 15) - 128*256*(yuv_u[c] + yuv_v[c]), v_plane);
+	vbx_set_vl(1, cols/2);
+	for (y = 0; y < rows; y++) {
+		vbx_word_t *v_left = v_plane + y*(cols+4) + first;
+		if (yuv_u[c]) {
+			yuv_add_chroma(v_left, v_row, v_cam + y*pitch, step, 0, yuv_u[c]);
+		}
+		if (yuv_v[c]) {
+			yuv_add_chroma(v_left, v_row, v_cam + y*pitch, step, 1, yuv_v[c]);
+		}
+	}
+	vbx_set_vl(cols, rows);
+	vbx_set_2D(padded, 0, padded);
+	vbx(SVW, VMULH, v_plane, 1 << 16, v_plane);
+}
+
+void cam_preprocess(vbx_ubyte_t *v_padb, vbx_word_t *v_gs, vbx_word_t *v_rgba,
+                    const int rows, const int cols, const int pitch, vbx_word_t *v_tmp)
+{
+	static const cam_format_t fmt = CAM_FORMAT_DEFAULT;
+	cam_preprocess_format(v_padb, v_gs, v_rgba, rows, cols, pitch, v_tmp, &fmt);
+}
+
+// One channel at a time: cam_extract() pulls the channel out of the camera
+// words into the inside of a padded word plane whose border stays zero, the
+// plane is scaled, one VCUSTOM0 saturates the whole plane to bytes, then the
+// plane is weighted into the grayscale image. VCUSTOM0 starts each op at byte
+// lane 0, so cols has to keep the planes word aligned.
+void cam_preprocess_format(vbx_ubyte_t *v_padb, vbx_word_t *v_gs, vbx_word_t *v_cam,
+                           const int rows, const int cols, const int pitch, vbx_word_t *v_tmp,
+                           const cam_format_t *fmt)
+{
+	int c, y;
+	const int padded = (cols+4)*sizeof(vbx_word_t);
+	vbx_word_t *v_plane = v_tmp + (cols+4) + 1;
+	vbx_word_t *v_row = v_tmp + (rows+2)*(cols+4); // a row past the plane
+
+	// zero the top and bottom rows, then the right columns with the next
+	// row's left column
+	vbx_set_vl(cols+4, 2);
+	vbx_set_2D((rows+1)*padded, 0, (rows+1)*padded);
+	vbx(SVW, VAND, v_tmp, 0, v_tmp);
+	vbx_set_vl(4, rows+1);
+	vbx_set_2D(padded, 0, padded);
+	vbx(SVW, VAND, v_tmp + cols+1, 0, v_tmp + cols+1);
+
+	for (c = 0; c < 3; c++) {
+		const int scaled = fmt->scale[c] != 256;
+		const int offset = !scaled && fmt->mean[c] != fmt->offset[c];
+
+		cam_extract(v_plane, v_row, v_cam, rows, cols, pitch, fmt, c);
+
+		if (v_gs && c == 0) {
+			vbx_set_vl(cols, rows);
+			vbx_set_2D(cols*sizeof(vbx_word_t), 0, padded);
+			vbx(SVW, VMUL, v_gs, gs_weights[c], v_plane);
+		} else if (v_gs && (scaled || offset)) {
+			// the plane is about to change, weigh it a row at a time
+			vbx_set_vl(cols);
+			for (y = 0; y < rows; y++) {
+				vbx(SVW, VMUL, v_row, gs_weights[c], v_plane + y*(cols+4));
+				vbx(VVW, VADD, v_gs + y*cols, v_gs + y*cols, v_row);
+			}
+		}
+
+		vbx_set_vl(cols, rows);
+		vbx_set_2D(padded, 0, padded);
+		if (scaled) {
+			vbx(SVW, VMUL, v_plane, fmt->scale[c], v_plane);
+			vbx(SVW, VADD, v_plane, fmt->offset[c]*256 - fmt->mean[c]*fmt->scale[c], v_plane);
+			vbx(SVW, VMULH, v_plane, 1 << 24, v_plane);
+		} else if (offset) {
+			vbx(SVW, VADD, v_plane, fmt->offset[c] - fmt->mean[c], v_plane);
+		}
+
+		vbx_set_vl(1, (rows+2)*(cols+4));
+		vbx_set_2D(sizeof(vbx_byte_t), sizeof(vbx_word_t), sizeof(vbx_word_t));
+		vbx(VVW, VCUSTOM0, (vbx_word_t*)(v_padb + c*(rows+2)*(cols+4)), v_tmp, 0);
+
+		if (!v_gs || c == 0 || scaled || offset) {
+			continue;
+		}
+		vbx_set_vl(cols, rows);
+		vbx_set_2D(padded, 0, padded);
+		vbx(SVW, VMUL, v_plane, gs_weights[c], v_plane);
+		vbx_set_2D(cols*sizeof(vbx_word_t), cols*sizeof(vbx_word_t), padded);
+		vbx(VVW, VADD, v_gs, v_gs, v_plane);
+	}
+
+	if (v_gs) {
+		// round to 8 bits
+		vbx_set_vl(rows*cols);
+		vbx(SVW, VADD, v_gs, 128, v_gs);
+		vbx(SVW, VMULH, v_gs, 1<<24, v_gs);
+	}
+}
+
 void vbx_accumulate_columns(vbx_word_t *v_map, vbx_half_t *v_maph, vbx_word_t *v_tmp, const int m, const int n)
 {
 	// add each packed column to output
@@ -134,95 +331,218 @@ void vbx_accumulate_columns(vbx_word_t *v_map, vbx_half_t *v_maph, vbx_word_t *v
 	vbx(SVW, VAND, (vbx_word_t*)v_maph, 0, (vbx_word_t*)v_maph);
 }
 
-// takes in padded inputs
+// bytes of temporaries convolution_ci_kernel_lve() uses from v_map onwards
+static int conv_temp_bytes(const int m, const int n)
+{
+	// v_map words, v_maph halves, then v_tmp which holds either the halfword
+	// convolution rows or the unpacked columns in vbx_accumulate_columns()
+	return m*n*sizeof(vbx_word_t) + m*n*sizeof(vbx_half_t) + max(m*n*sizeof(vbx_word_t), (m+2)*(n+4)*sizeof(vbx_half_t));
+}
 
-void convolution_ci_lve(vbx_ubyte_t *v_outb, vbx_ubyte_t *v_inb, convolution_layer_t *layer, const int debuglayer)
+// takes in padded inputs
+// runs a single kernel of a layer, layer weights must already be in the scratchpad
+static void convolution_ci_kernel_lve(vbx_ubyte_t *v_outb, vbx_ubyte_t *v_inb, convolution_layer_t *layer, const int k, vbx_word_t *v_map)
 {
-	int c, k, m = layer->m, n = layer->n, m0 = m, n0 = n;
+	int c, m = layer->m, n = layer->n, m0 = m, n0 = n;
 	if (layer->maxpool) {
 		m0 = m/2; n0 = n/2;
 	}
 
 	int32_t bias, scale;
 
-	// assumes 128K scratch
-	vbx_word_t *v_map = (vbx_word_t*)(SCRATCHPAD_BASE + 114*1024);
-	vbx_half_t *v_maph = (vbx_half_t*)(SCRATCHPAD_BASE + 118*1024);
-	vbx_word_t *v_tmp = (vbx_word_t*)(SCRATCHPAD_BASE + 120*1024);
+	vbx_half_t *v_maph = (vbx_half_t*)(v_map + m*n);
+	vbx_word_t *v_tmp = (vbx_word_t*)(v_maph + m*n);
 	int dma_size = 2*4 + layer->channels*2;
 	int dma_pad = dma_size % 4;
 	vbx_word_t *v_packed;
 	vbx_uhalf_t *v_weights;
 
+	v_packed = (vbx_word_t*)(layer->weights + k*(dma_size+dma_pad));
+	bias = v_packed[0];
+	scale = v_packed[1];
+	v_weights = (vbx_uhalf_t*)(v_packed + 2);
+
+	// set kernel bias
+	vbx_set_vl(n*m);
+	vbx(SVW, VAND, v_map, 0, v_map);
+	vbx(SVW, VOR, v_map, bias, v_map);
+
+	vbx_set_vl(n/2*m);
+	vbx(SVW, VAND, (vbx_word_t*)v_maph, 0, (vbx_word_t*)v_maph);
+
+	for (c = 0; c < layer->channels; c++) {
+		vbx_convolve_ci(v_maph, v_inb + c*(m+2)*(n+4), (vbx_half_t*)v_tmp, m, n, v_weights[c]);
+		if ((c+1)%13 == 0) {
+			vbx_accumulate_columns(v_map, v_maph, v_tmp, m, n);
+		}
+	}
+	if (layer->channels % 13) {
+		vbx_accumulate_columns(v_map, v_maph, v_tmp, m , n);
+	}
+	if (layer->maxpool) {
+		vbx_pool(v_map, v_tmp, n, m);
+	}
+	vbx_set_vl(m0*n0);
+	if (layer->scale) {
+		if (layer->zeropad_output) {
+			vbx(SVW, VMULH, v_map, scale, v_map);
+		} else {
+			vbx(SVW, VMUL, v_map, scale, v_map);
+		}
+	}
+	if (!layer->zeropad_output && layer->activation_type == RELU) {
+		vbx_relu(v_map, v_tmp);
+	}
+	if (layer->zeropad_output) {
+		vbx_zeropad_ci(v_outb+(k*(n0+4)*(m0+2)), v_tmp, v_map, m0, n0);
+	} else {
+		vbx_set_vl(m0*n0);
+		vbx(VVW, VMOV, (vbx_word_t*)v_outb+(k*n0*m0),v_map,0);
+	}
+}
+
+void convolution_ci_lve(vbx_ubyte_t *v_outb, vbx_ubyte_t *v_inb, convolution_layer_t *layer, const int debuglayer)
+{
+	int k;
+	for (k = 0; k < layer->kernels; k++) {
+		convolution_ci_kernel_lve(v_outb, v_inb, layer, k, CONV_TEMP);
+	}
+}
+
+// kernel-outer/frame-inner so each kernel's weights are used for every frame
+// in the batch before moving on to the next kernel
+void convolution_ci_lve_batch(vbx_ubyte_t **v_outb, vbx_ubyte_t **v_inb, const int frames, convolution_layer_t *layer)
+{
+	int k, f;
 	for (k = 0; k < layer->kernels; k++) {
-		v_packed = (vbx_word_t*)(layer->weights + k*(dma_size+dma_pad));
-		bias = v_packed[0];
-		scale = v_packed[1];
-		v_weights = (vbx_uhalf_t*)(v_packed + 2);
+		for (f = 0; f < frames; f++) {
+			convolution_ci_kernel_lve(v_outb[f], v_inb[f], layer, k, CONV_TEMP);
+		}
+	}
+}
+
+void tile_fetch_mem(vbx_void_t *v_dst, const int src, const int bytes)
+{
+	int i;
+	for (i = 0; i < bytes/4; i++) {
+		((vbx_word_t*)v_dst)[i] = ((vbx_word_t*)src)[i];
+	}
+}
+
+void tile_store_mem(const int dst, vbx_void_t *v_src, const int bytes)
+{
+	tile_fetch_mem((vbx_void_t*)dst, (int)v_src, bytes);
+}
+
+void tile_fetch_flash(vbx_void_t *v_dst, const int src, const int bytes)
+{
+	vbx_flash_dma((vbx_word_t*)v_dst, src, bytes);
+}
 
-		// set kernel bias
-		vbx_set_vl(n*m);
-		vbx(SVW, VAND, v_map, 0, v_map);
-		vbx(SVW, VOR, v_map, bias, v_map);
+static int conv_band_bytes(convolution_layer_t *layer, const int rows, int *in_bytes, int *out_bytes)
+{
+	int rows0 = layer->maxpool ? rows/2 : rows;
+	int n0 = layer->maxpool ? layer->n/2 : layer->n;
+	*in_bytes = (layer->channels*(rows+2)*(layer->n+4) + 3) & ~3;
+	if (layer->zeropad_output) {
+		*out_bytes = (layer->kernels*(rows0+2)*(n0+4) + 3) & ~3;
+	} else {
+		*out_bytes = layer->kernels*rows0*n0*sizeof(vbx_word_t);
+	}
+	return *in_bytes + *out_bytes + conv_temp_bytes(rows, layer->n);
+}
+
+// Row-band tiled convolution_ci_lve() for layers whose padded input, output
+// and temporaries don't fit in the scratchpad together. src and dst hold the
+// whole padded input and output tensors in the same layouts convolution_ci_lve()
+// uses; each band of input rows plus its one row halo above and below is
+// brought in with fetch, and the finished output rows are written back with
+// store. Bands are as tall as fit in the work_bytes at v_work. Returns the band
+// height used, or 0 if not even the smallest band fits.
+//
+// The caller sizes the work area because nothing here knows what is free: the
+// cifar code lays the scratchpad out with fixed SP_* addresses rather than
+// vbx_sp_alloc(), whose pointer stays at the base, and the scratchpad size is
+// a property of the bitstream, not of vbx.h. Anything above v_work, such as
+// the weights of the next layers or the camera buffers, may still be live, so
+// pass the bytes up to the next buffer the caller is keeping.
+int convolution_ci_lve_tiled(const int dst, const int src, convolution_layer_t *layer,
+                             tile_fetch_t fetch, tile_store_t store, vbx_void_t *v_work, const int work_bytes)
+{
+	int c, k, r, band, first, last, in_bytes, out_bytes;
+	int m = layer->m, n = layer->n, step = layer->maxpool ? 2 : 1;
+	int m0 = m/step, n0 = n/step;
+	convolution_layer_t tile = *layer;
+
+	for (band = m; band > 0 && conv_band_bytes(layer, band, &in_bytes, &out_bytes) > work_bytes; band -= step);
+	if (band <= 0) {
+		return 0;
+	}
+	vbx_ubyte_t *v_inb = (vbx_ubyte_t*)v_work;
+	vbx_ubyte_t *v_outb = v_inb + in_bytes;
+	vbx_word_t *v_map = (vbx_word_t*)(v_outb + out_bytes);
 
-		vbx_set_vl(n/2*m);
-		vbx(SVW, VAND, (vbx_word_t*)v_maph, 0, (vbx_word_t*)v_maph);
+	for (r = 0; r < m; r += band) {
+		tile.m = min(band, m-r);
+		int r0 = r/step, rows0 = tile.m/step;
 
+		// padded rows r to r+tile.m+1 include the halo rows above and below
 		for (c = 0; c < layer->channels; c++) {
-			vbx_convolve_ci(v_maph, v_inb + c*(m+2)*(n+4), (vbx_half_t*)v_tmp, m, n, v_weights[c]);
-			if ((c+1)%13 == 0) {
-				vbx_accumulate_columns(v_map, v_maph, v_tmp, m, n);
-			}
+			fetch(v_inb + c*(tile.m+2)*(n+4), src + (c*(m+2) + r)*(n+4), (tile.m+2)*(n+4));
 		}
-		if (layer->channels % 13) {
-			vbx_accumulate_columns(v_map, v_maph, v_tmp, m , n);
+		for (k = 0; k < layer->kernels; k++) {
+			convolution_ci_kernel_lve(v_outb, v_inb, &tile, k, v_map);
 		}
-		if (layer->maxpool) {
-			vbx_pool(v_map, v_tmp, m, n);
-		}
-		vbx_set_vl(m0*n0);
-		if (layer->scale) {
+
+		for (k = 0; k < layer->kernels; k++) {
 			if (layer->zeropad_output) {
-				vbx(SVW, VMULH, v_map, scale, v_map);
+				// band row i is padded output row r0+i, the band's zero rows
+				// only become the border at the top and bottom of the map
+				first = r ? 1 : 0;
+				last = (r+tile.m < m) ? rows0 : rows0+1;
+				store(dst + (k*(m0+2) + r0 + first)*(n0+4),
+				      v_outb + (k*(rows0+2) + first)*(n0+4), (last-first+1)*(n0+4));
 			} else {
-				vbx(SVW, VMUL, v_map, scale, v_map);
+				store(dst + (k*m0*n0 + r0*n0)*sizeof(vbx_word_t),
+				      (vbx_word_t*)v_outb + k*rows0*n0, rows0*n0*sizeof(vbx_word_t));
 			}
 		}
-		if (!layer->zeropad_output && layer->activation_type == RELU) {
-			vbx_relu(v_map, v_tmp);
-		}
-		if (layer->zeropad_output) {
-			vbx_zeropad_ci(v_outb+(k*(n0+4)*(m0+2)), v_tmp, v_map, m0, n0);
-		} else {
-			vbx_set_vl(m0*n0);
-			vbx(VVW, VMOV, (vbx_word_t*)v_outb+(k*n0*m0),v_map,0);
-		}
 	}
+	return band;
 }
 
-void dense_lve(vbx_word_t *v_out, vbx_word_t *v_in, dense_layer_t *layer)
+// unpacked weights are shared by all frames and placed after the outputs of frame 0
+void dense_lve_batch(vbx_word_t **v_out, vbx_word_t **v_in, const int frames, dense_layer_t *layer)
 {
-	int x;
+	int x, f;
 	vbx_word_t *v_biases  = (vbx_word_t *)layer->biases;
 	vbx_word_t *v_scales  = (vbx_word_t *)layer->scales;
 	vbx_word_t *v_packed = (vbx_word_t *)layer->weights; // packed into 32x
-	vbx_word_t *v_weights = v_out + layer->outputs*3;
-	vbx_word_t *v_relu = v_in;
+	vbx_word_t *v_weights = v_out[0] + layer->outputs*3;
 
 	for (x = 0; x < layer->outputs; x++) {
 		vbx_unpack_weights(v_weights, v_packed + x*layer->inputs/32, layer->inputs);
 		vbx_set_vl(layer->inputs);
-		vbx_acc(VVW, VMUL, v_out + x, v_in, v_weights);
+		for (f = 0; f < frames; f++) {
+			vbx_acc(VVW, VMUL, v_out[f] + x, v_in[f], v_weights);
+		}
 	}
 
 	vbx_set_vl(layer->outputs);
-	vbx(VVW, VADD, v_out, v_out, v_biases);
+	for (f = 0; f < frames; f++) {
+		vbx(VVW, VADD, v_out[f], v_out[f], v_biases);
 
-	if (layer->scale) {
-		vbx(VVW, VMULH, v_out, v_out, v_scales);
-	}
+		if (layer->scale) {
+			vbx(VVW, VMULH, v_out[f], v_out[f], v_scales);
+		}
 
-	if (layer->activation_type == RELU) {
-		vbx_relu(v_out, v_relu);
+		if (layer->activation_type == RELU) {
+			vbx_relu(v_out[f], v_in[f]);
+		}
 	}
 }
+
+void dense_lve(vbx_word_t *v_out, vbx_word_t *v_in, dense_layer_t *layer)
+{
+	dense_lve_batch(&v_out, &v_in, 1, layer);
+}
@@ -5,14 +5,66 @@ SW_PROJ ?= cifar_vector
 
 ifeq ($(SW_PROJ), cifar_vector)
   C_MAIN = main.c cifar_main.c cifar_vector.c net.c
-  C_LINK = base64.c sccb.c ovm7692.c  rgb2grayscale.c image_diff.c flash_dma.c
+  C_LINK = base64.c img_upload.c sccb.c ovm7692.c image_diff.c flash_dma.c cascade.c
 else ifeq ($(SW_PROJ), cifar_scalar)
   C_MAIN = main.c cifar_main.c cifar_scalar.c net.c
-  C_LINK = base64.c sccb.c ovm7692.c
+  C_LINK = base64.c img_upload.c sccb.c ovm7692.c cascade.c
+else ifeq ($(SW_PROJ), sccb)
+  C_MAIN = test_sccb.c
+  C_LINK = sccb.c
+else ifeq ($(SW_PROJ), ovm_stream)
+  C_MAIN = ovm_stream_test.c
+  C_LINK = sccb.c ovm7692.c
+else ifeq ($(SW_PROJ), image_diff)
+  C_MAIN = image_diff_test.c
+  C_LINK = image_diff.c
+else ifeq ($(SW_PROJ), img_upload)
+  C_MAIN = img_upload_test.c
+  C_LINK = img_upload.c base64.c
 else ifeq ($(SW_PROJ), lve_test)
   C_MAIN = lve_test.c
   C_LINK =
 else ifeq ($(SW_PROJ), conv)
   C_MAIN = conv_ci_test.c
   C_LINK =
+else ifeq ($(SW_PROJ), conv_tiled)
+  C_MAIN = conv_tiled_test.c cifar_vector.c
+  C_LINK = flash_dma.c
+else ifeq ($(SW_PROJ), vbx_nn)
+  C_MAIN = vbx_nn_test.c
+  C_LINK = vbx_nn.c
+else ifeq ($(SW_PROJ), beamform)
+  C_MAIN = beamform_test.c
+  C_LINK = beamform.c
+  vpath %.c ../../../software/apps/beamforming
+  INCLUDE_DIRS += ../../../software/apps/beamforming
+else ifeq ($(SW_PROJ), mic_capture)
+  C_MAIN = mic_capture_test.c
+  C_LINK = i2s.c
+else ifeq ($(SW_PROJ), audio_ring)
+  C_MAIN = audio_ring_test.c
+  C_LINK = i2s.c
+else ifeq ($(SW_PROJ), fft)
+  C_MAIN = vbx_fft_test.c
+  C_LINK = vbx_fft.c
+else ifeq ($(SW_PROJ), resample)
+  C_MAIN = resample_test.c
+  C_LINK = vbx_resample.c resample_taps.c
+  vpath %.c ../../../software/apps/beamforming
+  INCLUDE_DIRS += ../../../software/apps/beamforming
+else ifeq ($(SW_PROJ), bf_kernels)
+  C_MAIN = bf_kernels_test.c
+  C_LINK = bf_kernels.c
+  vpath %.c ../../../software/apps/beamforming
+  INCLUDE_DIRS += ../../../software/apps/beamforming
+else ifeq ($(SW_PROJ), beamforming_scalar)
+  C_MAIN = beamforming_scalar.c
+  C_LINK = i2s.c fir.c bf_kernels.c samples.c
+  vpath %.c ../../../software/apps/beamforming
+  INCLUDE_DIRS += ../../../software/apps/beamforming
+else ifeq ($(SW_PROJ), beamform_replay)
+  C_MAIN = beamform_replay.c
+  C_LINK = fir.c bf_kernels.c replay.c replay_samples.c flash_dma.c
+  vpath %.c ../../../software/apps/beamforming
+  INCLUDE_DIRS += ../../../software/apps/beamforming
 endif
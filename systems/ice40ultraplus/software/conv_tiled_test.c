@@ -0,0 +1,98 @@
+#include "printf.h"
+#include "vbx.h"
+#include "neural.h"
+
+// Checks convolution_ci_lve_tiled() against convolution_ci_lve() on a map that
+// fits in one go, with work areas small enough to force several row bands.
+#define TEST_M        16
+#define TEST_N        16
+#define TEST_CHANNELS 3
+#define TEST_KERNELS  4
+
+#define SP_INPUT ((int)SCRATCHPAD_BASE + 0*1024)
+#define SP_WEIGHTS ((int)SCRATCHPAD_BASE + 2*1024)
+#define SP_REF ((int)SCRATCHPAD_BASE + 4*1024)
+#define SP_TILED ((int)SCRATCHPAD_BASE + 8*1024)
+#define SP_WORK ((int)SCRATCHPAD_BASE + 16*1024)
+
+static unsigned seed = 0x1234567;
+static unsigned next_rand()
+{
+	seed = seed*1103515245 + 12345;
+	return seed >> 8;
+}
+
+static void init_inputs(const int scale)
+{
+	int c, i, j, k;
+	vbx_ubyte_t *v_in = (vbx_ubyte_t*)SP_INPUT;
+	for (c = 0; c < TEST_CHANNELS; c++) {
+		for (i = 0; i < TEST_M+2; i++) {
+			for (j = 0; j < TEST_N+4; j++) {
+				int pad = i == 0 || i > TEST_M || j == 0 || j > TEST_N;
+				*v_in++ = pad ? 0 : next_rand() & 0xFF;
+			}
+		}
+	}
+
+	// bias, scale and a 9 bit weight per channel, padded to words
+	vbx_word_t *v_w = (vbx_word_t*)SP_WEIGHTS;
+	for (k = 0; k < TEST_KERNELS; k++) {
+		v_w[0] = (int)(next_rand() & 0x3FF) - 0x200;
+		v_w[1] = scale;
+		vbx_uhalf_t *v_h = (vbx_uhalf_t*)(v_w + 2);
+		for (c = 0; c < TEST_CHANNELS; c++) {
+			v_h[c] = next_rand() & 0x1FF;
+		}
+		v_w += 2 + (TEST_CHANNELS*2 + 3)/4;
+	}
+}
+
+static int test_tiled(const char *name, convolution_layer_t *layer, const int work_bytes, const int out_bytes)
+{
+	int i, band, errors = 0;
+	vbx_ubyte_t *ref = (vbx_ubyte_t*)SP_REF;
+	vbx_ubyte_t *tiled = (vbx_ubyte_t*)SP_TILED;
+
+	convolution_ci_lve(ref, (vbx_ubyte_t*)SP_INPUT, layer, 0);
+
+	// garbage so missed rows show up
+	for (i = 0; i < out_bytes; i++) {
+		tiled[i] = 0xA5;
+	}
+	band = convolution_ci_lve_tiled(SP_TILED, SP_INPUT, layer, tile_fetch_mem, tile_store_mem,
+	                                (vbx_void_t*)SP_WORK, work_bytes);
+	if (!band) {
+		printf("%s: no band fits in %d bytes\r\n", name, work_bytes);
+		return 1;
+	}
+	for (i = 0; i < out_bytes; i++) {
+		if (ref[i] != tiled[i]) {
+			if (errors < 8) {
+				printf("ERROR @ %d: %x != %x\r\n", i, (int)ref[i], (int)tiled[i]);
+			}
+			errors++;
+		}
+	}
+	printf("%s (%d row bands) %s\r\n", name, band, errors ? "Failed" : "Passed");
+	return errors;
+}
+
+int main()
+{
+	int errors = 0;
+	init_lve();
+
+	convolution_layer_t pooled = {CONV, LINEAR, 0, TEST_M, TEST_N, TEST_CHANNELS, TEST_KERNELS, 1, SP_WEIGHTS, 1, 1};
+	init_inputs(1 << 24);
+	// bands of 4 rows divide the map, bands of 6 leave a short last band
+	errors += test_tiled("pooled zeropad 4", &pooled, 1200, TEST_KERNELS*(TEST_M/2+2)*(TEST_N/2+4));
+	errors += test_tiled("pooled zeropad 6", &pooled, 1700, TEST_KERNELS*(TEST_M/2+2)*(TEST_N/2+4));
+
+	convolution_layer_t flat = {CONV, RELU, 0, TEST_M, TEST_N, TEST_CHANNELS, TEST_KERNELS, 0, SP_WEIGHTS, 1, 0};
+	init_inputs(1);
+	errors += test_tiled("relu words", &flat, 2400, TEST_KERNELS*TEST_M*TEST_N*sizeof(vbx_word_t));
+
+	printf("DONE -- errors = %d %s\r\n\r\n", errors, errors ? "FAILED :(" : "PASSED :)");
+	return errors;
+}
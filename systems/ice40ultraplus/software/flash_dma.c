@@ -16,17 +16,16 @@ static uint8_t __attribute__((unused)) spi_get_bit(volatile uint32_t* pio,uint32
 static uint8_t __attribute__((unused)) spi_xfer_byte(volatile uint32_t* pio,
                                                      uint8_t write)
 {
+	//No delays between edges: the PIO accesses alone keep SCLK well under
+	//the flash's limit, and a sleep per edge would make loading the network
+	//weights take seconds.
 	uint8_t ret=0;
-	sleepus(5);
 	for(int i=7;i>=0;--i){
-		sleepus(5);
 		spi_set_bit(pio,SPI_SCLK,0);
 		spi_set_bit(pio,SPI_MOSI,write&(1<<i));
-		sleepus(5);
 		spi_set_bit(pio,SPI_SCLK,1);
 		ret |= spi_get_bit(pio,SPI_MISO)<<i;
 	}
-	sleepus(5);
 	spi_set_bit(pio,SPI_SCLK,0);
 
 	return ret;
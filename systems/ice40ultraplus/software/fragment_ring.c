@@ -11,17 +11,29 @@
 	 } } while(0)
 
 
+// The main loop of beamforming.c and beamforming_scalar.c, included into
+// their main(). It expects bf set up for WINDOW_LENGTH samples and
+// bf_window_init() done; beamforming_scalar.c keeps every stage scalar.
+// BLOCK_FIR 0 filters each sample as it arrives instead of the whole window at
+// once, to compare the samples/s of the two.
+
 // These counters add hysteresis to the system, improving output stability 
 int center_count = 0;
 int left_count = 0;
 int right_count = 0;
 int window_count = 0;
 
-// This is a temp variable used when breaking up vector instructions.
-int fir_acc_l_temp = 0;
-int fir_acc_r_temp = 0; 
+#if TRACK_TIME
+// Cycles spent on the windows, and the samples in them, since the last report.
+unsigned bf_cycles = 0;
+int bf_samples = 0;
+#if !BLOCK_FIR
+unsigned fir_start;
+#endif
+#endif
 
 int position;
+int direction;
 
 
 while (1) {
@@ -29,8 +41,10 @@ while (1) {
 #if TRACK_TIME
   int time; 
 #endif
-  // Collect WINDOW_LENGTH samples.
-  // Apply the FIR filter after acquiring each sample.
+  // Collect WINDOW_LENGTH samples, appended to the linear history that holds
+  // the last NUM_TAPS - 1 samples of the previous window. With BLOCK_FIR the
+  // whole window is filtered at once afterwards, otherwise each sample is
+  // filtered after acquiring it.
   // FIR filter is symmetric, applying cross-correlation is simpler than
   // convolution (no need for array flipping).
 
@@ -46,16 +60,19 @@ while (1) {
   time = get_time();
 #endif
 
+#if !BLOCK_FIR
+  bf_window_start(&bf);
+#endif
   for (i = 0; i < WINDOW_LENGTH; i++) {
-    // Insert new sample into the ring buffer.
+    // Insert new sample into the history.
 #if USE_MICS
 	  i2s_data_t mic_data;
 	  mic_data=i2s_get_data();
-	  mic_buffer_l[buffer_count] = mic_data.left;
-	  mic_buffer_r[buffer_count] = mic_data.right;
+	  bf.v_mic_l[NUM_TAPS - 1 + i] = mic_data.left;
+	  bf.v_mic_r[NUM_TAPS - 1 + i] = mic_data.right;
 #else
-	  mic_buffer_l[buffer_count] = samples_l[sample_count];
-	  mic_buffer_r[buffer_count] = samples_r[sample_count];
+	  bf.v_mic_l[NUM_TAPS - 1 + i] = samples_l[sample_count];
+	  bf.v_mic_r[NUM_TAPS - 1 + i] = samples_r[sample_count];
 
  	  sample_count++;
  	  if (sample_count >= NUM_SAMPLES) {
@@ -63,40 +80,16 @@ while (1) {
  	  }
 #endif
 
-    // Check if vector instructions need to be broken up.
-    if ((buffer_count + 1) - NUM_TAPS < 0) {
-      int taps_offset = NUM_TAPS - (buffer_count + 1);
-      vbx_word_t *v_fir_taps_end = v_fir_taps + taps_offset;
-      vbx_word_t *mic_buffer_end_l = mic_buffer_l + BUFFER_LENGTH - taps_offset;
-      vbx_word_t *mic_buffer_end_r = mic_buffer_r + BUFFER_LENGTH - taps_offset;
-       
-      vbx_set_vl(buffer_count + 1);
-      vbx_acc(VVWS, VMUL, fir_acc_l, mic_buffer_l, v_fir_taps_end);
-      fir_acc_l_temp = *fir_acc_l;
-      vbx_acc(VVWS, VMUL, fir_acc_r, mic_buffer_r, v_fir_taps_end);
-      fir_acc_r_temp = *fir_acc_r;
-
-      vbx_set_vl(taps_offset);
-      vbx_acc(VVWS, VMUL, fir_acc_l, mic_buffer_end_l, v_fir_taps);
-      *fir_acc_l += fir_acc_l_temp;
-      vbx_acc(VVWS, VMUL, fir_acc_r, mic_buffer_end_r, v_fir_taps);
-      *fir_acc_r += fir_acc_r_temp;
-    }
-    
-    else {
-      int buffer_offset = buffer_count - (NUM_TAPS - 1);
-      vbx_set_vl(NUM_TAPS);
-      vbx_acc(VVWS, VMUL, fir_acc_l, mic_buffer_l + buffer_offset, v_fir_taps);
-      vbx_acc(VVWS, VMUL, fir_acc_r, mic_buffer_r + buffer_offset, v_fir_taps);
-    }
-    
-    v_filtered_l[buffer_count] = (*fir_acc_l) >> FIR_PRECISION;
-    v_filtered_r[buffer_count] = (*fir_acc_r) >> FIR_PRECISION;
-
- 	  buffer_count++;
- 	  if (buffer_count >= BUFFER_LENGTH) {
-      buffer_count = 0;
- 	  }
+#if !BLOCK_FIR
+#if TRACK_TIME
+    fir_start = get_time();
+#endif
+    bf_fir(bf.v_sound_l + SAMPLE_DIFFERENCE + i, bf.v_mic_l + i, bf.v_taps, NUM_TAPS, 1, bf.fir_shift, bf.v_tmp);
+    bf_fir(bf.v_sound_r + SAMPLE_DIFFERENCE + i, bf.v_mic_r + i, bf.v_taps, NUM_TAPS, 1, bf.fir_shift, bf.v_tmp);
+#if TRACK_TIME
+    bf_cycles += get_time() - fir_start;
+#endif
+#endif
   }
 
 #if TRACK_TIME
@@ -107,51 +100,25 @@ while (1) {
   time = get_time();
 #endif
 
-  transfer_offset = buffer_count - WINDOW_LENGTH - SAMPLE_DIFFERENCE;
-  if (transfer_offset < 0) {
-	 transfer_offset += BUFFER_LENGTH;
-  }
-
-  vbx_set_vl(SAMPLE_DIFFERENCE);
-  vbx(SVWS, VADD, sound_vector_l, 0, (v_filtered_l + transfer_offset));
-  vbx(SVWS, VADD, sound_vector_r, 0, (v_filtered_r + transfer_offset));
-
-  transfer_offset = buffer_count - WINDOW_LENGTH;
-  if (transfer_offset < 0) {
-	 transfer_offset += BUFFER_LENGTH;
-  }
-
-  // MOV mic_buffer to sound_vector
-  vbx_set_vl(WINDOW_LENGTH);
-  vbx(SVWS, VADD, (sound_vector_l + SAMPLE_DIFFERENCE), 0, (v_filtered_l + transfer_offset));
-  vbx(SVWS, VADD, (sound_vector_r + SAMPLE_DIFFERENCE), 0, (v_filtered_r + transfer_offset));
-
-  // Calculate the power assuming the sound is coming from the center.
-  vbx(VVWS, VADD, sum_vector, (sound_vector_l + SAMPLE_DIFFERENCE), (sound_vector_r + SAMPLE_DIFFERENCE));
-  vbx(SVWS, VMULH, sum_vector, PRESCALE_MUL, sum_vector);
-  vbx_acc(VVWS, VMUL, power_center, sum_vector, sum_vector);
-
-  // Calculate the power assuming the sound is coming from the left (right microphone is
-  // delayed during sampling, so delay left microphone to compensate).
-  vbx(VVWS, VADD, sum_vector, sound_vector_l, (sound_vector_r + SAMPLE_DIFFERENCE));
-  vbx(SVWS, VMULH, sum_vector, PRESCALE_MUL, sum_vector);
-  vbx_acc(VVWS, VMUL, power_left, sum_vector, sum_vector);
-
-  // Calculate the power assuming the sound is coming from the right (left microphone is delayed
-  // during sampling, so delay right microphone to compensate).
-  vbx(VVWS, VADD, sum_vector, (sound_vector_l + SAMPLE_DIFFERENCE), sound_vector_r);
-  vbx(SVWS, VMULH, sum_vector, PRESCALE_MUL, sum_vector);
-  vbx_acc(VVWS, VMUL, power_right, sum_vector, sum_vector);
+  // Filter both microphones and take the power of each direction.
+#if BLOCK_FIR
+  direction = bf_window(&bf);
+#else
+  direction = bf_window_finish(&bf);
+#endif
 
 #if TRACK_TIME
   time = get_time() - time;
+  bf_cycles += time;
+  bf_samples += WINDOW_LENGTH;
   scratch_write(time);
 #endif
     
 #if !USE_PRINT
-  scratch_write(*power_center); 
-  scratch_write(*power_right); 
-  scratch_write(*power_left); 
+  scratch_write(bf.power[BF_CENTRE]); 
+  scratch_write(bf.power[BF_RIGHT]); 
+  scratch_write(bf.power[BF_LEFT]); 
+  scratch_write(direction);
 #endif
 
 #if USE_PRINT
@@ -162,33 +129,14 @@ while (1) {
 
   window_count++;
 
-  if (*power_center > *power_left) {
-	  if (*power_center > *power_right) {
-      center_count++;
-#if !USE_PRINT
-      scratch_write(0);    
-#endif
-	  }
-	  else {
-      right_count++;
-#if !USE_PRINT
-      scratch_write(1);
-#endif
-	  }
+  if (direction == BF_CENTRE) {
+    center_count++;
+  }
+  else if (direction == BF_LEFT) {
+    left_count++;
   }
   else {
-	  if (*power_left > *power_right) {
-      left_count++;
-#if !USE_PRINT
-      scratch_write(2);
-#endif
-	  }
-	  else {
-      right_count++;
-#if !USE_PRINT
-      scratch_write(1);
-#endif
-	  }
+    right_count++;
   }
 
 #define WINDOWS_PER_QUARTERSECOND SAMPLE_RATE / 4 / WINDOW_LENGTH 
@@ -215,6 +163,13 @@ while (1) {
     right_count >>= 2;
 #if USE_PRINT
     printf(position_str[position]);
+#endif
+#if TRACK_TIME && USE_PRINT
+    // Samples per microphone, both are filtered in that time.
+    printf("window %d cycles, %d samples/s\r\n", bf_cycles / WINDOWS_PER_QUARTERSECOND,
+           bf_samples * (SYS_CLK / 100) / (bf_cycles / 100));
+    bf_cycles = 0;
+    bf_samples = 0;
 #endif
   }
   
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Receives the frames img_upload.c sends and writes them out as PGM/PPM.
+
+    get_image.py [--port /dev/ttyUSB0] [--raw] [--out frames]
+    get_image.py --file capture.log [--raw]
+
+Text between the packets is passed through to stdout. --raw reads the
+binary packets of IMG_UPLOAD_RAW 1, the default the "IMG " base64 lines.
+"""
+import argparse
+import base64
+import os
+import sys
+
+IMG_SYNC = b'\xa5\x5a'
+IMG_HEADER_BYTES = 12
+IMG_NONE, IMG_RLE, IMG_DELTA_RLE, IMG_DELTA4 = range(4)
+
+
+def unpackbits(data, size):
+    out = bytearray()
+    i = 0
+    while i < len(data) and len(out) < size:
+        n = data[i] - 256 if data[i] > 127 else data[i]
+        i += 1
+        if n >= 0:
+            out += data[i:i + n + 1]
+            i += n + 1
+        elif n != -128:
+            out += bytes([data[i]]) * (1 - n)
+            i += 1
+    return out
+
+
+def unpack_nibbles(data, size):
+    nibbles = []
+    for b in data:
+        nibbles += [b >> 4, b & 0xF]
+    out = bytearray()
+    i = 0
+    while len(out) < size:
+        if nibbles[i] == 8:
+            out.append(nibbles[i + 1] << 4 | nibbles[i + 2])
+            i += 3
+        else:
+            out.append(nibbles[i] & 0xFF if nibbles[i] < 8 else nibbles[i] + 240)
+            i += 1
+    return out
+
+
+def undelta(data, width, channels):
+    row = width * channels
+    for i in range(len(data)):
+        if (i // channels) % width:
+            data[i] = (data[i] + data[i - channels]) & 0xFF
+        elif i >= row:
+            data[i] = (data[i] + data[i - row]) & 0xFF
+    return data
+
+
+def decode_frame(frame):
+    if frame[0:2] != b'IM':
+        raise ValueError('bad frame header')
+    channels, compress, number = frame[2], frame[3], frame[4]
+    width = frame[6] | frame[7] << 8
+    height = frame[8] | frame[9] << 8
+    data = frame[IMG_HEADER_BYTES:]
+    size = width * height * channels
+    if compress == IMG_NONE:
+        pixels = bytearray(data)
+    elif compress == IMG_RLE:
+        pixels = unpackbits(data, size)
+    elif compress == IMG_DELTA_RLE:
+        pixels = undelta(unpackbits(data, size), width, channels)
+    elif compress == IMG_DELTA4:
+        pixels = undelta(unpack_nibbles(data, size), width, channels)
+    else:
+        raise ValueError('unknown compression %d' % compress)
+    if len(pixels) != size:
+        raise ValueError('frame has %d bytes, expected %d' % (len(pixels), size))
+    return number, width, height, channels, compress, pixels
+
+
+def packet_body(body):
+    """seq, payload, or None when the checksum is wrong"""
+    if len(body) < 3 or len(body) != body[1] + 3 or sum(body[:-1]) & 0xFF != body[-1]:
+        return None
+    return body[0], body[2:-1]
+
+
+def packets_base64(stream):
+    for line in stream:
+        i = line.find(b'IMG ')
+        if i < 0:
+            sys.stdout.write(line.decode('ascii', 'replace'))
+            continue
+        sys.stdout.write(line[:i].decode('ascii', 'replace'))
+        try:
+            body = bytearray(base64.b64decode(line[i + 4:].strip()))
+        except ValueError:
+            body = b''
+        yield packet_body(body)
+
+
+def packets_raw(stream):
+    text = bytearray()
+    while True:
+        c = stream.read(1)
+        if not c:
+            return
+        text += c
+        if text[-2:] != IMG_SYNC:
+            if c == b'\n':
+                sys.stdout.write(text.decode('ascii', 'replace'))
+                text = bytearray()
+            continue
+        sys.stdout.write(text[:-2].decode('ascii', 'replace'))
+        text = bytearray()
+        head = stream.read(2)
+        if len(head) < 2:
+            return
+        body = bytearray(head) + stream.read(head[1] + 1)
+        yield packet_body(body)
+
+
+def receive(packets, out_dir):
+    frame, seq = None, 0
+    for packet in packets:
+        if packet is None:
+            sys.stderr.write('bad packet, dropping frame\n')
+            frame = None
+            continue
+        if packet[0] == 0:
+            frame, seq = bytearray(), 0
+        if frame is None or packet[0] != seq:
+            frame = None
+            continue
+        frame += packet[1]
+        seq += 1
+        if len(frame) < IMG_HEADER_BYTES or len(frame) < IMG_HEADER_BYTES + (frame[10] | frame[11] << 8):
+            continue
+
+        try:
+            number, width, height, channels, compress, pixels = decode_frame(frame)
+        except ValueError as e:
+            sys.stderr.write('%s\n' % e)
+            frame = None
+            continue
+        name = os.path.join(out_dir, 'frame_%03d.%s' % (number, 'pgm' if channels == 1 else 'ppm'))
+        with open(name, 'wb') as f:
+            f.write(b'P%d\n%d %d\n255\n' % (5 if channels == 1 else 6, width, height))
+            f.write(bytes(pixels))
+        sys.stderr.write('%s: %dx%d, %d bytes sent for %d\n' %
+                         (name, width, height, len(frame), len(pixels)))
+        frame = None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--port', default='/dev/ttyUSB0')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--file', help='read a capture instead of the serial port')
+    parser.add_argument('--raw', action='store_true', help='binary packets, IMG_UPLOAD_RAW 1')
+    parser.add_argument('--out', default='.', help='directory for the frames')
+    args = parser.parse_args()
+
+    if args.file:
+        stream = open(args.file, 'rb')
+    else:
+        import serial
+        stream = serial.Serial(args.port, args.baud)
+    with stream:
+        packets = packets_raw(stream) if args.raw else packets_base64(stream)
+        try:
+            receive(packets, args.out)
+        except KeyboardInterrupt:
+            pass
+
+
+if __name__ == '__main__':
+    main()
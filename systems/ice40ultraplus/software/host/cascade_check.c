@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <string.h>
+#include "neural.h"
+
+// Host check of run_cascade() in cascade.c on a synthetic two stage table.
+// run_network() is replaced by a stand-in that answers each stage with scores
+// set up by the case and scribbles over the input like the real layers do,
+// so a later stage also shows whether it got the input back.
+//
+// usage: cascade_check
+
+#define SP_IN      ((vbx_word_t*)SCRATCHPAD_BASE + 0)
+#define SP_IN_COPY ((vbx_word_t*)SCRATCHPAD_BASE + 4*1024)
+#define SP_OUT     ((vbx_word_t*)SCRATCHPAD_BASE + 8*1024)
+
+static layer_t first_net[1], full_net[1];
+static int scores[2][CATEGORIES];
+static int input_ok[2];
+static int failures;
+
+static void fill_input(vbx_word_t *v_in)
+{
+	int i;
+	for (i = 0; i < CASCADE_INPUT_WORDS; i++) {
+		v_in[i] = i*2654435761u;
+	}
+}
+
+static int check_input(vbx_word_t *v_in)
+{
+	int i;
+	for (i = 0; i < CASCADE_INPUT_WORDS; i++) {
+		if (v_in[i] != (vbx_word_t)(i*2654435761u)) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+vbx_word_t* run_network(layer_t *cifar, const int verbose)
+{
+	int stage = cifar == full_net, c;
+	input_ok[stage] = check_input(SP_IN);
+	memset(SP_IN, 0xA5, CASCADE_INPUT_WORDS*sizeof(vbx_word_t));
+	for (c = 0; c < CATEGORIES; c++) {
+		SP_OUT[c] = scores[stage][c];
+	}
+	return SP_OUT;
+}
+
+static void expect(const char *name, const int cond)
+{
+	if (!cond) {
+		printf("  %s FAILED\n", name);
+		failures++;
+	}
+}
+
+// first stage scores a and b with the exit threshold at 10
+static void check_case(const char *name, const int a, const int b, const int exits_early)
+{
+	cascade_stage_t stages[] = {
+		{"first", first_net, 10},
+		{"full", full_net, 1000}, // ignored, the last stage always answers
+	};
+	int c;
+	vbx_word_t *v_out;
+
+	for (c = 0; c < CATEGORIES; c++) {
+		scores[0][c] = scores[1][c] = -100;
+	}
+	scores[0][0] = a;
+	scores[0][1] = b;
+	scores[1][1] = 7;
+	input_ok[0] = input_ok[1] = -1;
+	fill_input(SP_IN);
+
+	printf("%s\n", name);
+	v_out = run_cascade(stages, 2, SP_IN, SP_IN_COPY, 0);
+	expect("first stage ran once", stages[0].runs == 1);
+	expect("first stage got the input", input_ok[0] == 1);
+	if (exits_early) {
+		expect("first stage exited", stages[0].exits == 1);
+		expect("full stage skipped", stages[1].runs == 0 && input_ok[1] == -1);
+		expect("first stage's scores returned", v_out[0] == a && v_out[1] == b);
+	} else {
+		expect("first stage did not exit", stages[0].exits == 0);
+		expect("full stage ran and exited", stages[1].runs == 1 && stages[1].exits == 1);
+		expect("full stage got the input back", input_ok[1] == 1);
+		expect("full stage's scores returned", v_out[1] == 7);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	init_lve();
+	check_case("confident first stage exits early", 40, 25, 1);
+	check_case("margin on the threshold exits early", 5, 15, 1);
+	check_case("unsure first stage falls through", 20, 11, 0);
+	printf("%d failures\n", failures);
+	return failures != 0;
+}
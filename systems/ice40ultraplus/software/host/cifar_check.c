@@ -0,0 +1,425 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "neural.h"
+
+// Host harness comparing the LVE kernels in cifar_vector.c (run on lve_emu)
+// with the plain C versions in cifar_scalar.c, bit exactly, layer by layer.
+// The flash image is checked against golden.c first, then the reduced net is
+// run on the golden image followed by layers with random weight blobs.
+// The scalar build's layer functions are renamed scalar_* by the Makefile.
+//
+// usage: cifar_check [iterations [seed]]
+
+void scalar_convolution_ci_lve(vbx_ubyte_t *v_outb, vbx_ubyte_t *v_inb, convolution_layer_t *layer, const int debug);
+void scalar_dense_lve(vbx_word_t *v_out, vbx_word_t *v_in, dense_layer_t *layer);
+void scalar_pool(vbx_word_t *v_out, const int width, const int height);
+void scalar_zeropad_ci(vbx_ubyte_t *v_out, vbx_word_t *v_in, const int m, const int n);
+void scalar_cam_preprocess(vbx_ubyte_t *v_padb, vbx_word_t *v_gs, vbx_word_t *v_rgba,
+                           const int rows, const int cols, const int pitch, vbx_word_t *v_tmp);
+void scalar_cam_preprocess_format(vbx_ubyte_t *v_padb, vbx_word_t *v_gs, vbx_word_t *v_cam,
+                                  const int rows, const int cols, const int pitch, vbx_word_t *v_tmp,
+                                  const cam_format_t *fmt);
+void vbx_pool(vbx_word_t *v_out, vbx_word_t *v_pool, const int width, const int height);
+void vbx_zeropad_ci(vbx_ubyte_t *v_out, vbx_word_t *v_pad, vbx_word_t *v_in, const int m, const int n);
+
+// both builds keep their temporaries above 110K
+#define SP_IN      ((int)SCRATCHPAD_BASE + 0*1024)
+#define SP_OUT     ((int)SCRATCHPAD_BASE + 24*1024)
+#define SP_WEIGHTS ((int)SCRATCHPAD_BASE + 64*1024)
+#define SP_TMP     ((int)SCRATCHPAD_BASE + 104*1024)
+#define SP_IN_BYTES  (24*1024)
+#define SP_OUT_BYTES (40*1024)
+
+#define RANDOM_FLASH_OFFSET 0x180000
+#define FLASH_DIR "../.."
+#define GOLDEN_CHUNK (64*1024)
+
+extern const int      golden_size;
+extern const uint16_t golden_BSD_checksums[];
+
+static uint8_t input[SP_IN_BYTES];
+static uint8_t vector_out[SP_OUT_BYTES];
+static uint8_t scalar_out[SP_OUT_BYTES];
+static int failures;
+
+static int layer_out_bytes(layer_t *layer)
+{
+	if (layer->layer_type == DENSE) {
+		return layer->dense.outputs*sizeof(vbx_word_t);
+	}
+	convolution_layer_t *conv = &layer->conv;
+	int m0 = conv->maxpool ? conv->m/2 : conv->m;
+	int n0 = conv->maxpool ? conv->n/2 : conv->n;
+	if (conv->zeropad_output) {
+		return conv->kernels*(m0+2)*(n0+4);
+	}
+	return conv->kernels*m0*n0*sizeof(vbx_word_t);
+}
+
+static int layer_in_bytes(layer_t *layer)
+{
+	if (layer->layer_type == DENSE) {
+		return layer->dense.inputs*sizeof(vbx_word_t);
+	}
+	return layer->conv.channels*(layer->conv.m+2)*(layer->conv.n+4);
+}
+
+// same layout transfer_layer() in cifar_main.c leaves in the scratchpad
+static void transfer_weights(layer_t *layer)
+{
+	int k, offset = 0, dma_size;
+	if (layer->layer_type == CONV) {
+		dma_size = 2*4 + 2*layer->conv.channels;
+		for (k = 0; k < layer->conv.kernels; k++) {
+			vbx_flash_dma((vbx_word_t*)(SP_WEIGHTS+offset), layer->conv.weights + dma_size*k, dma_size + dma_size%4);
+			offset += dma_size + dma_size%4;
+		}
+		layer->conv.weights = SP_WEIGHTS;
+	} else {
+		dma_size = layer->dense.inputs/32*4*layer->dense.outputs;
+		vbx_flash_dma((vbx_word_t*)(SP_WEIGHTS+offset), layer->dense.weights, dma_size);
+		layer->dense.weights = SP_WEIGHTS+offset;
+		offset += dma_size;
+		dma_size = layer->dense.outputs*4;
+		vbx_flash_dma((vbx_word_t*)(SP_WEIGHTS+offset), layer->dense.biases, dma_size);
+		layer->dense.biases = SP_WEIGHTS+offset;
+		offset += dma_size;
+		vbx_flash_dma((vbx_word_t*)(SP_WEIGHTS+offset), layer->dense.scales, dma_size);
+		layer->dense.scales = SP_WEIGHTS+offset;
+	}
+}
+
+static int compare(const char *name, const uint8_t *vec, const uint8_t *ref, const int bytes, const int words)
+{
+	int i, diffs = 0, first = -1;
+	for (i = 0; i < bytes; i++) {
+		if (vec[i] != ref[i]) {
+			if (first < 0) {
+				first = i;
+			}
+			diffs++;
+		}
+	}
+	printf("%-28s %s", name, diffs ? "MISMATCH" : "ok");
+	if (diffs) {
+		failures++;
+		if (words) {
+			printf(" (%d bytes, first word %d: vector %d scalar %d)", diffs, first/4,
+			       ((int32_t*)vec)[first/4], ((int32_t*)ref)[first/4]);
+		} else {
+			printf(" (%d bytes, first byte %d: vector %d scalar %d)", diffs, first, vec[first], ref[first]);
+		}
+	}
+	return diffs;
+}
+
+// same 64K chunk checksums flash_dma_test.c checks the board's flash with
+static int check_golden_image()
+{
+	int chunk, offset, bytes, errors = 0;
+	for (chunk = 0, offset = 0; offset < golden_size; chunk++, offset += GOLDEN_CHUNK) {
+		uint8_t *data = lve_emu_flash + GOLDEN_FLASH_DATA_OFFSET + offset;
+		uint16_t checksum = 0;
+		bytes = min(GOLDEN_CHUNK, golden_size - offset);
+		while (bytes--) {
+			checksum = (checksum >> 1) + ((checksum & 1) << 15);
+			checksum += *data++;
+		}
+		if (checksum != golden_BSD_checksums[chunk]) {
+			printf("golden.bin chunk %d checksum %u, expected %u\n", chunk, checksum, golden_BSD_checksums[chunk]);
+			errors++;
+		}
+	}
+	return errors;
+}
+
+static void print_stats(lve_emu_stats_t *start)
+{
+	printf("  %7llu instrs %9llu est. LVE cycles\n",
+	       lve_emu_stats.instrs - start->instrs, lve_emu_stats.cycles - start->cycles);
+}
+
+// runs one layer on both builds from the same input, returns the vector output
+static uint8_t* check_layer(const char *name, layer_t *layer)
+{
+	layer_t flash_layer = *layer, sp_layer = *layer;
+	int in_bytes = layer_in_bytes(layer), out_bytes = layer_out_bytes(layer);
+	lve_emu_stats_t start;
+
+	memset((void*)SP_OUT, 0, SP_OUT_BYTES);
+	memcpy((void*)SP_IN, input, in_bytes);
+	if (layer->layer_type == CONV) {
+		scalar_convolution_ci_lve((vbx_ubyte_t*)SP_OUT, (vbx_ubyte_t*)SP_IN, &flash_layer.conv, 0);
+	} else {
+		scalar_dense_lve((vbx_word_t*)SP_OUT, (vbx_word_t*)SP_IN, &flash_layer.dense);
+	}
+	memcpy(scalar_out, (void*)SP_OUT, out_bytes);
+
+	memset((void*)SP_OUT, 0, SP_OUT_BYTES);
+	memcpy((void*)SP_IN, input, in_bytes);
+	transfer_weights(&sp_layer);
+	start = lve_emu_stats;
+	if (layer->layer_type == CONV) {
+		convolution_ci_lve((vbx_ubyte_t*)SP_OUT, (vbx_ubyte_t*)SP_IN, &sp_layer.conv, 0);
+	} else {
+		dense_lve((vbx_word_t*)SP_OUT, (vbx_word_t*)SP_IN, &sp_layer.dense);
+	}
+	memcpy(vector_out, (void*)SP_OUT, out_bytes);
+
+	compare(name, vector_out, scalar_out, out_bytes, layer->layer_type == DENSE || !layer->conv.zeropad_output);
+	print_stats(&start);
+	return vector_out;
+}
+
+// the real network on the golden image, each layer fed the vector output of the last
+static void check_network(layer_t *network, const char *net_name)
+{
+	int l = 0, c;
+	char name[64];
+	uint8_t *out;
+
+	uint8_t *image = lve_emu_flash + GOLDEN_FLASH_DATA_OFFSET;
+	int y, x;
+	memset(input, 0, 3*34*36);
+	for (c = 0; c < 3; c++) {
+		for (y = 0; y < 32; y++) {
+			for (x = 0; x < 32; x++) {
+				input[(c*34 + y+1)*36 + x+1] = image[(c*32 + y)*32 + x];
+			}
+		}
+	}
+
+	while (1) {
+		snprintf(name, sizeof(name), "%s layer %d", net_name, l);
+		out = check_layer(name, &network[l]);
+		if (network[l].layer_type == CONV ? network[l].conv.last : network[l].dense.last) {
+			break;
+		}
+		memcpy(input, out, layer_out_bytes(&network[l]));
+		l++;
+	}
+	int best = 0;
+	for (c = 0; c < network[l].dense.outputs; c++) {
+		printf("  %s\t%d\n", categories[c], ((int32_t*)out)[c]);
+		if (((int32_t*)out)[c] > ((int32_t*)out)[best]) {
+			best = c;
+		}
+	}
+	printf("  golden image classified as %s\n", categories[best]);
+}
+
+static void random_bytes(uint8_t *buf, const int bytes)
+{
+	int i;
+	for (i = 0; i < bytes; i++) {
+		buf[i] = rand();
+	}
+}
+
+static void random_padded_input(const int channels, const int m, const int n)
+{
+	int c, y, x;
+	memset(input, 0, channels*(m+2)*(n+4));
+	for (c = 0; c < channels; c++) {
+		for (y = 1; y <= m; y++) {
+			for (x = 1; x <= n; x++) {
+				input[(c*(m+2) + y)*(n+4) + x] = rand();
+			}
+		}
+	}
+}
+
+static void check_random_conv(const int i)
+{
+	static const int sizes[] = {8, 16, 32};
+	char name[64];
+	layer_t layer;
+	int k, dma_size;
+	convolution_layer_t *conv = &layer.conv;
+
+	conv->layer_type = CONV;
+	conv->activation_type = rand() % 2 ? RELU : LINEAR;
+	conv->last = 0;
+	conv->m = conv->n = sizes[rand() % 3];
+	conv->channels = 1 + rand() % min(32, SP_IN_BYTES/((conv->m+2)*(conv->n+4)));
+	conv->kernels = 1 + rand() % 8;
+	conv->maxpool = rand() % 2;
+	conv->weights = RANDOM_FLASH_OFFSET;
+	conv->scale = 1;
+	conv->zeropad_output = rand() % 2;
+
+	// bias, scale then a 9 bit weight per channel for each kernel
+	dma_size = 2*4 + 2*conv->channels;
+	for (k = 0; k < conv->kernels; k++) {
+		int32_t *blob = (int32_t*)(lve_emu_flash + RANDOM_FLASH_OFFSET + k*dma_size);
+		random_bytes((uint8_t*)(blob+2), 2*conv->channels);
+		blob[0] = rand() % 4096 - 2048;
+		blob[1] = conv->zeropad_output ? rand() % (1<<28) : 1;
+	}
+	random_padded_input(conv->channels, conv->m, conv->n);
+
+	snprintf(name, sizeof(name), "conv %d %dx%dx%d k%d%s%s", i, conv->m, conv->n, conv->channels, conv->kernels,
+	         conv->maxpool ? " pool" : "", conv->zeropad_output ? " pad" : "");
+	check_layer(name, &layer);
+}
+
+static void check_random_dense(const int i)
+{
+	char name[64];
+	layer_t layer;
+	int o, bytes;
+	dense_layer_t *dense = &layer.dense;
+
+	dense->layer_type = DENSE;
+	dense->activation_type = rand() % 2 ? RELU : LINEAR;
+	dense->last = 0;
+	dense->inputs = 32*(1 + rand() % 8);
+	dense->outputs = 1 + rand() % 64;
+	dense->scale = 1;
+
+	bytes = dense->inputs/32*4*dense->outputs;
+	dense->weights = RANDOM_FLASH_OFFSET;
+	dense->biases = dense->weights + bytes;
+	dense->scales = dense->biases + dense->outputs*4;
+	random_bytes(lve_emu_flash + dense->weights, bytes);
+	for (o = 0; o < dense->outputs; o++) {
+		((int32_t*)(lve_emu_flash + dense->biases))[o] = rand() % 4096 - 2048;
+		((int32_t*)(lve_emu_flash + dense->scales))[o] = rand() % (1<<28);
+	}
+	for (o = 0; o < dense->inputs; o++) {
+		((int32_t*)input)[o] = rand() % 512 - 256;
+	}
+
+	snprintf(name, sizeof(name), "dense %d %dx%d", i, dense->inputs, dense->outputs);
+	check_layer(name, &layer);
+}
+
+static void check_pool_zeropad(const int i)
+{
+	char name[64];
+	int j, m = 2*(1 + rand() % 16), n = 4*(1 + rand() % 8);
+	int32_t *words = (int32_t*)input;
+
+	for (j = 0; j < m*n; j++) {
+		words[j] = rand() % 1024 - 384;
+	}
+
+	memcpy((void*)SP_OUT, words, m*n*4);
+	scalar_pool((vbx_word_t*)SP_OUT, n, m);
+	memcpy(scalar_out, (void*)SP_OUT, m*n*4/4);
+	memcpy((void*)SP_OUT, words, m*n*4);
+	vbx_pool((vbx_word_t*)SP_OUT, (vbx_word_t*)SP_TMP, n, m);
+	memcpy(vector_out, (void*)SP_OUT, m*n*4/4);
+	snprintf(name, sizeof(name), "pool %d %dx%d", i, m, n);
+	compare(name, vector_out, scalar_out, m*n*4/4, 1);
+	printf("\n");
+
+	memcpy((void*)SP_IN, words, m*n*4);
+	memset((void*)SP_OUT, 0xA5, (m+2)*(n+4));
+	scalar_zeropad_ci((vbx_ubyte_t*)SP_OUT, (vbx_word_t*)SP_IN, m, n);
+	memcpy(scalar_out, (void*)SP_OUT, (m+2)*(n+4));
+	memset((void*)SP_OUT, 0xA5, (m+2)*(n+4));
+	vbx_zeropad_ci((vbx_ubyte_t*)SP_OUT, (vbx_word_t*)SP_TMP, (vbx_word_t*)SP_IN, m, n);
+	memcpy(vector_out, (void*)SP_OUT, (m+2)*(n+4));
+	snprintf(name, sizeof(name), "zeropad %d %dx%d", i, m, n);
+	compare(name, vector_out, scalar_out, (m+2)*(n+4), 0);
+	printf("\n");
+}
+
+// a 64x32 camera frame, the network's 32x32 corner of it or a random window,
+// then the same window in another camera format, mirrored every other time
+// and with random scaling on some channels
+static void check_cam_preprocess(const int i)
+{
+	static const char *formats[] = {"xrgb", "rgba", "rgb565", "yuv422"};
+	char name[64];
+	int j, c, rows = 32, cols = 32, pitch = 64;
+	int pad_bytes, gs_bytes;
+	int32_t *words = (int32_t*)input;
+	cam_format_t fmt = CAM_FORMAT_DEFAULT;
+	lve_emu_stats_t start;
+
+	if (i) {
+		rows = 1 + rand() % 32;
+		cols = 4*(1 + rand() % 16);
+	}
+	pad_bytes = 3*(rows+2)*(cols+4);
+	gs_bytes = rows*cols*sizeof(vbx_word_t);
+	for (j = 0; j < 32*pitch; j++) {
+		words[j] = rand() ^ (rand() << 16);
+	}
+
+	memcpy((void*)SP_IN, words, 32*pitch*4);
+	memset((void*)SP_OUT, 0xA5, SP_OUT_BYTES);
+	scalar_cam_preprocess((vbx_ubyte_t*)SP_OUT, (vbx_word_t*)(SP_OUT + 16*1024), (vbx_word_t*)SP_IN,
+	                      rows, cols, pitch, (vbx_word_t*)SP_TMP);
+	memcpy(scalar_out, (void*)SP_OUT, SP_OUT_BYTES);
+	memset((void*)SP_OUT, 0xA5, SP_OUT_BYTES);
+	start = lve_emu_stats;
+	cam_preprocess((vbx_ubyte_t*)SP_OUT, (vbx_word_t*)(SP_OUT + 16*1024), (vbx_word_t*)SP_IN,
+	               rows, cols, pitch, (vbx_word_t*)SP_TMP);
+	memcpy(vector_out, (void*)SP_OUT, SP_OUT_BYTES);
+
+	// the bytes either side of both outputs too
+	snprintf(name, sizeof(name), "cam planes %d %dx%d", i, rows, cols);
+	compare(name, vector_out, scalar_out, pad_bytes + 4, 0);
+	print_stats(&start);
+	snprintf(name, sizeof(name), "cam grayscale %d %dx%d", i, rows, cols);
+	compare(name, vector_out + 16*1024, scalar_out + 16*1024, gs_bytes + 4, 1);
+	printf("\n");
+
+	fmt.format = i % 4;
+	fmt.flip = i/4 % 2;
+	for (c = 0; c < 3; c++) {
+		if (rand() % 2) {
+			fmt.mean[c] = rand() % 256;
+			fmt.scale[c] = rand() % 1024 - 256;
+			fmt.offset[c] = rand() % 256 - 64;
+		}
+	}
+	memset((void*)SP_OUT, 0xA5, SP_OUT_BYTES);
+	scalar_cam_preprocess_format((vbx_ubyte_t*)SP_OUT, (vbx_word_t*)(SP_OUT + 16*1024), (vbx_word_t*)SP_IN,
+	                             rows, cols, pitch, (vbx_word_t*)SP_TMP, &fmt);
+	memcpy(scalar_out, (void*)SP_OUT, SP_OUT_BYTES);
+	memset((void*)SP_OUT, 0xA5, SP_OUT_BYTES);
+	start = lve_emu_stats;
+	cam_preprocess_format((vbx_ubyte_t*)SP_OUT, (vbx_word_t*)(SP_OUT + 16*1024), (vbx_word_t*)SP_IN,
+	                      rows, cols, pitch, (vbx_word_t*)SP_TMP, &fmt);
+	memcpy(vector_out, (void*)SP_OUT, SP_OUT_BYTES);
+
+	snprintf(name, sizeof(name), "cam %s%s %d %dx%d", formats[fmt.format], fmt.flip ? " flip" : "", i, rows, cols);
+	compare(name, vector_out, scalar_out, pad_bytes + 4, 0);
+	print_stats(&start);
+	snprintf(name, sizeof(name), "cam %s grayscale %d", formats[fmt.format], i);
+	compare(name, vector_out + 16*1024, scalar_out + 16*1024, gs_bytes + 4, 1);
+	printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+	int i, iterations = argc > 1 ? atoi(argv[1]) : 20;
+	srand(argc > 2 ? atoi(argv[2]) : 1);
+
+	init_lve();
+	if (lve_emu_load_flash(FLASH_DIR "/golden.bin", GOLDEN_FLASH_DATA_OFFSET) < 0 ||
+	    lve_emu_load_flash(FLASH_DIR "/qmin.bin", REDUCED_FLASH_DATA_OFFSET) < 0) {
+		printf("can't read the flash images from " FLASH_DIR "\n");
+		return 1;
+	}
+	if (check_golden_image()) {
+		printf("golden.bin doesn't match golden.c\n");
+		return 1;
+	}
+
+	check_network(cifar_reduced, "reduced");
+	for (i = 0; i < iterations; i++) {
+		check_random_conv(i);
+		check_random_dense(i);
+		check_pool_zeropad(i);
+		check_cam_preprocess(i);
+	}
+
+	printf("%d mismatches\n", failures);
+	return failures != 0;
+}
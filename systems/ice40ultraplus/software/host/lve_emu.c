@@ -0,0 +1,267 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "vbx.h"
+#include "flash_dma.h"
+
+vbx_lve_t the_lve;
+lve_emu_stats_t lve_emu_stats;
+uint8_t lve_emu_flash[LVE_EMU_FLASH_SIZE];
+
+// the instructions lve_core/lve_ci implement, by the mnemonic vbx_cproto.h emits
+enum {
+	OP_MOV, OP_AND, OP_OR, OP_XOR, OP_ADD, OP_SUB, OP_MUL, OP_MULH, OP_MULHU,
+	OP_SLL, OP_SRL, OP_SRA, OP_SLT, OP_SLTU, OP_SGT, OP_SGTU, OP_CMV_NZ, OP_CMV_Z,
+	OP_CUSTOM0, OP_CUSTOM1, OP_CUSTOM2, OP_CUSTOM3, NUM_OPS
+};
+static const char *op_names[NUM_OPS] = {
+	"VMOV", "VAND", "VOR", "VXOR", "VADD", "VSUB", "VMUL", "VMULH", "VMULHU",
+	"VSHL", "VSRL", "VSRA", "VSLT", "VSLTU", "VSGT", "VSGTU", "VCMV_NZ", "VCMV_Z",
+	"VCUSTOM0", "VCUSTOM1", "VCUSTOM2", "VCUSTOM3"
+};
+
+static struct {
+	unsigned vl, nrows;
+	int incrd, incra, incrb;
+	uint32_t conv_weights;
+} lve;
+
+static void fail(const char *mode, const char *op, const char *why)
+{
+	fprintf(stderr, "lve_emu: %s.%s: %s\n", op, mode, why);
+	abort();
+}
+
+static uint8_t *sp_byte(const char *mode, const char *op, uint32_t addr)
+{
+	if (addr < LVE_EMU_SP_BASE || addr >= LVE_EMU_SP_BASE + LVE_EMU_SP_SIZE) {
+		fprintf(stderr, "lve_emu: %s.%s: address %08x outside the scratchpad\n", op, mode, addr);
+		abort();
+	}
+	return (uint8_t*)(intptr_t)addr;
+}
+
+static uint32_t sp_read(const char *mode, const char *op, uint32_t addr)
+{
+	uint32_t data;
+	memcpy(&data, sp_byte(mode, op, addr & ~3), sizeof(data));
+	return data;
+}
+
+static void sp_write(const char *mode, const char *op, uint32_t addr, uint32_t data)
+{
+	memcpy(sp_byte(mode, op, addr & ~3), &data, sizeof(data));
+}
+
+void init_lve()
+{
+	static int mapped;
+	if (!mapped) {
+		void *sp = mmap((void*)LVE_EMU_SP_BASE, LVE_EMU_SP_SIZE, PROT_READ | PROT_WRITE,
+		                MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+		if (sp != (void*)LVE_EMU_SP_BASE) {
+			perror("lve_emu: can't map the scratchpad");
+			exit(1);
+		}
+		mapped = 1;
+	}
+	the_lve.sp_ptr = SCRATCHPAD_BASE;
+	the_lve.sp_base = SCRATCHPAD_BASE;
+	the_lve.init = 1;
+	lve.vl = 1;
+	lve.nrows = 1;
+}
+
+void lve_emu_set_vl(unsigned vl, unsigned nrows)
+{
+	lve.vl = vl;
+	lve.nrows = nrows;
+	lve_emu_stats.cycles++;
+}
+
+void lve_emu_set_2D(int incrd, int incra, int incrb)
+{
+	lve.incrd = incrd;
+	lve.incra = incra;
+	lve.incrb = incrb;
+	lve_emu_stats.cycles++;
+}
+
+uint32_t lve_emu_get_state(int reg)
+{
+	switch (reg) {
+	case VBX_STATE_VECTOR_LENGTH: return lve.vl;
+	case VBX_STATE_NROWS: return lve.nrows;
+	case VBX_STATE_INCRD_2D: return lve.incrd;
+	case VBX_STATE_INCRA_2D: return lve.incra;
+	case VBX_STATE_INCRB_2D: return lve.incrb;
+	}
+	return 0;
+}
+
+// flash_dma.h backend, the flash is an image in host memory
+void flash_dma_trans(int flash_address, uint8_t *dest_address, unsigned xfer_length)
+{
+	if (flash_address < 0 || flash_address + xfer_length > LVE_EMU_FLASH_SIZE) {
+		fprintf(stderr, "lve_emu: flash read %x+%x out of range\n", flash_address, xfer_length);
+		abort();
+	}
+	memcpy(dest_address, lve_emu_flash + flash_address, xfer_length);
+}
+
+void flash_dma_init()
+{
+}
+
+int lve_emu_load_flash(const char *path, const int offset)
+{
+	FILE *f = fopen(path, "rb");
+	if (!f) {
+		return -1;
+	}
+	size_t len = fread(lve_emu_flash + offset, 1, LVE_EMU_FLASH_SIZE - offset, f);
+	fclose(f);
+	return len;
+}
+
+static int conv_pixel(const uint32_t row, const int weight)
+{
+	int pix = row & 0xFF;
+	return weight ? pix : -pix;
+}
+
+// VCUSTOM2: each element is a row of 4 pixels, element k writes the two
+// 3x3 sums over the rows of elements k, k+1 and k+2 to its own dest
+// address, the last two elements only flush the pipeline
+static void ci_conv(const char *mode, const char *op, uint32_t *rows, uint32_t *dests, const unsigned elems)
+{
+	unsigned k;
+	int r, c, sum0, sum1;
+	for (k = 0; k+2 < elems; k++) {
+		sum0 = sum1 = 0;
+		for (r = 0; r < 3; r++) {
+			for (c = 0; c < 3; c++) {
+				int w = (lve.conv_weights >> (8 - (r*3 + c))) & 1;
+				sum0 += conv_pixel(rows[k+r] >> (8*c), w);
+				sum1 += conv_pixel(rows[k+r] >> (8*(c+1)), w);
+			}
+		}
+		sp_write(mode, op, dests[k], (sum1 << 16) | (sum0 & 0xFFFF));
+	}
+}
+
+void lve_emu_exec(int modify, const char *mode, const char *name, intptr_t dest, intptr_t srca, intptr_t srcb)
+{
+	int op;
+	for (op = 0; op < NUM_OPS && strcmp(name, op_names[op]); op++);
+	if (op == NUM_OPS) {
+		fail(mode, name, "not an LVE instruction");
+	}
+
+	unsigned e, r, count = 0;
+	uint32_t d_row = dest, a_row = srca, b_row = srcb;
+	uint32_t acc = 0;
+	int a_scalar = mode[0] == 'S';
+	int b_enum = mode[1] == 'E';
+	int uses_b = !(op == OP_MOV || op == OP_CUSTOM0 || op == OP_CUSTOM1);
+	unsigned elems = lve.vl*lve.nrows;
+	uint32_t *ci_rows = 0, *ci_dests = 0;
+
+	if (strncmp(mode+2, "WWW", 3)) {
+		fail(mode, name, "the LVE only has word operands");
+	}
+	if (mode[1] == 'S') {
+		fail(mode, name, "the LVE only takes a scalar for srca");
+	}
+	if (modify == MOD_ACC && op >= OP_CUSTOM0) {
+		fail(mode, name, "custom instructions can't accumulate");
+	}
+	if (!elems) {
+		return;
+	}
+
+	lve_emu_stats.instrs++;
+	lve_emu_stats.elements += elems;
+	lve_emu_stats.cycles += LVE_EMU_ISSUE_CYCLES + elems;
+	if (op == OP_CUSTOM2) {
+		lve_emu_stats.cycles += LVE_EMU_CI_CONV_CYCLES;
+		ci_rows = malloc(elems*sizeof(uint32_t));
+		ci_dests = malloc(elems*sizeof(uint32_t));
+	}
+
+	for (r = 0; r < lve.nrows; r++) {
+		uint32_t d = d_row, a = a_row, b = b_row;
+		for (e = 0; e < lve.vl; e++, count++) {
+			uint32_t va = a_scalar ? (uint32_t)srca : sp_read(mode, name, a);
+			uint32_t vb = b_enum ? e : uses_b ? sp_read(mode, name, b) : 0;
+			uint32_t result = 0;
+			int write = 1;
+
+			switch (op) {
+			case OP_MOV:   result = va; break;
+			case OP_AND:   result = va & vb; break;
+			case OP_OR:    result = va | vb; break;
+			case OP_XOR:   result = va ^ vb; break;
+			case OP_ADD:   result = va + vb; break;
+			case OP_SUB:   result = va - vb; break;
+			case OP_MUL:   result = va * vb; break;
+			case OP_MULH:  result = ((int64_t)(int32_t)va*(int32_t)vb) >> 32; break;
+			case OP_MULHU: result = ((uint64_t)va*vb) >> 32; break;
+			case OP_SLL:   result = va << (vb & 31); break;
+			case OP_SRL:   result = va >> (vb & 31); break;
+			case OP_SRA:   result = (int32_t)va >> (vb & 31); break;
+			case OP_SLT:   result = (int32_t)va < (int32_t)vb; break;
+			case OP_SLTU:  result = va < vb; break;
+			case OP_SGT:   result = (int32_t)va > (int32_t)vb; break;
+			case OP_SGTU:  result = va > vb; break;
+			case OP_CMV_NZ: result = va; write = vb != 0; break;
+			case OP_CMV_Z:  result = va; write = vb == 0; break;
+			case OP_CUSTOM0: {
+				// word to byte saturation, byte lanes rotate with the element count
+				int32_t v = va;
+				*sp_byte(mode, name, (d & ~3) + (count & 3)) = v > 255 ? 255 : v < 0 ? 0 : v;
+				write = 0;
+				break;
+			}
+			case OP_CUSTOM1:
+				lve.conv_weights = va & 0x1FF;
+				write = 0;
+				break;
+			case OP_CUSTOM2: {
+				// unaligned rows take the top half of srca and bottom half of srcb
+				ci_rows[count] = (a & 3) ? (va >> 16) | (vb << 16) : va;
+				ci_dests[count] = d;
+				write = 0;
+				break;
+			}
+			case OP_CUSTOM3:
+				result = (((va >> 16) + (vb >> 16)) << 16) | ((va + vb) & 0xFFFF);
+				break;
+			}
+
+			if (modify == MOD_ACC) {
+				// the accumulator is only cleared at the start of an instruction,
+				// and dest only moves on at the end of a row
+				acc += result;
+				sp_write(mode, name, d, acc);
+			} else {
+				if (write) {
+					sp_write(mode, name, d, result);
+				}
+				d += 4;
+			}
+			a += 4;
+			b += 4;
+		}
+		d_row += lve.incrd;
+		a_row += lve.incra;
+		b_row += lve.incrb;
+	}
+
+	if (op == OP_CUSTOM2) {
+		ci_conv(mode, name, ci_rows, ci_dests, elems);
+		free(ci_rows);
+		free(ci_dests);
+	}
+}
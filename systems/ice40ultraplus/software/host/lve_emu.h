@@ -0,0 +1,38 @@
+#ifndef LVE_EMU_H
+#define LVE_EMU_H
+
+#include <stdint.h>
+
+// Host model of the ice40ultraplus LVE, used by the host test harness in this
+// directory. The scratchpad is mapped at its real address so the int/pointer
+// conversions in the kernels behave as on the board, and instructions run
+// one element at a time in hardware order (lve_core.vhd, lve_ci.vhd).
+// Anything the hardware can't do (byte/half operands, scalar srcb,
+// ops outside the RISC-V ALU + cmv/mov/sgt + VCUSTOM0-3) aborts with the
+// offending instruction rather than being quietly emulated.
+
+#define LVE_EMU_SP_BASE 0x04000000
+#define LVE_EMU_SP_SIZE (128*1024)
+#define LVE_EMU_FLASH_SIZE (2*1024*1024)
+
+// cost model for the cycle estimate: one element per cycle once an
+// instruction has filled the read/alu/write pipeline
+#define LVE_EMU_ISSUE_CYCLES 5
+#define LVE_EMU_CI_CONV_CYCLES 3 // extra VCUSTOM2 pipeline depth
+
+typedef struct {
+	unsigned long long instrs;
+	unsigned long long elements;
+	unsigned long long cycles;
+} lve_emu_stats_t;
+
+extern lve_emu_stats_t lve_emu_stats;
+extern uint8_t lve_emu_flash[LVE_EMU_FLASH_SIZE];
+
+void lve_emu_exec(int modify, const char *mode, const char *op, intptr_t dest, intptr_t srca, intptr_t srcb);
+void lve_emu_set_vl(unsigned vl, unsigned nrows);
+void lve_emu_set_2D(int incrd, int incra, int incrb);
+uint32_t lve_emu_get_state(int reg);
+int lve_emu_load_flash(const char *path, const int offset);
+
+#endif //LVE_EMU_H
@@ -0,0 +1,7 @@
+#ifndef __ORCA_PRINTF_H
+#define __ORCA_PRINTF_H
+
+// Host stand-in for orca_lib/orca_printf.h
+#include <stdio.h>
+
+#endif //#ifndef __ORCA_PRINTF_H
@@ -0,0 +1,14 @@
+#ifndef __ORCA_TIME_H
+#define __ORCA_TIME_H
+
+// Host stand-in for orca_lib/orca_time.h. Time is the LVE cycle estimate, so
+// scalar code takes no time at all on the host.
+#include "bsp.h"
+#include <stdint.h>
+#include "lve_emu.h"
+
+static inline uint32_t get_time(){
+	return (uint32_t)lve_emu_stats.cycles;
+}
+
+#endif //#ifndef __ORCA_TIME_H
@@ -0,0 +1,7 @@
+#ifndef PRINTF_H
+#define PRINTF_H
+
+// Host stand-in for the board's printf.h
+#include <stdio.h>
+
+#endif //PRINTF_H
@@ -0,0 +1,84 @@
+#ifndef VBX_H
+#define VBX_H
+
+// Host stand-in for vbx_lib/vbx.h, force included ahead of everything so the
+// real vbx.h and vbx_macros.h are skipped by their include guards. Everything
+// vbx_macros.h provides is mirrored here on top of lve_emu.
+
+#define MACROS_H
+
+#include <assert.h>
+#include <stdint.h>
+#include "vbx_types.h"
+#include "lve_emu.h"
+
+extern vbx_lve_t the_lve;
+#define MOD_NONE 0
+#define MOD_ACC 1
+
+#define max(a,b) ((a)<(b) ?(b):(a))
+#define min(a,b) ((a)>(b) ?(b):(a))
+
+#define vbxasm(modify,vmode,vinstr,dest,srca,srcb) \
+	lve_emu_exec(modify, #vmode, #vinstr, (intptr_t)(dest), (intptr_t)(srca), (intptr_t)(srcb))
+
+static inline void vbx_set_vl(unsigned vl,unsigned nrows){
+	lve_emu_set_vl(vl, nrows);
+}
+static inline void vbx_set_2D(int incrd,int incra,int incrb){
+	lve_emu_set_2D(incrd, incra, incrb);
+}
+
+#define vbx_set_vl_1(vl) vbx_set_vl(vl,1)
+#define vbx_set_vl_2(vl,rows) vbx_set_vl(vl,rows)
+
+#define vbx_set_vl_X(x,A,B,FUNC, ...)  FUNC
+#define vbx_set_vl(...) vbx_set_vl_X(,##__VA_ARGS__,      \
+                                     vbx_set_vl_2(__VA_ARGS__),\
+                                     vbx_set_vl_1(__VA_ARGS__))
+
+typedef enum{
+	VBX_STATE_VECTOR_LENGTH=0,
+	VBX_STATE_NROWS=1,
+	VBX_STATE_INCRD_2D=2,
+	VBX_STATE_INCRA_2D=3,
+	VBX_STATE_INCRB_2D=4,
+	VBX_STATE_NMATS=5,
+	VBX_STATE_INCRD_3D=6,
+	VBX_STATE_INCRA_3D=7,
+	VBX_STATE_INCRB_3D=8
+}state_e;
+static inline vbx_uword_t vbx_get_state(state_e reg){
+	return lve_emu_get_state(reg);
+}
+
+static inline void vbx_sync(){
+}
+
+static inline void vbx_get_vl(unsigned* vl,unsigned *nrows){
+	*vl=vbx_get_state(VBX_STATE_VECTOR_LENGTH);
+	*nrows=vbx_get_state(VBX_STATE_NROWS);
+}
+static inline void vbx_get_2D(int *incrd,int* incra,int* incrb){
+	*incra=vbx_get_state(VBX_STATE_INCRA_2D);
+	*incrb=vbx_get_state(VBX_STATE_INCRB_2D);
+	*incrd=vbx_get_state(VBX_STATE_INCRD_2D);
+}
+
+static inline void* vbx_sp_alloc(unsigned sz){
+	char* retval=the_lve.sp_ptr;
+	the_lve.sp_ptr += (sz+3) & (~0x3);
+	return (void*)retval;
+}
+
+static inline void vbx_sp_free(){
+	the_lve.sp_ptr= the_lve.sp_base;
+}
+
+#include "vbx_cproto.h"
+
+void init_lve();
+
+#define  SCRATCHPAD_BASE ((void*)LVE_EMU_SP_BASE)
+
+#endif //VBX_H
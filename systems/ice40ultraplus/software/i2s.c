@@ -1,4 +1,5 @@
 #include "i2s.h"
+#include "time.h"
 int i2s_put_data_pointer;
 
 
@@ -16,3 +17,186 @@ void i2s_set_frequency(int system_clk_freq,int i2s_frequency){
   *TX_I2S_CONFIG = tx_config;
 
 }
+
+
+volatile i2s_capture_stats_t i2s_capture_stats;
+
+//A block belongs to the capture until it fills, then is READY until
+//i2s_wait_block() takes it, and HELD until the next call hands it back. Only
+//the capture moves a block to READY and only the application moves it on from
+//there, so neither side has to mask interrupts.
+enum {BLOCK_CAPTURE,BLOCK_READY,BLOCK_HELD};
+static i2s_block_t capture_blocks[2];
+static volatile int block_state[2];
+static int capture_samples;
+static int fill_block;
+static int fill_count;
+
+void i2s_capture_start(int32_t *buffer,int block_samples){
+  int b;
+  capture_samples=block_samples;
+  for(b=0;b<2;b++){
+    capture_blocks[b].left=buffer+2*b*block_samples;
+    capture_blocks[b].right=buffer+(2*b+1)*block_samples;
+    block_state[b]=BLOCK_CAPTURE;
+  }
+  fill_block=0;
+  fill_count=0;
+  i2s_capture_stats.blocks=0;
+  i2s_capture_stats.block_overruns=0;
+  i2s_capture_stats.fifo_overflows=0;
+
+  //start on fresh samples, this also clears the overflow flag
+  int level=RX_I2S_BASE[RX_I2S_STATUS_OFFSET] & RX_I2S_STATUS_LEVEL;
+  while(level--){
+    (void)RX_I2S_BASE[RX_I2S_DATA_OFFSET];
+  }
+}
+
+int i2s_capture_service(){
+  uint32_t status=RX_I2S_BASE[RX_I2S_STATUS_OFFSET];
+  int level=status & RX_I2S_STATUS_LEVEL;
+  int i;
+  if(status & RX_I2S_STATUS_OVERFLOW){
+    i2s_capture_stats.fifo_overflows++;
+  }
+  for(i=0;i<level;i++){
+    i2s_block_t *block=&capture_blocks[fill_block];
+    union i2s_union data;
+    data.as_int=RX_I2S_BASE[RX_I2S_DATA_OFFSET];
+    block->left[fill_count]=data.as_struct.left;
+    block->right[fill_count]=data.as_struct.right;
+    if(++fill_count<capture_samples){
+      continue;
+    }
+    fill_count=0;
+    block->index=i2s_capture_stats.blocks++;
+    block->timestamp=get_time();
+    if(block_state[!fill_block]==BLOCK_CAPTURE){
+      //the samples have to be in memory before the application can see the block
+      asm volatile("":::"memory");
+      block_state[fill_block]=BLOCK_READY;
+      fill_block=!fill_block;
+    }else{
+      //the application still has the other block, fill this one again
+      i2s_capture_stats.block_overruns++;
+    }
+  }
+  return level;
+}
+
+i2s_block_t* i2s_wait_block(){
+  int b;
+  for(b=0;b<2;b++){
+    if(block_state[b]==BLOCK_HELD){
+      block_state[b]=BLOCK_CAPTURE;
+    }
+  }
+  for(;;){
+    //the capture never has both blocks READY, it drops the newer one instead
+    for(b=0;b<2;b++){
+      if(block_state[b]==BLOCK_READY){
+        block_state[b]=BLOCK_HELD;
+        return &capture_blocks[b];
+      }
+    }
+#if !I2S_CAPTURE_USE_INTERRUPT
+    i2s_capture_service();
+#endif
+  }
+}
+
+
+volatile i2s_tx_stats_t i2s_tx_stats;
+
+//head and tail count samples ever queued and ever taken, so head - tail is
+//the level even when they wrap. Only i2s_put_block() writes head and only
+//i2s_tx_service() writes tail.
+static i2s_data_t *tx_ring;
+static int tx_ring_mask;
+static volatile unsigned tx_head;
+static volatile unsigned tx_tail;
+
+void i2s_tx_start(i2s_data_t *ring,int ring_samples){
+  int i;
+  tx_ring=ring;
+  tx_ring_mask=ring_samples-1;
+  tx_head=0;
+  tx_tail=0;
+  i2s_tx_stats.refills=0;
+  i2s_tx_stats.underruns=0;
+
+  for(i=0;i<TX_I2S_BUFFER_SIZE;i++){
+    TX_I2S_BUFFER[i]=0;
+  }
+  *TX_I2S_INT_STAT=TX_I2S_INT_LOWER | TX_I2S_INT_UPPER;
+#if I2S_TX_USE_INTERRUPT
+  *TX_I2S_INT_MASK=TX_I2S_INT_LOWER | TX_I2S_INT_UPPER;
+  *TX_I2S_CONFIG|=TX_I2S_CONFIG_TINTEN;
+#endif
+}
+
+static void tx_refill(volatile short *half){
+  unsigned tail=tx_tail;
+  int level=tx_head-tail;
+  int i;
+  //silence before the first samples are queued doesn't count
+  if(level<TX_I2S_BUFFER_SIZE/4 && tx_head){
+    i2s_tx_stats.underruns++;
+  }
+  for(i=0;i<TX_I2S_BUFFER_SIZE/2;i+=2){
+    if(level){
+      i2s_data_t sample=tx_ring[tail++ & tx_ring_mask];
+      half[i]=sample.left;
+      half[i+1]=sample.right;
+      level--;
+    }else{
+      half[i]=0;
+      half[i+1]=0;
+    }
+  }
+  //the samples have to be out of the ring before the producer can reuse it
+  asm volatile("":::"memory");
+  tx_tail=tail;
+  i2s_tx_stats.refills++;
+}
+
+int i2s_tx_service(){
+  unsigned short stat=*TX_I2S_INT_STAT & (TX_I2S_INT_LOWER | TX_I2S_INT_UPPER);
+  //clear first, so a half that finishes during the refill isn't missed
+  *TX_I2S_INT_STAT=stat;
+  if(stat & TX_I2S_INT_LOWER){
+    tx_refill(TX_I2S_BUFFER);
+  }
+  if(stat & TX_I2S_INT_UPPER){
+    tx_refill(TX_I2S_BUFFER+TX_I2S_BUFFER_SIZE/2);
+  }
+  return !!(stat & TX_I2S_INT_LOWER) + !!(stat & TX_I2S_INT_UPPER);
+}
+
+int i2s_tx_level(){
+  return tx_head-tx_tail;
+}
+
+int i2s_tx_space(){
+  return tx_ring_mask+1-i2s_tx_level();
+}
+
+void i2s_put_block(const i2s_data_t *samples,int count){
+  unsigned head=tx_head;
+  while(count){
+    int space=tx_ring_mask+1-(int)(head-tx_tail);
+    if(!space){
+#if !I2S_TX_USE_INTERRUPT
+      i2s_tx_service();
+#endif
+      continue;
+    }
+    for(;space && count;space--,count--){
+      tx_ring[head++ & tx_ring_mask]=*samples++;
+    }
+    //publish the samples only once they are in the ring
+    asm volatile("":::"memory");
+    tx_head=head;
+  }
+}
@@ -9,6 +9,9 @@ static uint32_t volatile * const  RX_I2S_BASE=( uint32_t volatile * const)0x0001
 static const int RX_I2S_VERSION_OFFSET=0;
 static const int RX_I2S_CLOCK_DIV_OFFSET=1;
 static const int RX_I2S_DATA_OFFSET=2;
+static const int RX_I2S_STATUS_OFFSET=3;
+#define RX_I2S_STATUS_LEVEL    0xFFFF
+#define RX_I2S_STATUS_OVERFLOW 0x80000000
 
 typedef struct {
   int16_t left;
@@ -26,6 +29,49 @@ static inline i2s_data_t i2s_get_data(){
 }
 
 
+/*****************************/
+/* I2S BLOCK CAPTURE (MICS)  */
+/*****************************/
+
+//When nothing else drains the fifo, i2s_wait_block() does it while waiting.
+//With the fifo interrupt wired up, call i2s_capture_service() from
+//handle_interrupt() instead and the capture runs behind the application.
+#ifndef I2S_CAPTURE_USE_INTERRUPT
+#define I2S_CAPTURE_USE_INTERRUPT 0
+#endif
+
+typedef struct {
+  int32_t *left;
+  int32_t *right;
+  unsigned index;     //blocks captured before this one, counting dropped blocks
+  unsigned timestamp; //get_time() when the last sample was taken from the fifo
+}i2s_block_t;
+
+typedef struct {
+  unsigned blocks;          //blocks captured, including dropped ones
+  unsigned block_overruns;  //blocks dropped because the application still had the other one
+  unsigned fifo_overflows;  //times the hardware fifo dropped samples before they were drained
+}i2s_capture_stats_t;
+
+extern volatile i2s_capture_stats_t i2s_capture_stats;
+
+//Capture both channels into two blocks of block_samples words each, one
+//filling while the application works on the other. buffer must hold
+//4*block_samples words, in the scratchpad if the blocks go to the LVE.
+void i2s_capture_start(int32_t *buffer,int block_samples);
+
+//Move every sample in the fifo into the filling block, never stalling on an
+//empty fifo. The fifo holds 31 samples, so this has to run at least that
+//often. Returns the number of samples moved.
+int i2s_capture_service();
+
+//Hand back the block returned by the previous call and wait for the next full
+//one. A block that fills while the application still has the other one is
+//dropped and counted in i2s_capture_stats.block_overruns; the gap shows up in
+//i2s_block_t.index.
+i2s_block_t* i2s_wait_block();
+
+
 
 
 /*********************/
@@ -39,10 +85,17 @@ static inline i2s_data_t i2s_get_data(){
 #define TX_I2S_INT_STAT    ((volatile unsigned short *)0x00030006)
 #define TX_I2S_BUFFER       ((volatile short *)(0x00030000 + (TX_I2S_BUFFER_SIZE<<1)))
 
+#define TX_I2S_CONFIG_TINTEN 0x02
+//INT_STAT bits are set when the codec has played that half of the buffer,
+//write them back to clear them
+#define TX_I2S_INT_LOWER     0x01
+#define TX_I2S_INT_UPPER     0x02
+
 extern int i2s_put_data_pointer;
 static inline void i2s_put_data(short left,short right)
 {
   //NOT THREADSAFE......
+  //Don't mix with i2s_put_block(), which keeps its own place in the buffer
   TX_I2S_BUFFER[i2s_put_data_pointer++]=left;
   TX_I2S_BUFFER[i2s_put_data_pointer++]=right;
 
@@ -51,6 +104,44 @@ static inline void i2s_put_data(short left,short right)
 }
 
 
+/*****************************/
+/* I2S BLOCK OUTPUT (JACK)   */
+/*****************************/
+
+//Samples are queued in a ring and copied into the half of the hardware buffer
+//the codec has just played. Without the TX interrupt wired up,
+//i2s_put_block() does the copying while it waits for space, and anything
+//that runs longer than half a buffer (64 samples) has to call
+//i2s_tx_service() in between.
+#ifndef I2S_TX_USE_INTERRUPT
+#define I2S_TX_USE_INTERRUPT 0
+#endif
+
+typedef struct {
+  unsigned refills;   //halves of the hardware buffer written
+  unsigned underruns; //refills the ring ran dry for once playing, padded with silence
+}i2s_tx_stats_t;
+
+extern volatile i2s_tx_stats_t i2s_tx_stats;
+
+//Start playing silence and queue samples in ring, which holds ring_samples
+//(a power of 2) samples.
+void i2s_tx_start(i2s_data_t *ring,int ring_samples);
+
+//Refill any half of the hardware buffer the codec has played, from
+//handle_interrupt() or polled. Returns the number of halves refilled.
+int i2s_tx_service();
+
+//Samples queued and not yet copied to the hardware buffer, and the room left.
+//Either side can call these at any time.
+int i2s_tx_level();
+int i2s_tx_space();
+
+//Queue count samples, waiting for room when the ring is full. The main loop is
+//the only producer, the refill the only consumer, so there are no locks.
+void i2s_put_block(const i2s_data_t *samples,int count);
+
+
 
 
 //This function sets the frequency for both the input and the output
@@ -1,45 +1,171 @@
 #include "vbx.h"
 #include "image_diff.h"
 
+#define PIXELS (THUMBNAIL_WIDTH*THUMBNAIL_HEIGHT)
+#define TMP_ROWS max(DIFF_CHUNK_ROWS,MOTION_TILE)
+
+#if MOTION_TILES > 32
+#error the motion bitmap only has 32 tiles
+#endif
+
+/* widen_bytes
+ *
+ * The LVE only has word operands, so each byte lane of the packed words is
+ * masked out and shifted down on its own, one element per 2D row so lane k
+ * lands in every fourth output word.
+ */
+static void widen_bytes(vbx_word_t* out,vbx_ubyte_t* in,const int pixels)
+{
+	vbx_set_vl(1,pixels/4);
+	vbx_set_2D(4*sizeof(vbx_word_t),sizeof(vbx_word_t),sizeof(vbx_word_t));
+	vbx(SVW,VAND,out + 0,0xFF,(vbx_word_t*)in);
+	vbx(SVW,VAND,out + 1,0xFF00,(vbx_word_t*)in);
+	vbx(SVW,VAND,out + 2,0xFF0000,(vbx_word_t*)in);
+	vbx(SVW,VMULH,out + 3,(1<<8),(vbx_word_t*)in); // sign extends, masked below
+
+	vbx_set_2D(4*sizeof(vbx_word_t),0,4*sizeof(vbx_word_t));
+	vbx(SVW,VMULH,out + 1,(1<<24),out + 1);
+	vbx(SVW,VMULH,out + 2,(1<<16),out + 2);
+	vbx(SVW,VAND,out + 3,0xFF,out + 3);
+}
+
+/* keep_current
+ *
+ * Packs the current image into prevBuf for the next call and returns it as
+ * words, widened into cur for a grayscale camera and in place otherwise.
+ */
+#if GS_CAM
+static vbx_word_t* keep_current(vbx_ubyte_t* imgAb,vbx_ubyte_t* prevBuf,vbx_word_t* cur)
+{
+	vbx_set_vl(THUMBNAIL_WIDTH/4,THUMBNAIL_HEIGHT);
+	vbx_set_2D(THUMBNAIL_WIDTH,CAM_IMG_WIDTH,CAM_IMG_WIDTH);
+	vbx(VVW,VMOV,(vbx_word_t*)prevBuf,(vbx_word_t*)imgAb,0);
+	widen_bytes(cur,prevBuf,PIXELS);
+	return cur;
+}
+#else
+static vbx_word_t* keep_current(vbx_word_t* imgA,vbx_ubyte_t* prevBuf)
+{
+	vbx_set_vl(1,PIXELS);
+	vbx_set_2D(sizeof(vbx_byte_t),sizeof(vbx_word_t),sizeof(vbx_word_t));
+	vbx(VVW,VCUSTOM0,(vbx_word_t*)prevBuf,imgA,0);
+	return imgA;
+}
+#endif
+
+/* abs_diff_rows
+ *
+ * delta = |cur - prevb| over pixels pixels, prev and flag are temporaries of
+ * the same size.
+ */
+static void abs_diff_rows(vbx_word_t* delta,vbx_word_t* cur,vbx_ubyte_t* prevb,const int pixels,
+                          vbx_word_t* prev,vbx_word_t* flag)
+{
+	widen_bytes(prev,prevb,pixels);
+
+	vbx_set_vl(pixels);
+	vbx(VVW,VSUB,delta,cur,prev); // delta = cur - prev
+	vbx(VVW,VSUB,prev,prev,cur); // prev = prev - cur ( == -delta)
+	vbx(VVW,VSLT,flag,delta,prev); // flag = delta < prev ? 1 : 0
+	vbx(VVW,VCMV_NZ,delta,prev,flag); // delta = flag ? prev : delta
+}
+
 #if GS_CAM
-uint32_t abs_image_diff(vbx_ubyte_t* imgAb,vbx_ubyte_t* imgBb,vbx_ubyte_t* prevBuf)
+int abs_image_diff(vbx_ubyte_t* imgAb,vbx_ubyte_t* imgBb,vbx_ubyte_t* prevBuf,
+                   const uint32_t threshold,uint32_t* score,vbx_word_t* v_tmp)
 #else
-uint32_t abs_image_diff(vbx_word_t* imgA,vbx_ubyte_t* imgBb,vbx_ubyte_t* prevBuf)
+int abs_image_diff(vbx_word_t* imgA,vbx_ubyte_t* imgBb,vbx_ubyte_t* prevBuf,
+                   const uint32_t threshold,uint32_t* score,vbx_word_t* v_tmp)
 #endif
 {
 	uint32_t diff = 0;
-	vbx_word_t* tmp0 = (vbx_word_t*)(imgA + 4*THUMBNAIL_WIDTH*THUMBNAIL_HEIGHT);
-	vbx_word_t* tmp1 = (vbx_word_t*)(tmp0 + 4*THUMBNAIL_WIDTH);
-	vbx_word_t* imgB = (vbx_word_t*)(tmp1 + 4*THUMBNAIL_WIDTH); // note that imgB + THUMBNAIL_WIDTH*4 should not exceed the value of the SP address where the NN weights are stored
+	int row,moved = 0;
+	vbx_word_t* prev = v_tmp;
+	vbx_word_t* delta = prev + TMP_ROWS*THUMBNAIL_WIDTH;
+	vbx_word_t* flag = delta + TMP_ROWS*THUMBNAIL_WIDTH;
+	vbx_word_t* cur = flag + TMP_ROWS*THUMBNAIL_WIDTH + MOTION_TILES;
 
 #if GS_CAM
-	vbx_word_t* imgA = (vbx_word_t*)(imgB + 4*THUMBNAIL_WIDTH);
+	cur = keep_current(imgAb,prevBuf,cur);
+#else
+	cur = keep_current(imgA,prevBuf);
 #endif
-	vbx_set_vl(THUMBNAIL_WIDTH);
-	for(int row=0;row<THUMBNAIL_HEIGHT;row++){
-		// unpack the bytes of the previous image into words
-		// and store the current image in the previous image buffer
-		for(int col=0;col<THUMBNAIL_WIDTH;col++){
-			imgB[col] = imgBb[row*THUMBNAIL_WIDTH + col];
+
+	for(row=0;row<THUMBNAIL_HEIGHT && !moved;row+=DIFF_CHUNK_ROWS){
+		int pixels = min(DIFF_CHUNK_ROWS,THUMBNAIL_HEIGHT-row)*THUMBNAIL_WIDTH;
+
+		abs_diff_rows(delta,cur + row*THUMBNAIL_WIDTH,imgBb + row*THUMBNAIL_WIDTH,pixels,prev,flag);
+		// the whole chunk in one accumulate
+		vbx_acc(SVW,VADD,flag,0,delta);
+		vbx_sync();
+		diff += *flag;
+		moved = diff > threshold;
+	}
+
+	if(score){
+		*score = diff;
+	}
+	return moved;
+}
+
 #if GS_CAM
-			imgA[col] = imgAb[row*CAM_IMAGE_WIDTH + col];
+int motion_map(vbx_ubyte_t* imgAb,vbx_ubyte_t* imgBb,vbx_ubyte_t* prevBuf,
+               const uint32_t tile_threshold,motion_map_t* map,vbx_word_t* v_tmp)
+#else
+int motion_map(vbx_word_t* imgA,vbx_ubyte_t* imgBb,vbx_ubyte_t* prevBuf,
+               const uint32_t tile_threshold,motion_map_t* map,vbx_word_t* v_tmp)
 #endif
-			prevBuf[row*THUMBNAIL_WIDTH+col] = imgA[row*THUMBNAIL_WIDTH+col];
-		}
+{
+	int t,tx,ty;
+	vbx_word_t* prev = v_tmp;
+	vbx_word_t* delta = prev + TMP_ROWS*THUMBNAIL_WIDTH;
+	vbx_word_t* flag = delta + TMP_ROWS*THUMBNAIL_WIDTH;
+	vbx_word_t* sad = flag + TMP_ROWS*THUMBNAIL_WIDTH;
+	vbx_word_t* cur = sad + MOTION_TILES;
 
-		// compute the diff for this row
 #if GS_CAM
-		vbx(VVW,VSUB,tmp0,imgA,imgB); //tmp0 = imgA - imgB
-		vbx(VVW,VSUB,imgB,imgB,imgA); //imgB = imgB - imgA ( == -tmp0)
+	cur = keep_current(imgAb,prevBuf,cur);
 #else
-		vbx(VVW,VSUB,tmp0,imgA + row*THUMBNAIL_WIDTH,imgB); // tmp0 = imgA - imgB
-		vbx(VVW,VSUB,imgB,imgB,imgA + row*THUMBNAIL_WIDTH); // imgB = imgB - imgA ( == -tmp0)
+	cur = keep_current(imgA,prevBuf);
 #endif
-		vbx(VVW,VSLT,tmp1,tmp0,imgB); // tmp1 = tmp0 < imgB ? 1 : 0
-		vbx(VVW,VCMV_NZ,tmp0,imgB,tmp1); // tmp0 = tmp1 ? imgB : tmp0
-		vbx_acc(SVW,VADD,tmp0,0,tmp0);
-		diff += *tmp0;
+
+	for(ty=0;ty<MOTION_TILES_Y;ty++){
+		int row = ty*MOTION_TILE;
+		abs_diff_rows(delta,cur + row*THUMBNAIL_WIDTH,imgBb + row*THUMBNAIL_WIDTH,
+		              MOTION_TILE*THUMBNAIL_WIDTH,prev,flag);
+
+		// one accumulate per tile, dest stays put so it ends with the tile's sum
+		vbx_set_vl(MOTION_TILE,MOTION_TILE);
+		vbx_set_2D(0,0,THUMBNAIL_WIDTH*sizeof(vbx_word_t));
+		for(tx=0;tx<MOTION_TILES_X;tx++){
+			vbx_acc(SVW,VADD,sad + ty*MOTION_TILES_X + tx,0,delta + tx*MOTION_TILE);
+		}
 	}
+	vbx_sync();
 
-	return diff;
+	map->total = 0;
+	map->bitmap = 0;
+	map->tiles = 0;
+	map->x0 = THUMBNAIL_WIDTH;
+	map->y0 = THUMBNAIL_HEIGHT;
+	map->x1 = 0;
+	map->y1 = 0;
+	for(t=0;t<MOTION_TILES;t++){
+		map->sad[t] = sad[t];
+		map->total += sad[t];
+		if(map->sad[t] > tile_threshold){
+			tx = t % MOTION_TILES_X;
+			ty = t / MOTION_TILES_X;
+			map->bitmap |= 1<<t;
+			map->tiles++;
+			map->x0 = min(map->x0,tx*MOTION_TILE);
+			map->y0 = min(map->y0,ty*MOTION_TILE);
+			map->x1 = max(map->x1,(tx+1)*MOTION_TILE);
+			map->y1 = max(map->y1,(ty+1)*MOTION_TILE);
+		}
+	}
+	if(!map->tiles){
+		map->x0 = map->y0 = 0;
+	}
+	return map->tiles;
 }
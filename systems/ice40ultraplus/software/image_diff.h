@@ -15,11 +15,51 @@
 
 #define DIFF_THRESH 0x1600
 
+// rows compared between checks against the threshold
+#define DIFF_CHUNK_ROWS 8
+
+// motion_map() tiles, 8x8 pixels with a bit each in the bitmap
+#define MOTION_TILE    8
+#define MOTION_TILES_X (THUMBNAIL_WIDTH/MOTION_TILE)
+#define MOTION_TILES_Y (THUMBNAIL_HEIGHT/MOTION_TILE)
+#define MOTION_TILES   (MOTION_TILES_X*MOTION_TILES_Y)
+#define MOTION_TILE_THRESH (MOTION_TILE*MOTION_TILE*12) // an average of 12 grey levels
+
+// scratchpad abs_image_diff() and motion_map() need at v_tmp
+#define IMAGE_DIFF_TMP_BYTES \
+	((3*max(DIFF_CHUNK_ROWS,MOTION_TILE) + GS_CAM*THUMBNAIL_HEIGHT)*THUMBNAIL_WIDTH*sizeof(vbx_word_t) + \
+	 MOTION_TILES*sizeof(vbx_word_t))
+
+typedef struct {
+	uint32_t sad[MOTION_TILES]; // sum of absolute differences per tile, row by row
+	uint32_t total;
+	uint32_t bitmap;            // bit ty*MOTION_TILES_X+tx set for each moving tile
+	int tiles;                  // moving tiles
+	int x0,y0,x1,y1;            // thumbnail pixels the moving tiles cover, x1 and y1 exclusive
+} motion_map_t;
+
+// Sums the absolute difference between the current thumbnail and the
+// previous one, packed as bytes at imgBb, and leaves the current one packed
+// at prevBuf for the next call. Returns 1 as soon as the sum passes
+// threshold, without looking at the rest of the image, and 0 if it never
+// does. The sum so far goes to *score unless score is 0.
 #if GS_CAM
-uint32_t abs_image_diff(vbx_ubyte_t* imgAb,vbx_ubyte_t* imgBb,vbx_ubyte_t* prevBuf);
+int abs_image_diff(vbx_ubyte_t* imgAb,vbx_ubyte_t* imgBb,vbx_ubyte_t* prevBuf,
+                   const uint32_t threshold,uint32_t* score,vbx_word_t* v_tmp);
 #else
-uint32_t abs_image_diff(vbx_word_t* imgA,vbx_ubyte_t* imgBb,vbx_ubyte_t* prevBuf);
+int abs_image_diff(vbx_word_t* imgA,vbx_ubyte_t* imgBb,vbx_ubyte_t* prevBuf,
+                   const uint32_t threshold,uint32_t* score,vbx_word_t* v_tmp);
 #endif
 
+// Compares the same two images per MOTION_TILE square and fills in map.
+// A tile moves when its sum passes tile_threshold. Returns the number of
+// moving tiles; the box is all 0 when there are none.
+#if GS_CAM
+int motion_map(vbx_ubyte_t* imgAb,vbx_ubyte_t* imgBb,vbx_ubyte_t* prevBuf,
+               const uint32_t tile_threshold,motion_map_t* map,vbx_word_t* v_tmp);
+#else
+int motion_map(vbx_word_t* imgA,vbx_ubyte_t* imgBb,vbx_ubyte_t* prevBuf,
+               const uint32_t tile_threshold,motion_map_t* map,vbx_word_t* v_tmp);
+#endif
 
 #endif
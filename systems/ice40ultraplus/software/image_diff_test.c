@@ -0,0 +1,177 @@
+#include "printf.h"
+#include "vbx.h"
+#include "time.h"
+#include "image_diff.h"
+
+// Checks abs_image_diff() against a plain C sum of absolute differences, that
+// it leaves the current image packed for the next call and that it stops at
+// the first chunk that takes the sum past the threshold. Then checks
+// motion_map()'s tile sums, bitmap and box with a moving block.
+#define PIXELS (THUMBNAIL_WIDTH*THUMBNAIL_HEIGHT)
+#define CHUNKS ((THUMBNAIL_HEIGHT + DIFF_CHUNK_ROWS - 1)/DIFF_CHUNK_ROWS)
+
+#define SP_GS     ((vbx_word_t*)(SCRATCHPAD_BASE + 0*1024))
+#define SP_PREV_A ((vbx_ubyte_t*)(SCRATCHPAD_BASE + 4*1024))
+#define SP_PREV_B ((vbx_ubyte_t*)(SCRATCHPAD_BASE + 5*1024))
+#define SP_TMP    ((vbx_word_t*)(SCRATCHPAD_BASE + 8*1024))
+
+static unsigned seed = 0x13579b;
+static int next_rand()
+{
+	seed = seed*1103515245 + 12345;
+	return (int)(seed >> 8);
+}
+
+// the chunk sums abs_image_diff() adds up, returns the total
+static uint32_t reference(vbx_word_t *gs, vbx_ubyte_t *prev, uint32_t *chunk_sums)
+{
+	int i;
+	uint32_t total = 0;
+	for (i = 0; i < CHUNKS; i++) {
+		chunk_sums[i] = 0;
+	}
+	for (i = 0; i < PIXELS; i++) {
+		int d = gs[i] - prev[i];
+		chunk_sums[i/(DIFF_CHUNK_ROWS*THUMBNAIL_WIDTH)] += d < 0 ? -d : d;
+	}
+	for (i = 0; i < CHUNKS; i++) {
+		total += chunk_sums[i];
+	}
+	return total;
+}
+
+// a previous image, and a current one that differs from it by up to spread
+static void make_images(const int spread)
+{
+	int i;
+	for (i = 0; i < PIXELS; i++) {
+		int p = next_rand() & 0xFF;
+		int g = p + (spread ? next_rand() % (2*spread + 1) - spread : 0);
+		SP_PREV_A[i] = p;
+		SP_GS[i] = g < 0 ? 0 : g > 255 ? 255 : g;
+	}
+}
+
+static int test(const char *name, const int spread, const int threshold_percent)
+{
+	int i, moved, errors = 0;
+	uint32_t chunk_sums[CHUNKS], total, threshold, score, expected;
+	unsigned cycles;
+
+	make_images(spread);
+	total = reference(SP_GS, SP_PREV_A, chunk_sums);
+	threshold = threshold_percent < 100 ? (uint32_t)((long long)total*threshold_percent/100) : 0xFFFFFFFF;
+	// the chunk that takes the sum past the threshold is the last one looked at
+	expected = 0;
+	for (i = 0; i < CHUNKS && expected <= threshold; i++) {
+		expected += chunk_sums[i];
+	}
+
+	for (i = 0; i < PIXELS; i++) {
+		SP_PREV_B[i] = 0xA5;
+	}
+	cycles = get_time();
+	moved = abs_image_diff(SP_GS, SP_PREV_A, SP_PREV_B, threshold, &score, SP_TMP);
+	cycles = get_time() - cycles;
+
+	if (score != expected || moved != (expected > threshold)) {
+		printf("%s: score %d moved %d, expected %d moved %d\r\n", name,
+		       (int)score, moved, (int)expected, expected > threshold);
+		errors++;
+	}
+	for (i = 0; i < PIXELS; i++) {
+		if (SP_PREV_B[i] != SP_GS[i]) {
+			printf("%s: packed pixel %d is %d, not %d\r\n", name, i, SP_PREV_B[i], (int)SP_GS[i]);
+			errors++;
+			break;
+		}
+	}
+	printf("%-24s score %6d of %6d, %d cycles %s\r\n", name, (int)score, (int)total, cycles,
+	       errors ? "Failed" : "Passed");
+	return errors;
+}
+
+// noise everywhere, and the block x0,y0 to x1,y1 brightened by 100
+static int test_map(const char *name, const int x0, const int y0, const int x1, const int y1)
+{
+	int i, x, y, t, tiles, errors = 0;
+	uint32_t sad[MOTION_TILES], bitmap = 0;
+	int bx0 = THUMBNAIL_WIDTH, by0 = THUMBNAIL_HEIGHT, bx1 = 0, by1 = 0;
+	motion_map_t map;
+	unsigned cycles;
+
+	make_images(3);
+	for (y = y0; y < y1; y++) {
+		for (x = x0; x < x1; x++) {
+			i = y*THUMBNAIL_WIDTH + x;
+			SP_GS[i] = SP_PREV_A[i] < 156 ? SP_PREV_A[i] + 100 : SP_PREV_A[i] - 100;
+		}
+	}
+
+	for (t = 0; t < MOTION_TILES; t++) {
+		sad[t] = 0;
+	}
+	for (i = 0; i < PIXELS; i++) {
+		int d = SP_GS[i] - SP_PREV_A[i];
+		x = i % THUMBNAIL_WIDTH;
+		y = i / THUMBNAIL_WIDTH;
+		sad[(y/MOTION_TILE)*MOTION_TILES_X + x/MOTION_TILE] += d < 0 ? -d : d;
+	}
+	for (t = 0; t < MOTION_TILES; t++) {
+		if (sad[t] > MOTION_TILE_THRESH) {
+			x = t % MOTION_TILES_X;
+			y = t / MOTION_TILES_X;
+			bitmap |= 1 << t;
+			bx0 = min(bx0, x*MOTION_TILE);
+			by0 = min(by0, y*MOTION_TILE);
+			bx1 = max(bx1, (x+1)*MOTION_TILE);
+			by1 = max(by1, (y+1)*MOTION_TILE);
+		}
+	}
+	if (!bitmap) {
+		bx0 = by0 = 0;
+	}
+
+	cycles = get_time();
+	tiles = motion_map(SP_GS, SP_PREV_A, SP_PREV_B, MOTION_TILE_THRESH, &map, SP_TMP);
+	cycles = get_time() - cycles;
+
+	for (t = 0; t < MOTION_TILES; t++) {
+		if (map.sad[t] != sad[t]) {
+			printf("%s: tile %d sad %d, expected %d\r\n", name, t, (int)map.sad[t], (int)sad[t]);
+			errors++;
+		}
+	}
+	if (map.bitmap != bitmap || tiles != map.tiles ||
+	    map.x0 != bx0 || map.y0 != by0 || map.x1 != bx1 || map.y1 != by1) {
+		printf("%s: tiles %04x box %d,%d to %d,%d, expected %04x box %d,%d to %d,%d\r\n", name,
+		       (int)map.bitmap, map.x0, map.y0, map.x1, map.y1, (int)bitmap, bx0, by0, bx1, by1);
+		errors++;
+	}
+	printf("%-24s tiles %04x box %d,%d to %d,%d, %d cycles %s\r\n", name, (int)map.bitmap,
+	       map.x0, map.y0, map.x1, map.y1, cycles, errors ? "Failed" : "Passed");
+	return errors;
+}
+
+int main()
+{
+	int errors = 0;
+
+	printf("\r\nimage diff test\r\n");
+	init_lve();
+
+	errors += test("still", 0, 100);
+	errors += test("noise", 8, 100);
+	errors += test("motion", 255, 100);
+	errors += test("motion, early exit", 255, 20);
+	errors += test("motion, last chunk", 255, 90);
+	errors += test("threshold 0", 4, 0);
+
+	errors += test_map("map, still", 0, 0, 0, 0);
+	errors += test_map("map, one tile", 9, 17, 15, 23);
+	errors += test_map("map, block", 5, 3, 21, 14);
+	errors += test_map("map, corner", 24, 24, 32, 32);
+
+	printf("DONE -- errors = %d %s\r\n\r\n", errors, errors ? "FAILED :(" : "PASSED :)");
+	return errors;
+}
@@ -0,0 +1,232 @@
+#include "uart.h"
+#include "time.h"
+#include "base64.h"
+#include "img_upload.h"
+
+#define CHAR_CYCLES (10*(ORCA_CLK/UART_BAUD)) // start, 8 data and stop bits
+
+static struct {
+	const uint8_t* data;
+	int len,sent,seq;
+	int frame;
+} job;
+
+// the frame bytes in stream order, less their left (or upper) neighbour for
+// IMG_DELTA_RLE and IMG_DELTA4
+static void img_samples(uint8_t* out, const img_t* img, const int delta)
+{
+	int x,y,c;
+	for(y=0;y<img->height;y++){
+		const uint8_t* row = img->pixels + y*img->pitch;
+		for(x=0;x<img->width;x++){
+			const uint8_t* pixel = row + x*img->stride;
+			for(c=0;c<img->channels;c++){
+				uint8_t v = pixel[c*img->plane];
+				if(delta){
+					if(x){
+						v -= pixel[c*img->plane - img->stride];
+					}else if(y){
+						v -= pixel[c*img->plane - img->pitch];
+					}
+				}
+				*out++ = v;
+			}
+		}
+	}
+}
+
+// PackBits: n+1 literal bytes follow a control byte n of 0 to 127, the next
+// byte repeats 1-n times for n of -1 to -127. out may start up to
+// IMG_STAGE_BYTES() - IMG_HEADER_BYTES - len bytes below in, the output never
+// catches up with the input it still has to read.
+static int packbits(uint8_t* out, const uint8_t* in, const int len)
+{
+	int i = 0, o = 0;
+	while(i<len){
+		int run = 1;
+		while(i+run<len && run<128 && in[i+run]==in[i]){
+			run++;
+		}
+		if(run>=3){
+			uint8_t v = in[i];
+			out[o++] = (uint8_t)(1-run);
+			out[o++] = v;
+			i += run;
+			continue;
+		}
+
+		// literals up to the next run of 3
+		int start = i, lit = 0;
+		while(i<len && lit<128){
+			if(i+2<len && in[i]==in[i+1] && in[i]==in[i+2]){
+				break;
+			}
+			i++;
+			lit++;
+		}
+		out[o++] = lit-1;
+		while(lit--){
+			out[o++] = in[start++];
+		}
+	}
+	return o;
+}
+
+// the differences as nibbles, returns 0 when the output would catch up with
+// the input, which starts slack bytes above it
+static int delta4(uint8_t* out, const uint8_t* in, const int len, const int slack)
+{
+	int i, n = 0;
+	for(i=0;i<len;i++){
+		int8_t d = in[i];
+		if(n/2 + 2 > i + slack){
+			return 0;
+		}
+		if(d >= -7 && d <= 7){
+			out[n/2] = n&1 ? out[n/2] | (d & 0xF) : d<<4;
+			n++;
+		}else{
+			int k, nibbles[3] = {8, (d>>4) & 0xF, d & 0xF};
+			for(k=0;k<3;k++,n++){
+				out[n/2] = n&1 ? out[n/2] | nibbles[k] : nibbles[k]<<4;
+			}
+		}
+	}
+	return (n+1)/2;
+}
+
+int img_encode(uint8_t* out, const img_t* img, int compress, int frame)
+{
+	int bytes = img->width*img->height*img->channels;
+	uint8_t* data = out + IMG_HEADER_BYTES;
+	int len = bytes;
+
+	if(compress != IMG_NONE){
+		// the samples go at the end of the staging buffer and are packed
+		// forwards from its start
+		int slack = bytes/128 + 2;
+		uint8_t* samples = data + slack;
+		img_samples(samples,img,compress != IMG_RLE);
+		if(compress == IMG_DELTA4){
+			len = delta4(data,samples,bytes,slack);
+		}else{
+			len = packbits(data,samples,bytes);
+		}
+		if(!len || len >= bytes){
+			compress = IMG_NONE;
+		}
+	}
+	if(compress == IMG_NONE){
+		img_samples(data,img,0);
+		len = bytes;
+	}
+
+	out[0] = 'I';
+	out[1] = 'M';
+	out[2] = img->channels;
+	out[3] = compress;
+	out[4] = frame;
+	out[5] = 0;
+	out[6] = img->width; out[7] = img->width>>8;
+	out[8] = img->height; out[9] = img->height>>8;
+	out[10] = len; out[11] = len>>8;
+	return IMG_HEADER_BYTES + len;
+}
+
+int img_upload_start(uint8_t* stage, const img_t* img, int compress)
+{
+	if(job.sent < job.len){
+		return 0;
+	}
+	job.data = stage;
+	job.len = img_encode(stage,img,compress,job.frame++);
+	job.sent = 0;
+	job.seq = 0;
+	return job.len;
+}
+
+// characters on the wire for the next packet
+static int packet_chars()
+{
+	int len = job.len-job.sent < IMG_PACKET_BYTES ? job.len-job.sent : IMG_PACKET_BYTES;
+#if IMG_UPLOAD_RAW
+	return 2 + len + 3;
+#else
+	return 4 + BASE64_LEN(len + 3) + 2;
+#endif
+}
+
+// seq, length, the bytes and their 8-bit sum, built in one buffer and written
+// to the UART in one go
+static void send_packet()
+{
+	static uint8_t body[IMG_PACKET_BYTES + 3];
+#if IMG_UPLOAD_RAW
+	static char tx[2 + sizeof(body)];
+	char* wire = tx + 2;
+	tx[0] = IMG_SYNC0;
+	tx[1] = IMG_SYNC1;
+#else
+	static char tx[4 + BASE64_LEN(sizeof(body)) + 2];
+	tx[0] = 'I'; tx[1] = 'M'; tx[2] = 'G'; tx[3] = ' ';
+#endif
+	int i, chars, len = job.len-job.sent < IMG_PACKET_BYTES ? job.len-job.sent : IMG_PACKET_BYTES;
+	uint8_t sum;
+
+	body[0] = job.seq;
+	body[1] = len;
+	sum = body[0] + body[1];
+	for(i=0;i<len;i++){
+		body[2+i] = job.data[job.sent+i];
+		sum += body[2+i];
+	}
+	body[2+len] = sum;
+
+#if IMG_UPLOAD_RAW
+	for(i=0;i<len+3;i++){
+		wire[i] = body[i];
+	}
+	chars = 2 + len + 3;
+#else
+	chars = 4 + base64_encode(tx+4,body,len+3);
+	tx[chars++] = '\r';
+	tx[chars++] = '\n';
+#endif
+	for(i=0;i<chars;i++){
+		mputc(DEFAULT_PUTP,tx[i]);
+	}
+	job.sent += len;
+	job.seq++;
+}
+
+int img_upload_poll(int packets)
+{
+	while(packets-- && job.sent < job.len){
+		send_packet();
+	}
+	return job.len - job.sent;
+}
+
+void img_upload_until(unsigned cycle)
+{
+	while(job.sent < job.len && (int)(cycle - get_time()) > packet_chars()*CHAR_CYCLES){
+		send_packet();
+	}
+}
+
+void img_upload_wait(unsigned ms)
+{
+	unsigned end = get_time() + ms2cycle(ms);
+	img_upload_until(end);
+	sleepuntil(end);
+	// cores without the sleep CSR return at once
+	while((int)(end - get_time()) > 0){
+	}
+}
+
+void img_upload_flush()
+{
+	while(job.sent < job.len){
+		send_packet();
+	}
+}
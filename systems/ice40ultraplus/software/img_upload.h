@@ -0,0 +1,65 @@
+#ifndef IMG_UPLOAD_H
+#define IMG_UPLOAD_H
+
+#include <stdint.h>
+
+// Frame dumps for get_image.py. img_upload_start() compresses a frame into a
+// staging buffer and the other calls send it a packet at a time, so printf
+// output between them lands between packets and never inside one.
+
+// 1 sends the packets as binary behind IMG_SYNC0/IMG_SYNC1, 0 as
+// "IMG <base64>" lines, which take a third more bytes but survive a terminal
+#define IMG_UPLOAD_RAW 0
+#define IMG_SYNC0 0xA5
+#define IMG_SYNC1 0x5A
+
+#define IMG_PACKET_BYTES 48 // frame bytes per packet
+
+// compression
+#define IMG_NONE      0
+#define IMG_RLE       1 // PackBits
+#define IMG_DELTA_RLE 2 // PackBits of each byte less the one to its left, or above in the first column
+#define IMG_DELTA4    3 // the same differences 2 to a byte, high nibble first, 8 and 2 more nibbles for
+                        // those outside -7 to 7
+
+// 'I','M', channels, compression, frame number, 0, then width, height and
+// the bytes that follow, 16 bits little endian each
+#define IMG_HEADER_BYTES 12
+
+// bytes img_encode() may write for a frame, PackBits adds 1 byte in 128 at worst
+// and IMG_DELTA4 gives up before it catches up with its input
+#define IMG_STAGE_BYTES(width,height,channels) \
+	(IMG_HEADER_BYTES + (width)*(height)*(channels) + (width)*(height)*(channels)/128 + 2)
+
+typedef struct {
+	const uint8_t* pixels; // first channel of the top left pixel
+	int width,height,channels;
+	int stride; // bytes from a pixel to the next one in its row
+	int pitch;  // bytes from a row to the next
+	int plane;  // bytes from a channel to the next, 1 for interleaved pixels
+} img_t;
+
+// Writes the header and the pixels, row by row with the channels of each
+// pixel together, to out. Falls back to IMG_NONE when compressing does not
+// make the frame smaller. Returns the bytes written.
+int img_encode(uint8_t* out, const img_t* img, int compress, int frame);
+
+// Encodes img into stage, which must hold IMG_STAGE_BYTES() and stay
+// untouched until the upload is done. Returns 0 and drops the frame when the
+// last one is still going out, else the bytes to send.
+int img_upload_start(uint8_t* stage, const img_t* img, int compress);
+
+// Sends up to packets packets, returns the bytes still to send.
+int img_upload_poll(int packets);
+
+// Sends the packets that fit before get_time() reaches cycle.
+void img_upload_until(unsigned cycle);
+
+// delayms() that sends packets while it waits, as many as fit in ms, and
+// sleeps the core for the rest.
+void img_upload_wait(unsigned ms);
+
+// Sends whatever is left.
+void img_upload_flush();
+
+#endif //IMG_UPLOAD_H
@@ -0,0 +1,161 @@
+#include "printf.h"
+#include "vbx.h"
+#include "time.h"
+#include "base64.h"
+#include "img_upload.h"
+
+// Checks base64_encode() against known strings, and that img_encode()'s
+// output unpacks to the frame for each compression. Nothing is sent, see
+// get_image.py for the other end of the UART.
+#define W 32
+#define H 32
+
+#define SP_FRAME ((uint8_t*)(SCRATCHPAD_BASE + 0*1024))  // 32x32 RGB planes, 3K
+#define SP_STAGE ((uint8_t*)(SCRATCHPAD_BASE + 4*1024))
+#define SP_OUT   ((uint8_t*)(SCRATCHPAD_BASE + 8*1024))
+
+static unsigned seed = 0x2468ace;
+static int next_rand()
+{
+	seed = seed*1103515245 + 12345;
+	return (int)(seed >> 8);
+}
+
+static int test_base64(const char *in, const char *expected)
+{
+	char out[16];
+	int i, len = 0, errors = 0;
+	while(in[len]) len++;
+	int chars = base64_encode(out, (const uint8_t*)in, len);
+	for (i = 0; i < chars; i++) {
+		if (!expected[i] || out[i] != expected[i]) errors++;
+	}
+	if (expected[chars] || chars != BASE64_LEN(len)) errors++;
+	printf("base64 \"%s\" %s\r\n", in, errors ? "Failed" : "Passed");
+	return errors;
+}
+
+// undoes img_encode(), returns the frame bytes or -1
+static int decode(uint8_t *out, const uint8_t *in)
+{
+	int channels = in[2], compress = in[3];
+	int width = in[6] | in[7]<<8, height = in[8] | in[9]<<8, len = in[10] | in[11]<<8;
+	int i, o = 0, bytes = width*height*channels;
+	if (in[0] != 'I' || in[1] != 'M') return -1;
+	in += IMG_HEADER_BYTES;
+	if (compress == IMG_NONE) {
+		for (i = 0; i < len; i++) out[i] = in[i];
+		return len;
+	}
+	if (compress == IMG_DELTA4) {
+		// nibble i
+		for (i = 0; i < 2*len && o < bytes; i++) {
+			int n = i&1 ? in[i/2] & 0xF : in[i/2] >> 4;
+			if (n == 8) {
+				out[o++] = ((i+1)&1 ? in[(i+1)/2] & 0xF : in[(i+1)/2] >> 4) << 4 |
+				           ((i+2)&1 ? in[(i+2)/2] & 0xF : in[(i+2)/2] >> 4);
+				i += 2;
+			} else {
+				out[o++] = n & 8 ? n - 16 : n;
+			}
+		}
+		if ((i+1)/2 != len) return -1;
+	} else for (i = 0; i < len && o < bytes; ) {
+		int n = (int8_t)in[i++];
+		if (n >= 0) {
+			while (n-- >= 0) out[o++] = in[i++];
+		} else if (n != -128) {
+			n = 1-n;
+			while (n--) out[o++] = in[i];
+			i++;
+		}
+	}
+	if (o != bytes || (compress != IMG_DELTA4 && i != len)) return -1;
+	if (compress != IMG_RLE) {
+		for (i = 0; i < bytes; i++) {
+			int x = (i/channels) % width;
+			if (x) {
+				out[i] += out[i - channels];
+			} else if (i >= width*channels) {
+				out[i] += out[i - width*channels];
+			}
+		}
+	}
+	return o;
+}
+
+static int test_frame(const char *name, const img_t *img, const int compress)
+{
+	int x, y, c, i = 0, errors = 0, bytes = img->width*img->height*img->channels;
+	unsigned cycles = get_time();
+	int len = img_encode(SP_STAGE, img, compress, 0);
+	cycles = get_time() - cycles;
+
+	if (len > IMG_STAGE_BYTES(img->width, img->height, img->channels) || decode(SP_OUT, SP_STAGE) != bytes) {
+		printf("%s: does not decode\r\n", name);
+		errors++;
+	} else {
+		for (y = 0; y < img->height; y++) {
+			for (x = 0; x < img->width; x++) {
+				for (c = 0; c < img->channels; c++, i++) {
+					int p = img->pixels[y*img->pitch + x*img->stride + c*img->plane];
+					if (SP_OUT[i] != p && !errors++) {
+						printf("%s: %d,%d channel %d is %d, not %d\r\n", name, x, y, c, SP_OUT[i], p);
+					}
+				}
+			}
+		}
+	}
+	printf("%-24s %4d of %4d bytes, type %d, %d cycles %s\r\n", name, len - IMG_HEADER_BYTES, bytes,
+	       SP_STAGE[3], cycles, errors ? "Failed" : "Passed");
+	return errors;
+}
+
+int main()
+{
+	int i, x, y, errors = 0;
+	img_t gray = { SP_FRAME, W, H, 1, 1, W, 1 };
+	img_t rgb = { SP_FRAME, W, H, 3, 1, W, W*H };
+	img_t rgbx = { SP_FRAME, W/2, H/2, 3, 4, 2*W, 1 }; // camera style words
+
+	printf("\r\nimage upload test\r\n");
+	init_lve();
+
+	errors += test_base64("Man", "TWFu");
+	errors += test_base64("Ma", "TWE=");
+	errors += test_base64("M", "TQ==");
+	errors += test_base64("pleasure.", "cGxlYXN1cmUu");
+
+	// a gradient with a little noise, like a camera thumbnail
+	for (i = 0; i < 3*W*H; i++) {
+		x = i % W;
+		y = (i / W) % H;
+		SP_FRAME[i] = 4*x + 2*y + (next_rand() & 3);
+	}
+	errors += test_frame("gray, raw", &gray, IMG_NONE);
+	errors += test_frame("gray, rle", &gray, IMG_RLE);
+	errors += test_frame("gray, delta rle", &gray, IMG_DELTA_RLE);
+	errors += test_frame("rgb planes, delta rle", &rgb, IMG_DELTA_RLE);
+	errors += test_frame("rgbx words, delta rle", &rgbx, IMG_DELTA_RLE);
+	errors += test_frame("gray, delta4", &gray, IMG_DELTA4);
+	errors += test_frame("rgb planes, delta4", &rgb, IMG_DELTA4);
+	errors += test_frame("rgbx words, delta4", &rgbx, IMG_DELTA4);
+
+	for (i = 0; i < 3*W*H; i++) {
+		SP_FRAME[i] = i < W*H/2 ? 0 : 200;
+	}
+	errors += test_frame("flat, rle", &gray, IMG_RLE);
+	errors += test_frame("flat rgb, delta rle", &rgb, IMG_DELTA_RLE);
+	errors += test_frame("flat, delta4", &gray, IMG_DELTA4);
+
+	// noise does not compress, so goes out raw
+	for (i = 0; i < 3*W*H; i++) {
+		SP_FRAME[i] = next_rand();
+	}
+	errors += test_frame("noise, rle", &gray, IMG_RLE);
+	errors += test_frame("noise rgb, delta rle", &rgb, IMG_DELTA_RLE);
+	errors += test_frame("noise, delta4", &gray, IMG_DELTA4);
+
+	printf("DONE -- errors = %d %s\r\n\r\n", errors, errors ? "FAILED :(" : "PASSED :)");
+	return errors;
+}
@@ -0,0 +1,76 @@
+#include "printf.h"
+#include "vbx.h"
+#include "time.h"
+#include "i2s.h"
+
+// Captures the mics in blocks while a stand-in for the beamforming work runs
+// on the other block, and checks no block is lost and the timestamps keep to
+// the sample rate. A pass that takes too long per block has to count overruns
+// instead.
+#define MIC_HZ        8000
+#define BLOCK_SAMPLES 64
+#define BLOCKS        64
+#define BLOCK_CYCLES  (ORCA_CLK/MIC_HZ*BLOCK_SAMPLES)
+
+#define SP_CAPTURE ((int32_t*)(SCRATCHPAD_BASE + 0*1024))
+
+// busy for cycles, draining the fifo every 16 samples like a compute loop would
+static void work(const unsigned cycles)
+{
+	unsigned start = get_time();
+	while (get_time() - start < cycles) {
+#if !I2S_CAPTURE_USE_INTERRUPT
+		unsigned poll = get_time();
+		while (get_time() - poll < 16*(ORCA_CLK/MIC_HZ) && get_time() - start < cycles);
+		i2s_capture_service();
+#endif
+	}
+}
+
+static int run(const unsigned cycles, const int expect_overruns)
+{
+	int b, errors = 0, late = 0;
+	unsigned last_index = 0, last_time = 0;
+
+	i2s_capture_start(SP_CAPTURE, BLOCK_SAMPLES);
+	for (b = 0; b < BLOCKS; b++) {
+		i2s_block_t *block = i2s_wait_block();
+		if (b) {
+			// a block period is allowed to be off by what a fifo drain can lag
+			int period = (block->timestamp - last_time)/(block->index - last_index);
+			if (period < BLOCK_CYCLES - BLOCK_CYCLES/2 || period > BLOCK_CYCLES + BLOCK_CYCLES/2) {
+				late++;
+			}
+		}
+		last_index = block->index;
+		last_time = block->timestamp;
+		work(cycles);
+	}
+
+	printf("%d cycles/block: %d blocks, %d overruns, %d fifo overflows, %d off period\r\n",
+	       (int)cycles, (int)i2s_capture_stats.blocks, (int)i2s_capture_stats.block_overruns,
+	       (int)i2s_capture_stats.fifo_overflows, late);
+	if (expect_overruns) {
+		errors += i2s_capture_stats.block_overruns == 0;
+	} else {
+		errors += i2s_capture_stats.block_overruns != 0;
+		errors += i2s_capture_stats.fifo_overflows != 0;
+	}
+	errors += late != 0;
+	printf("%s\r\n", errors ? "Failed" : "Passed");
+	return errors;
+}
+
+int main()
+{
+	int errors = 0;
+
+	printf("mic capture test\r\n");
+	i2s_set_frequency(ORCA_CLK, MIC_HZ);
+
+	errors += run(BLOCK_CYCLES*3/4, 0);
+	errors += run(BLOCK_CYCLES*5/2, 1);
+
+	printf("DONE -- errors = %d %s\r\n\r\n", errors, errors ? "FAILED :(" : "PASSED :)");
+	return errors;
+}
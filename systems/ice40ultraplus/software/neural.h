@@ -63,13 +63,77 @@ typedef union {
 } layer_t;
 
 
+// one stage of a classifier cascade, see run_cascade() in cascade.c
+typedef struct {
+    const char *name;
+    layer_t *network;
+    int threshold; // exit at this stage when top-1 minus top-2 score >= threshold
+    unsigned runs;
+    unsigned exits;
+    unsigned cycles;
+} cascade_stage_t;
+
+// the three padded 32x32 byte planes run_network() starts from, in words
+#define CASCADE_INPUT_WORDS (3*(32+2)*(32+4)/4)
+
+
 extern layer_t cifar_golden[];
 extern layer_t cifar_reduced[];
 void cifar_lve();
 void vbx_flash_dma(vbx_word_t *v_dst, int flash_byte_offset, const int bytes);
 void vbx_flash_dma_async(vbx_word_t *v_dst, int flash_byte_offset, const int bytes);
 void zeropad_input(vbx_ubyte_t *v_out, vbx_ubyte_t *v_in, const int m, const int n);
+vbx_word_t* run_network(layer_t *cifar, const int verbose);
+// Runs stages in order until one's top two scores are threshold apart, the
+// last stage always answers.
+vbx_word_t* run_cascade(cascade_stage_t *stages, const int num_stages,
+                        vbx_word_t *v_in, vbx_word_t *v_in_copy, const int verbose);
+
+// Camera pixel layouts, one or two pixels to a word
+enum CAM_FORMAT {
+    CAM_XRGB,   // blue in the low byte, red in the third: what wb_cam writes
+    CAM_RGBA,   // red in the low byte, blue in the third
+    CAM_RGB565, // left pixel in the low half, red in the top 5 bits of each
+    CAM_YUV422  // Y0 U Y1 V from the low byte up, BT.601 full range
+};
+
+// How cam_preprocess_format() reads the camera and scales its channels: each
+// becomes ((value - mean)*scale >> 8) + offset saturated to a byte, red first.
+// The grayscale image is made before the scaling.
+typedef struct {
+    int format;
+    int flip; // mirror left to right
+    int mean[3];
+    int scale[3];
+    int offset[3];
+} cam_format_t;
+
+#define CAM_FORMAT_DEFAULT {CAM_XRGB, 0, {0, 0, 0}, {256, 256, 256}, {0, 0, 0}}
+
+// Makes the network input from rows x cols of RGBA camera words at v_rgba,
+// pitch words apart: three zero padded (rows+2)x(cols+4) byte planes at
+// v_padb, red first, and unless v_gs is 0 the rows x cols grayscale image
+// convert_rgb2grayscale() makes from the same pixels, as words. cols must be
+// a multiple of 4.
+#define CAM_PREPROCESS_TMP_BYTES(rows, cols) (((rows)+3)*((cols)+4)*sizeof(vbx_word_t))
+void cam_preprocess(vbx_ubyte_t *v_padb, vbx_word_t *v_gs, vbx_word_t *v_rgba,
+                    const int rows, const int cols, const int pitch, vbx_word_t *v_tmp);
+// cam_preprocess() for the camera words fmt describes, pitch is still in
+// words and covers cols/2 of them for the two pixel formats.
+void cam_preprocess_format(vbx_ubyte_t *v_padb, vbx_word_t *v_gs, vbx_word_t *v_cam,
+                           const int rows, const int cols, const int pitch, vbx_word_t *v_tmp,
+                           const cam_format_t *fmt);
 void convolution_ci_lve(vbx_ubyte_t *v_outb, vbx_ubyte_t *v_inb, convolution_layer_t *layer, const int debug);
 void dense_lve(vbx_word_t *v_out, vbx_word_t *v_in, dense_layer_t *layer);
+void convolution_ci_lve_batch(vbx_ubyte_t **v_outb, vbx_ubyte_t **v_inb, const int frames, convolution_layer_t *layer);
+typedef void (*tile_fetch_t)(vbx_void_t *v_dst, const int src, const int bytes);
+typedef void (*tile_store_t)(const int dst, vbx_void_t *v_src, const int bytes);
+void tile_fetch_mem(vbx_void_t *v_dst, const int src, const int bytes);
+void tile_fetch_flash(vbx_void_t *v_dst, const int src, const int bytes);
+void tile_store_mem(const int dst, vbx_void_t *v_src, const int bytes);
+// work_bytes at v_work must be free for the whole call, bands are sized to it
+int convolution_ci_lve_tiled(const int dst, const int src, convolution_layer_t *layer,
+                             tile_fetch_t fetch, tile_store_t store, vbx_void_t *v_work, const int work_bytes);
+void dense_lve_batch(vbx_word_t **v_out, vbx_word_t **v_in, const int frames, dense_layer_t *layer);
 
 #endif // __NEURAL_H__
@@ -25,8 +25,9 @@ static int ovm_read_reg(int reg_addr)
 
 
 
-#define PIO_BIT_START 2
-#define PIO_BIT_DONE  3
+#define PIO_BIT_START  2
+#define PIO_BIT_DONE   3
+#define PIO_BIT_BUFFER 11 //2 bits, which 8K frame buffer the camera writes
 
 static void ovm_set_bit( int bitpos )
 {
@@ -52,13 +53,35 @@ static int ovm_isdone()
 	return !ovm_get_bit( PIO_BIT_DONE );
 }
 
+//only takes effect while the camera is idle
+static void ovm_select_buffer( int buffer )
+{
+	volatile unsigned *p = (volatile unsigned *)(&( SCCB_PIO_BASE[PIO_DATA_REGISTER] ));
+	*p = (*p & ~(3<<PIO_BIT_BUFFER)) | (buffer<<PIO_BIT_BUFFER);
+}
+
 
 
+//The camera does not answer on SCCB until this long after power up
+#define OVM_POWERUP_MS 500
+//Read every configuration register back after writing it
+#define OVM_VERIFY_CONFIG 0
+
 static int ovm_configure()
 {
+	static int powered_up=0;
 	ovm_printf("STARTING OVM configuration\r\n");
-	delayms(500);
+	//counted from boot, reconfiguring after a wake starts at once; a busy
+	//wait so it holds on cores where the sleep CSR does not stall
+	if(!powered_up){
+		while(get_time() < ms2cycle(OVM_POWERUP_MS)){
+		}
+		powered_up=1;
+	}
 	ovm_printf("Done Delay\r\n");
+#if OVM_VERBOSE
+	unsigned start=get_time();
+#endif
 	sccb_init(SCCB_PIO_BASE);
 
 	uint8_t pidh = ovm_read_reg(OVM7692_SUBADDRESS_PIDH);
@@ -73,22 +96,25 @@ static int ovm_configure()
 		ovm_printf("Error: WRITE FAILED \r\n");
 		return 1;
 	}
-	int i;
 	ovm_printf("Writing Configuration Registers...");
-	for(i=0;i<(sizeof(regval_list)/sizeof(regval_list[0]));i++){
-		ovm_write_reg(regval_list[i].addr,regval_list[i].val);
-		delayms(2);
+	int mismatches=sccb_write_table(SCCB_PIO_BASE, OVM7692_ADDRESS, regval_list,
+	                                sizeof(regval_list)/sizeof(regval_list[0]), OVM_VERIFY_CONFIG);
+	if(mismatches){
+		ovm_printf("Error: %d registers did not read back\r\n",mismatches);
+		return 1;
 	}
 
-	ovm_printf("Done\r\n");
+#if OVM_VERBOSE
+	ovm_printf("Done in %d ms\r\n",cycle2ms(get_time()-start));
+#endif
 	return 0;
 }
 
 static int initialized=0;
 
 
-#define INCOMING_COLS 64
-#define INCOMING_ROWS 32
+#define INCOMING_COLS OVM_FRAME_COLS
+#define INCOMING_ROWS OVM_FRAME_ROWS
 
 #define OUT_COLS 32
 #define OUT_ROWS 32
@@ -122,6 +148,7 @@ int ovm_get_frame()
 	}
 	ovm_printf("is initialized\r\n");
 	// tell camera to capture a frame
+	ovm_select_buffer( 0 );
 	ovm_set_bit( PIO_BIT_START );
 	ovm_printf("start bit set\r\n");
 	// wait until FSM actually starts
@@ -150,6 +177,7 @@ int ovm_get_frame_async()
 	}
 	ovm_printf("is initialized\r\n");
 	// tell camera to capture a frame
+	ovm_select_buffer( 0 );
 	ovm_set_bit( PIO_BIT_START );
 	ovm_printf("start bit set\r\n");
 	// wait until FSM actually starts
@@ -173,3 +201,154 @@ int ovm_wait_frame()
 
 	return 0;
 }
+
+
+enum{ BUF_FREE, BUF_CAPTURE, BUF_READY, BUF_HELD };
+enum{ STREAM_OFF, STREAM_ARMING, STREAM_CAPTURING, STREAM_STALLED };
+
+volatile ovm_stream_stats_t ovm_stream_stats;
+
+static volatile struct{
+	int buffers;
+	int state;
+	int current; //buffer being captured
+	int stop;
+	ovm_frame_callback_t callback;
+	int buf_state[OVM_MAX_FRAME_BUFFERS];
+	unsigned buf_index[OVM_MAX_FRAME_BUFFERS];
+}stream;
+
+static uint32_t *ovm_frame_buffer(int b)
+{
+	return (uint32_t*)((char*)OVM_DMA_BUFFER + b*OVM_FRAME_BYTES);
+}
+
+//a free buffer, or else the oldest frame nobody has taken other than keep
+static int ovm_next_buffer(int keep)
+{
+	int b,oldest=-1;
+	for(b=0;b<stream.buffers;b++){
+		if(stream.buf_state[b]==BUF_FREE){
+			return b;
+		}
+	}
+	for(b=0;b<stream.buffers;b++){
+		if(b!=keep && stream.buf_state[b]==BUF_READY &&
+		   (oldest<0 || stream.buf_index[b]<stream.buf_index[oldest])){
+			oldest=b;
+		}
+	}
+	if(oldest>=0){
+		ovm_stream_stats.dropped++;
+	}
+	return oldest;
+}
+
+static void ovm_stream_arm(int keep)
+{
+	int b=ovm_next_buffer(keep);
+	if(b<0){
+		if(stream.state!=STREAM_STALLED){
+			ovm_stream_stats.stalls++;
+		}
+		stream.state=STREAM_STALLED;
+		return;
+	}
+	stream.current=b;
+	stream.buf_state[b]=BUF_CAPTURE;
+	ovm_select_buffer(b);
+	ovm_set_bit( PIO_BIT_START );
+	stream.state=STREAM_ARMING;
+}
+
+int ovm_stream_start(int buffers,ovm_frame_callback_t callback)
+{
+	int b;
+	if(!initialized || buffers<2 || buffers>OVM_MAX_FRAME_BUFFERS || stream.state!=STREAM_OFF){
+		return 1;
+	}
+	stream.buffers=buffers;
+	stream.callback=callback;
+	stream.stop=0;
+	for(b=0;b<buffers;b++){
+		stream.buf_state[b]=BUF_FREE;
+	}
+	ovm_stream_stats.frames=0;
+	ovm_stream_stats.dropped=0;
+	ovm_stream_stats.stalls=0;
+	ovm_stream_arm(-1);
+	return 0;
+}
+
+int ovm_stream_service()
+{
+	int finished=0;
+	if(stream.state==STREAM_ARMING && !ovm_isdone()){
+		//the frame has started, don't let the camera go on to another one
+		ovm_clear_bit( PIO_BIT_START );
+		stream.state=STREAM_CAPTURING;
+	}
+	if(stream.state==STREAM_CAPTURING && ovm_isdone()){
+		int b=stream.current;
+		unsigned index=ovm_stream_stats.frames++;
+		stream.buf_index[b]=index;
+		stream.buf_state[b]=stream.callback ? BUF_HELD : BUF_READY;
+		stream.state=STREAM_OFF;
+		if(!stream.stop){
+			ovm_stream_arm(b);
+		}
+		finished=1;
+		if(stream.callback && !stream.callback(ovm_frame_buffer(b),index)){
+			ovm_stream_release(ovm_frame_buffer(b));
+		}
+	}
+	return finished;
+}
+
+uint32_t *ovm_stream_get(unsigned *index)
+{
+	int b,oldest=-1;
+#if !OVM_STREAM_USE_INTERRUPT
+	ovm_stream_service();
+#endif
+	for(b=0;b<stream.buffers;b++){
+		if(stream.buf_state[b]==BUF_READY &&
+		   (oldest<0 || stream.buf_index[b]<stream.buf_index[oldest])){
+			oldest=b;
+		}
+	}
+	if(oldest<0){
+		return 0;
+	}
+	stream.buf_state[oldest]=BUF_HELD;
+	if(index){
+		*index=stream.buf_index[oldest];
+	}
+	return ovm_frame_buffer(oldest);
+}
+
+void ovm_stream_release(uint32_t *frame)
+{
+	int b=((char*)frame-(char*)OVM_DMA_BUFFER)/OVM_FRAME_BYTES;
+	if(b<0 || b>=stream.buffers || stream.buf_state[b]!=BUF_HELD){
+		return;
+	}
+	stream.buf_state[b]=BUF_FREE;
+	//the camera is idle, so there is no done interrupt to restart it
+	if(stream.state==STREAM_STALLED && !stream.stop){
+		ovm_stream_arm(-1);
+	}
+}
+
+void ovm_stream_stop()
+{
+	stream.stop=1;
+	if(stream.state==STREAM_STALLED){
+		stream.state=STREAM_OFF;
+	}
+	while(stream.state!=STREAM_OFF){
+#if !OVM_STREAM_USE_INTERRUPT
+		ovm_stream_service();
+#endif
+	}
+}
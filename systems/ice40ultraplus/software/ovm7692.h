@@ -16,9 +16,9 @@
 #define OVM7692_DEFAULT_PIDH  0x76
 #define OVM7692_DEFAULT_PIDL  0x92
 
-typedef struct{
-	uint8_t addr,val;
-} regval_t;
+#include "sccb.h"
+
+typedef sccb_reg_t regval_t;
 #include "ovm7692_reg.c"
 
 int ovm_initialize();
@@ -28,5 +28,50 @@ int ovm_get_frame();
 int ovm_get_frame_async();
 int ovm_wait_frame();
 
+//Streaming capture: the camera DMA cycles through buffers frame buffers of
+//OVM_FRAME_BYTES each, starting at SCRATCHPAD_BASE, and is re-armed as soon
+//as a frame lands so the application can work on one frame while the next
+//is captured. Each finished frame is handed to the callback, if there is
+//one, which returns nonzero to hold on to it until ovm_stream_release().
+//Without a callback frames are collected with ovm_stream_get().
+//
+//A finished frame the application hasn't taken yet is overwritten by the
+//next capture when there is no free buffer (counted in dropped, the newest
+//frame always wins). With every other buffer held the camera stops until one
+//is released (counted in stalls).
+//
+//ovm_stream_service() does all of the above and has to be called often
+//enough to see each frame finish. With the camera done signal wired to an
+//interrupt, call it from handle_interrupt() instead.
+#ifndef OVM_STREAM_USE_INTERRUPT
+#define OVM_STREAM_USE_INTERRUPT 0
+#endif
+
+#define OVM_FRAME_COLS        64
+#define OVM_FRAME_ROWS        32
+#define OVM_FRAME_BYTES       (OVM_FRAME_COLS*OVM_FRAME_ROWS*4)
+#define OVM_MAX_FRAME_BUFFERS 4
+
+typedef int (*ovm_frame_callback_t)(uint32_t *frame,unsigned index);
+
+typedef struct{
+	unsigned frames;  //frames captured
+	unsigned dropped; //captured frames overwritten before they were taken
+	unsigned stalls;  //times the camera waited for a buffer to be released
+}ovm_stream_stats_t;
+
+extern volatile ovm_stream_stats_t ovm_stream_stats;
+
+//buffers is 2 to OVM_MAX_FRAME_BUFFERS, callback may be NULL.
+int ovm_stream_start(int buffers,ovm_frame_callback_t callback);
+//Returns the number of frames that finished since the last call.
+int ovm_stream_service();
+//The oldest finished frame, now held, or NULL. *index counts every frame
+//captured before it.
+uint32_t *ovm_stream_get(unsigned *index);
+void ovm_stream_release(uint32_t *frame);
+//Lets the current capture finish and returns once the camera is idle.
+void ovm_stream_stop();
+
 
 #endif //def __OVM7692_H_
@@ -19,11 +19,12 @@
 
 static const regval_t regval_list[] = {
 
-// pairs of values below are <reg, value>
+// pairs of values below are <reg, value>, with a wait after the write where
+// the camera needs one
 // value in comments in (parentheses) are camera defaults listed in datasheet
 // actual camera defaults may be different than values listed below
 
- {0x12, 0x80}, // enable RESET
+ {0x12, 0x80, SCCB_WAIT(2) | SCCB_NO_VERIFY}, // enable RESET, reads back 0 once done
  {0x0e, 0x08}, // enable SLEEP
 
  {0x69, 0x52}, // (0x12) BLC9 b6:3=blc_window_selection, b2=bypass_blc, b1:0=blc_enable
@@ -83,7 +84,7 @@ static const regval_t regval_list[] = {
  {0x7b, 0x1f}, // (0x1f) 5060_b clock_period_for_sample_num[7:0]
  {0x7c, 0x00}, // (0x00) 5060_c indirect_register_address
 
- {0x11, 0x01}, // (0x00) DPLL b5:0=internal_pre-scaler_amount
+ {0x11, 0x01, SCCB_WAIT(2)}, // (0x00) DPLL b5:0=internal_pre-scaler_amount
  {0x20, 0x00}, // (0x00) banding MSBs=0, extra banding info
  {0x21, 0x57}, // (0x00) b7:4=banding_filt_max_step_for_50Hz, b3:0=banding_filt_max_step_for_60Hz
 
@@ -178,7 +179,7 @@ static const regval_t regval_list[] = {
 // {0x11, 0x00},   // PCLK divider, data=N=0, divide by (N+1)=1
 // {0x11, 0x02},   // PCLK divider, data=N=1, divide by (N+1)=3
 // {0x11, 0x01},   // PCLK divider, data=N=1, divide by (N+1)=2
- {0x11, 0x00},   // PCLK divider, data=N=1, divide by (N+1)=8
+ {0x11, 0x00, SCCB_WAIT(2)},   // PCLK divider, data=N=1, divide by (N+1)=8
 
 
  ////////////////////////////
@@ -0,0 +1,109 @@
+#include "printf.h"
+#include "sccb.h"
+#include "ovm7692.h"
+#include "time.h"
+#include "vbx.h"
+
+// Streams frames into rotating scratchpad buffers while a stand-in for the
+// network spends WORK_MS on each one, then does the same with ovm_get_frame()
+// one frame at a time, and compares the frames processed per second. Checks
+// frames come out in order and every captured frame is processed, dropped or
+// still waiting.
+#define BUFFERS 3
+#define FRAMES  30
+#define WORK_MS 40 // about one network run
+
+static uint32_t *held;
+static unsigned held_index;
+
+static int on_frame(uint32_t *frame, unsigned index)
+{
+	if (held) {
+		return 0; // still busy with the last one, let the stream recycle this
+	}
+	held = frame;
+	held_index = index;
+	return 1;
+}
+
+// something to look at in each frame, and the time a network would take
+static unsigned process(uint32_t *frame)
+{
+	int i;
+	unsigned sum = 0;
+	for (i = 0; i < OVM_FRAME_COLS*OVM_FRAME_ROWS; i += 16) {
+		sum += frame[i] & 0xFFFFFF;
+	}
+	delayms(WORK_MS);
+	return sum;
+}
+
+int main()
+{
+	int errors = 0, processed = 0, skipped = 0;
+	unsigned start, stream_cycles, single_cycles, last_index = 0;
+
+	printf("\r\nOVM stream test\r\n");
+	init_lve();
+	// keep the LVE allocator clear of the frame buffers
+	the_lve.sp_base = ((char*)SCRATCHPAD_BASE) + BUFFERS*OVM_FRAME_BYTES;
+	the_lve.sp_ptr = the_lve.sp_base;
+
+	if (ovm_initialize()) {
+		printf("Initialization Failed\r\n");
+		return 1;
+	}
+
+	start = get_time();
+	if (ovm_stream_start(BUFFERS, on_frame)) {
+		printf("stream start Failed\r\n");
+		return 1;
+	}
+	while (processed < FRAMES) {
+		ovm_stream_service();
+		if (held) {
+			// the callback may skip frames while this runs, but the
+			// ones that arrive have to be in order
+			if (processed && held_index <= last_index) {
+				printf("frame %d came after %d\r\n", held_index, last_index);
+				errors++;
+			}
+			skipped += held_index - (processed ? last_index + 1 : 0);
+			last_index = held_index;
+			process(held);
+			processed++;
+			uint32_t *frame = held;
+			held = 0;
+			ovm_stream_release(frame);
+		}
+	}
+	stream_cycles = get_time() - start;
+	ovm_stream_stop();
+
+	printf("streamed %d frames in %d ms: %d captured, %d dropped, %d stalls, %d skipped\r\n",
+	       processed, cycle2ms(stream_cycles), ovm_stream_stats.frames,
+	       ovm_stream_stats.dropped, ovm_stream_stats.stalls, skipped);
+	if (ovm_stream_stats.frames < (unsigned)processed) {
+		printf("fewer frames captured than processed\r\n");
+		errors++;
+	}
+
+	start = get_time();
+	for (processed = 0; processed < FRAMES; processed++) {
+		if (ovm_get_frame()) {
+			printf("Get frame Failed\r\n");
+			errors++;
+			break;
+		}
+		process((uint32_t*)SCRATCHPAD_BASE);
+	}
+	single_cycles = get_time() - start;
+
+	printf("%d frames/10s streamed, %d one at a time %s\r\n",
+	       (int)(FRAMES*10000/cycle2ms(stream_cycles)), (int)(FRAMES*10000/cycle2ms(single_cycles)),
+	       stream_cycles <= single_cycles ? "Passed" : "Failed");
+	errors += stream_cycles > single_cycles;
+
+	printf("DONE -- errors = %d %s\r\n\r\n", errors, errors ? "FAILED :(" : "PASSED :)");
+	return errors;
+}
@@ -0,0 +1,8 @@
+#ifndef PRINTF_H
+#define PRINTF_H
+
+// i2s.h and the test programs include printf.h as on the other systems; on
+// this one it is orca_lib's.
+#include "orca_printf.h"
+
+#endif //PRINTF_H
@@ -0,0 +1,157 @@
+#include "printf.h"
+#include "vbx.h"
+#include "time.h"
+#include "vbx_resample.h"
+#include "resample_taps.h"
+
+// Checks vbx_resample bit for bit against plain C for a few ratios, checks the
+// generated decimator passes a low tone and stops a high one, and times it
+// against filtering at the full rate.
+#define MIC_HZ  8000
+#define BLOCK   240
+#define BLOCKS  4
+#define SAMPLES (BLOCKS*BLOCK)
+
+#define SP_IN   ((vbx_word_t*)(SCRATCHPAD_BASE + 0*1024))
+#define SP_OUT  ((vbx_word_t*)(SCRATCHPAD_BASE + 8*1024))
+#define SP_WORK ((vbx_word_t*)(SCRATCHPAD_BASE + 24*1024))
+
+static int32_t coefs[64*4];
+
+static unsigned seed = 0x7654321;
+static int next_rand()
+{
+	seed = seed*1103515245 + 12345;
+	return (int)(seed >> 8);
+}
+
+// sin(2*pi*hz*t/MIC_HZ)*amplitude, Bhaskara's approximation
+static int tone(const int t, const int hz, const int amplitude)
+{
+	int x = t*hz % MIC_HZ*360/MIC_HZ, sign = 1;
+	if (x > 180) {
+		x -= 180;
+		sign = -1;
+	}
+	int p = x*(180 - x);
+	return sign*amplitude*4*p/(40500 - p);
+}
+
+static int check(vbx_resample_t *rs, const int32_t *taps, const int count)
+{
+	int j, k, errors = 0;
+	int up = rs->up, down = rs->down;
+	for (j = 0; j < count; j++) {
+		int phase = j*down % up, end = j*down/up;
+		uint32_t acc = 0;
+		for (k = 0; k < rs->taps && k <= end; k++) {
+			acc += (uint32_t)(taps[phase + k*up]*SP_IN[end - k]);
+		}
+		int32_t ref = (int32_t)acc >> rs->shift;
+		if (ref != SP_OUT[j]) {
+			if (errors < 4) {
+				printf("ERROR %d/%d output %d: %d != %d\r\n", up, down, j, (int)ref, (int)SP_OUT[j]);
+			}
+			errors++;
+		}
+	}
+	return errors;
+}
+
+// run every block through and return the outputs, cycles per block in *cycles
+static int run(vbx_resample_t *rs, unsigned *cycles)
+{
+	int b, count = 0;
+	*cycles = 0;
+	for (b = 0; b < BLOCKS; b++) {
+		unsigned start = get_time();
+		count += vbx_resample(rs, SP_OUT + count, SP_IN + b*BLOCK);
+		*cycles += get_time() - start;
+	}
+	*cycles /= BLOCKS;
+	return count;
+}
+
+static int test_ratio(const int up, const int down, const int taps)
+{
+	int i, errors;
+	unsigned cycles;
+	vbx_resample_t rs;
+
+	for (i = 0; i < up*taps; i++) {
+		coefs[i] = (next_rand() & 0x1FFF) - 0x1000;
+	}
+	for (i = 0; i < SAMPLES; i++) {
+		SP_IN[i] = (next_rand() & 0xFFFF) - 0x8000;
+	}
+	if (!vbx_resample_init(&rs, up, down, taps, BLOCK, coefs, 12, SP_WORK)) {
+		printf("init failed for %d/%d\r\n", up, down);
+		return 1;
+	}
+	int count = run(&rs, &cycles);
+	errors = count != SAMPLES*up/down;
+	errors += check(&rs, coefs, count);
+	printf("%2d/%-2d %2d taps: %d outputs, %d cycles/block %s\r\n",
+	       up, down, taps, count, (int)cycles, errors ? "Failed" : "Passed");
+	return errors;
+}
+
+// mean square of the outputs past the filter's start up
+static int power(const int count)
+{
+	int i;
+	int64_t sum = 0;
+	for (i = RESAMPLE_TAPS; i < count; i++) {
+		sum += (int64_t)SP_OUT[i]*SP_OUT[i];
+	}
+	return sum/(count - RESAMPLE_TAPS);
+}
+
+int main()
+{
+	int i, errors = 0;
+	unsigned cycles, full_cycles;
+	vbx_resample_t rs;
+
+	printf("resample test\r\n");
+	init_lve();
+
+	errors += test_ratio(1, 2, 16);
+	errors += test_ratio(1, 3, 8);
+	errors += test_ratio(3, 2, 8);
+	errors += test_ratio(2, 3, 12);
+	errors += test_ratio(39, 40, 4);
+
+	// the generated decimator on tones either side of the new Nyquist rate
+	int nyquist = MIC_HZ*RESAMPLE_UP/RESAMPLE_DOWN/2;
+	int low = nyquist/4, high = MIC_HZ/2 - nyquist/4;
+	vbx_resample_init(&rs, RESAMPLE_UP, RESAMPLE_DOWN, RESAMPLE_TAPS, BLOCK, resample_taps, RESAMPLE_SHIFT, SP_WORK);
+	for (i = 0; i < SAMPLES; i++) {
+		SP_IN[i] = tone(i, low, 10000);
+	}
+	int count = run(&rs, &cycles);
+	int pass = power(count);
+	errors += check(&rs, resample_taps, count);
+
+	vbx_resample_init(&rs, RESAMPLE_UP, RESAMPLE_DOWN, RESAMPLE_TAPS, BLOCK, resample_taps, RESAMPLE_SHIFT, SP_WORK);
+	for (i = 0; i < SAMPLES; i++) {
+		SP_IN[i] = tone(i, high, 10000);
+	}
+	count = run(&rs, &cycles);
+	int stop = power(count);
+	errors += check(&rs, resample_taps, count);
+
+	// a tone of amplitude a has a mean square of a^2/2
+	int passed = pass > 10000*10000/2*8/10 && stop < pass/100;
+	printf("%d Hz power %d, %d Hz power %d %s\r\n", low, pass, high, stop, passed ? "Passed" : "Failed");
+	errors += !passed;
+
+	// the same filter at the full rate, keeping every output
+	vbx_resample_init(&rs, 1, 1, RESAMPLE_TAPS, BLOCK, resample_taps, RESAMPLE_SHIFT, SP_WORK);
+	run(&rs, &full_cycles);
+	printf("%d/%d %d taps: %d cycles/block, %d at the full rate\r\n",
+	       RESAMPLE_UP, RESAMPLE_DOWN, RESAMPLE_TAPS, (int)cycles, (int)full_cycles);
+
+	printf("DONE -- errors = %d %s\r\n\r\n", errors, errors ? "FAILED :(" : "PASSED :)");
+	return errors;
+}
@@ -6,12 +6,37 @@
 //with pull-ups.  This code does not drive 1's, and there is no difference
 //between 1 and a high-Z.
 
-const unsigned int DELAY_CYCLES = (ORCA_CLK/8000000)*20;//Too high and writes fail...
+//Each SCL period is four bus phases; DELAY_CYCLES is what is left of a phase
+//after the PIO access and the delay loop, measured the first time sccb_init()
+//runs.
+static unsigned int DELAY_CYCLES = ORCA_CLK/(4*SCCB_HZ);
+static int calibrated = 0;
 
 #define BIT_MASK (PIO_SDA_MASK | PIO_SCL_MASK)
+//Busy wait rather than sleepuntil() so bus timing and the settle times the
+//camera needs hold on cores where the sleep CSR does not stall.
 static inline void delay_cycles(unsigned int cycles)
 {
-	sleepuntil(get_time()+cycles);
+	unsigned int start = get_time();
+	while((get_time() - start) < cycles){
+	}
+}
+
+static void sccb_calibrate(volatile void *pioBase){
+	volatile uint32_t *pioRegister = (volatile uint32_t *)pioBase;
+	uint32_t enable = pioRegister[PIO_ENABLE_REGISTER];
+	unsigned int phase = ORCA_CLK/(4*SCCB_HZ);
+	int i;
+
+	unsigned int start = get_time();
+	for(i = 0; i < 8; i++){
+		pioRegister[PIO_ENABLE_REGISTER] = enable;
+		delay_cycles(0);
+	}
+	unsigned int overhead = (get_time() - start) >> 3;
+
+	DELAY_CYCLES = overhead < phase ? phase - overhead : 0;
+	calibrated = 1;
 }
 
 static inline void pio_enable(volatile void *pioBase, uint32_t data){
@@ -34,6 +59,9 @@ static inline uint32_t pio_read(volatile void *pioBase){
 }
 
 void sccb_init(volatile void *pioBase){
+	if(!calibrated){
+		sccb_calibrate(pioBase);
+	}
 	pio_enable(pioBase, 0);
 	pio_write(pioBase, 0);
 }
@@ -127,3 +155,26 @@ uint8_t sccb_read(volatile void *pioBase, uint8_t slaveAddress, uint8_t subAddre
 
 	return readData;
 }
+
+int sccb_write_table(volatile void *pioBase, uint8_t slaveAddress, const sccb_reg_t *table, int count, int verify){
+	int i, mismatches = 0;
+	sccb_init(pioBase);
+
+	for(i = 0; i < count; i++){
+		sccb_write(pioBase, slaveAddress, table[i].addr, table[i].val);
+		if(SCCB_WAIT_MS(table[i].flags)){
+			delayms(SCCB_WAIT_MS(table[i].flags));
+		}
+		if(!verify || (table[i].flags & SCCB_NO_VERIFY)){
+			continue;
+		}
+		if(sccb_read(pioBase, slaveAddress, table[i].addr) != table[i].val){
+			//One more try before giving up on it
+			sccb_write(pioBase, slaveAddress, table[i].addr, table[i].val);
+			if(sccb_read(pioBase, slaveAddress, table[i].addr) != table[i].val){
+				mismatches++;
+			}
+		}
+	}
+	return mismatches;
+}
@@ -27,10 +27,30 @@
 
 #define SCCB_PIO_BASE   ((volatile uint32_t *)GPIO_BASE_ADDRESS)
 
+//SCL rate, the OV7692 takes up to 400kHz
+#define SCCB_HZ 100000
+
+//A register table entry; flags is a SCCB_WAIT() after the write, if the
+//device needs one there (resets, clock changes), or'd with SCCB_NO_VERIFY
+//for registers that do not read back what was written
+typedef struct{
+	uint8_t addr,val;
+	uint8_t flags;
+} sccb_reg_t;
+
+#define SCCB_WAIT(ms)        ((ms) & 0x7F)
+#define SCCB_NO_VERIFY       0x80
+#define SCCB_WAIT_MS(flags)  ((flags) & 0x7F)
+
 void sccb_init(volatile void *pioBase);
 void sccb_write(volatile void *pioBase, uint8_t slaveAddress, uint8_t subAddress, uint8_t data);
 uint8_t sccb_read(volatile void *pioBase, uint8_t slaveAddress, uint8_t subAddress);
 
+//Writes count registers back to back, waiting only where an entry asks to.
+//With verify each one is read back, and written again if it differs.
+//Returns the number that still differ.
+int sccb_write_table(volatile void *pioBase, uint8_t slaveAddress, const sccb_reg_t *table, int count, int verify);
+
 
 
 static inline void led_on()
@@ -1,6 +1,7 @@
 #include "printf.h"
 #include "sccb.h"
 #include "ovm7692.h"
+#include "time.h"
 
 int main(){
 	int errors = 0;
@@ -33,9 +34,28 @@ int main(){
 	}
 	printf("\r\n");
 
-	sccb_write(SCCB_PIO_BASE, OVM7692_ADDRESS, OVM7692_SUBADDRESS_RGAIN, OVM7692_DEFAULT_RGAIN);
-	sccb_write(SCCB_PIO_BASE, OVM7692_ADDRESS, OVM7692_SUBADDRESS_GGAIN, OVM7692_DEFAULT_GGAIN);
-	sccb_write(SCCB_PIO_BASE, OVM7692_ADDRESS, OVM7692_SUBADDRESS_BGAIN, OVM7692_DEFAULT_BGAIN);
+	//The same through the table writer, read back as it goes
+	const sccb_reg_t gains[] = {
+		{OVM7692_SUBADDRESS_RGAIN, 0x12},
+		{OVM7692_SUBADDRESS_GGAIN, 0x34},
+		{OVM7692_SUBADDRESS_BGAIN, 0x56, SCCB_WAIT(1)},
+	};
+	unsigned cycles = get_time();
+	int mismatches = sccb_write_table(SCCB_PIO_BASE, OVM7692_ADDRESS, gains, 3, 1);
+	cycles = get_time() - cycles;
+	printf("Table of 3 registers with readback, %d mismatches, %u cycles at %d Hz", mismatches, cycles, SCCB_HZ);
+	if(mismatches){
+		printf(" -- ERROR");
+		errors++;
+	}
+	printf("\r\n");
+
+	const sccb_reg_t defaults[] = {
+		{OVM7692_SUBADDRESS_RGAIN, OVM7692_DEFAULT_RGAIN},
+		{OVM7692_SUBADDRESS_GGAIN, OVM7692_DEFAULT_GGAIN},
+		{OVM7692_SUBADDRESS_BGAIN, OVM7692_DEFAULT_BGAIN},
+	};
+	sccb_write_table(SCCB_PIO_BASE, OVM7692_ADDRESS, defaults, 3, 0);
 
 	if(errors){
 		printf("SCCB test failed with %d errors :(\r\n", errors);
@@ -3,6 +3,7 @@
 
 #include "orca_time.h"
 
+// Stalls the core until get_time() reaches cycle or an interrupt is pending.
 static inline void sleepuntil(unsigned int cycle)
 {
 	asm volatile ("csrw 0x800,%0"::"r"(cycle));
@@ -3,7 +3,7 @@
 #if BIT_BANG_UART
 
 #define UART_BIT (1<<5)
-#define UART_DELAY_CYCLES (ORCA_CLK/115200)
+#define UART_DELAY_CYCLES (ORCA_CLK/UART_BAUD)
 
 #include "time.h"
 #include "sccb.h"
@@ -0,0 +1,167 @@
+#include "printf.h"
+#include "vbx.h"
+#include "time.h"
+#include "vbx_fft.h"
+
+// Checks the vbx_fft kernels bit for bit against plain C on random input, checks
+// a tone lands in its bin and mel band, and times every FFT size.
+#define MIC_HZ 8000
+#define BANDS  20
+
+#define SP_RE    ((vbx_word_t*)(SCRATCHPAD_BASE + 0*1024))
+#define SP_IM    ((vbx_word_t*)(SCRATCHPAD_BASE + 4*1024))
+#define SP_MEL   ((vbx_word_t*)(SCRATCHPAD_BASE + 8*1024))
+#define SP_FFT   ((vbx_word_t*)(SCRATCHPAD_BASE + 16*1024))
+#define SP_REF   ((int32_t*)(SCRATCHPAD_BASE + 32*1024))
+#define SP_BANDS ((vbx_word_t*)(SCRATCHPAD_BASE + 48*1024))
+
+static unsigned seed = 0x1234567;
+static int next_rand()
+{
+	seed = seed*1103515245 + 12345;
+	return (int)(seed >> 8);
+}
+
+static int32_t mulh(const int32_t a, const int32_t b)
+{
+	return ((int64_t)a*b) >> 32;
+}
+
+// the same butterflies in plain C, bit reversed output
+static void scalar_fft(vbx_fft_t *fft, int32_t *re, int32_t *im)
+{
+	int h, g, j, n = fft->n;
+	for (h = n/2; h >= 1; h /= 2) {
+		for (g = 0; g < n; g += 2*h) {
+			for (j = 0; j < h; j++) {
+				int32_t *ar = re + g + j, *ai = im + g + j, *br = ar + h, *bi = ai + h;
+				int32_t dr = *ar - *br, di = *ai - *bi;
+				*ar += *br;
+				*ai += *bi;
+				if (h == 1) {
+					*br = dr;
+					*bi = di;
+				} else {
+					int32_t c = fft->v_cos[h - 1 + j], s = fft->v_sin[h - 1 + j];
+					*br = mulh(2*dr, c) + mulh(2*di, s);
+					*bi = mulh(2*di, c) - mulh(2*dr, s);
+				}
+			}
+		}
+	}
+}
+
+static int reverse(int i, const int bits)
+{
+	int b, r = 0;
+	for (b = 0; b < bits; b++) {
+		r = (r << 1) | ((i >> b) & 1);
+	}
+	return r;
+}
+
+static int check(const char *what, const int n, int32_t *ref, vbx_word_t *v_out)
+{
+	int i, errors = 0;
+	for (i = 0; i < n; i++) {
+		if (ref[i] != v_out[i]) {
+			if (errors < 4) {
+				printf("ERROR %s %d: %d != %d\r\n", what, i, (int)ref[i], (int)v_out[i]);
+			}
+			errors++;
+		}
+	}
+	return errors;
+}
+
+static int test_size(const int n)
+{
+	int i, errors = 0;
+	unsigned start, fft_cycles, rev_cycles, power_cycles, mel_cycles;
+	vbx_fft_t fft;
+	vbx_mel_t mel;
+	int32_t *ref_re = SP_REF, *ref_im = SP_REF + n;
+
+	if (!vbx_fft_init(&fft, n, SP_FFT) || !vbx_mel_init(&mel, BANDS, n, MIC_HZ, SP_MEL)) {
+		printf("init failed for %d points\r\n", n);
+		return 1;
+	}
+
+	// random complex input at full scale
+	int bits = 30 - fft.log2n;
+	for (i = 0; i < n; i++) {
+		SP_RE[i] = ref_re[i] = (next_rand() << 8) >> (32 - bits);
+		SP_IM[i] = ref_im[i] = (next_rand() << 8) >> (32 - bits);
+	}
+	start = get_time();
+	vbx_fft(&fft, SP_RE, SP_IM);
+	fft_cycles = get_time() - start;
+	scalar_fft(&fft, ref_re, ref_im);
+	errors += check("re", n, ref_re, SP_RE);
+	errors += check("im", n, ref_im, SP_IM);
+
+	start = get_time();
+	vbx_fft_bitreverse(&fft, SP_RE);
+	rev_cycles = get_time() - start;
+	for (i = 0; i < n; i++) {
+		ref_im[reverse(i, fft.log2n)] = ref_re[i];
+	}
+	errors += check("bitreverse", n, ref_im, SP_RE);
+
+	// a tone at bin n/8 + 3, with the twiddle table's own samples
+	int bin = n/8 + 3;
+	vbx_word_t *c = fft.v_cos + n/2 - 1;
+	for (i = 0; i < n; i++) {
+		int t = i*bin & (n - 1);
+		int sign = t < n/2 ? 1 : -1;
+		SP_RE[i] = (c[t & (n/2 - 1)] >> (fft.log2n + 1))*sign;
+		SP_IM[i] = 0;
+	}
+	vbx_fft(&fft, SP_RE, SP_IM);
+	start = get_time();
+	vbx_fft_power(SP_RE, SP_RE, SP_IM, n);
+	power_cycles = get_time() - start;
+	vbx_fft_bitreverse(&fft, SP_RE);
+	start = get_time();
+	vbx_mel(&mel, SP_BANDS, SP_RE);
+	mel_cycles = get_time() - start;
+
+	int peak = 1, band = 0;
+	for (i = 1; i <= n/2; i++) {
+		if (SP_RE[i] > SP_RE[peak]) {
+			peak = i;
+		}
+	}
+	for (i = 0; i < n/2; i++) {
+		if (i != bin && i != n - bin && SP_RE[i] > SP_RE[bin]/1000) {
+			peak = -1;
+		}
+	}
+	for (i = 1; i < BANDS; i++) {
+		if (SP_BANDS[i] > SP_BANDS[band]) {
+			band = i;
+		}
+	}
+	int in_band = bin >= mel.lo[band] && bin < mel.lo[band] + mel.width[band];
+	printf("%4d points: tone %d found %d, band %d %s\r\n", n, bin, peak, band,
+	       peak == bin && in_band ? "Passed" : "Failed");
+	errors += peak != bin || !in_band;
+
+	printf("%4d points: fft %d, bitreverse %d, power %d, %d mel bands %d cycles\r\n",
+	       n, (int)fft_cycles, (int)rev_cycles, (int)power_cycles, BANDS, (int)mel_cycles);
+	return errors;
+}
+
+int main()
+{
+	int n, errors = 0;
+
+	printf("vbx_fft test\r\n");
+	init_lve();
+	for (n = VBX_FFT_MIN_N; n <= VBX_FFT_MAX_N; n *= 2) {
+		errors += test_size(n);
+	}
+
+	printf("DONE -- errors = %d %s\r\n\r\n", errors, errors ? "FAILED :(" : "PASSED :)");
+	return errors;
+}
@@ -0,0 +1,171 @@
+#include "printf.h"
+#include "vbx.h"
+#include "vbx_nn.h"
+
+// Checks the vbx_nn int8 kernels against plain C on small random layers.
+#define M        8
+#define N        8
+#define CHANNELS 3
+#define KERNELS  4
+#define INPUTS   32
+#define OUTPUTS  10
+
+#define SP_IN   ((vbx_word_t*)(SCRATCHPAD_BASE + 0*1024))
+#define SP_OUT  ((vbx_word_t*)(SCRATCHPAD_BASE + 4*1024))
+#define SP_TMP  ((vbx_word_t*)(SCRATCHPAD_BASE + 8*1024))
+#define SP_PACK ((vbx_word_t*)(SCRATCHPAD_BASE + 12*1024))
+
+static int8_t weights[KERNELS*CHANNELS*9];
+static int32_t biases[KERNELS];
+static int32_t ref[KERNELS*M*N];
+
+static unsigned seed = 0x2468ace;
+static int next_rand()
+{
+	seed = seed*1103515245 + 12345;
+	return seed >> 8;
+}
+
+static void init(vbx_word_t *v_in, const int words)
+{
+	int i;
+	for (i = 0; i < words; i++) {
+		v_in[i] = (int8_t)next_rand();
+	}
+	for (i = 0; i < sizeof(weights); i++) {
+		weights[i] = (int8_t)next_rand();
+	}
+	for (i = 0; i < KERNELS; i++) {
+		biases[i] = (next_rand() & 0xFFF) - 0x800;
+	}
+}
+
+static int check(const char *name, vbx_word_t *v_out, const int words)
+{
+	int i, errors = 0;
+	for (i = 0; i < words; i++) {
+		if (v_out[i] != ref[i]) {
+			if (errors < 8) {
+				printf("ERROR @ %d: %d != %d\r\n", i, (int)ref[i], (int)v_out[i]);
+			}
+			errors++;
+		}
+	}
+	printf("%s %s\r\n", name, errors ? "Failed" : "Passed");
+	return errors;
+}
+
+static int test_conv3x3(const int stride, const int depthwise)
+{
+	int k, c, y, x, t;
+	int kernels = depthwise ? CHANNELS : KERNELS;
+	int m0 = M/stride, n0 = N/stride;
+	vbx_word_t *v_in = SP_IN;
+	init(v_in, CHANNELS*(M+2)*(N+2));
+
+	for (k = 0; k < kernels; k++) {
+		for (y = 0; y < m0; y++) {
+			for (x = 0; x < n0; x++) {
+				int sum = biases[k];
+				for (c = depthwise ? k : 0; c < (depthwise ? k+1 : CHANNELS); c++) {
+					const int8_t *w = weights + (depthwise ? c : k*CHANNELS + c)*9;
+					for (t = 0; t < 9; t++) {
+						sum += w[t]*v_in[c*(M+2)*(N+2) + (y*stride + t/3)*(N+2) + x*stride + t%3];
+					}
+				}
+				ref[(k*m0 + y)*n0 + x] = sum;
+			}
+		}
+	}
+	vbx_nn_conv3x3(SP_OUT, v_in, SP_TMP, M, N, CHANNELS, kernels, stride, depthwise, weights, biases);
+	return check(depthwise ? "conv3x3 depthwise" : stride == 1 ? "conv3x3" : "conv3x3 stride 2",
+	             SP_OUT, kernels*m0*n0);
+}
+
+static int test_conv1x1()
+{
+	int k, c, i;
+	vbx_word_t *v_in = SP_IN;
+	init(v_in, CHANNELS*M*N);
+
+	for (k = 0; k < KERNELS; k++) {
+		for (i = 0; i < M*N; i++) {
+			int sum = biases[k];
+			for (c = 0; c < CHANNELS; c++) {
+				sum += weights[k*CHANNELS + c]*v_in[c*M*N + i];
+			}
+			ref[k*M*N + i] = sum;
+		}
+	}
+	vbx_nn_conv1x1(SP_OUT, v_in, SP_TMP, M*N, CHANNELS, KERNELS, weights, biases);
+	return check("conv1x1", SP_OUT, KERNELS*M*N);
+}
+
+static int test_dense()
+{
+	int o, i;
+	vbx_word_t *v_in = SP_IN;
+	vbx_word_t *v_biases = SP_IN + INPUTS;
+	int8_t *packed = (int8_t*)SP_PACK;
+	init(v_in, INPUTS + OUTPUTS);
+
+	for (i = 0; i < INPUTS*OUTPUTS; i++) {
+		packed[i] = (int8_t)next_rand();
+	}
+	for (o = 0; o < OUTPUTS; o++) {
+		int sum = v_biases[o];
+		for (i = 0; i < INPUTS; i++) {
+			sum += packed[o*INPUTS + i]*v_in[i];
+		}
+		ref[o] = sum;
+	}
+	// room for 3 rows at a time, so the last pass is short
+	vbx_nn_dense(SP_OUT, v_in, SP_PACK, v_biases, SP_TMP, 3*(INPUTS+1)+1, INPUTS, OUTPUTS);
+	return check("dense", SP_OUT, OUTPUTS);
+}
+
+static int test_requantize()
+{
+	int i;
+	int size = M*N;
+	int32_t mults[2] = {0x40000000, 0x1234567};
+	int8_t shifts[2] = {0, 4};
+	vbx_word_t *v_data = SP_OUT;
+	int8_t *packed = (int8_t*)SP_PACK;
+
+	for (i = 0; i < 2*size; i++) {
+		int c = i/size;
+		v_data[i] = (next_rand() & 0xFFFF) - 0x8000;
+		int64_t q = ((int64_t)(v_data[i] << shifts[c])*mults[c]) >> 32;
+		q += 3;
+		ref[i] = q > 127 ? 127 : q < -128 ? -128 : q;
+	}
+	vbx_nn_requantize_channels(v_data, size, 2, mults, shifts, 3);
+	vbx_nn_saturate(v_data, SP_TMP, 2*size, -128, 127);
+	vbx_nn_pack_int8(SP_PACK, v_data, SP_TMP, 2*size);
+
+	int errors = check("requantize", v_data, 2*size);
+	for (i = 0; i < 2*size; i++) {
+		if (packed[i] != ref[i]) {
+			errors++;
+		}
+	}
+	vbx_nn_unpack_int8(SP_TMP, SP_PACK, 2*size);
+	errors += check("pack/unpack", SP_TMP, 2*size);
+	return errors;
+}
+
+int main()
+{
+	int errors = 0;
+	init_lve();
+	errors += test_conv3x3(1, 0);
+	errors += test_conv3x3(2, 0);
+	errors += test_conv3x3(1, 1);
+	errors += test_conv1x1();
+	errors += test_dense();
+	errors += test_requantize();
+
+	printf("DONE -- errors = %d %s\r\n\r\n", errors, errors ? "FAILED :(" : "PASSED :)");
+	return errors;
+}
@@ -258,9 +258,10 @@ architecture rtl of vhdl_top is
   signal auto_reset_on_clk : std_logic            := '1';
   signal reset_count       : unsigned(3 downto 0) := (others => '0');
 
-  signal ovm_dma_start : std_logic;
-  signal ovm_dma_done  : std_logic;
-  signal ovm_dma_busy  : std_logic;
+  signal ovm_dma_start  : std_logic;
+  signal ovm_dma_done   : std_logic;
+  signal ovm_dma_busy   : std_logic;
+  signal ovm_dma_buffer : std_logic_vector(1 downto 0);
 
   signal cam_pclk : std_logic;
 
@@ -904,6 +905,9 @@ begin
   pio_in(2)     <= pio_out(2);
 
   pio_in(3)    <= ovm_dma_busy;
+
+  ovm_dma_buffer       <= pio_out(12 downto 11);
+  pio_in(12 downto 11) <= pio_out(12 downto 11);
   ovm_dma_busy <= '1' when ovm_dma_done = '0' else '0';
 
   led       <= 'Z' when (pio_out(4) and led_counter(15) and led_counter(14)) = '1' else '0';
@@ -938,6 +942,7 @@ begin
         cam_start  => ovm_dma_start,
         cam_done   => ovm_dma_done,
         cam_dat_en => cam_dat_en,
+        cam_buffer => ovm_dma_buffer,
         --camera signals
         ovm_pclk   => cam_pclk,
         ovm_vsync  => cam_vsync,
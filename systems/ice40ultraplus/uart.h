@@ -14,6 +14,8 @@
 #define DEFAULT_PUTP ((void *)UART_BASE_ADDRESS)
 #endif //#else //#ifndef UART_BASE_ADDRESS
 
+#define UART_BAUD 115200
+
 
 void mputc(void* p, char c);
 
@@ -0,0 +1,363 @@
+library IEEE;
+use IEEE.STD_LOGIC_1164.all;
+use IEEE.NUMERIC_STD.all;
+
+library work;
+use work.rv_components.all;
+use work.utils.all;
+use work.constants_pkg.all;
+
+--Self-checking miss rate benchmark for a read-only cache_controller.  Memory
+--returns each word's own address as its data so every read is checked.  The
+--reads are made one at a time in phases, with the misses (cache_miss pulses)
+--and cycles of each phase reported:
+--
+--  CONFLICT: CONFLICT_LINES lines that all map to set 0 read in turn.  Only
+--    the first read of each line may miss if they fit in the set's WAYS; a
+--    direct-mapped cache misses on every read once there are two.
+--  HOT_LINE: one line in set 1 read between reads of a new line in the same
+--    set every time.  LRU always keeps the hot line, so it misses only once.
+--  SEQUENTIAL: every word of STREAM_LINES consecutive new lines.
+--  STRIDED: half the words of STREAM_LINES new lines STRIDE_LINES apart.
+--
+--Memory answers after MEMORY_LATENCY cycles.  A miss whose line is never
+--requested from memory was filled from the prefetch buffer; these are counted
+--too.  Most of the streams' misses after the first few must be prefetched
+--(NEXT_LINE only on SEQUENTIAL, STRIDE on both), and none without PREFETCH.
+entity cache_controller_tb is
+  generic (
+    WAYS           : positive               := 2;
+    REPLACEMENT    : cache_replacement_type := LRU;
+    PREFETCH       : cache_prefetch_type    := NO_PREFETCH;
+    MEMORY_LATENCY : natural                := 4;
+    CONFLICT_LINES : positive               := 2;
+    ITERATIONS     : positive               := 64
+    );
+end entity;
+
+architecture rtl of cache_controller_tb is
+  constant ADDRESS_WIDTH            : positive := 32;
+  constant WIDTH                    : positive := 32;
+  constant CACHE_SIZE               : positive := 1024;
+  constant LINE_SIZE                : positive := 32;
+  constant LOG2_BURSTLENGTH         : positive := 4;
+  constant MAX_OUTSTANDING_REQUESTS : positive := 2;
+  constant STREAM_LINES             : positive := 16;
+  constant STRIDE_LINES             : positive := 3;
+  constant WORDS_PER_LINE           : positive := LINE_SIZE/(WIDTH/8);
+  constant CLOCK_PERIOD             : time     := 10 ns;
+
+  subtype line_type is unsigned(ADDRESS_WIDTH-1 downto log2(LINE_SIZE));
+
+  type phase_type is (CONFLICT, HOT_LINE, SEQUENTIAL, STRIDED, FINISHED);
+
+  function reads_in (phase : phase_type) return natural is
+  begin
+    case phase is
+      when CONFLICT   => return ITERATIONS*CONFLICT_LINES;
+      when HOT_LINE   => return 2*ITERATIONS;
+      when SEQUENTIAL => return STREAM_LINES*WORDS_PER_LINE;
+      when STRIDED    => return STREAM_LINES*(WORDS_PER_LINE/2);
+      when others     => return 0;
+    end case;
+  end function;
+
+  --Address of the nth read of a phase
+  function address_of (phase : phase_type; n : natural) return unsigned is
+    variable address : unsigned(ADDRESS_WIDTH-1 downto 0);
+  begin
+    case phase is
+      when CONFLICT =>
+        address := to_unsigned(((n mod CONFLICT_LINES)*CACHE_SIZE) +
+                               (((n/CONFLICT_LINES) mod (LINE_SIZE/4))*4), ADDRESS_WIDTH);
+      when HOT_LINE =>
+        if (n mod 2) = 0 then
+          address := to_unsigned(LINE_SIZE, ADDRESS_WIDTH);
+        else
+          address := to_unsigned((((n/2)+1)*CACHE_SIZE) + LINE_SIZE, ADDRESS_WIDTH);
+        end if;
+      when SEQUENTIAL =>
+        address := to_unsigned(16#10000# + (n*(WIDTH/8)), ADDRESS_WIDTH);
+      when others =>
+        address := to_unsigned(16#20000# + ((n/(WORDS_PER_LINE/2))*STRIDE_LINES*LINE_SIZE) +
+                               ((n mod (WORDS_PER_LINE/2))*(WIDTH/8)), ADDRESS_WIDTH);
+    end case;
+    return address;
+  end function;
+
+  signal clk   : std_logic := '0';
+  signal reset : std_logic := '1';
+  signal done  : std_logic := '0';
+  signal cycle : natural   := 0;
+
+  signal cache_idle : std_logic;
+  signal cache_miss : std_logic;
+
+  --Line of the read that missed, while it is outstanding, and a count of the
+  --memory reads of such lines
+  signal missed        : std_logic := '0';
+  signal missed_line   : line_type;
+  signal demand_bursts : natural   := 0;
+
+  signal cacheint_oimm_address       : std_logic_vector(ADDRESS_WIDTH-1 downto 0) := (others => '0');
+  signal cacheint_oimm_requestvalid  : std_logic                                  := '0';
+  signal cacheint_oimm_readdata      : std_logic_vector(WIDTH-1 downto 0);
+  signal cacheint_oimm_readdatavalid : std_logic;
+  signal cacheint_oimm_waitrequest   : std_logic;
+
+  signal c_oimm_address            : std_logic_vector(ADDRESS_WIDTH-1 downto 0);
+  signal c_oimm_burstlength        : std_logic_vector(LOG2_BURSTLENGTH downto 0);
+  signal c_oimm_burstlength_minus1 : std_logic_vector(LOG2_BURSTLENGTH-1 downto 0);
+  signal c_oimm_byteenable         : std_logic_vector((WIDTH/8)-1 downto 0);
+  signal c_oimm_requestvalid       : std_logic;
+  signal c_oimm_readnotwrite       : std_logic;
+  signal c_oimm_writedata          : std_logic_vector(WIDTH-1 downto 0);
+  signal c_oimm_writelast          : std_logic;
+  signal c_oimm_readdata           : std_logic_vector(WIDTH-1 downto 0) := (others => '0');
+  signal c_oimm_readdatavalid      : std_logic                          := '0';
+  signal c_oimm_waitrequest        : std_logic                          := '0';
+begin
+  process
+  begin
+    clk <= '0';
+    wait for CLOCK_PERIOD/2;
+    clk <= '1';
+    wait for CLOCK_PERIOD/2;
+    if done = '1' then
+      wait;
+    end if;
+  end process;
+  reset <= '1', '0' after CLOCK_PERIOD*5;
+
+  dut : cache_controller
+    generic map (
+      CACHE_SIZE               => CACHE_SIZE,
+      LINE_SIZE                => LINE_SIZE,
+      WAYS                     => WAYS,
+      REPLACEMENT              => REPLACEMENT,
+      PREFETCH                 => PREFETCH,
+      ADDRESS_WIDTH            => ADDRESS_WIDTH,
+      INTERNAL_WIDTH           => WIDTH,
+      EXTERNAL_WIDTH           => WIDTH,
+      LOG2_BURSTLENGTH         => LOG2_BURSTLENGTH,
+      MAX_OUTSTANDING_REQUESTS => MAX_OUTSTANDING_REQUESTS,
+      POLICY                   => READ_ONLY,
+      REGION_OPTIMIZATIONS     => true,
+      WRITE_FIRST_SUPPORTED    => false
+      )
+    port map (
+      clk   => clk,
+      reset => reset,
+
+      from_cache_control_ready => open,
+      to_cache_control_valid   => '0',
+      to_cache_control_command => INITIALIZE,
+      to_cache_control_base    => (others => '0'),
+      to_cache_control_last    => (others => '0'),
+
+      precache_idle => '1',
+      cache_idle    => cache_idle,
+      cache_miss    => cache_miss,
+
+      cacheint_oimm_address       => cacheint_oimm_address,
+      cacheint_oimm_byteenable    => (others => '1'),
+      cacheint_oimm_requestvalid  => cacheint_oimm_requestvalid,
+      cacheint_oimm_readnotwrite  => '1',
+      cacheint_oimm_writedata     => (others => '0'),
+      cacheint_oimm_readdata      => cacheint_oimm_readdata,
+      cacheint_oimm_readdatavalid => cacheint_oimm_readdatavalid,
+      cacheint_oimm_waitrequest   => cacheint_oimm_waitrequest,
+
+      c_oimm_address            => c_oimm_address,
+      c_oimm_burstlength        => c_oimm_burstlength,
+      c_oimm_burstlength_minus1 => c_oimm_burstlength_minus1,
+      c_oimm_byteenable         => c_oimm_byteenable,
+      c_oimm_requestvalid       => c_oimm_requestvalid,
+      c_oimm_readnotwrite       => c_oimm_readnotwrite,
+      c_oimm_writedata          => c_oimm_writedata,
+      c_oimm_writelast          => c_oimm_writelast,
+      c_oimm_readdata           => c_oimm_readdata,
+      c_oimm_readdatavalid      => c_oimm_readdatavalid,
+      c_oimm_waitrequest        => c_oimm_waitrequest
+      );
+
+  --External memory: bursts are accepted every cycle and their beats returned
+  --in order starting MEMORY_LATENCY cycles later, one per cycle.  Also counts
+  --the bursts that read the line of an outstanding miss.
+  memory : process (clk) is
+    constant MAX_BURSTS : positive := 8;
+    type address_vector is array (0 to MAX_BURSTS-1) of unsigned(ADDRESS_WIDTH-1 downto 0);
+    type natural_vector is array (0 to MAX_BURSTS-1) of natural;
+    variable burst_address : address_vector;
+    variable burst_beats   : natural_vector;
+    variable burst_ready   : natural_vector;
+    variable head          : natural range 0 to MAX_BURSTS-1;
+    variable count         : natural range 0 to MAX_BURSTS;
+    variable beat          : natural;
+  begin
+    if rising_edge(clk) then
+      cycle                <= cycle + 1;
+      c_oimm_readdatavalid <= '0';
+      if count > 0 and cycle >= burst_ready(head) then
+        c_oimm_readdatavalid <= '1';
+        c_oimm_readdata      <= std_logic_vector(burst_address(head) + to_unsigned(beat*(WIDTH/8), ADDRESS_WIDTH));
+        beat                 := beat + 1;
+        if beat = burst_beats(head) then
+          beat  := 0;
+          head  := (head + 1) mod MAX_BURSTS;
+          count := count - 1;
+        end if;
+      end if;
+
+      if c_oimm_requestvalid = '1' and c_oimm_waitrequest = '0' then
+        assert c_oimm_readnotwrite = '1' report "Write to memory from a read-only cache" severity failure;
+        assert count < MAX_BURSTS report "Too many bursts outstanding" severity failure;
+        burst_address((head + count) mod MAX_BURSTS) := unsigned(c_oimm_address);
+        burst_beats((head + count) mod MAX_BURSTS)   := to_integer(unsigned(c_oimm_burstlength));
+        burst_ready((head + count) mod MAX_BURSTS)   := cycle + MEMORY_LATENCY;
+        count                                        := count + 1;
+        if missed = '1' and unsigned(c_oimm_address(line_type'range)) = missed_line then
+          demand_bursts <= demand_bursts + 1;
+        end if;
+      end if;
+
+      if reset = '1' then
+        c_oimm_readdatavalid <= '0';
+        head                 := 0;
+        count                := 0;
+        beat                 := 0;
+      end if;
+    end if;
+  end process;
+
+  --Processor: one read at a time, checking its data and counting the misses
+  --and cycles of each phase.
+  processor : process (clk) is
+    type state_type is (ISSUE, REQUEST, RESPONSE);
+    variable state               : state_type;
+    variable phase               : phase_type;
+    variable n                   : natural;
+    variable address             : unsigned(ADDRESS_WIDTH-1 downto 0);
+    variable misses              : natural;
+    variable phase_cycles        : natural;
+    variable phase_demand_bursts : natural;
+    variable prefetched          : integer;
+    variable expected            : integer;
+    variable expected_prefetched : natural;
+    variable errors              : natural;
+  begin
+    if rising_edge(clk) then
+      if cache_miss = '1' then
+        misses      := misses + 1;
+        missed      <= '1';
+        missed_line <= address(line_type'range);
+      end if;
+      phase_cycles := phase_cycles + 1;
+
+      assert cacheint_oimm_readdatavalid = '0' or state = RESPONSE report
+        "Read data returned with no read outstanding"
+        severity failure;
+
+      case state is
+        when ISSUE =>
+          if phase /= FINISHED then
+            address                    := address_of(phase, n);
+            cacheint_oimm_address      <= std_logic_vector(address);
+            cacheint_oimm_requestvalid <= '1';
+            state                      := REQUEST;
+          end if;
+
+        when REQUEST =>
+          if cacheint_oimm_waitrequest = '0' then
+            cacheint_oimm_requestvalid <= '0';
+            state                      := RESPONSE;
+          end if;
+
+        when RESPONSE =>
+          if cacheint_oimm_readdatavalid = '1' then
+            if cacheint_oimm_readdata /= std_logic_vector(address) then
+              report "Read " & integer'image(to_integer(unsigned(cacheint_oimm_readdata))) &
+                " from " & integer'image(to_integer(address))
+                severity error;
+              errors := errors + 1;
+            end if;
+            missed <= '0';
+            n      := n + 1;
+            state  := ISSUE;
+
+            if n = reads_in(phase) then
+              prefetched := misses - (demand_bursts - phase_demand_bursts);
+              report "cache_controller_tb: " & phase_type'image(phase) & ": " & integer'image(misses) & " misses in " &
+                integer'image(n) & " reads (" & integer'image((100*misses)/n) & "%), " &
+                integer'image(prefetched) & " prefetched, " & integer'image(phase_cycles) & " cycles";
+
+              expected := -1;
+              case phase is
+                when CONFLICT =>
+                  if CONFLICT_LINES <= WAYS then
+                    expected := CONFLICT_LINES;
+                  elsif WAYS = 1 then
+                    expected := n;
+                  end if;
+                when HOT_LINE =>
+                  if WAYS = 1 then
+                    expected := n;
+                  elsif REPLACEMENT = LRU then
+                    expected := ITERATIONS+1;
+                  end if;
+                when others =>
+                  --Every stream line is new and they all fit
+                  expected := STREAM_LINES;
+              end case;
+              if expected >= 0 and misses /= expected then
+                report "cache_controller_tb: " & phase_type'image(phase) & " expected " & integer'image(expected) & " misses"
+                  severity error;
+                errors := errors + 1;
+              end if;
+
+              expected_prefetched := 0;
+              if (phase = SEQUENTIAL and PREFETCH /= NO_PREFETCH) or (phase = STRIDED and PREFETCH = STRIDE) then
+                expected_prefetched := STREAM_LINES/2;
+              end if;
+              if prefetched < expected_prefetched or (PREFETCH = NO_PREFETCH and prefetched /= 0) then
+                report "cache_controller_tb: " & phase_type'image(phase) & " expected " &
+                  integer'image(expected_prefetched) & " prefetched misses"
+                  severity error;
+                errors := errors + 1;
+              end if;
+
+              phase               := phase_type'succ(phase);
+              n                   := 0;
+              misses              := 0;
+              phase_cycles        := 0;
+              phase_demand_bursts := demand_bursts;
+              if phase = FINISHED then
+                assert errors = 0 report "cache_controller_tb FAILED" severity failure;
+                report "cache_controller_tb PASSED";
+                done <= '1';
+              end if;
+            end if;
+          end if;
+      end case;
+
+      if reset = '1' then
+        cacheint_oimm_requestvalid <= '0';
+        state                      := ISSUE;
+        phase                      := CONFLICT;
+        n                          := 0;
+        missed                     <= '0';
+        misses                     := 0;
+        phase_cycles               := 0;
+        phase_demand_bursts        := 0;
+        errors                     := 0;
+      end if;
+    end if;
+  end process;
+
+  process
+  begin
+    wait for CLOCK_PERIOD*(100+MEMORY_LATENCY)*((ITERATIONS*(CONFLICT_LINES+2))+(2*STREAM_LINES*WORDS_PER_LINE));
+    assert done = '1' report "cache_controller_tb timed out" severity failure;
+    wait;
+  end process;
+end architecture rtl;
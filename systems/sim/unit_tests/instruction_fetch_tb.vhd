@@ -0,0 +1,333 @@
+library IEEE;
+use IEEE.STD_LOGIC_1164.all;
+use IEEE.NUMERIC_STD.all;
+
+library work;
+use work.rv_components.all;
+use work.constants_pkg.all;
+
+--Self-checking testbench for the branch predictors and return address stack in
+--instruction_fetch.  A behavioural execute stage runs a small program of
+--nested calls, returns, a jump and a branch taken pseudo-randomly:
+--
+--  0x100 call 0x110      0x110 return          0x120 call 0x110
+--  0x104 call 0x120                            0x124 branch to 0x130
+--  0x108 jump 0x100                            0x128 return
+--                                              0x130 return
+--
+--It checks every instruction it takes is on the program's path, then trains
+--the predictor and corrects the PC on a mispredict EXECUTE_CYCLES later so
+--that wrong-path fetches (the return after the branch) have already popped the
+--speculative return stack by then.  Once both sides of the branch have been
+--seen only the branch may mispredict; 0x110 returns to two different places
+--so the return stack has to predict it, and the returns after a mispredicted
+--branch only predict correctly if the stack was recovered.
+entity instruction_fetch_tb is
+  generic (
+    BRANCH_PREDICTOR       : branch_predictor_type := TWO_BIT;
+    BTB_ENTRIES            : positive              := 16;
+    RAS_ENTRIES            : positive              := 4;
+    MAX_IFETCHES_IN_FLIGHT : positive              := 2;
+    WAITREQUEST_EVERY      : natural               := 3;  --0 for none
+    ITERATIONS             : positive              := 64
+    );
+end entity;
+
+architecture rtl of instruction_fetch_tb is
+  constant REGISTER_SIZE  : positive := 32;
+  constant CLOCK_PERIOD   : time     := 10 ns;
+  constant EXECUTE_CYCLES : positive := 3;
+  constant START_PC       : unsigned(REGISTER_SIZE-1 downto 0) := to_unsigned(16#100#, REGISTER_SIZE);
+
+  type kind_type is (CALL, JUMP, RET, BRANCH, NONE);
+
+  function kind_of (pc : unsigned(REGISTER_SIZE-1 downto 0)) return kind_type is
+  begin
+    case to_integer(pc) is
+      when 16#100# | 16#104# | 16#120# => return CALL;
+      when 16#108#                     => return JUMP;
+      when 16#110# | 16#128# | 16#130# => return RET;
+      when 16#124#                     => return BRANCH;
+      when others                      => return NONE;
+    end case;
+  end function;
+
+  --Target of a call or jump, or of the branch when taken
+  function target_of (pc : unsigned(REGISTER_SIZE-1 downto 0)) return unsigned is
+  begin
+    case to_integer(pc) is
+      when 16#100# | 16#120# => return to_unsigned(16#110#, REGISTER_SIZE);
+      when 16#104#           => return to_unsigned(16#120#, REGISTER_SIZE);
+      when 16#108#           => return START_PC;
+      when others            => return to_unsigned(16#130#, REGISTER_SIZE);
+    end case;
+  end function;
+
+  signal clk   : std_logic := '0';
+  signal reset : std_logic := '1';
+  signal done  : std_logic := '0';
+  signal cycle : natural   := 0;
+
+  signal to_pc_correction_data        : unsigned(REGISTER_SIZE-1 downto 0) := (others => '0');
+  signal to_pc_correction_source_pc   : unsigned(REGISTER_SIZE-1 downto 0) := (others => '0');
+  signal to_pc_correction_valid       : std_logic                          := '0';
+  signal from_pc_correction_ready     : std_logic;
+  signal to_predictor_update_valid    : std_logic                          := '0';
+  signal to_predictor_update_branch   : std_logic                          := '0';
+  signal to_predictor_update_taken    : std_logic                          := '0';
+  signal to_predictor_update_target   : unsigned(REGISTER_SIZE-1 downto 0) := (others => '0');
+  signal to_predictor_update_call     : std_logic                          := '0';
+  signal to_predictor_update_return   : std_logic                          := '0';
+
+  signal ifetch_idle                 : std_logic;
+  signal from_ifetch_instruction     : std_logic_vector(31 downto 0);
+  signal from_ifetch_program_counter : unsigned(REGISTER_SIZE-1 downto 0);
+  signal from_ifetch_predicted_pc    : unsigned(REGISTER_SIZE-1 downto 0);
+  signal from_ifetch_valid           : std_logic;
+  signal to_ifetch_ready             : std_logic := '0';
+  signal program_counter             : unsigned(REGISTER_SIZE-1 downto 0);
+
+  signal oimm_address       : std_logic_vector(REGISTER_SIZE-1 downto 0);
+  signal oimm_requestvalid  : std_logic;
+  signal oimm_readdata      : std_logic_vector(31 downto 0) := (others => '0');
+  signal oimm_readdatavalid : std_logic                     := '0';
+  signal oimm_waitrequest   : std_logic;
+begin
+  process
+  begin
+    clk <= '0';
+    wait for CLOCK_PERIOD/2;
+    clk <= '1';
+    wait for CLOCK_PERIOD/2;
+    if done = '1' then
+      wait;
+    end if;
+  end process;
+  reset <= '1', '0' after CLOCK_PERIOD*5;
+
+  dut : instruction_fetch
+    generic map (
+      REGISTER_SIZE          => REGISTER_SIZE,
+      RESET_VECTOR           => std_logic_vector(START_PC),
+      MAX_IFETCHES_IN_FLIGHT => MAX_IFETCHES_IN_FLIGHT,
+      BTB_ENTRIES            => BTB_ENTRIES,
+      BRANCH_PREDICTOR       => BRANCH_PREDICTOR,
+      RAS_ENTRIES            => RAS_ENTRIES
+      )
+    port map (
+      clk   => clk,
+      reset => reset,
+
+      pause_ifetch => '0',
+
+      to_pc_correction_data        => to_pc_correction_data,
+      to_pc_correction_source_pc   => to_pc_correction_source_pc,
+      to_pc_correction_valid       => to_pc_correction_valid,
+      to_pc_correction_predictable => '1',
+      from_pc_correction_ready     => from_pc_correction_ready,
+
+      to_predictor_update_valid  => to_predictor_update_valid,
+      to_predictor_update_branch => to_predictor_update_branch,
+      to_predictor_update_taken  => to_predictor_update_taken,
+      to_predictor_update_target => to_predictor_update_target,
+      to_predictor_update_call   => to_predictor_update_call,
+      to_predictor_update_return => to_predictor_update_return,
+
+      ifetch_idle => ifetch_idle,
+
+      from_ifetch_instruction     => from_ifetch_instruction,
+      from_ifetch_program_counter => from_ifetch_program_counter,
+      from_ifetch_predicted_pc    => from_ifetch_predicted_pc,
+      from_ifetch_valid           => from_ifetch_valid,
+      to_ifetch_ready             => to_ifetch_ready,
+
+      program_counter => program_counter,
+
+      oimm_address       => oimm_address,
+      oimm_requestvalid  => oimm_requestvalid,
+      oimm_readdata      => oimm_readdata,
+      oimm_readdatavalid => oimm_readdatavalid,
+      oimm_waitrequest   => oimm_waitrequest
+      );
+
+  --Instruction memory: every word reads back as its own address, one cycle
+  --after the request is accepted, with waitrequest every WAITREQUEST_EVERY
+  --cycles.
+  process (clk) is
+  begin
+    if rising_edge(clk) then
+      cycle              <= cycle + 1;
+      oimm_readdatavalid <= oimm_requestvalid and (not oimm_waitrequest);
+      oimm_readdata      <= oimm_address;
+      if reset = '1' then
+        oimm_readdatavalid <= '0';
+      end if;
+    end if;
+  end process;
+  oimm_waitrequest <=
+    '1' when WAITREQUEST_EVERY > 0 and (cycle mod WAITREQUEST_EVERY) = WAITREQUEST_EVERY-1 else
+    '0';
+
+  execute : process (clk) is
+    type state_type is (TAKE, RESOLVE, CORRECT);
+    type stack_type is array (0 to 7) of unsigned(REGISTER_SIZE-1 downto 0);
+    variable state          : state_type;
+    variable stack          : stack_type;
+    variable depth          : natural range 0 to 8;
+    variable expected_pc    : unsigned(REGISTER_SIZE-1 downto 0);
+    variable pc             : unsigned(REGISTER_SIZE-1 downto 0);
+    variable next_pc        : unsigned(REGISTER_SIZE-1 downto 0);
+    variable kind           : kind_type;
+    variable taken          : std_logic;
+    variable mispredicted   : boolean;
+    variable wait_cycles    : natural;
+    variable lfsr           : std_logic_vector(15 downto 0);
+    variable seen_taken     : boolean;
+    variable seen_not_taken : boolean;
+    variable warm           : boolean;
+    variable iteration      : natural;
+    variable recoveries     : natural;
+    variable errors         : natural;
+  begin
+    if rising_edge(clk) then
+      to_predictor_update_valid <= '0';
+
+      case state is
+        when TAKE =>
+          if from_ifetch_valid = '1' and to_ifetch_ready = '1' then
+            pc := from_ifetch_program_counter;
+            assert pc = expected_pc report
+              "Took the instruction at " & integer'image(to_integer(pc)) &
+              ", expected the one at " & integer'image(to_integer(expected_pc))
+              severity failure;
+            assert from_ifetch_instruction = std_logic_vector(pc) report
+              "Instruction does not match its PC " & integer'image(to_integer(pc))
+              severity failure;
+
+            if pc = START_PC then
+              if seen_taken and seen_not_taken then
+                warm := true;
+              end if;
+              if iteration = ITERATIONS then
+                report "instruction_fetch_tb: " & integer'image(recoveries) &
+                  " branch mispredicts recovered from, " & integer'image(errors) & " errors";
+                assert recoveries > 0 report
+                  "The branch never mispredicted after warm-up; recovery was not exercised"
+                  severity failure;
+                assert errors = 0 report "instruction_fetch_tb FAILED" severity failure;
+                report "instruction_fetch_tb PASSED";
+                done <= '1';
+              end if;
+              iteration := iteration + 1;
+            end if;
+
+            kind  := kind_of(pc);
+            taken := '1';
+            case kind is
+              when CALL =>
+                next_pc      := target_of(pc);
+                stack(depth) := pc + 4;
+                depth        := depth + 1;
+              when JUMP =>
+                next_pc := target_of(pc);
+              when RET =>
+                depth   := depth - 1;
+                next_pc := stack(depth);
+              when BRANCH =>
+                taken := lfsr(0);
+                lfsr  := lfsr(14 downto 0) & (lfsr(15) xor lfsr(13) xor lfsr(12) xor lfsr(10));
+                if taken = '1' then
+                  next_pc    := target_of(pc);
+                  seen_taken := true;
+                else
+                  next_pc        := pc + 4;
+                  seen_not_taken := true;
+                end if;
+              when NONE =>
+                report "No instruction at " & integer'image(to_integer(pc)) severity failure;
+            end case;
+
+            mispredicted := from_ifetch_predicted_pc /= next_pc;
+            if warm and mispredicted then
+              if kind = BRANCH then
+                recoveries := recoveries + 1;
+              else
+                report kind_type'image(kind) & " at " & integer'image(to_integer(pc)) &
+                  " predicted " & integer'image(to_integer(from_ifetch_predicted_pc)) &
+                  " instead of " & integer'image(to_integer(next_pc))
+                  severity error;
+                errors := errors + 1;
+              end if;
+            end if;
+
+            to_ifetch_ready <= '0';
+            wait_cycles     := EXECUTE_CYCLES;
+            state           := RESOLVE;
+          end if;
+
+        when RESOLVE =>
+          if wait_cycles > 1 then
+            wait_cycles := wait_cycles - 1;
+          else
+            --As the branch unit does: the update is valid for a cycle, the
+            --correction until it is accepted, and both use the source PC.
+            to_predictor_update_valid  <= '1';
+            to_predictor_update_branch <= '0';
+            if kind = BRANCH then
+              to_predictor_update_branch <= '1';
+            end if;
+            to_predictor_update_taken  <= taken;
+            to_predictor_update_target <= next_pc;
+            to_predictor_update_call   <= '0';
+            if kind = CALL then
+              to_predictor_update_call <= '1';
+            end if;
+            to_predictor_update_return <= '0';
+            if kind = RET then
+              to_predictor_update_return <= '1';
+            end if;
+            to_pc_correction_source_pc <= pc;
+            to_pc_correction_data      <= next_pc;
+            expected_pc                := next_pc;
+            if mispredicted then
+              to_pc_correction_valid <= '1';
+              state                  := CORRECT;
+            else
+              to_ifetch_ready <= '1';
+              state           := TAKE;
+            end if;
+          end if;
+
+        when CORRECT =>
+          if from_pc_correction_ready = '1' then
+            to_pc_correction_valid <= '0';
+            to_ifetch_ready        <= '1';
+            state                  := TAKE;
+          end if;
+      end case;
+
+      if reset = '1' then
+        to_pc_correction_valid    <= '0';
+        to_predictor_update_valid <= '0';
+        to_ifetch_ready           <= '1';
+        state                     := TAKE;
+        depth                     := 0;
+        expected_pc               := START_PC;
+        lfsr                      := x"ACE1";
+        seen_taken                := false;
+        seen_not_taken            := false;
+        warm                      := false;
+        iteration                 := 0;
+        recoveries                := 0;
+        errors                    := 0;
+      end if;
+    end if;
+  end process;
+
+  process
+  begin
+    wait for CLOCK_PERIOD*400*ITERATIONS;
+    assert done = '1' report "instruction_fetch_tb timed out" severity failure;
+    wait;
+  end process;
+end architecture rtl;
@@ -0,0 +1,72 @@
+#Component testbenches for parts of ORCA the test systems don't cover on their
+#own (e.g. predictor and cache generics the .qsys files don't select).  Run
+#from this directory with 'vsim -c -do "source unit_tests.tcl; run_unit_tests"'
+#or 'make unit' from systems/sim.  Each testbench is self-checking and sets
+#its done signal only if it passed.
+
+proc com { args } {
+    set fileset [list \
+                     ../../../ip/orca/hdl/utils.vhd                 \
+                     ../../../ip/orca/hdl/constants_pkg.vhd         \
+                     ../../../ip/orca/hdl/components.vhd            \
+                     ../../../ip/orca/hdl/instruction_fetch.vhd     \
+                     ../../../ip/orca/hdl/bram_sdp_write_first.vhd  \
+                     ../../../ip/orca/hdl/cache.vhd                 \
+                     ../../../ip/orca/hdl/cache_controller.vhd      \
+                     instruction_fetch_tb.vhd                       \
+                     cache_controller_tb.vhd
+                ]
+
+    vlib work
+    foreach f $fileset {
+        vcom -work work -2002 -explicit $f
+    }
+}
+
+#Run one testbench with a list of generic overrides (e.g. -gBTB_ENTRIES=16)
+#and print a line saying whether it passed
+proc run_tb { tb generics } {
+    eval vsim -c -t 1ns $generics work.$tb
+    onbreak { resume }
+    run -all
+    set done [examine /$tb/done]
+    if { $done == "1" } {
+        set passfail "PASS"
+    } else {
+        set passfail "FAIL"
+    }
+    puts [format "%-24s %-48s %s" $tb $generics $passfail]
+    quit -sim
+}
+
+proc run_unit_tests { } {
+    com
+
+    foreach predictor {ONE_BIT TWO_BIT GSHARE} {
+        foreach waitrequest {0 3} {
+            run_tb instruction_fetch_tb "-gBRANCH_PREDICTOR=$predictor -gWAITREQUEST_EVERY=$waitrequest"
+        }
+    }
+    run_tb instruction_fetch_tb "-gBRANCH_PREDICTOR=TWO_BIT -gMAX_IFETCHES_IN_FLIGHT=3"
+
+    #Lines that fit in a set, then one more than fits to compare how the
+    #replacement policies thrash
+    run_tb cache_controller_tb "-gWAYS=1 -gCONFLICT_LINES=2"
+    foreach ways {2 4} {
+        foreach replacement {LRU PSEUDO_RANDOM} {
+            foreach lines [list $ways [expr {$ways+1}]] {
+                run_tb cache_controller_tb "-gWAYS=$ways -gREPLACEMENT=$replacement -gCONFLICT_LINES=$lines"
+            }
+        }
+    }
+
+    #Prefetchers against a fast and a slow memory; compare the stream phase
+    #cycles with NO_PREFETCH at the same latency
+    foreach latency {4 16} {
+        foreach prefetch {NO_PREFETCH NEXT_LINE STRIDE} {
+            run_tb cache_controller_tb "-gPREFETCH=$prefetch -gMEMORY_LATENCY=$latency"
+        }
+    }
+
+    exit -f;
+}
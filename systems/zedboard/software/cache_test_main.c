@@ -20,7 +20,7 @@
 #define MAX_PRINT_ERRORS 5
 
 #ifdef ORCA_DUC_READY_DELAYER_DC_BASE_ADDR
-#define USE_DELAYER_DC      0
+#define USE_DELAYER_DC      1
 #define DELAYER_DC_RANDOM   1
 #define DELAYER_DC_MASK     0x0113
 #define DELAYER_DC_CHANNELS 0x1F
@@ -47,6 +47,8 @@
 #define RUN_BTB_MISSES            1
 #define RUN_CACHE_MISSES          1
 #define RUN_CACHE_AND_BTB_MISSES  1
+#define RUN_DCACHE_CONFLICTS      1
+#define RUN_SEQUENTIAL_READ       1
 
 #define LOOP_RUNS 1000
 
@@ -71,6 +73,23 @@ typedef enum {INVALIDATE = 3, FLUSH = 2, WRITEBACK = 1, NOTHING = 0} cache_contr
 //sure that UC peripherals (like UART) are still accesible
 #define UC_MIN_MEMORY_BASE 0xC0000000
 
+//Set COUNT_EVENTS when ORCA is built with PERFORMANCE_COUNTERS of 3 or more
+//to print how often an event (line fills, mispredicts) happened while the
+//timing tests ran, counted on mhpmcounter3.
+#define COUNT_EVENTS 0
+
+#if COUNT_EVENTS
+#include "orca_counters.h"
+#define EVENT_COUNTER 3
+#define count_event(event) orca_counter_event(EVENT_COUNTER, (event))
+#define start_events()     orca_counter_write(EVENT_COUNTER, 0)
+#define print_events(what) printf("%9d %s.\r\n", (int)orca_counter_read(EVENT_COUNTER), (what))
+#else //#if COUNT_EVENTS
+#define count_event(event)
+#define start_events()
+#define print_events(what)
+#endif //#else //#if COUNT_EVENTS
+
 typedef void (*timing_loop)(uint32_t);
 
 #define RANDOM_TEST_RUNS CACHE_SIZE*16
@@ -500,6 +519,7 @@ uint32_t timing_test(uint32_t *first_loop_ptr,
     
       timing_loop the_timing_loop = (timing_loop)(first_loop_ptr);
   
+      start_events();
       uint32_t start_cycle = get_time();
       (*the_timing_loop)(LOOP_RUNS);
       uint32_t end_cycle = get_time();
@@ -507,6 +527,54 @@ uint32_t timing_test(uint32_t *first_loop_ptr,
       return end_cycle-start_cycle;
 }
 
+//Alternates loads between two words stride_bytes apart for timing.  With a
+//stride of CACHE_SIZE they share a line in a direct-mapped data cache and
+//every load misses; with DCACHE_WAYS of 2 or more they all hit.
+uint32_t conflict_test(uint32_t *first_word_ptr,
+                       uint32_t stride_bytes){
+  volatile uint32_t *first_word  = first_word_ptr;
+  volatile uint32_t *second_word = (volatile uint32_t *)(((uintptr_t)first_word_ptr)+stride_bytes);
+  uint32_t sum = 0;
+
+  start_events();
+  uint32_t start_cycle = get_time();
+  for(int run = 0; run < LOOP_RUNS; run++){
+    sum += *first_word;
+    sum += *second_word;
+  }
+  uint32_t end_cycle = get_time();
+
+  //Keep the loads from being optimized out
+  asm volatile("" : : "r"(sum));
+
+  return end_cycle-start_cycle;
+}
+
+//Loads every stride_bytes from bytes of memory that has been flushed from the
+//data cache, for timing.  Each line misses; with DCACHE_PREFETCH set the
+//misses after the first few should find their line already prefetched.  Set
+//USE_DELAYER_DC to add memory latency for prefetching to hide.
+uint32_t sequential_read_test(uint32_t *first_word_ptr,
+                              uint32_t bytes,
+                              uint32_t stride_bytes){
+  volatile uint32_t *word = first_word_ptr;
+  uint32_t sum = 0;
+
+  orca_flush_dcache_range((void *)first_word_ptr, (void *)(((uintptr_t)first_word_ptr)+bytes-1));
+
+  start_events();
+  uint32_t start_cycle = get_time();
+  for(uint32_t offset = 0; offset < bytes; offset += stride_bytes){
+    sum += word[offset/sizeof(uint32_t)];
+  }
+  uint32_t end_cycle = get_time();
+
+  //Keep the loads from being optimized out
+  asm volatile("" : : "r"(sum));
+
+  return end_cycle-start_cycle;
+}
+
 int main(void){
   if(WAIT_SECONDS_BEFORE_START){
     for(int i = 0; i < WAIT_SECONDS_BEFORE_START; i++){
@@ -831,9 +899,11 @@ int main(void){
 
       uint32_t timing_loop_size = (uint32_t)(((uintptr_t)(&idram_timing_loop_end))-((uintptr_t)(&idram_timing_loop)));
 
+      count_event(HPM_EVENT_MISPREDICT);
       uint32_t run_cycles = timing_test((uint32_t *)test_space_aligned, timing_loop_size);
       
       printf("%9d cycles for %d runs of 3 instruction (2 copy) loop.\r\n", (int)run_cycles, LOOP_RUNS);
+      print_events("branch mispredicts");
     }
 #endif //#if RUN_6_INSTRUCTION_LOOP
 
@@ -841,9 +911,13 @@ int main(void){
     {
       printf("-- BTB misses:\r\n");
 
+      //Both jumps share a BTB entry, so every one mispredicts whichever
+      //BRANCH_PREDICTOR is used.
+      count_event(HPM_EVENT_MISPREDICT);
       uint32_t run_cycles = timing_test((uint32_t *)test_space_aligned, (BTB_SIZE*sizeof(uint32_t)));
   
       printf("%9d cycles for %d runs of 3 instruction (2 copy) loop.\r\n", (int)run_cycles, LOOP_RUNS);
+      print_events("branch mispredicts");
     }
 #endif //#if RUN_BTB_MISSES
 
@@ -853,10 +927,13 @@ int main(void){
 
       //Increment by CACHE_SIZE + one word; this gives the same cache
       //line for both timing loops but a different BTB entry (assuming
-      //more than one BTB entry)
+      //more than one BTB entry).  With ICACHE_WAYS of 2 or more both
+      //loops stay cached.
+      count_event(HPM_EVENT_ICACHE_MISS);
       uint32_t run_cycles = timing_test((uint32_t *)test_space_aligned, (CACHE_SIZE+sizeof(uint32_t)));
   
       printf("%9d cycles for %d runs of 3 instruction (2 copy) loop.\r\n", (int)run_cycles, LOOP_RUNS);
+      print_events("instruction cache line fills");
     }
 #endif //#if RUN_CACHE_MISSES
 
@@ -870,6 +947,42 @@ int main(void){
     }
 #endif //#if RUN_CACHE_AND_BTB_MISSES
 
+#if RUN_DCACHE_CONFLICTS
+    {
+      printf("-- Data cache conflicts:\r\n");
+
+      count_event(HPM_EVENT_DCACHE_MISS);
+      uint32_t run_cycles = conflict_test((uint32_t *)test_space_aligned, CACHE_LINE_SIZE);
+
+      printf("%9d cycles for %d runs of 2 loads to different lines.\r\n", (int)run_cycles, LOOP_RUNS);
+      print_events("data cache line fills");
+
+      run_cycles = conflict_test((uint32_t *)test_space_aligned, CACHE_SIZE);
+
+      printf("%9d cycles for %d runs of 2 loads CACHE_SIZE apart.\r\n", (int)run_cycles, LOOP_RUNS);
+      print_events("data cache line fills");
+    }
+#endif //#if RUN_DCACHE_CONFLICTS
+
+#if RUN_SEQUENTIAL_READ
+    {
+      printf("-- Sequential reads:\r\n");
+
+      //Line fills include those copied from the prefetch buffer; compare
+      //cycles across DCACHE_PREFETCH settings to see what was hidden.
+      count_event(HPM_EVENT_DCACHE_MISS);
+      uint32_t run_cycles = sequential_read_test((uint32_t *)test_space_aligned, 2*CACHE_SIZE, sizeof(uint32_t));
+
+      printf("%9d cycles to read %d bytes a word at a time.\r\n", (int)run_cycles, 2*CACHE_SIZE);
+      print_events("data cache line fills");
+
+      run_cycles = sequential_read_test((uint32_t *)test_space_aligned, 2*CACHE_SIZE, 2*CACHE_LINE_SIZE);
+
+      printf("%9d cycles to read %d bytes every other line.\r\n", (int)run_cycles, 2*CACHE_SIZE);
+      print_events("data cache line fills");
+    }
+#endif //#if RUN_SEQUENTIAL_READ
+
   }
 
   if(errors){